@@ -18,6 +18,7 @@
 #define DIVISOR "  |  "
 #define DIVISOR_LENGTH 5
 #define EXIT_CODE -99
+#define LOAD_BATCH_SIZE 1024                  // Tuples inserted at once by load
 
 // DATABASE_FOLDER is given by makefile.inc file.
 // If your compiler complains about DATABASE_FOLDER, explicitly define DATABASE_FOLDER here
@@ -1190,6 +1191,7 @@ RC CLI::load() {
 
     string line, token;
     char *tokenizer;
+    vector<vector<char> > tuples;
     while (ifs.good()) {
         getline(ifs, line);
         if (line.compare("") == 0)
@@ -1242,7 +1244,8 @@ RC CLI::load() {
             if (keyIndex == attributes.size())
                 keyIndex = 0;
         }
-        if (this->insertTupleToDB(tableName, attributes, buffer, indexMap) != 0) {
+        tuples.push_back(vector<char>((char *) buffer, (char *) buffer + offset));
+        if (tuples.size() == LOAD_BATCH_SIZE && this->insertTuplesToDB(tableName, tuples) != 0) {
             return error("error while inserting tuple");
         }
 
@@ -1251,6 +1254,9 @@ RC CLI::load() {
         // for (std::vector<Attribute>::iterator it = attrs.begin() ; it != attrs.end(); ++it)
         // totalLength += it->length;
     }
+    if (!tuples.empty() && this->insertTuplesToDB(tableName, tuples) != 0) {
+        return error("error while inserting tuple");
+    }
     // clear up indexMap
     for (auto it = indexMap.begin(); it != indexMap.end(); ++it) {
         free(it->second);
@@ -1371,6 +1377,21 @@ RC CLI::insertTupleToDB(const string tableName, const vector<Attribute> attribut
     return 0;
 }
 
+// Inserts the tuples with one call to the record manager and empties the batch
+RC CLI::insertTuplesToDB(const string tableName, vector<vector<char> > &tuples) {
+    vector<const void *> data;
+    vector<RID> rids;
+    for (uint i = 0; i < tuples.size(); i++)
+        data.push_back(tuples[i].data());
+
+    RC rc = rm.insertTuples(tableName, data, rids);
+    tuples.clear();
+    if (rc != 0)
+        return error("error CLI::insertTuplesToDB in rm.insertTuples");
+
+    return 0;
+}
+
 RC CLI::printAttributes() {
     char *tokenizer = next();
     if (tokenizer == NULL) {
@@ -1638,12 +1659,12 @@ RC CLI::addIndexToCatalog(const string tableName, const string columnName) {
         return -1;
 
     int max_size = -1;
-    bool is_variable = false;
+    int is_variable = 0;
     for (uint i = 0; i < columns.size(); i++) {
         if (columns.at(i).name == columnName) {
             if (columns.at(i).type == TypeVarChar) {
                 max_size = columns.at(i).length + 2;
-                is_variable = true;
+                is_variable = 1;
             } else {
                 max_size = columns.at(i).length;
             }
@@ -1656,12 +1677,12 @@ RC CLI::addIndexToCatalog(const string tableName, const string columnName) {
 
     int offset = 0;
     int length;
-    void *buffer = malloc(tableName.size() + columnName.size() + 8 + 4 + 1 + 1);
+    void *buffer = malloc(tableName.size() + columnName.size() + 4 * sizeof(int) + 1);
 
     // Null-indicators
     unsigned char *nullsIndicator = (unsigned char *) malloc(1);
 
-    memset(buffer, 0, tableName.size() + columnName.size() + 8 + 4 + 1 + 1);
+    memset(buffer, 0, tableName.size() + columnName.size() + 4 * sizeof(int) + 1);
     memset(nullsIndicator, 0, 1);
 
     // Null-indicator for the fields
@@ -155,6 +155,8 @@ private:
     RC insertTupleToDB(const std::string tableName, const std::vector<Attribute> attributes, const void *data,
                        std::unordered_map<int, void *> indexMap);
 
+    RC insertTuplesToDB(const std::string tableName, std::vector<std::vector<char> > &tuples);
+
     RC getAttribute(const std::string name, const std::vector<Attribute> pool, Attribute &attr);
 
     RelationManager &rm = RelationManager::instance();
@@ -0,0 +1,99 @@
+#include <fstream>
+#include <cstdio>
+
+#include "cli.h"
+
+#define SUCCESS 0
+#define MODE 0  // 0 = TEST MODE
+// 1 = INTERACTIVE MODE
+// 3 = TEST + INTERACTIVE MODE
+
+CLI *cli;
+
+const int numberOfTuples = 2500;   // two full batches of load, and a partial one
+
+void exec(const std::string &command, bool equal = true) {
+    std::cout << ">>> " << command << std::endl;
+
+    if (equal)
+        assert (cli->process(command) == SUCCESS);
+    else
+        assert (cli->process(command) != SUCCESS);
+}
+
+// Line i of the file: Id, a Name of its own length, Score
+std::string batchName(int id) {
+    return std::string(1 + id % 30, 'a' + id % 26);
+}
+
+// test load in batches
+// test the index maintained by load
+void Test13() {
+    std::cout << "*********** CLI Test13 begins ******************" << std::endl;
+
+    const std::string fileName = "batch_2500";
+    const std::string fileUrl = std::string(DATABASE_FOLDER) + "../data/" + fileName;
+    std::ofstream ofs(fileUrl.c_str());
+    for (int id = 0; id < numberOfTuples; id++) {
+        ofs << id << "," << batchName(id) << "," << id / 2.0 << std::endl;
+    }
+    ofs.close();
+
+    // The catalog is created by Test01 already if it ran in this folder
+    cli->process("create catalog");
+
+    exec("create table tbl_batch Id = int, Name = varchar(40), Score = real");
+    exec("create index Id on tbl_batch");
+    exec("load tbl_batch " + fileName);
+
+    // Every line once, under the RID the index has for it
+    RelationManager &relationManager = RelationManager::instance();
+    std::vector<RID> rids(numberOfTuples);
+    std::vector<bool> seen(numberOfTuples, false);
+    RM_ScanIterator rmsi;
+    std::vector<std::string> attributeNames = {"Id", "Name", "Score"};
+    assert(relationManager.scan("tbl_batch", "", NO_OP, NULL, attributeNames, rmsi) == SUCCESS);
+    RID rid;
+    char data[100];
+    while (rmsi.getNextTuple(rid, data) != RM_EOF) {
+        int id, nameLength;
+        float score;
+        memcpy(&id, data + 1, sizeof(int));
+        memcpy(&nameLength, data + 1 + sizeof(int), sizeof(int));
+        memcpy(&score, data + 1 + 2 * sizeof(int) + nameLength, sizeof(float));
+        assert(id >= 0 && id < numberOfTuples && !seen[id]);
+        assert(std::string(data + 1 + 2 * sizeof(int), nameLength) == batchName(id) && score == id / 2.0f);
+        seen[id] = true;
+        rids[id] = rid;
+    }
+    rmsi.close();
+    assert(std::find(seen.begin(), seen.end(), false) == seen.end());
+
+    RM_IndexScanIterator rmisi;
+    assert(relationManager.indexScan("tbl_batch", "Id", NULL, NULL, true, true, rmisi) == SUCCESS);
+    int key;
+    int count = 0;
+    while (rmisi.getNextEntry(rid, &key) != RM_EOF) {
+        assert(key == count && rid.pageNum == rids[key].pageNum && rid.slotNum == rids[key].slotNum);
+        count++;
+    }
+    rmisi.close();
+    assert(count == numberOfTuples);
+
+    exec(("drop table tbl_batch"));
+    remove(fileUrl.c_str());
+}
+
+int main() {
+
+    cli = CLI::Instance();
+
+    if (MODE == 0 || MODE == 3) {
+        Test13();
+    }
+    if (MODE == 1 || MODE == 3) {
+        cli->start();
+    }
+
+    return 0;
+}
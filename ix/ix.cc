@@ -5,6 +5,7 @@
 #include <string>
 #include <unistd.h>
 #include <climits>
+#include <algorithm>
 
 using namespace std;
 
@@ -13,79 +14,64 @@ IndexManager &IndexManager::instance() {
     return _index_manager;
 }
 
-RC IndexManager::createFile(const std::string &fileName) {
-	//File already exists!
-	if(access(fileName.c_str(),F_OK) == 0)
-		return -1;
-
-	FILE *fp = fopen(fileName.c_str(),"wb+");
-	//File open error!
-	if(!fp)
-		return -1;
-
-	byte cnt[PAGE_SIZE];
-	memset(cnt,0,sizeof(cnt));
-	//cout<<cnt[0]<<" "<<cnt[1]<<" "<<cnt[2]<<" "<<cnt[3]<<endl;
-	fseek(fp,0,SEEK_SET);
-	fwrite(cnt,1,PAGE_SIZE,fp);
-	//if fp is not closed,there could be undefined behaviors, e.g.  counter value undefined.
-	//This is because when two file descriptors exist concurrently, they read like the other never writes.(they read original data)
-	fclose(fp);
-	return 0;
+//Index files share the paged file layout (hidden page first), so creation and removal are delegated to PFM
+RC IndexManager::createFile(const std::string &fileName, unsigned pageSize) {
+	return PagedFileManager::instance().createFile(fileName, pageSize);
 }
 
 RC IndexManager::destroyFile(const std::string &fileName) {
-	return remove(fileName.c_str());
+	return PagedFileManager::instance().destroyFile(fileName);
 }
 
 RC IndexManager::openFile(const std::string &fileName, IXFileHandle &ixFileHandle) {
-	//File doesn't exist!
-	if(access(fileName.c_str(),F_OK)) {
+	//fileHandle is already a handle for some open file!
+	if(ixFileHandle.fd >= 0) {
 		return -1;
 	}
 
-	//fileHandle is already a handle for some open file!
-	if(ixFileHandle.fp) {
+	ixFileHandle.fd = open(fileName.c_str(), O_RDWR);
+	//File doesn't exist or open error!
+	if(ixFileHandle.fd < 0) {
 		return -1;
 	}
 
-	ixFileHandle.fp = fopen(fileName.c_str(),"rb+");
-	//File open error!
-	if(!ixFileHandle.fp) {
+	unsigned cnt[HEADER_FIELDS];
+	if(PagedFileManager::readHeader(ixFileHandle.fd, cnt) != 0
+	   || BufferPool::instance().registerFile(fileName, cnt[HEADER_PAGE_SIZE], ixFileHandle.fileId) != 0) {
+		close(ixFileHandle.fd);
+		ixFileHandle.fd = -1;
 		return -1;
 	}
-
-	unsigned cnt[5];
-	fseek(ixFileHandle.fp,0,SEEK_SET);
-	fread(cnt,sizeof(unsigned),5,ixFileHandle.fp);
 	ixFileHandle.ixReadPageCounter = cnt[0];
 	ixFileHandle.ixWritePageCounter =  cnt[1];
 	ixFileHandle.ixAppendPageCounter = cnt[2];
 	ixFileHandle.noPages = cnt[3];
 	ixFileHandle.rootPage = cnt[4];
-
-	//cout<<cnt[0]<<" "<<cnt[1]<<" "<<cnt[2]<<" "<<cnt[3]<<endl;
+	ixFileHandle.pageSize = cnt[HEADER_PAGE_SIZE];
 	return 0;
 }
 
 RC IndexManager::closeFile(IXFileHandle &ixFileHandle) {
-	if(ixFileHandle.fp == NULL) {
+	if(ixFileHandle.fd < 0) {
 		return -1;
 	}
-	fseek(ixFileHandle.fp, 0, SEEK_SET);
 	unsigned cnt[5];
 	cnt[0] = ixFileHandle.ixReadPageCounter;
 	cnt[1] = ixFileHandle.ixWritePageCounter;
 	cnt[2] = ixFileHandle.ixAppendPageCounter;
 	cnt[3] = ixFileHandle.noPages;
 	cnt[4] = ixFileHandle.rootPage;
-	fwrite(cnt,sizeof(unsigned),5,ixFileHandle.fp);
+	RC rc = pwrite(ixFileHandle.fd, cnt, sizeof(cnt), 0) == sizeof(cnt) ? 0 : -1;
+	//Dirty frames are written back, the pool keeps caching the file's pages
+	if(BufferPool::instance().flushFile(ixFileHandle.fileId) != 0) {
+		rc = -1;
+	}
 	//File close error!
-	if(fclose(ixFileHandle.fp) == EOF) {
-		return -1;
+	if(close(ixFileHandle.fd) != 0) {
+		rc = -1;
 	}
-	ixFileHandle.fp = NULL;
-	return 0;
+	ixFileHandle.fd = -1;
+	return rc;
 }
 
 /***
@@ -195,9 +181,9 @@ RC IndexManager::getNewChildEntry(char *bin,const indexEntry newChildEntry,const
 }
 
 //Transforms from: BYTE* compositeKey ---> dataEntry& de
-RC IndexManager::resolveCompositeKey(char *compositeKey,const Attribute &attribute,
+RC IndexManager::resolveCompositeKey(const char *compositeKey,const Attribute &attribute,
 			dataEntry &de,unsigned &cLen) const {
-    char *composite = compositeKey;
+    const char *composite = compositeKey;
     if(attribute.type == AttrType::TypeInt){
         de.ival = *(int *)composite;
         composite += sizeof(int);
@@ -251,7 +237,8 @@ End of these four functions.
 
 RC IndexManager::createNewRoot(IXFileHandle &ixFileHandle,const indexEntry &newChildEntry,
 		const Attribute attribute,const unsigned leftChild,unsigned &newRootPageNum){
-    char root[PAGE_SIZE];
+    const unsigned pageSize = ixFileHandle.getPageSize();
+    char root[MAX_PAGE_SIZE];
     char *cur = root;
 
     //copy the left child node pointer into new root node
@@ -259,14 +246,14 @@ RC IndexManager::createNewRoot(IXFileHandle &ixFileHandle,const indexEntry &newC
     cur += sizeof(unsigned);
 
     //copy newChildEntry into new root node
-    char bin[PAGE_SIZE];
+    char bin[MAX_PAGE_SIZE];
     unsigned iLen;
     getNewChildEntry(bin,newChildEntry,attribute,iLen);
     memcpy(cur,bin,iLen);
     cur += iLen;
 
-    *(unsigned *)(root+PAGE_SIZE-sizeof(unsigned)) = cur-root;
-    *(unsigned *)(root+PAGE_SIZE-2*sizeof(unsigned)) = 0;
+    *(unsigned *)(root+pageSize-sizeof(unsigned)) = cur-root;
+    *(unsigned *)(root+pageSize-2*sizeof(unsigned)) = 0;
     
     int rc = ixFileHandle.appendPage(root);
     if(rc != 0)
@@ -277,7 +264,8 @@ RC IndexManager::createNewRoot(IXFileHandle &ixFileHandle,const indexEntry &newC
 
 //Search for the offset where the first data entry >= target entry
 RC IndexManager::searchEntry(IXFileHandle &ixFileHandle, const Attribute &attribute,const dataEntry &target,char *page,unsigned &offset){
-    unsigned freeSpaceOffset = *(unsigned *)(page+PAGE_SIZE-sizeof(unsigned));
+    const unsigned pageSize = ixFileHandle.getPageSize();
+    unsigned freeSpaceOffset = *(unsigned *)(page+pageSize-sizeof(unsigned));
 
     char *cur = page;
     dataEntry de;
@@ -340,7 +328,8 @@ RC IndexManager::searchEntry(IXFileHandle &ixFileHandle, const Attribute &attrib
 //Search for the offset where the first index entry >= target entry
 RC IndexManager::searchEntry(IXFileHandle &ixFileHandle, const Attribute &attribute,
 		const indexEntry &target,char *page,unsigned &offset){
-    unsigned freeSpaceOffset = *(unsigned *)(page+PAGE_SIZE-sizeof(unsigned));
+    const unsigned pageSize = ixFileHandle.getPageSize();
+    unsigned freeSpaceOffset = *(unsigned *)(page+pageSize-sizeof(unsigned));
     //cout<<"Free space offset when searching this index page:"<<freeSpaceOffset<<endl;
 
     //Skip the first node pointer
@@ -405,10 +394,11 @@ RC IndexManager::searchEntry(IXFileHandle &ixFileHandle, const Attribute &attrib
 
 RC IndexManager::searchEntry(IXFileHandle &ixFileHandle, const Attribute &attribute,
 		const indexEntry &target,const bool lowKeyInclusive,char *page,unsigned &offset){
+	const unsigned pageSize = ixFileHandle.getPageSize();
 	if(lowKeyInclusive)
 		return searchEntry(ixFileHandle, attribute, target, page, offset);
 	else{
-		unsigned freeSpaceOffset = *(unsigned *)(page+PAGE_SIZE-sizeof(unsigned));
+		unsigned freeSpaceOffset = *(unsigned *)(page+pageSize-sizeof(unsigned));
 
 		//Skip the first node pointer
 		char *cur = page+sizeof(unsigned);
@@ -448,10 +438,11 @@ RC IndexManager::searchEntry(IXFileHandle &ixFileHandle, const Attribute &attrib
 
 RC IndexManager::searchEntry(IXFileHandle &ixFileHandle, const Attribute &attribute,
                    const dataEntry &target,const bool lowKeyInclusive,char *page,unsigned &offset){
+	const unsigned pageSize = ixFileHandle.getPageSize();
 	if(lowKeyInclusive)
 		return searchEntry(ixFileHandle, attribute, target, page, offset);
 	else{
-		unsigned freeSpaceOffset = *(unsigned *)(page+PAGE_SIZE-sizeof(unsigned));
+		unsigned freeSpaceOffset = *(unsigned *)(page+pageSize-sizeof(unsigned));
 
 		char *cur = page;
 		dataEntry de;
@@ -495,10 +486,11 @@ The original node is named N,and the newly created one N2. 'index' stores data w
 **/
 RC IndexManager::splitIndexEntry(IXFileHandle &ixFileHandle,indexEntry &newChildEntry,const Attribute attribute,
     unsigned insertOffset,char *index,char *bin,const unsigned iLen,const unsigned pageNumber){
+    const unsigned pageSize = ixFileHandle.getPageSize();
     //Insert entry into the leaf node
-    char data[2*PAGE_SIZE]; //Auxiliary double-size page
-    char newn[PAGE_SIZE];
-    unsigned freeSpaceOffset = *(unsigned *)(index+PAGE_SIZE-sizeof(unsigned));
+    char data[2*MAX_PAGE_SIZE]; //Auxiliary double-size page
+    char newn[MAX_PAGE_SIZE];
+    unsigned freeSpaceOffset = *(unsigned *)(index+pageSize-sizeof(unsigned));
     unsigned spaceToBeSplit = freeSpaceOffset+iLen;
     //cout<<"Free space offset in the index page:"<<freeSpaceOffset<<" insertOffset:"<<insertOffset<<" entry length:"<<iLen<<endl;
     memcpy(data,index,insertOffset);
@@ -536,8 +528,8 @@ RC IndexManager::splitIndexEntry(IXFileHandle &ixFileHandle,indexEntry &newChild
     }
 
     memcpy(newn,start-sizeof(unsigned),spaceToBeSplit-(start-data)+sizeof(unsigned));
-    *(unsigned *)(newn+PAGE_SIZE-sizeof(unsigned)) = spaceToBeSplit-(start-data)+sizeof(unsigned); //Set free space indicator for N2
-    *(unsigned *)(newn+PAGE_SIZE-2*sizeof(unsigned)) = 0;
+    *(unsigned *)(newn+pageSize-sizeof(unsigned)) = spaceToBeSplit-(start-data)+sizeof(unsigned); //Set free space indicator for N2
+    *(unsigned *)(newn+pageSize-2*sizeof(unsigned)) = 0;
     //After deletion there would be unused page, a linked list for these unused page remains to be implemented.
     int rc = ixFileHandle.appendPage(newn);
     //cout<<"Append N2 return "<<rc<<endl;
@@ -554,7 +546,7 @@ RC IndexManager::splitIndexEntry(IXFileHandle &ixFileHandle,indexEntry &newChild
 
     //Modify N
     memcpy(index,data,cur-data); //Modify data entry within N
-    *(unsigned *)(index+PAGE_SIZE-sizeof(unsigned)) = cur-data; //Set free space indicator for N
+    *(unsigned *)(index+pageSize-sizeof(unsigned)) = cur-data; //Set free space indicator for N
 
 
     return 0;
@@ -562,11 +554,12 @@ RC IndexManager::splitIndexEntry(IXFileHandle &ixFileHandle,indexEntry &newChild
 
 RC IndexManager::splitDataEntry(IXFileHandle &ixFileHandle,indexEntry &newChildEntry,const Attribute attribute,
     const unsigned insertOffset,char *leaf,const char *composite,const unsigned ckLen,const unsigned pageNumber){
+    const unsigned pageSize = ixFileHandle.getPageSize();
     //Insert entry into the leaf node
     //Insert should be applied to 'leaf' page
-    char data[2*PAGE_SIZE];
-    char newn[PAGE_SIZE]; //Allocate for new node
-    unsigned freeSpaceOffset = *(unsigned *)(leaf+PAGE_SIZE-sizeof(unsigned));
+    char data[2*MAX_PAGE_SIZE];
+    char newn[MAX_PAGE_SIZE]; //Allocate for new node
+    unsigned freeSpaceOffset = *(unsigned *)(leaf+pageSize-sizeof(unsigned));
     unsigned spaceToBeSplit = freeSpaceOffset+ckLen;
     memcpy(data,leaf,insertOffset);
     memcpy(data+insertOffset,composite,ckLen);
@@ -591,12 +584,12 @@ RC IndexManager::splitDataEntry(IXFileHandle &ixFileHandle,indexEntry &newChildE
 
     //create a new leaf node called L2
     memcpy(newn,cur,spaceToBeSplit-(cur-data));
-    *(unsigned *)(newn+PAGE_SIZE-sizeof(unsigned)) = spaceToBeSplit-(cur-data); //Set free space indicator for N2
-    *(unsigned *)(newn+PAGE_SIZE-2*sizeof(unsigned)) = 1;
-    *(unsigned *)(newn+PAGE_SIZE-4*sizeof(unsigned)) = pageNumber;
+    *(unsigned *)(newn+pageSize-sizeof(unsigned)) = spaceToBeSplit-(cur-data); //Set free space indicator for N2
+    *(unsigned *)(newn+pageSize-2*sizeof(unsigned)) = 1;
+    *(unsigned *)(newn+pageSize-4*sizeof(unsigned)) = pageNumber;
     //rightSib could be -1 if it's the rightmost page
-    int rightSib = *(int *)(leaf+PAGE_SIZE-3*sizeof(unsigned));
-    *(int *)(newn+PAGE_SIZE-3*sizeof(unsigned)) = rightSib;
+    int rightSib = *(int *)(leaf+pageSize-3*sizeof(unsigned));
+    *(int *)(newn+pageSize-3*sizeof(unsigned)) = rightSib;
     //After deletion there would be unused page, a linked list for these unused page remains to be implemented.
     int rc = ixFileHandle.appendPage(newn);
     //cout<<"Append L2 return "<<rc<<endl;
@@ -611,12 +604,12 @@ RC IndexManager::splitDataEntry(IXFileHandle &ixFileHandle,indexEntry &newChildE
     //Change the sibling pointer of the leaf node that N originally points to.
     //cout<<"Right sibling page number:"<<rightSib<<endl;
     if(rightSib != -1){
-    	char r[PAGE_SIZE];
+    	char r[MAX_PAGE_SIZE];
 		rc = ixFileHandle.readPage(rightSib, r);
 		//cout<<"Read right sibling return "<<rc<<endl;
 		if(rc != 0)
 			return -1;
-		*(unsigned *)(r+PAGE_SIZE-4*sizeof(unsigned)) = ixFileHandle.getNumberOfPages()-1;
+		*(unsigned *)(r+pageSize-4*sizeof(unsigned)) = ixFileHandle.getNumberOfPages()-1;
 		rc = ixFileHandle.writePage(rightSib, r);
 		//cout<<"Modify right sibling return "<<rc<<endl;
 		if(rc != 0)
@@ -630,8 +623,8 @@ RC IndexManager::splitDataEntry(IXFileHandle &ixFileHandle,indexEntry &newChildE
 
     //Modify L
     memcpy(leaf,data,cur-data); //Modify data entry within L
-    *(unsigned *)(leaf+PAGE_SIZE-sizeof(unsigned)) = cur-data; //Set free space indicator
-    *(unsigned *)(leaf+PAGE_SIZE-3*sizeof(unsigned)) = newChildEntry.pageNum; //Set right sibling to be L2
+    *(unsigned *)(leaf+pageSize-sizeof(unsigned)) = cur-data; //Set free space indicator
+    *(unsigned *)(leaf+pageSize-3*sizeof(unsigned)) = newChildEntry.pageNum; //Set right sibling to be L2
 
     /*
      * If we are splitting the first page of an index file(which is root page as well as data entry page),
@@ -655,8 +648,9 @@ but fail to write back certain page in some level of the tree, then there would
 **/
 RC IndexManager::backtraceInsert(IXFileHandle &ixFileHandle,const unsigned pageNumber,const Attribute &attribute,
     const void *key,const RID &rid,indexEntry &newChildEntry){
+    const unsigned pageSize = ixFileHandle.getPageSize();
     bool isFull;
-    char page[PAGE_SIZE];
+    char page[MAX_PAGE_SIZE];
     int rc = ixFileHandle.readPage(pageNumber,page);
     if(rc != 0)
         return -1;
@@ -665,14 +659,14 @@ RC IndexManager::backtraceInsert(IXFileHandle &ixFileHandle,const unsigned pageN
     unsigned ckLen;
     transformKeyRIDPair(attribute,keyEntry,key,rid,ckLen);
 
-    unsigned freeSpaceOffset = *(unsigned *)(page+PAGE_SIZE-sizeof(unsigned));
-    bool isLeaf = *(unsigned *)(page+PAGE_SIZE-2*sizeof(unsigned));
+    unsigned freeSpaceOffset = *(unsigned *)(page+pageSize-sizeof(unsigned));
+    bool isLeaf = *(unsigned *)(page+pageSize-2*sizeof(unsigned));
 
     if(isLeaf){
         //Leaf node case
-        char composite[PAGE_SIZE];
+        char composite[MAX_PAGE_SIZE];
         getCompositeKey(composite,attribute,keyEntry,ckLen);
-        isFull = freeSpaceOffset+ckLen > PAGE_SIZE-4*sizeof(unsigned);
+        isFull = freeSpaceOffset+ckLen > pageSize-4*sizeof(unsigned);
         //cout<<"Current freeSpaceOffset:"<<freeSpaceOffset<<" data entry length:"<<ckLen<<endl;
         //cout<<"Leaf page "<<pageNumber<<" full? "<<isFull<<endl;
 
@@ -686,7 +680,7 @@ RC IndexManager::backtraceInsert(IXFileHandle &ixFileHandle,const unsigned pageN
             if(offset < freeSpaceOffset)
                 memmove(page+offset+ckLen,page+offset,freeSpaceOffset-offset);
             memcpy(page+offset,composite,ckLen);
-            *(unsigned *)(page+PAGE_SIZE-sizeof(unsigned)) += ckLen; //Change free space indicator
+            *(unsigned *)(page+pageSize-sizeof(unsigned)) += ckLen; //Change free space indicator
             //newChildEntry.valid = false;
         }else{
         	//if(rid.pageNum % 50 == 0)
@@ -713,10 +707,10 @@ RC IndexManager::backtraceInsert(IXFileHandle &ixFileHandle,const unsigned pageN
             return 0;
         }else{
             //Implement pointer pointing to its child nodes!
-            char bin[PAGE_SIZE];
+            char bin[MAX_PAGE_SIZE];
             unsigned iLen;
             getNewChildEntry(bin,newChildEntry,attribute,iLen);
-            isFull = freeSpaceOffset+iLen > PAGE_SIZE-2*sizeof(unsigned);
+            isFull = freeSpaceOffset+iLen > pageSize-2*sizeof(unsigned);
 
             /**
             If there are enough space in this node for the copy-up entry,just insert it,else split this node.
@@ -733,7 +727,7 @@ RC IndexManager::backtraceInsert(IXFileHandle &ixFileHandle,const unsigned pageN
                 if(offset < freeSpaceOffset)
                     memmove(page+offset+iLen,page+offset,freeSpaceOffset-offset);
                 memcpy(page+offset,bin,iLen);
-                *(unsigned *)(page+PAGE_SIZE-sizeof(unsigned)) += iLen; //Change free space indicator
+                *(unsigned *)(page+pageSize-sizeof(unsigned)) += iLen; //Change free space indicator
                 newChildEntry.valid = false; //Set newChildEntry to be NULL
             }else{ //Since no enough space,split index node
             	//cout<<"Current index page number:"<<pageNumber<<endl;
@@ -763,13 +757,14 @@ RC IndexManager::backtraceInsert(IXFileHandle &ixFileHandle,const unsigned pageN
 }
 
 RC IndexManager::insertEntry(IXFileHandle &ixFileHandle, const Attribute &attribute, const void *key, const RID &rid) {
+	const unsigned pageSize = ixFileHandle.getPageSize();
 	if(ixFileHandle.noPages == 0){
-		char firstPage[PAGE_SIZE];
+		char firstPage[MAX_PAGE_SIZE];
 		memset(firstPage,0,sizeof(firstPage));
-		*(unsigned *)(firstPage+PAGE_SIZE-sizeof(unsigned)) = 0;
-		*(unsigned *)(firstPage+PAGE_SIZE-2*sizeof(unsigned)) = 1;
-		*(int *)(firstPage+PAGE_SIZE-3*sizeof(int)) = -1;
-		*(int *)(firstPage+PAGE_SIZE-4*sizeof(int)) = -1;
+		*(unsigned *)(firstPage+pageSize-sizeof(unsigned)) = 0;
+		*(unsigned *)(firstPage+pageSize-2*sizeof(unsigned)) = 1;
+		*(int *)(firstPage+pageSize-3*sizeof(int)) = -1;
+		*(int *)(firstPage+pageSize-4*sizeof(int)) = -1;
 		int rc = ixFileHandle.appendPage(firstPage);
 		if(rc != 0)
 			return -1;
@@ -784,20 +779,21 @@ RC IndexManager::insertEntry(IXFileHandle &ixFileHandle, const Attribute &attrib
 }
 
 RC IX_ScanIterator::findFirstLeafPage(IXFileHandle& fileHandle, unsigned& pageNo) {
+    const unsigned pageSize = fileHandle.getPageSize();
     if(fileHandle.noPages == 0) {
         return -1;
     }
 
-    byte page[PAGE_SIZE];
+    byte page[MAX_PAGE_SIZE];
     for(unsigned currPage = fileHandle.rootPage ; true ; currPage = *reinterpret_cast<unsigned*>(page)) {
         int rc = fileHandle.readPage(currPage,page);
         if(rc != 0) {
             return -1;
         }
 
-        if(*reinterpret_cast<unsigned*>(page+PAGE_SIZE-2*sizeof(unsigned)) == 1) {
+        if(*reinterpret_cast<unsigned*>(page+pageSize-2*sizeof(unsigned)) == 1) {
             pageNo = currPage;
-            lastReadFreeSpaceOffset = *reinterpret_cast<unsigned *>(page+PAGE_SIZE-sizeof(unsigned));
+            lastReadFreeSpaceOffset = *reinterpret_cast<unsigned *>(page+pageSize-sizeof(unsigned));
             lastReadDataEntryLength = 0;
             return 0;
         }
@@ -806,13 +802,14 @@ RC IX_ScanIterator::findFirstLeafPage(IXFileHandle& fileHandle, unsigned& pageNo
 
 RC IndexManager::searchIndexTree(IXFileHandle& fileHandle, const unsigned pageNumber,
 		const Attribute& attribute,const bool lowKeyInclusive, const dataEntry& dataEnt, unsigned& leafPageNo) {
-    char page[PAGE_SIZE];
+    const unsigned pageSize = fileHandle.getPageSize();
+    char page[MAX_PAGE_SIZE];
     RC rc = fileHandle.readPage(pageNumber,page);
     if(rc != 0) {
         return -1;
     }
     //If page is a leaf, return its number
-    if(*reinterpret_cast<unsigned*>(page+PAGE_SIZE-2*sizeof(unsigned)) == 1) {
+    if(*reinterpret_cast<unsigned*>(page+pageSize-2*sizeof(unsigned)) == 1) {
         leafPageNo = pageNumber;
         return 0;
     }
@@ -852,12 +849,13 @@ RC IndexManager::deleteEntry(IXFileHandle &ixFileHandle, const Attribute &attrib
 }
 
 RC IndexManager::deleteEntryHelper(IXFileHandle &ixFileHandle, const unsigned pageNumber, const Attribute &attribute, const dataEntry& dataEnt, bool amIRoot) {
-    char page[PAGE_SIZE];
+    const unsigned pageSize = ixFileHandle.getPageSize();
+    char page[MAX_PAGE_SIZE];
     RC rc = ixFileHandle.readPage(pageNumber,page);
     if(rc != 0) {
         return -1;
     }
-    const unsigned freeSpaceOffset = *reinterpret_cast<unsigned *>(page+PAGE_SIZE-sizeof(unsigned));
+    const unsigned freeSpaceOffset = *reinterpret_cast<unsigned *>(page+pageSize-sizeof(unsigned));
     unsigned offset;
 
     //If page is a leaf, delete the data entry, if found
@@ -865,7 +863,7 @@ RC IndexManager::deleteEntryHelper(IXFileHandle &ixFileHandle, const unsigned pa
     //key not found/internal error: -1
     //key found and deleted without freeing the page: 0
     //key found and deleted at the same time freeing the page: -2
-    if(*reinterpret_cast<unsigned*>(page+PAGE_SIZE-2*sizeof(unsigned)) == 1) {
+    if(*reinterpret_cast<unsigned*>(page+pageSize-2*sizeof(unsigned)) == 1) {
         rc = IndexManager::instance().searchEntry(ixFileHandle, attribute, dataEnt, page, offset);
         if(rc != 0 || offset >= freeSpaceOffset) {  //key not found
             return -1;
@@ -880,9 +878,9 @@ RC IndexManager::deleteEntryHelper(IXFileHandle &ixFileHandle, const unsigned pa
         }
         else if(freeSpaceOffset == readDataEntryLength) { //found data entry is the only one on page, we have to free the page:
             //we have to update freeSpaceOffset anyway, for the sake of getNextEntry method
-            *reinterpret_cast<unsigned *>(page+PAGE_SIZE-sizeof(unsigned)) -= readDataEntryLength;
-            int rightSiblingPageNo = *reinterpret_cast<int*>(page+PAGE_SIZE-3*sizeof(int));
-            int leftSiblingPageNo = *reinterpret_cast<int*>(page+PAGE_SIZE-4*sizeof(int));
+            *reinterpret_cast<unsigned *>(page+pageSize-sizeof(unsigned)) -= readDataEntryLength;
+            int rightSiblingPageNo = *reinterpret_cast<int*>(page+pageSize-3*sizeof(int));
+            int leftSiblingPageNo = *reinterpret_cast<int*>(page+pageSize-4*sizeof(int));
             rc = ixFileHandle.writePage(pageNumber,page);
             if(rc != 0) {
                 return -1;
@@ -893,7 +891,7 @@ RC IndexManager::deleteEntryHelper(IXFileHandle &ixFileHandle, const unsigned pa
                 if(rc != 0) {
                     return -1;
                 }
-                *reinterpret_cast<int*>(page+PAGE_SIZE-3*sizeof(int)) = rightSiblingPageNo;
+                *reinterpret_cast<int*>(page+pageSize-3*sizeof(int)) = rightSiblingPageNo;
                 rc = ixFileHandle.writePage(leftSiblingPageNo,page);
                 if(rc != 0) {
                     return -1;
@@ -904,7 +902,7 @@ RC IndexManager::deleteEntryHelper(IXFileHandle &ixFileHandle, const unsigned pa
                 if(rc != 0) {
                     return -1;
                 }
-                *reinterpret_cast<int*>(page+PAGE_SIZE-4*sizeof(int)) = leftSiblingPageNo;
+                *reinterpret_cast<int*>(page+pageSize-4*sizeof(int)) = leftSiblingPageNo;
                 rc = ixFileHandle.writePage(rightSiblingPageNo,page);
                 if(rc != 0) {
                     return -1;
@@ -915,7 +913,7 @@ RC IndexManager::deleteEntryHelper(IXFileHandle &ixFileHandle, const unsigned pa
         }
         else {  //leaf page contains more than one data entry
             memmove(page+offset, page+offset+readDataEntryLength, freeSpaceOffset-(offset+readDataEntryLength));
-            *reinterpret_cast<unsigned *>(page+PAGE_SIZE-sizeof(unsigned)) -= readDataEntryLength;
+            *reinterpret_cast<unsigned *>(page+pageSize-sizeof(unsigned)) -= readDataEntryLength;
             rc = ixFileHandle.writePage(pageNumber,page);
             if(rc != 0) {
                 return -1;
@@ -930,6 +928,22 @@ RC IndexManager::deleteEntryHelper(IXFileHandle &ixFileHandle, const unsigned pa
         if(rc != 0) {
             return -1;
         }
+        //A split copies the first data entry of the right page up: an index entry equal to the target leads to its right child
+        if(offset < freeSpaceOffset) {
+            indexEntry readIndexEnt;
+            unsigned readIndexEntLength;
+            resolveNewChildEntry(page+offset, readIndexEnt, attribute, readIndexEntLength);
+            bool sameKey;
+            if(attribute.type == AttrType::TypeInt)
+                sameKey = readIndexEnt.ival == indexEnt.ival;
+            else if(attribute.type == AttrType::TypeReal)
+                sameKey = readIndexEnt.fval == indexEnt.fval;
+            else
+                sameKey = readIndexEnt.key == indexEnt.key;
+            if(sameKey && readIndexEnt.rid.pageNum == indexEnt.rid.pageNum && readIndexEnt.rid.slotNum == indexEnt.rid.slotNum) {
+                offset += readIndexEntLength;
+            }
+        }
 
         rc = deleteEntryHelper(ixFileHandle, *reinterpret_cast<unsigned*>(page+offset-sizeof(unsigned)), attribute, dataEnt, false);
         if(rc == 0 || rc == -1) { //no deletion took place below this node/page below this node had more than one entry when the deletion took place (rc==0) OR key not found (rc==-1)
@@ -964,7 +978,7 @@ RC IndexManager::deleteEntryHelper(IXFileHandle &ixFileHandle, const unsigned pa
             else { //not last index entry: shift entries, update freeSpaceOffset and return 0
                                                       //lengthOfIndexEnt already includes sizeof(unsigned) so we have to subtract it
                 memmove(page+offset-sizeof(unsigned), page+offset-sizeof(unsigned)+lengthOfIndexEnt, freeSpaceOffset-(offset-sizeof(unsigned)+lengthOfIndexEnt));
-                *reinterpret_cast<unsigned *>(page+PAGE_SIZE-sizeof(unsigned)) -= lengthOfIndexEnt;
+                *reinterpret_cast<unsigned *>(page+pageSize-sizeof(unsigned)) -= lengthOfIndexEnt;
                 rc = ixFileHandle.writePage(pageNumber,page);
                 if(rc != 0) {
                     return -1;
@@ -1005,12 +1019,15 @@ RC IndexManager::scan(IXFileHandle &ixFileHandle,
         ix_ScanIterator.setLowKeyInfinity(true);
     }
     else {
+        //The iterator may come from an earlier scan without a low key
+        ix_ScanIterator.setLowKeyInfinity(false);
         ix_ScanIterator.setLowKeyEntry(lowKeyEntry);
     }
     if(transformKeyRIDPair(attribute, highKeyEntry, highKey, dummyRID, dummyLength) != 0) {
         ix_ScanIterator.setHighKeyInfinity(true);
     }
     else {
+        ix_ScanIterator.setHighKeyInfinity(false);
         ix_ScanIterator.setHighKeyEntry(highKeyEntry);
     }
 
@@ -1045,14 +1062,15 @@ string IndexManager::RIDtoStr(const RID &rid) const {
 
 void IndexManager::printNode(IXFileHandle &ixFileHandle, const Attribute &attribute,
 		const unsigned pageNumber,const unsigned level) const {
-	char node[PAGE_SIZE];
+	const unsigned pageSize = ixFileHandle.getPageSize();
+	char node[MAX_PAGE_SIZE];
 	int rc = ixFileHandle.readPage(pageNumber, node);
 	if(rc != 0)
 		return;
 
 	char *cur = node;
-	unsigned isLeaf = *(unsigned *)(node+PAGE_SIZE-2*sizeof(unsigned));
-	unsigned freeSpaceOffset = *(unsigned *)(node+PAGE_SIZE-sizeof(unsigned));
+	unsigned isLeaf = *(unsigned *)(node+pageSize-2*sizeof(unsigned));
+	unsigned freeSpaceOffset = *(unsigned *)(node+pageSize-sizeof(unsigned));
 	printTab(level);
 	cout<<"{\"keys\":[";
 	if(isLeaf){
@@ -1134,6 +1152,7 @@ IX_ScanIterator::~IX_ScanIterator() {
  * In addition, IX_ScanIterator::lastReadFreeSpaceOffset and IX_ScanIterator::lastReadDataEntryLength is initialized.
  * */
 RC IX_ScanIterator::determineInitialPageAndOffset() {
+    const unsigned pageSize = ixFileHandle.getPageSize();
     RC rc;
     if(lowKeyInfinity) {
         rc = findFirstLeafPage(ixFileHandle, currPage);
@@ -1155,12 +1174,12 @@ RC IX_ScanIterator::determineInitialPageAndOffset() {
         }
     }
 
-    char page[PAGE_SIZE];
+    char page[MAX_PAGE_SIZE];
     rc = ixFileHandle.readPage(currPage,page);
     if(rc != 0) {
         return rc;
     }
-    unsigned currentFreeSpaceOffset = *reinterpret_cast<unsigned *>(page+PAGE_SIZE-sizeof(unsigned));
+    unsigned currentFreeSpaceOffset = *reinterpret_cast<unsigned *>(page+pageSize-sizeof(unsigned));
 
     rc = IndexManager::instance().searchEntry(ixFileHandle, attribute, lowKeyEntry, lowKeyInclusive, page, currOffset);
     if(rc != 0) {
@@ -1168,7 +1187,7 @@ RC IX_ScanIterator::determineInitialPageAndOffset() {
     }
     //If the record is not on the page where it's supposed to be:
     if(currOffset >= currentFreeSpaceOffset){
-        currPage = *reinterpret_cast<int *>(page+PAGE_SIZE-3*sizeof(unsigned));
+        currPage = *reinterpret_cast<int *>(page+pageSize-3*sizeof(unsigned));
         if(currPage == -1) {
             return IX_EOF;
         }
@@ -1206,6 +1225,7 @@ void IX_ScanIterator::transformDataEntryKey(dataEntry dataEnt, void* key) const
 }
 
 RC IX_ScanIterator::getNextEntry(RID &rid, void *key) {
+    const unsigned pageSize = ixFileHandle.getPageSize();
     /*
      * During the very first scan operation we need to find the corresponding page and offset
      * of the first qualifying data entry.
@@ -1217,6 +1237,7 @@ RC IX_ScanIterator::getNextEntry(RID &rid, void *key) {
             return IX_EOF;
         }
         scanning = true;
+        readAheadLeaf = UINT_MAX;
         //cout<<"First page number for scanning:"<<currPage<<endl;
     }
     if(currPage == -1) {
@@ -1249,12 +1270,18 @@ RC IX_ScanIterator::getNextEntry(RID &rid, void *key) {
      //towards the beginning of the page
     //-----------------------------------------------------------------------------------------------------------
 
-    char page[PAGE_SIZE];
-    RC rc = ixFileHandle.readPage(currPage,page);
+    byte buffer[MAX_PAGE_SIZE];
+    const byte *pageData;
+    RC rc = ixFileHandle.accessPage(currPage,pageData,buffer);
     if(rc != 0) {
         return rc;
     }
-    unsigned currentFreeSpaceOffset = *reinterpret_cast<unsigned *>(page+PAGE_SIZE-sizeof(unsigned));
+    if(currPage != readAheadLeaf) {
+        readAheadLeaf = currPage;
+        ixFileHandle.readAheadLeaves(currPage);
+    }
+    const char *page = reinterpret_cast<const char *>(pageData);
+    unsigned currentFreeSpaceOffset = *reinterpret_cast<const unsigned *>(page+pageSize-sizeof(unsigned));
 
     if(lastReadFreeSpaceOffset != INT_MAX && currentFreeSpaceOffset < lastReadFreeSpaceOffset){
 		currOffset -= lastReadDataEntryLength;
@@ -1287,7 +1314,7 @@ RC IX_ScanIterator::getNextEntry(RID &rid, void *key) {
     transformDataEntryKey(readDataEntry, key);
     currOffset += lastReadDataEntryLength;
     if(currOffset >= currentFreeSpaceOffset){
-    	currPage = *reinterpret_cast<int *>(page+PAGE_SIZE-3*sizeof(unsigned));
+    	currPage = *reinterpret_cast<const int *>(page+pageSize-3*sizeof(unsigned));
     	currOffset = 0;
     	lastReadFreeSpaceOffset = INT_MAX;
     }
@@ -1380,7 +1407,13 @@ IXFileHandle::IXFileHandle() {
     ixAppendPageCounter = 0;
     noPages = 0;
     rootPage = 0;
-    fp = nullptr;
+    ixBufferHitCounter = 0;
+    ixBufferMissCounter = 0;
+    fd = -1;
+    fileId = 0;
+    mappedReads = false;
+    leafReadAhead = READ_AHEAD_MIN_PAGES;
+    pageSize = PAGE_SIZE;
 }
 
 IXFileHandle::~IXFileHandle() {
@@ -1393,12 +1426,14 @@ RC IXFileHandle::readPage(PageNum pageNum, void *data){
 		return -1;
 	}
 
-	fseek( fp, (pageNum+1)*PAGE_SIZE, SEEK_SET );
-	unsigned res = fread(data,sizeof(char),PAGE_SIZE,fp);
-	//File read error!
-	if(res != PAGE_SIZE && feof(fp) != EOF)
+	byte *frame;
+	bool hit;
+	if(BufferPool::instance().pinPage(fileId, pageNum, true, frame, hit) != 0)
 		return -1;
+	memcpy(data, frame, pageSize);
+	BufferPool::instance().unpinPage(fileId, pageNum, false);
 
+	hit ? ixBufferHitCounter++ : ixBufferMissCounter++;
 	ixReadPageCounter++;
     flushCountersToDisk();
 	return 0;
@@ -1412,11 +1447,13 @@ RC IXFileHandle::writePage(PageNum pageNum, const void *data){
 		return -1;
 	}
 
-	fseek( fp, (pageNum+1)*PAGE_SIZE, SEEK_SET );
-	unsigned res = fwrite(data,sizeof(char),PAGE_SIZE,fp);
-	//File write error!
-	if(res != PAGE_SIZE)
+	//The whole page is overwritten, so there is no need to read it first
+	byte *frame;
+	bool hit;
+	if(BufferPool::instance().pinPage(fileId, pageNum, false, frame, hit) != 0)
 		return -1;
+	memcpy(frame, data, pageSize);
+	BufferPool::instance().unpinPage(fileId, pageNum, true);
 
 	ixWritePageCounter++;
     flushCountersToDisk();
@@ -1424,11 +1461,14 @@ RC IXFileHandle::writePage(PageNum pageNum, const void *data){
 }
 
 RC IXFileHandle::appendPage(const void *data){
-	fseek( fp, 0, SEEK_END );
-	unsigned res = fwrite(data,sizeof(char),PAGE_SIZE,fp);
-	//File append error!
-	if(res != PAGE_SIZE)
+	if(BufferPool::instance().reservePage(fileId, noPages, PagedFileManager::instance().getExtentSize()) != 0)
 		return -1;
+	byte *frame;
+	bool hit;
+	if(BufferPool::instance().pinPage(fileId, noPages, false, frame, hit) != 0)
+		return -1;
+	memcpy(frame, data, pageSize);
+	BufferPool::instance().unpinPage(fileId, noPages, true);
 
 	noPages++;
 	ixAppendPageCounter++;
@@ -1436,21 +1476,120 @@ RC IXFileHandle::appendPage(const void *data){
 	return 0;
 }
 
+RC IXFileHandle::readPages(PageNum firstPage, unsigned count, void *data){
+	std::vector<void *> pages(count);
+	for(unsigned i = 0 ; i < count ; ++i) {
+		pages[i] = static_cast<byte *>(data) + i*pageSize;
+	}
+	return readPages(firstPage, count, pages.data());
+}
+
+RC IXFileHandle::readPages(PageNum firstPage, unsigned count, void *const pages[]){
+	//Intend to read non-existing pages!
+	if(firstPage > noPages || count > noPages-firstPage){
+		ixReadPageCounter += count;
+		flushCountersToDisk();
+		return -1;
+	}
+
+	unsigned hits;
+	if(BufferPool::instance().readPages(fileId, firstPage, count, reinterpret_cast<byte *const *>(pages), hits) != 0)
+		return -1;
+
+	ixBufferHitCounter += hits;
+	ixBufferMissCounter += count-hits;
+	ixReadPageCounter += count;
+    flushCountersToDisk();
+	return 0;
+}
+
+RC IXFileHandle::writePages(PageNum firstPage, unsigned count, const void *data){
+	std::vector<const void *> pages(count);
+	for(unsigned i = 0 ; i < count ; ++i) {
+		pages[i] = static_cast<const byte *>(data) + i*pageSize;
+	}
+	return writePages(firstPage, count, pages.data());
+}
+
+RC IXFileHandle::writePages(PageNum firstPage, unsigned count, const void *const pages[]){
+	//Intend to update non-existing pages!
+	if(firstPage > noPages || count > noPages-firstPage){
+		ixWritePageCounter += count;
+		flushCountersToDisk();
+		return -1;
+	}
+
+	if(BufferPool::instance().writePages(fileId, firstPage, count, reinterpret_cast<const byte *const *>(pages)) != 0)
+		return -1;
+
+	ixWritePageCounter += count;
+    flushCountersToDisk();
+	return 0;
+}
+
+RC IXFileHandle::setMappedReads(bool enabled, bool sequential) {
+	if(fd < 0) {
+		return -1;
+	}
+	mappedReads = enabled;
+	return enabled ? BufferPool::instance().adviseSequential(fileId, sequential) : 0;
+}
+
+RC IXFileHandle::mapPage(PageNum pageNum, const byte *&data) {
+	if(pageNum >= noPages){
+		ixReadPageCounter++;
+		return -1;
+	}
+	if(BufferPool::instance().mapPage(fileId, pageNum, data) != 0)
+		return -1;
+	ixReadPageCounter++;
+    flushCountersToDisk();
+	return 0;
+}
+
+RC IXFileHandle::accessPage(PageNum pageNum, const byte *&data, byte *buffer) {
+	if(mappedReads) {
+		return mapPage(pageNum, data);
+	}
+	data = buffer;
+	return readPage(pageNum, buffer);
+}
+
+/**
+The leaves are chained, so the pool reads them one after the other, each read starting once the previous leaf
+(and its sibling pointer) is in memory. If none of the next leaves was in memory yet, the scan is catching up with
+the reads and the window doubles; if the whole window was there already, it shrinks back.
+**/
+void IXFileHandle::readAheadLeaves(PageNum leafPage) {
+	//with mapped reads, the kernel reads ahead
+	if(mappedReads) {
+		return;
+	}
+	unsigned cachedAhead;
+	if(BufferPool::instance().prefetchChain(fileId, leafPage, pageSize-3*sizeof(unsigned), leafReadAhead, cachedAhead) != 0) {
+		return;
+	}
+	if(cachedAhead == 0) {
+		leafReadAhead = std::min(2*leafReadAhead, static_cast<unsigned>(READ_AHEAD_MAX_PAGES));
+	}
+	else if(cachedAhead >= leafReadAhead) {
+		leafReadAhead = std::max(leafReadAhead/2, static_cast<unsigned>(READ_AHEAD_MIN_PAGES));
+	}
+}
+
 void IXFileHandle::flushCountersToDisk()  {
-    fseek(fp, 0, SEEK_SET);
     unsigned cnt[5];
     cnt[0] = ixReadPageCounter;
     cnt[1] = ixWritePageCounter;
     cnt[2] = ixAppendPageCounter;
     cnt[3] = noPages;
     cnt[4] = rootPage;
-    fwrite(cnt,sizeof(unsigned),5,fp);
+    pwrite(fd, cnt, sizeof(cnt), 0);
 }
 
 RC IXFileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount) {
     unsigned cnt[3];
-    fseek(fp,0,SEEK_SET);
-    fread(cnt,sizeof(unsigned),3,fp);
+    pread(fd, cnt, sizeof(cnt), 0);
     ixReadPageCounter = cnt[0];
     ixWritePageCounter =  cnt[1];
     ixAppendPageCounter = cnt[2];
@@ -1460,3 +1599,17 @@ RC IXFileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePa
     appendPageCount = ixAppendPageCounter;
     return 0;
 }
+
+RC IXFileHandle::collectBufferCounterValues(unsigned &hitCount, unsigned &missCount) {
+    hitCount = ixBufferHitCounter;
+    missCount = ixBufferMissCounter;
+    return 0;
+}
+
+RC IXFileHandle::flush() {
+	if(fd < 0) {
+		return -1;
+	}
+	flushCountersToDisk();
+	return BufferPool::instance().flushFile(fileId, true);
+}
@@ -94,7 +94,14 @@ public:
     unsigned ixAppendPageCounter;
     unsigned noPages;
     unsigned rootPage;
-    FILE *fp;
+    unsigned pageSize; // node size, recorded in the hidden page
+    // buffer pool statistics of readPage(), they are not persisted in the hidden page
+    unsigned ixBufferHitCounter;
+    unsigned ixBufferMissCounter;
+    int fd; // -1 when no file is open, only used with pread/pwrite
+    unsigned fileId; // Id of the file in the BufferPool
+    bool mappedReads; // accessPage() returns pointers into a mapping of the file
+    unsigned leafReadAhead; // number of leaves prefetched ahead of a scan, adapts to the scan's pace
 
     // Constructor
     IXFileHandle();
@@ -102,7 +109,7 @@ public:
     // Destructor
     ~IXFileHandle();
 
-    bool isValid() { return fp != NULL; }
+    bool isValid() { return fd >= 0; }
 
     RC readPage(PageNum pageNum, void *data);
 
@@ -110,11 +117,38 @@ public:
 
     RC appendPage(const void *data);
 
+    // Vectored variants (see FileHandle::readPages), counted as one read or write per page
+    RC readPages(PageNum firstPage, unsigned count, void *data);
+
+    RC readPages(PageNum firstPage, unsigned count, void *const pages[]);
+
+    RC writePages(PageNum firstPage, unsigned count, const void *data);
+
+    RC writePages(PageNum firstPage, unsigned count, const void *const pages[]);
+
+    // Zero-copy read path (see FileHandle::accessPage), writes keep going through writePage()
+    RC setMappedReads(bool enabled, bool sequential = false);
+
+    RC mapPage(PageNum pageNum, const byte *&data);
+
+    RC accessPage(PageNum pageNum, const byte *&data, byte *buffer);
+
+    // Called by the scans when they enter a leaf: prefetches the next leaves along the right-sibling pointers
+    void readAheadLeaves(PageNum leafPage);
+
     // Put the current counter values of associated PF FileHandles into variables
     RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount);
 
+    // Put the buffer pool hits/misses of this handle into variables
+    RC collectBufferCounterValues(unsigned &hitCount, unsigned &missCount);
+
+    // Make the index durable: counters, dirty pages of the buffer pool, fdatasync()
+    RC flush();
+
     unsigned getNumberOfPages() {return noPages;}
 
+    unsigned getPageSize() const {return pageSize;}
+
 private:
     void flushCountersToDisk();
 };
@@ -140,6 +174,7 @@ class IX_ScanIterator {
     unsigned currOffset;
     unsigned lastReadFreeSpaceOffset;
     unsigned lastReadDataEntryLength;
+    unsigned readAheadLeaf; // leaf from which the read-ahead was started last
 
     RC determineInitialPageAndOffset();
 
@@ -203,8 +238,8 @@ class IndexManager {
 public:
     static IndexManager &instance();
 
-    // Create an index file.
-    RC createFile(const std::string &fileName);
+    // Create an index file, whose nodes are pages of "pageSize" bytes.
+    RC createFile(const std::string &fileName, unsigned pageSize = PAGE_SIZE);
 
     // Delete an index file.
     RC destroyFile(const std::string &fileName);
@@ -246,7 +281,7 @@ public:
     RC searchEntry(IXFileHandle &ixFileHandle, const Attribute &attribute,
                    const dataEntry &target,const bool lowKeyInclusive,char *page,unsigned &offset);
 
-    RC resolveCompositeKey(char *compositeKey,const Attribute &attribute,dataEntry &de,unsigned &cLen) const;
+    RC resolveCompositeKey(const char *compositeKey,const Attribute &attribute,dataEntry &de,unsigned &cLen) const;
 
 protected:
     IndexManager() = default;                                                   // Prevent construction
@@ -0,0 +1,166 @@
+#include "ix.h"
+#include "ix_test_util.h"
+
+const unsigned numOfPages = 24;
+const unsigned numOfFrames = 16;
+
+// Page p: its number, then a byte of its own that "version" shifts
+void prepareIndexPage(PageNum p, unsigned version, unsigned pageSize, byte *page) {
+    memset(page, (p * 5 + version * 11 + 3) & 0xFF, pageSize);
+    memcpy(page, &p, sizeof(PageNum));
+}
+
+// Counters of the handle (from its hidden page) and of the pool
+struct IndexPageCounters {
+    unsigned reads, writes, appends, hits, misses, written;
+
+    explicit IndexPageCounters(IXFileHandle &ixFileHandle) {
+        ixFileHandle.collectCounterValues(reads, writes, appends);
+        ixFileHandle.collectBufferCounterValues(hits, misses);
+        written = BufferPool::instance().getPagesWritten();
+    }
+};
+
+// The pages of [first, first+numOfPages) that are a multiple of 3 away from "first" get a frame
+void makeResident(IXFileHandle &ixFileHandle, PageNum first) {
+    RC rc = BufferPool::instance().setCapacity(numOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+    std::vector<byte> page(ixFileHandle.getPageSize());
+    for (PageNum p = 0; p < numOfPages; p += 3) {
+        rc = ixFileHandle.readPage(first + p, page.data());
+        assert(rc == success && "IXFileHandle::readPage() should not fail.");
+    }
+}
+
+void testIndexPages(const std::string &indexFileName, unsigned pageSize) {
+    RC rc = indexManager.createFile(indexFileName, pageSize);
+    assert(rc == success && "indexManager::createFile() should not fail.");
+    IXFileHandle ixFileHandle;
+    rc = indexManager.openFile(indexFileName, ixFileHandle);
+    assert(rc == success && "indexManager::openFile() should not fail.");
+
+    // The pages follow the root of the empty index
+    const PageNum first = ixFileHandle.getNumberOfPages();
+    std::vector<byte> data(numOfPages * pageSize);
+    std::vector<byte> expected(pageSize);
+    for (PageNum p = 0; p < numOfPages; p++) {
+        prepareIndexPage(first + p, 0, pageSize, data.data() + p * pageSize);
+        rc = ixFileHandle.appendPage(data.data() + p * pageSize);
+        assert(rc == success && "IXFileHandle::appendPage() should not fail.");
+    }
+    rc = ixFileHandle.flush();
+    assert(rc == success && "IXFileHandle::flush() should not fail.");
+
+    // Scattered read: 8 of the 24 pages come from their frames
+    makeResident(ixFileHandle, first);
+    const unsigned resident = 8;
+    std::vector<std::vector<byte> > buffers(numOfPages, std::vector<byte>(pageSize));
+    std::vector<void *> pages(numOfPages);
+    for (unsigned i = 0; i < numOfPages; i++) {
+        pages[i] = buffers[i].data();
+    }
+    IndexPageCounters before(ixFileHandle);
+    rc = ixFileHandle.readPages(first, numOfPages, pages.data());
+    assert(rc == success && "IXFileHandle::readPages() should not fail.");
+    IndexPageCounters after(ixFileHandle);
+    for (unsigned i = 0; i < numOfPages; i++) {
+        assert(memcmp(buffers[i].data(), data.data() + i * pageSize, pageSize) == 0 && "A page should read back as written.");
+    }
+    assert(after.reads - before.reads == numOfPages && "Each page read should be counted once.");
+    assert(after.hits - before.hits == resident && after.misses - before.misses == numOfPages - resident
+           && "The resident pages should be hits, the others misses.");
+    assert(after.writes == before.writes && after.appends == before.appends && "A read should not count writes.");
+
+    // Scattered write: the resident pages are dirtied in their frames, the others written right away
+    makeResident(ixFileHandle, first);
+    std::vector<const void *> constPages(numOfPages);
+    for (unsigned i = 0; i < numOfPages; i++) {
+        prepareIndexPage(first + i, 1, pageSize, buffers[i].data());
+        constPages[i] = buffers[i].data();
+    }
+    before = IndexPageCounters(ixFileHandle);
+    rc = ixFileHandle.writePages(first, numOfPages, constPages.data());
+    assert(rc == success && "IXFileHandle::writePages() should not fail.");
+    after = IndexPageCounters(ixFileHandle);
+    assert(after.writes - before.writes == numOfPages && "Each page written should be counted once.");
+    assert(after.reads == before.reads && after.appends == before.appends && "A write should not count reads.");
+    assert(after.written - before.written == numOfPages - resident && "Only the pages without a frame should reach the file.");
+
+    // Packed read of the pages just written, nothing resident once the pool is emptied
+    rc = BufferPool::instance().setCapacity(numOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+    before = IndexPageCounters(ixFileHandle);
+    rc = ixFileHandle.readPages(first, numOfPages, data.data());
+    assert(rc == success && "IXFileHandle::readPages() should not fail.");
+    after = IndexPageCounters(ixFileHandle);
+    for (unsigned i = 0; i < numOfPages; i++) {
+        assert(memcmp(buffers[i].data(), data.data() + i * pageSize, pageSize) == 0 && "A page should read back as written.");
+    }
+    assert(after.reads - before.reads == numOfPages && after.misses - before.misses == numOfPages
+           && after.hits == before.hits && "Each page read from the file should be counted once, as a miss.");
+
+    // Packed write, then read back through readPage()
+    for (PageNum p = 0; p < numOfPages; p++) {
+        prepareIndexPage(first + p, 2, pageSize, data.data() + p * pageSize);
+    }
+    before = IndexPageCounters(ixFileHandle);
+    rc = ixFileHandle.writePages(first, numOfPages, data.data());
+    assert(rc == success && "IXFileHandle::writePages() should not fail.");
+    after = IndexPageCounters(ixFileHandle);
+    assert(after.writes - before.writes == numOfPages && "Each page written should be counted once.");
+    for (PageNum p = 0; p < numOfPages; p++) {
+        rc = ixFileHandle.readPage(first + p, expected.data());
+        assert(rc == success && memcmp(data.data() + p * pageSize, expected.data(), pageSize) == 0
+               && "A page should read back as written.");
+    }
+
+    // Past the last page: nothing is transferred, the pages are counted all the same
+    before = IndexPageCounters(ixFileHandle);
+    rc = ixFileHandle.readPages(first + numOfPages - 2, 4, data.data());
+    assert(rc != success && "Reading pages past the end of the file should fail.");
+    rc = ixFileHandle.writePages(first + numOfPages - 2, 4, data.data());
+    assert(rc != success && "Writing pages past the end of the file should fail.");
+    after = IndexPageCounters(ixFileHandle);
+    assert(after.reads - before.reads == 4 && after.writes - before.writes == 4 && "Failed transfers should be counted per page.");
+
+    rc = indexManager.closeFile(ixFileHandle);
+    assert(rc == success && "indexManager::closeFile() should not fail.");
+    rc = indexManager.destroyFile(indexFileName);
+    assert(rc == success && "indexManager::destroyFile() should not fail.");
+}
+
+int testCase_Pages(const std::string &indexFileName) {
+    // Functions tested
+    // 1. IXFileHandle::readPages() and writePages(), with a buffer per page and packed in one buffer
+    // 2. Resident pages are copied from and to their frames, the others transferred with the file
+    // 3. The counters kept in the hidden page count pages, the buffer pool hits and misses as well
+    std::cerr << std::endl << "***** In IX Test Case Pages *****" << std::endl;
+
+    BufferPool &bufferPool = BufferPool::instance();
+    const unsigned capacity = bufferPool.getCapacity();
+    // Dirty frames only reach the file when the test flushes them
+    bufferPool.setBackgroundWriterDelay(0);
+
+    testIndexPages(indexFileName, PAGE_SIZE);
+    testIndexPages(indexFileName, 2 * PAGE_SIZE);
+
+    bufferPool.setBackgroundWriterDelay(BG_WRITER_DELAY);
+    RC rc = bufferPool.setCapacity(capacity);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+
+    return success;
+}
+
+int main() {
+    const std::string indexFileName = "pages_idx";
+
+    indexManager.destroyFile(indexFileName);
+
+    if (testCase_Pages(indexFileName) == success) {
+        std::cerr << "***** IX Test Case Pages finished. The result will be examined. *****" << std::endl;
+        return success;
+    } else {
+        std::cerr << "***** [FAIL] IX Test Case Pages failed. *****" << std::endl;
+        return fail;
+    }
+}
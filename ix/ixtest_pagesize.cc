@@ -0,0 +1,153 @@
+#include "ix.h"
+#include "ix_test_util.h"
+
+const unsigned numOfIntKeys = 20000;
+const unsigned numOfVarCharKeys = 300;
+
+// Key i of a varchar index: i on six digits, then letters up to "length" characters
+void prepareWideKey(const unsigned length, const unsigned i, char *key) {
+    *(int *) key = length;
+    snprintf(key + 4, 7, "%06u", i);
+    memset(key + 10, 'a' + i % 26, length - 6);
+}
+
+// Scans [lowKey, highKey] (NULL: unbounded) and checks that the entries come in key order, rids matching their keys
+unsigned scanIntIndex(IXFileHandle &ixFileHandle, const Attribute &attribute, const int *lowKey, const int *highKey) {
+    IX_ScanIterator ix_ScanIterator;
+    RC rc = indexManager.scan(ixFileHandle, attribute, lowKey, highKey, true, true, ix_ScanIterator);
+    assert(rc == success && "indexManager::scan() should not fail.");
+    RID rid;
+    int key;
+    int previous = lowKey != NULL ? *lowKey - 1 : -1;
+    unsigned count = 0;
+    while (ix_ScanIterator.getNextEntry(rid, &key) == success) {
+        assert(key > previous && "The entries should come in key order.");
+        assert(rid.pageNum == (unsigned) key && rid.slotNum == (unsigned) key % 100 && "The rid should be the key's.");
+        assert((highKey == NULL || key <= *highKey) && "The entries should be in the range.");
+        previous = key;
+        count++;
+    }
+    rc = ix_ScanIterator.close();
+    assert(rc == success && "IX_ScanIterator::close() should not fail.");
+    return count;
+}
+
+// Int keys inserted in a scattered order: the leaves split many times
+void testIntIndex(const std::string &indexFileName, unsigned pageSize) {
+    Attribute attribute;
+    attribute.length = 4;
+    attribute.name = "age";
+    attribute.type = TypeInt;
+
+    RC rc = indexManager.createFile(indexFileName, pageSize);
+    assert(rc == success && "indexManager::createFile() should not fail.");
+    IXFileHandle ixFileHandle;
+    rc = indexManager.openFile(indexFileName, ixFileHandle);
+    assert(rc == success && ixFileHandle.getPageSize() == pageSize && "The index should have the page size it was created with.");
+
+    RID rid;
+    for (unsigned i = 0; i < numOfIntKeys; i++) {
+        int key = (i * 7919) % numOfIntKeys;
+        rid.pageNum = key;
+        rid.slotNum = key % 100;
+        rc = indexManager.insertEntry(ixFileHandle, attribute, &key, rid);
+        assert(rc == success && "indexManager::insertEntry() should not fail.");
+    }
+    assert(ixFileHandle.getNumberOfPages() > numOfIntKeys * 12 / pageSize && "The leaves should have split.");
+
+    assert(scanIntIndex(ixFileHandle, attribute, NULL, NULL) == numOfIntKeys && "A full scan should return every entry.");
+    int lowKey = 5000, highKey = 14999;
+    assert(scanIntIndex(ixFileHandle, attribute, &lowKey, &highKey) == 10000 && "A range scan should return the range.");
+
+    // Every third key is deleted
+    for (unsigned key = 0; key < numOfIntKeys; key += 3) {
+        rid.pageNum = key;
+        rid.slotNum = key % 100;
+        rc = indexManager.deleteEntry(ixFileHandle, attribute, &key, rid);
+        assert(rc == success && "indexManager::deleteEntry() should not fail.");
+    }
+    assert(scanIntIndex(ixFileHandle, attribute, NULL, NULL) == numOfIntKeys - (numOfIntKeys + 2) / 3
+           && "A full scan should skip the deleted entries.");
+
+    rc = indexManager.closeFile(ixFileHandle);
+    assert(rc == success && "indexManager::closeFile() should not fail.");
+    rc = indexManager.destroyFile(indexFileName);
+    assert(rc == success && "indexManager::destroyFile() should not fail.");
+}
+
+// Varchar keys a sixth of a page long, wider than 4096 bytes with 64K pages: a few keys per node
+void testVarCharIndex(const std::string &indexFileName, unsigned pageSize) {
+    Attribute attribute;
+    attribute.length = pageSize / 6;
+    attribute.name = "EmpName";
+    attribute.type = TypeVarChar;
+
+    RC rc = indexManager.createFile(indexFileName, pageSize);
+    assert(rc == success && "indexManager::createFile() should not fail.");
+    IXFileHandle ixFileHandle;
+    rc = indexManager.openFile(indexFileName, ixFileHandle);
+    assert(rc == success && "indexManager::openFile() should not fail.");
+
+    std::vector<char> key(MAX_PAGE_SIZE);
+    RID rid;
+    for (unsigned i = 0; i < numOfVarCharKeys; i++) {
+        const unsigned k = (i * 37) % numOfVarCharKeys;
+        prepareWideKey(attribute.length, k, key.data());
+        rid.pageNum = k;
+        rid.slotNum = k;
+        rc = indexManager.insertEntry(ixFileHandle, attribute, key.data(), rid);
+        assert(rc == success && "indexManager::insertEntry() should not fail.");
+    }
+
+    // From key 100 on, every key once and in order, whole
+    std::vector<char> lowKey(MAX_PAGE_SIZE);
+    std::vector<char> expected(MAX_PAGE_SIZE);
+    prepareWideKey(attribute.length, 100, lowKey.data());
+    IX_ScanIterator ix_ScanIterator;
+    rc = indexManager.scan(ixFileHandle, attribute, lowKey.data(), NULL, true, true, ix_ScanIterator);
+    assert(rc == success && "indexManager::scan() should not fail.");
+    unsigned k = 100;
+    while (ix_ScanIterator.getNextEntry(rid, key.data()) == success) {
+        prepareWideKey(attribute.length, k, expected.data());
+        assert(rid.pageNum == k && rid.slotNum == k && "The entries should come in key order.");
+        assert(memcmp(key.data(), expected.data(), 4 + attribute.length) == 0 && "The key should be returned whole.");
+        k++;
+    }
+    assert(k == numOfVarCharKeys && "The scan should return every key of the range.");
+    rc = ix_ScanIterator.close();
+    assert(rc == success && "IX_ScanIterator::close() should not fail.");
+
+    rc = indexManager.closeFile(ixFileHandle);
+    assert(rc == success && "indexManager::closeFile() should not fail.");
+    rc = indexManager.destroyFile(indexFileName);
+    assert(rc == success && "indexManager::destroyFile() should not fail.");
+}
+
+int testCase_PageSize(const std::string &indexFileName) {
+    // Functions tested
+    // 1. Indexes of 8K and 64K pages: inserts splitting the leaves and the inner nodes
+    // 2. Full and range scans, after deletes as well
+    // 3. Varchar keys wider than 4096 bytes
+    std::cerr << std::endl << "***** In IX Test Case PageSize *****" << std::endl;
+
+    testIntIndex(indexFileName, 2 * PAGE_SIZE);
+    testIntIndex(indexFileName, MAX_PAGE_SIZE);
+    testVarCharIndex(indexFileName, 2 * PAGE_SIZE);
+    testVarCharIndex(indexFileName, MAX_PAGE_SIZE);
+
+    return success;
+}
+
+int main() {
+    const std::string indexFileName = "pagesize_idx";
+
+    indexManager.destroyFile(indexFileName);
+
+    if (testCase_PageSize(indexFileName) == success) {
+        std::cerr << "***** IX Test Case PageSize finished. The result will be examined. *****" << std::endl;
+        return success;
+    } else {
+        std::cerr << "***** [FAIL] IX Test Case PageSize failed. *****" << std::endl;
+        return fail;
+    }
+}
@@ -0,0 +1,91 @@
+#include "ix.h"
+#include "ix_test_util.h"
+
+const unsigned numOfKeys = 30000;
+// Enough frames for the whole index: a prefetched leaf is never evicted before it is read
+const unsigned numOfFrames = 512;
+
+int testCase_ReadAhead(const std::string &indexFileName) {
+    // Functions tested
+    // 1. A scan over many leaves: each leaf it enters prefetches the next ones along the sibling pointers
+    //    (BufferPool::prefetchChain())
+    // 2. Only the pages read to find the first entry are misses, every leaf after it is a hit
+    std::cerr << std::endl << "***** In IX Test Case ReadAhead *****" << std::endl;
+
+    Attribute attribute;
+    attribute.length = 4;
+    attribute.name = "age";
+    attribute.type = TypeInt;
+
+    BufferPool &bufferPool = BufferPool::instance();
+    const unsigned capacity = bufferPool.getCapacity();
+
+    RC rc = indexManager.createFile(indexFileName);
+    assert(rc == success && "indexManager::createFile() should not fail.");
+    IXFileHandle ixFileHandle;
+    rc = indexManager.openFile(indexFileName, ixFileHandle);
+    assert(rc == success && "indexManager::openFile() should not fail.");
+    RID rid;
+    for (unsigned i = 0; i < numOfKeys; i++) {
+        int key = (i * 7919) % numOfKeys;
+        rid.pageNum = key;
+        rid.slotNum = key % 100;
+        rc = indexManager.insertEntry(ixFileHandle, attribute, &key, rid);
+        assert(rc == success && "indexManager::insertEntry() should not fail.");
+    }
+    assert(ixFileHandle.getNumberOfPages() > numOfKeys * 12 / PAGE_SIZE && "The index should have many leaves.");
+    rc = indexManager.closeFile(ixFileHandle);
+    assert(rc == success && "indexManager::closeFile() should not fail.");
+
+    // Nothing of the index in the pool: the pages of the first entry are read, the leaves after it prefetched
+    rc = bufferPool.setCapacity(numOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+    rc = indexManager.openFile(indexFileName, ixFileHandle);
+    assert(rc == success && "indexManager::openFile() should not fail.");
+    IX_ScanIterator ix_ScanIterator;
+    rc = indexManager.scan(ixFileHandle, attribute, NULL, NULL, true, true, ix_ScanIterator);
+    assert(rc == success && "indexManager::scan() should not fail.");
+    int key;
+    rc = ix_ScanIterator.getNextEntry(rid, &key);
+    assert(rc == success && key == 0 && "The scan should start at the first key.");
+    // The iterator reads through its own copy of the handle
+    const IXFileHandle &scanHandle = ix_ScanIterator.getIxFileHandle();
+    const unsigned descentMisses = scanHandle.ixBufferMissCounter;
+    assert(descentMisses > 0 && "The path to the first leaf should be read.");
+
+    int previous = key;
+    unsigned count = 1;
+    while (ix_ScanIterator.getNextEntry(rid, &key) == success) {
+        assert(key == previous + 1 && rid.pageNum == (unsigned) key && "The entries should come in key order.");
+        previous = key;
+        count++;
+    }
+    assert(count == numOfKeys && "A full scan should return every entry.");
+    assert(scanHandle.ixBufferMissCounter == descentMisses && "Every leaf after the first should have been prefetched.");
+    assert(ixFileHandle.getNumberOfPages() - descentMisses > 50 && "The scan should have gone through many leaves.");
+    rc = ix_ScanIterator.close();
+    assert(rc == success && "IX_ScanIterator::close() should not fail.");
+
+    rc = indexManager.closeFile(ixFileHandle);
+    assert(rc == success && "indexManager::closeFile() should not fail.");
+    rc = indexManager.destroyFile(indexFileName);
+    assert(rc == success && "indexManager::destroyFile() should not fail.");
+    rc = bufferPool.setCapacity(capacity);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+
+    return success;
+}
+
+int main() {
+    const std::string indexFileName = "readahead_idx";
+
+    indexManager.destroyFile(indexFileName);
+
+    if (testCase_ReadAhead(indexFileName) == success) {
+        std::cerr << "***** IX Test Case ReadAhead finished. The result will be examined. *****" << std::endl;
+        return success;
+    } else {
+        std::cerr << "***** [FAIL] IX Test Case ReadAhead failed. *****" << std::endl;
+        return fail;
+    }
+}
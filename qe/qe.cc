@@ -12,54 +12,48 @@ using namespace std;
 Filter::Filter(Iterator *input, const Condition &condition) {
 	it = input;
 	con = condition;
+	vector<Attribute> attrs;
 	input->getAttributes(attrs);
+	schema = Schema(attrs);
+	conditionField = schema.indexOf(con.lhsAttr);
+
+	//Over a table scan (maybe through other filters pushed into it), the condition is checked by the scan itself
+	pushedInto = NULL;
+	if(!con.bRhsIsAttr && con.op != NO_OP) {
+		TableScan *scan = dynamic_cast<TableScan *>(input);
+		Filter *filter = dynamic_cast<Filter *>(input);
+		if(scan == NULL && filter != NULL)
+			scan = filter->pushedInto;
+		if(scan != NULL && scan->pushDown(con.lhsAttr, con.op, con.rhsValue.data))
+			pushedInto = scan;
+	}
 }
 
 /*
  * Input: char *data(null indicator + actual data)
  * */
 bool Filter::filterMatch(char *data){
-	unsigned nullLen = (unsigned)(ceil(attrs.size()/8.0));
-	char *actualData = data+nullLen;
-	for(unsigned i = 0;i < attrs.size();i++){
-		const char* byteInNullInfoField = data + i/8;
-		bool nullField = *byteInNullInfoField & (1 << 7-i%8);
-		if(attrs[i].name == con.lhsAttr) {
-			if(!nullField) {
-				if(attrs[i].type == TypeInt) {
-					int eval = *(int *)actualData;
-					return performOp(eval, *(int *)con.rhsValue.data);
-				}
-				else if(attrs[i].type == TypeReal) {
-					float eval = *(float *)actualData;
-					return performOp(eval, *(float *)con.rhsValue.data);
-				}
-				else {
-					unsigned conLen = *(unsigned *)(con.rhsValue.data);
-					unsigned tupleStrLen = *(unsigned *)actualData;
-					string eval = string(actualData+sizeof(unsigned),tupleStrLen);
-					return performOp(eval, string((char *)con.rhsValue.data+sizeof(unsigned),conLen));
-				}
-			}
-			else {
-                return false;
-			}
-		}
-		else if(!nullField) {
-            if(attrs[i].type == TypeInt) {
-                actualData += sizeof(int);
-            }
-            else if(attrs[i].type == TypeReal) {
-                actualData += sizeof(float);
-            }
-            else{
-                unsigned strLen = *(unsigned *)actualData;
-                actualData += (sizeof(unsigned)+strLen);
-            }
-		}
-	}
 	// If the filtered field can't be found,return false.
-	return false;
+	if(conditionField == -1)
+		return false;
+	unsigned length;
+	const char *actualData = (const char *)schema.findField(data, conditionField, length);
+	if(actualData == NULL)
+		return false;
+	if(schema.getType(conditionField) == TypeInt) {
+		int eval = *(int *)actualData;
+		return performOp(eval, *(int *)con.rhsValue.data);
+	}
+	else if(schema.getType(conditionField) == TypeReal) {
+		float eval = *(float *)actualData;
+		return performOp(eval, *(float *)con.rhsValue.data);
+	}
+	else {
+		unsigned conLen = *(unsigned *)(con.rhsValue.data);
+		unsigned tupleStrLen = *(unsigned *)actualData;
+		string eval = string(actualData+sizeof(unsigned),tupleStrLen);
+		return performOp(eval, string((char *)con.rhsValue.data+sizeof(unsigned),conLen));
+	}
 }
 
 template <typename T>
@@ -83,6 +77,9 @@ bool Filter::performOp(const T &x,const T &y){
 RC Filter::getNextTuple(void *data){
 	//Filter this tuple got from other operators or tableScan/IndexScan
 	int rc = it->getNextTuple(data);
+	if(pushedInto != NULL) {
+		return rc != 0 ? QE_EOF : 0;
+	}
 	if(rc != 0) {
         return QE_EOF;
 	}
@@ -109,65 +106,34 @@ Project::Project(Iterator *input,const std::vector<std::string> &attrNames){
 	projectedAttr.clear();
 	vector<Attribute> allAttrs;
 	it->getAttributes(allAttrs);
+	inputSchema = Schema(allAttrs);
 	for(int i = 0;i < projectedAttrName.size();i++){
-		for(int j = 0;j < allAttrs.size();j++){
-			if(allAttrs[j].name == projectedAttrName[i]){
-				projectedAttr.push_back(allAttrs[j]);
-			}
+		int field = inputSchema.indexOf(projectedAttrName[i]);
+		if(field != -1){
+			projectedAttr.push_back(allAttrs[field]);
+			projectedFields.push_back(field);
 		}
 	}
-	//getAttributes(this->projectedAttr);
-	//cout<<"projectedAttr size:"<<projectedAttr.size()<<endl;
 }
 
 void Project::preprocess(char *pre,char *post){
-	vector<Attribute> allAttrs;
-	it->getAttributes(allAttrs);
-
-	std::vector<unsigned> fieldOffsets(allAttrs.size()+1,0); // Record field offset in pre
-    const unsigned nullFieldLen = (unsigned)(ceil(allAttrs.size()/8.0));
-	const char* actualData = pre + nullFieldLen;
-	unsigned actualDataLen = 0;
-	for(unsigned i = 0 ; i < allAttrs.size() ; ++i) {
-		const char* byteInNullInfoField = pre + i/8;
-
-		bool nullField = *byteInNullInfoField & (1 << 7-i%8);
-		if(nullField) {
-			fieldOffsets[i+1] = fieldOffsets[i];
-		}
-		else {
-			if(allAttrs[i].type == AttrType::TypeInt || allAttrs[i].type == AttrType::TypeReal) {
-				fieldOffsets[i+1] = fieldOffsets[i] + allAttrs[i].length;
-				actualDataLen += allAttrs[i].length;
-			}
-			else { //recordDescriptor[i].type == AttrType::TypeVarChar
-				unsigned varCharLength = *reinterpret_cast<const unsigned*>(actualData + actualDataLen);
-				fieldOffsets[i+1] = fieldOffsets[i] + (4 + varCharLength);
-				actualDataLen += (4 + varCharLength);
-			}
-		}
-	}
-
-	unsigned projectedNullFieldLen = (unsigned)(ceil(projectedAttr.size()/8.0));
+	unsigned projectedNullFieldLen = Schema::nullIndicatorSize(projectedFields.size());
 	memset(post, 0, projectedNullFieldLen); // By default no field is NULL
 	char *cur = post+projectedNullFieldLen;
-	for(int i = 0;i < projectedAttrName.size();i++){
-		for(int j = 0;j < allAttrs.size();j++){
-			if(allAttrs[j].name == projectedAttrName[i]){
-				unsigned currByte = i/8;
-				if(fieldOffsets[j+1] == fieldOffsets[j])
-					*(post+currByte) |= (1 << 7-i%8);
-				else{
-					memcpy(cur, pre+nullFieldLen+fieldOffsets[j], fieldOffsets[j+1]-fieldOffsets[j]);
-					cur += fieldOffsets[j+1]-fieldOffsets[j];
-				}
-			}
+	for(unsigned i = 0;i < projectedFields.size();i++){
+		unsigned length;
+		const byte *field = inputSchema.findField(pre, projectedFields[i], length);
+		if(field == NULL)
+			*(post+i/8) |= (1 << 7-i%8);
+		else{
+			memcpy(cur, field, length);
+			cur += length;
 		}
 	}
 }
 
 RC Project::getNextTuple(void *data){
-	char pre[PAGE_SIZE];
+	char pre[MAX_PAGE_SIZE];
 	int rc = it->getNextTuple(pre);
 	if(rc != 0)
 		return rc;
@@ -191,10 +157,12 @@ BNLJoin::BNLJoin(Iterator *leftIn,TableScan *rightIn,const Condition &condition,
 	right->getAttributes(rightAttrs);
 	getAttributes(attrs);
 	bufferPage = numPages;
+	if(right->rm.getPageSize(right->tableName, pageSize) != 0)
+		pageSize = PAGE_SIZE;
 	//leftTable = (char *)malloc(bufferPage*PAGE_SIZE);
 	//rightTable = (char *)malloc(PAGE_SIZE);
-	leftTable = new char[bufferPage*PAGE_SIZE];
-	rightTable = new char[PAGE_SIZE];
+	leftTable = new char[bufferPage*pageSize];
+	rightTable = new char[pageSize];
 	currLOffset = 0;
 	currROffset = 0;
 	//rightRid = {0,0};
@@ -230,8 +198,8 @@ unsigned BNLJoin::calcMaxLenOfTuple(vector<Attribute> attrs){
  */
 RC BNLJoin::loadLeftTable(){
 	unsigned currLen = 0;
-	unsigned nullLen = ceil(leftAttrs.size()/8.0);
-	while(currLen+maxLeft <= bufferPage*PAGE_SIZE){
+	unsigned nullLen = Schema::nullIndicatorSize(leftAttrs.size());
+	while(currLen+maxLeft <= bufferPage*pageSize){
 		int rc = left->getNextTuple(leftTable+currLen);
 		if(rc != 0){
 			leftOffset = currLen;
@@ -259,8 +227,8 @@ RC BNLJoin::loadLeftTable(){
 
 RC BNLJoin::loadRightPage(){
 	unsigned currLen = 0;
-	unsigned nullLen = ceil(rightAttrs.size()/8.0);
-	while(currLen+maxRight <= PAGE_SIZE){
+	unsigned nullLen = Schema::nullIndicatorSize(rightAttrs.size());
+	while(currLen+maxRight <= pageSize){
 		int rc = right->getNextTuple(rightTable+currLen);
 		if(rc != 0){
 			rightOffset = currLen;
@@ -369,7 +337,7 @@ bool BNLJoin::BNLJoinMatch(unsigned &leftTupleLen,unsigned &rightTupleLen){
 	float fvalL,fvalR;
 	string strL,strR;
 	bool res = false;
-	unsigned nullLen = ceil(leftAttrs.size()/8.0);
+	unsigned nullLen = Schema::nullIndicatorSize(leftAttrs.size());
 	char *actualData = leftTable+currLOffset+nullLen;
 	for(int i = 0;i < leftAttrs.size();i++){
 		const char* byteInNullInfoField = leftTable+currLOffset + i/8;
@@ -396,7 +364,7 @@ bool BNLJoin::BNLJoinMatch(unsigned &leftTupleLen,unsigned &rightTupleLen){
 	}
 	leftTupleLen = actualData-leftTable-currLOffset;
 
-	nullLen = ceil(rightAttrs.size()/8.0);
+	nullLen = Schema::nullIndicatorSize(rightAttrs.size());
 	actualData = rightTable+currROffset+nullLen;
 	for(int i = 0;i < rightAttrs.size();i++){
 		const char* byteInNullInfoField = rightTable+currROffset + i/8;
@@ -430,15 +398,15 @@ bool BNLJoin::BNLJoinMatch(unsigned &leftTupleLen,unsigned &rightTupleLen){
 }
 
 void BNLJoin::BNLJoinTuple(void *data){
-    unsigned nullInfoFieldLength = static_cast<unsigned>(ceil((leftAttrs.size()+rightAttrs.size())/8.0));
+    unsigned nullInfoFieldLength = Schema::nullIndicatorSize(leftAttrs.size()+rightAttrs.size());
     vector<byte> result(nullInfoFieldLength, 0);
 
     const char* records[2] = { leftTable+currLOffset, rightTable+currROffset };
 
     const byte* actualData[2];
-    nullInfoFieldLength = static_cast<unsigned>(ceil(leftAttrs.size()/8.0));
+    nullInfoFieldLength = Schema::nullIndicatorSize(leftAttrs.size());
     actualData[0] = reinterpret_cast<const byte*>(records[0]) + nullInfoFieldLength;
-    nullInfoFieldLength = static_cast<unsigned>(ceil(rightAttrs.size()/8.0));
+    nullInfoFieldLength = Schema::nullIndicatorSize(rightAttrs.size());
     actualData[1] = reinterpret_cast<const byte*>(records[1]) + nullInfoFieldLength;
 
     //array of pointers in order to avoid copying two vectors
@@ -529,43 +497,72 @@ RC Aggregate::getNextTuple(void *data){
             resReal = FLT_MIN;
 		}
 
-		while(it->getNextTuple(data) != QE_EOF){
-			unsigned nullFieldLen = (unsigned)ceil(attributes.size()/8.0);
-			char *cur = (char *)data+nullFieldLen;
-			for(unsigned i = 0;i < attributes.size();i++){
-				const char* nullByte = (char *)data + i/8;
-
-				bool nullField = *nullByte & (1 << 7-i%8);
-				if(!nullField && attributes[i].name == aggrAttr.name){
-					if(attributes[i].type == TypeInt && attributes[i].type == aggrAttr.type){
-						switch(op){
-							case MIN: if(*(int *)cur < resInt) resInt = *(int *)cur;    break;
-							case MAX: if(*(int *)cur > resInt) resInt = *(int *)cur;    break;
-							case COUNT: cnt++;                                          break;
-							case SUM: resInt += *(int *)cur;                            break;
-							case AVG: resInt += *(int *)cur; cnt++;                     break;
-						}
-					}else if(attributes[i].type == TypeReal && attributes[i].type == aggrAttr.type){
-						switch(op){
-							case MIN: if(*(float *)cur < resReal) resReal = *(float *)cur;  break;
-							case MAX: if(*(float *)cur > resReal) resReal = *(float *)cur;  break;
-							case COUNT: cnt++;                                              break;
-							case SUM: resReal += *(float *)cur;                             break;
-							case AVG: resReal += *(float *)cur; cnt++;                      break;
-						}
-					}
-					break;
+		auto addInt = [&](int value) {
+			switch(op){
+				case MIN: if(value < resInt) resInt = value;    break;
+				case MAX: if(value > resInt) resInt = value;    break;
+				case COUNT: cnt++;                              break;
+				case SUM: resInt += value;                      break;
+				case AVG: resInt += value; cnt++;               break;
+			}
+		};
+		auto addReal = [&](float value) {
+			switch(op){
+				case MIN: if(value < resReal) resReal = value;  break;
+				case MAX: if(value > resReal) resReal = value;  break;
+				case COUNT: cnt++;                              break;
+				case SUM: resReal += value;                     break;
+				case AVG: resReal += value; cnt++;              break;
+			}
+		};
+
+		//Straight over a column table (maybe through filters pushed into its scan), only the aggregated column is
+		//read, a batch of values at a time
+		TableScan *scan = dynamic_cast<TableScan *>(it);
+		Filter *filter = dynamic_cast<Filter *>(it);
+		if(scan == NULL && filter != NULL)
+			scan = filter->getPushedInto();
+		if(scan != NULL && scan->scanColumn(aggrAttr.name)) {
+			ColumnBatch batch;
+			while(scan->getNextBatch(batch) == 0) {
+				const ColumnVector &column = batch.columns[0];
+				for(unsigned r = 0;r < batch.size();r++){
+					if(column.nulls[r] || column.type != aggrAttr.type)
+						continue;
+					if(column.type == TypeInt)
+						addInt(column.ints[r]);
+					else if(column.type == TypeReal)
+						addReal(column.reals[r]);
 				}
-				else if(!nullField){
-					if(attributes[i].type == TypeInt) {
-                        cur += sizeof(int);
-					}
-					else if(attributes[i].type == TypeReal) {
-                        cur += sizeof(float);
+			}
+		}
+		else {
+			while(it->getNextTuple(data) != QE_EOF){
+				unsigned nullFieldLen = Schema::nullIndicatorSize(attributes.size());
+				char *cur = (char *)data+nullFieldLen;
+				for(unsigned i = 0;i < attributes.size();i++){
+					const char* nullByte = (char *)data + i/8;
+
+					bool nullField = *nullByte & (1 << 7-i%8);
+					if(!nullField && attributes[i].name == aggrAttr.name){
+						if(attributes[i].type == TypeInt && attributes[i].type == aggrAttr.type){
+							addInt(*(int *)cur);
+						}else if(attributes[i].type == TypeReal && attributes[i].type == aggrAttr.type){
+							addReal(*(float *)cur);
+						}
+						break;
 					}
-					else{
-						unsigned strLen = *(unsigned *)cur;
-						cur += strLen+sizeof(unsigned);
+					else if(!nullField){
+						if(attributes[i].type == TypeInt) {
+	                        cur += sizeof(int);
+						}
+						else if(attributes[i].type == TypeReal) {
+	                        cur += sizeof(float);
+						}
+						else{
+							unsigned strLen = *(unsigned *)cur;
+							cur += strLen+sizeof(unsigned);
+						}
 					}
 				}
 			}
@@ -642,8 +639,8 @@ INLJoin::INLJoin(Iterator *leftIn, IndexScan *rightIn, const Condition &conditio
         return;
     }
 
-    byte pageLeft[PAGE_SIZE];
-    byte pageRight[PAGE_SIZE];
+    byte pageLeft[MAX_PAGE_SIZE];
+    byte pageRight[MAX_PAGE_SIZE];
     while(leftIn->getNextTuple(pageLeft) != QE_EOF) {
         vector<byte> extractedConditionField;
         rc = extractField(pageLeft, leftAttrs, condition.lhsAttr, extractedConditionField);
@@ -669,7 +666,7 @@ INLJoin::INLJoin(Iterator *leftIn, IndexScan *rightIn, const Condition &conditio
 
 RC INLJoin::extractField(const byte* record, const std::vector<Attribute> &attrs, const string& fieldToExtract, vector<byte>& extractedField) {
     extractedField.clear();
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(attrs.size()/8.0));
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(attrs.size());
     const byte* actualData = reinterpret_cast<const byte*>(record) + nullInfoFieldLength;
 
     for(unsigned i = 0 ; i < attrs.size() ; ++i) {
@@ -701,16 +698,16 @@ RC INLJoin::extractField(const byte* record, const std::vector<Attribute> &attrs
 void INLJoin::concatenateRecords(const byte* firstRecord, const std::vector<Attribute> &firstRecordAttrs,
                                 const byte* secondRecord, const std::vector<Attribute> &secondRecordAttrs,
                                 vector<byte>& result) {
-    unsigned nullInfoFieldLength = static_cast<unsigned>(ceil((firstRecordAttrs.size()+secondRecordAttrs.size())/8.0));
+    unsigned nullInfoFieldLength = Schema::nullIndicatorSize(firstRecordAttrs.size()+secondRecordAttrs.size());
     result.clear();
     result.resize(nullInfoFieldLength, 0);
 
     const byte* records[2] = { firstRecord, secondRecord };
 
     const byte* actualData[2];
-    nullInfoFieldLength = static_cast<unsigned>(ceil(firstRecordAttrs.size()/8.0));
+    nullInfoFieldLength = Schema::nullIndicatorSize(firstRecordAttrs.size());
     actualData[0] = reinterpret_cast<const byte*>(firstRecord) + nullInfoFieldLength;
-    nullInfoFieldLength = static_cast<unsigned>(ceil(secondRecordAttrs.size()/8.0));
+    nullInfoFieldLength = Schema::nullIndicatorSize(secondRecordAttrs.size());
     actualData[1] = reinterpret_cast<const byte*>(secondRecord) + nullInfoFieldLength;
 
     //array of pointers in order to avoid copying two vectors
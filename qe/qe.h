@@ -5,6 +5,7 @@
 #include "../rm/rm.h"
 #include "../ix/ix.h"
 #include <iostream>
+#include <list>
 
 using namespace std;
 
@@ -82,11 +83,16 @@ public:
     std::string tableName;
     std::vector<Attribute> attrs;
     std::vector<std::string> attrNames;
+    std::string relationName;                   // tableName before aliasing
+    std::vector<ScanPredicate> predicates;      // conditions pushed down by Filter, checked by the RBFM scan
+    std::list<std::vector<byte> > pushedValues; // their values, copied: a Filter may go away before the scan
+    unsigned workers = 0;                       // threads of a parallel scan, 0 for the plain one
     RID rid{};
 
     TableScan(RelationManager &rm, const std::string &tableName, const char *alias = NULL) : rm(rm) {
         //Set members
         this->tableName = tableName;
+        this->relationName = tableName;
 
         // Get Attributes from RM
         rm.getAttributes(tableName, attrs);
@@ -111,7 +117,55 @@ public:
         delete iter;
         iter = new RM_ScanIterator();
         //cerr<<"Use rm scan to init..."<<endl;
-        rm.scan(tableName, "", NO_OP, NULL, attrNames, *iter);
+        if (workers > 0) rm.scan(relationName, predicates, attrNames, workers, *iter);
+        else rm.scan(relationName, predicates, attrNames, *iter);
+    };
+
+    // Restarts the scan on "workers" threads (see RelationManager::scan()), 0 goes back to a single one. The tuples
+    // of a parallel scan come in no particular order
+    void setParallelism(unsigned workers) {
+        this->workers = workers;
+        setIterator();
+    };
+
+    // Let the scan check "attribute op value" on the page (attribute named rel.attr, "value" is copied); the scan
+    // starts over. Returns false if the attribute isn't one of the table's
+    bool pushDown(const std::string &attribute, CompOp op, const void *value) {
+        std::string prefix = tableName + ".";
+        if (attribute.compare(0, prefix.size(), prefix) != 0) return false;
+        std::string name = attribute.substr(prefix.size());
+        for (const Attribute &attr : attrs) {
+            if (attr.name == name) {
+                unsigned length = attr.type == TypeVarChar ? sizeof(unsigned) + *(const unsigned *) value : sizeof(int);
+                pushedValues.emplace_back((const byte *) value, (const byte *) value + length);
+                predicates.push_back(ScanPredicate{name, op, pushedValues.back().data()});
+                setIterator();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Restarts the scan to read only "attribute" (named rel.attr), a batch of rows at a time through getNextBatch();
+    // the pushed predicates still apply. Returns false unless the table is a column table having that attribute
+    bool scanColumn(const std::string &attribute) {
+        std::string prefix = tableName + ".";
+        if (!iter->isColumnar() || attribute.compare(0, prefix.size(), prefix) != 0) return false;
+        std::string name = attribute.substr(prefix.size());
+        for (const Attribute &attr : attrs) {
+            if (attr.name == name) {
+                iter->close();
+                delete iter;
+                iter = new RM_ScanIterator();
+                rm.scan(relationName, predicates, std::vector<std::string>(1, name), *iter);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    RC getNextBatch(ColumnBatch &batch) {
+        return iter->getNextBatch(batch);
     };
 
     RC getNextTuple(void *data) override {
@@ -204,7 +258,9 @@ class Filter : public Iterator {
     // Filter operator
 	Iterator *it;
 	Condition con;
-	vector<Attribute> attrs;
+	Schema schema;          // of the input, compiled once
+	int conditionField;     // index of con.lhsAttr in it, -1 if missing
+	TableScan *pushedInto;  // the scan that checks con itself, NULL if this operator does
 public:
     Filter(Iterator *input,               // Iterator of input R
            const Condition &condition     // Selection condition
@@ -221,6 +277,8 @@ public:
 
     // For attribute in std::vector<Attribute>, name it as rel.attr
     void getAttributes(std::vector<Attribute> &attrs) const override;
+
+    TableScan *getPushedInto() const { return pushedInto; }
 };
 
 class Project : public Iterator {
@@ -228,6 +286,8 @@ class Project : public Iterator {
 	Iterator *it;
 	vector<string> projectedAttrName;
 	vector<Attribute> projectedAttr;
+	Schema inputSchema;
+	vector<unsigned> projectedFields;   // index in the input of every projected attribute
 	string tableName;
 public:
     Project(Iterator *input,                    // Iterator of input R
@@ -255,8 +315,9 @@ class BNLJoin : public Iterator {
 	vector<Attribute> rightAttrs;
 	vector<Attribute> attrs;
 	unsigned bufferPage; // Buffer pool size
-	char *leftTable; // Memory buffer allocated for left table(size of bufferPage*PAGE_SIZE)
-	char *rightTable; // Memory buffer allocated for right table(PAGE_SIZE)
+	unsigned pageSize; // Page size of the right table's file
+	char *leftTable; // Memory buffer allocated for left table(size of bufferPage*pageSize)
+	char *rightTable; // Memory buffer allocated for right table(pageSize)
 	unsigned leftOffset; // Actual largest offset of loaded left table
 	unsigned currLOffset; // Current offset in page leftPageNum
 	unsigned rightOffset;
@@ -0,0 +1,165 @@
+#include "qe_test_util.h"
+
+// More rows than a column scan reads at once
+const int colTupleCount = 2500;
+
+// (A int, B real, C varchar(20)): A = i, B = i/2 (NULL for every 4th tuple), C "C<i>"
+int createAggregateTable(const string &tableName, PageLayout layout) {
+    vector<Attribute> attrs;
+
+    Attribute attr;
+    attr.name = "A";
+    attr.type = TypeInt;
+    attr.length = 4;
+    attrs.push_back(attr);
+
+    attr.name = "B";
+    attr.type = TypeReal;
+    attr.length = 4;
+    attrs.push_back(attr);
+
+    attr.name = "C";
+    attr.type = TypeVarChar;
+    attr.length = 20;
+    attrs.push_back(attr);
+
+    RC rc = rm.createTable(tableName, attrs, PAGE_SIZE, layout);
+    if (rc != success) {
+        return rc;
+    }
+
+    char buf[bufSize];
+    RID rid;
+    for (int i = 0; i < colTupleCount; ++i) {
+        string name = "C" + to_string(i);
+        unsigned length = name.size();
+        float b = i / 2.0f;
+        int offset = 0;
+        buf[offset] = i % 4 == 0 ? 1 << 6 : 0;
+        offset += 1;
+        memcpy(buf + offset, &i, sizeof(int));
+        offset += sizeof(int);
+        if (i % 4 != 0) {
+            memcpy(buf + offset, &b, sizeof(float));
+            offset += sizeof(float);
+        }
+        memcpy(buf + offset, &length, sizeof(unsigned));
+        offset += sizeof(unsigned);
+        memcpy(buf + offset, name.data(), length);
+        rc = rm.insertTuple(tableName, buf, rid);
+        if (rc != success) {
+            return rc;
+        }
+    }
+    return success;
+}
+
+// Value of the aggregate over the table, through a filter "A >= lowA" when lowA > 0
+float aggregate(const string &tableName, const string &attribute, AttrType type, AggregateOp op, int lowA) {
+    auto *input = new TableScan(rm, tableName);
+    Filter *filter = NULL;
+    Iterator *top = input;
+    if (lowA > 0) {
+        Condition cond;
+        cond.lhsAttr = tableName + ".A";
+        cond.op = GE_OP;
+        cond.bRhsIsAttr = false;
+        cond.rhsValue.type = TypeInt;
+        cond.rhsValue.data = &lowA;
+        filter = new Filter(input, cond);
+        top = filter;
+    }
+    Attribute aggAttr;
+    aggAttr.name = tableName + "." + attribute;
+    aggAttr.type = type;
+    aggAttr.length = 4;
+    auto *agg = new Aggregate(top, aggAttr, op);
+
+    char data[bufSize];
+    float value = -1;
+    int count = 0;
+    while (agg->getNextTuple(data) != QE_EOF) {
+        memcpy(&value, data + 1, sizeof(float));
+        count++;
+    }
+    if (count != 1) {
+        std::cerr << "***** An aggregate should return one tuple. *****" << std::endl;
+        value = -1;
+    }
+    delete agg;
+    delete filter;
+    delete input;
+    return value;
+}
+
+RC testCase_ColumnStore() {
+    // Aggregates over a column table, read a batch at a time, against the same over a row table
+    // 1. SELECT MAX(A), COUNT(A), SUM(A), AVG(B), MIN(B) over the whole table
+    // 2. The same with WHERE A >= 1234, the condition checked by the column scan
+    std::cerr << std::endl << "***** In QE Test Case ColumnStore *****" << std::endl;
+
+    struct {
+        string attribute;
+        AttrType type;
+        AggregateOp op;
+    } aggregates[] = {{"A", TypeInt,  MAX},
+                      {"A", TypeInt,  COUNT},
+                      {"A", TypeInt,  SUM},
+                      {"B", TypeReal, AVG},
+                      {"B", TypeReal, MIN},
+                      {"B", TypeReal, COUNT}};
+
+    RC rc = success;
+    for (int lowA : {0, 1234}) {
+        for (const auto &a : aggregates) {
+            // Expected from the definition of the table, NULLs left out
+            double expected = a.op == MIN ? 1e9 : a.op == MAX ? -1e9 : 0;
+            int count = 0;
+            for (int i = lowA; i < colTupleCount; i++) {
+                if (a.type == TypeReal && i % 4 == 0) {
+                    continue;
+                }
+                double v = a.type == TypeInt ? i : i / 2.0;
+                expected = a.op == MIN ? min(expected, v) : a.op == MAX ? max(expected, v) : expected + v;
+                count++;
+            }
+            if (a.op == COUNT) {
+                expected = count;
+            }
+            else if (a.op == AVG) {
+                expected /= count;
+            }
+
+            float columnValue = aggregate("colagg", a.attribute, a.type, a.op, lowA);
+            float rowValue = aggregate("rowagg", a.attribute, a.type, a.op, lowA);
+            if (columnValue != (float) expected || rowValue != columnValue) {
+                std::cerr << "***** Aggregate " << a.op << " of " << a.attribute << " from A >= " << lowA << ": "
+                          << columnValue << " over the column table, " << rowValue << " over the row table, "
+                          << expected << " expected. *****" << std::endl;
+                rc = fail;
+            }
+        }
+    }
+    return rc;
+}
+
+int main() {
+    // Tables created: colagg (column table), rowagg
+
+    if (createAggregateTable("colagg", COLUMN_LAYOUT) != success || createAggregateTable("rowagg", ROW_LAYOUT) != success) {
+        std::cerr << "***** createAggregateTable() failed." << std::endl;
+        std::cerr << "***** [FAIL] QE Test Case ColumnStore failed. *****" << std::endl;
+        return fail;
+    }
+
+    RC rc = testCase_ColumnStore();
+    rm.deleteTable("colagg");
+    rm.deleteTable("rowagg");
+    if (rc != success) {
+        std::cerr << "***** [FAIL] QE Test Case ColumnStore failed. *****" << std::endl;
+        return fail;
+    } else {
+        std::cerr << "***** QE Test Case ColumnStore finished. The result will be examined. *****" << std::endl;
+        return success;
+    }
+}
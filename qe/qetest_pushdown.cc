@@ -0,0 +1,156 @@
+#include "qe_test_util.h"
+
+// pushdown(A int, B varchar(30), C real): A in [0,99], B "Name<A>", C = A + 50
+int createPushdownTable() {
+    vector<Attribute> attrs;
+
+    Attribute attr;
+    attr.name = "A";
+    attr.type = TypeInt;
+    attr.length = 4;
+    attrs.push_back(attr);
+
+    attr.name = "B";
+    attr.type = TypeVarChar;
+    attr.length = 30;
+    attrs.push_back(attr);
+
+    attr.name = "C";
+    attr.type = TypeReal;
+    attr.length = 4;
+    attrs.push_back(attr);
+
+    RC rc = rm.createTable("pushdown", attrs);
+    if (rc != success) {
+        return rc;
+    }
+
+    char buf[bufSize];
+    RID rid;
+    for (int i = 0; i < tupleCount; ++i) {
+        string name = "Name" + to_string(i);
+        unsigned length = name.size();
+        float c = (float) (i + 50);
+        int offset = 0;
+        buf[offset] = 0;
+        offset += 1;
+        memcpy(buf + offset, &i, sizeof(int));
+        offset += sizeof(int);
+        memcpy(buf + offset, &length, sizeof(unsigned));
+        offset += sizeof(unsigned);
+        memcpy(buf + offset, name.data(), length);
+        offset += length;
+        memcpy(buf + offset, &c, sizeof(float));
+        rc = rm.insertTuple("pushdown", buf, rid);
+        if (rc != success) {
+            return rc;
+        }
+    }
+    return success;
+}
+
+// Reads every tuple of "input", returns the values of pushdown.A
+set<int> collectA(Iterator &input) {
+    set<int> values;
+    char data[bufSize];
+    while (input.getNextTuple(data) != QE_EOF) {
+        int a;
+        memcpy(&a, data + 1, sizeof(int));
+        values.insert(a);
+    }
+    return values;
+}
+
+RC testCase_Pushdown() {
+    // Filters over a table scan
+    // 1. SELECT * FROM pushdown WHERE pushdown.A >= 20 AND pushdown.C < 80.0: both filters go into the scan
+    // 2. The scan keeps applying a pushed condition after its filter and the condition's value are gone
+    std::cerr << std::endl << "***** In QE Test Case Pushdown *****" << std::endl;
+
+    RC rc = success;
+    auto *input = new TableScan(rm, "pushdown");
+
+    int lowA = 20;
+    Condition cond1;
+    cond1.lhsAttr = "pushdown.A";
+    cond1.op = GE_OP;
+    cond1.bRhsIsAttr = false;
+    cond1.rhsValue.type = TypeInt;
+    cond1.rhsValue.data = &lowA;
+    auto *filter1 = new Filter(input, cond1);
+
+    float highC = 80;
+    Condition cond2;
+    cond2.lhsAttr = "pushdown.C";
+    cond2.op = LT_OP;
+    cond2.bRhsIsAttr = false;
+    cond2.rhsValue.type = TypeReal;
+    cond2.rhsValue.data = &highC;
+    auto *filter2 = new Filter(filter1, cond2);
+
+    if (filter1->getPushedInto() != input || filter2->getPushedInto() != input) {
+        std::cerr << "***** The conditions should be checked by the table scan. *****" << std::endl;
+        rc = fail;
+    }
+    set<int> expected;
+    for (int i = 20; i < 30; i++) {
+        expected.insert(i);
+    }
+    if (collectA(*filter2) != expected) {
+        std::cerr << "***** The filters should return the tuples satisfying both conditions. *****" << std::endl;
+        rc = fail;
+    }
+    delete filter2;
+    delete filter1;
+    delete input;
+
+    // The value of the condition is freed and the filter deleted before the scan starts over
+    input = new TableScan(rm, "pushdown");
+    auto *name = (char *) malloc(bufSize);
+    unsigned length = 6;
+    memcpy(name, &length, sizeof(unsigned));
+    memcpy(name + sizeof(unsigned), "Name42", length);
+    Condition cond3;
+    cond3.lhsAttr = "pushdown.B";
+    cond3.op = EQ_OP;
+    cond3.bRhsIsAttr = false;
+    cond3.rhsValue.type = TypeVarChar;
+    cond3.rhsValue.data = name;
+    auto *filter3 = new Filter(input, cond3);
+    if (filter3->getPushedInto() != input) {
+        std::cerr << "***** The condition should be checked by the table scan. *****" << std::endl;
+        rc = fail;
+    }
+    delete filter3;
+    memset(name, 0, bufSize);
+    free(name);
+
+    input->setIterator();
+    if (collectA(*input) != set<int>{42}) {
+        std::cerr << "***** The scan should keep its pushed condition. *****" << std::endl;
+        rc = fail;
+    }
+    delete input;
+
+    return rc;
+}
+
+int main() {
+    // Tables created: pushdown
+
+    if (createPushdownTable() != success) {
+        std::cerr << "***** createPushdownTable() failed." << std::endl;
+        std::cerr << "***** [FAIL] QE Test Case Pushdown failed. *****" << std::endl;
+        return fail;
+    }
+
+    RC rc = testCase_Pushdown();
+    rm.deleteTable("pushdown");
+    if (rc != success) {
+        std::cerr << "***** [FAIL] QE Test Case Pushdown failed. *****" << std::endl;
+        return fail;
+    } else {
+        std::cerr << "***** QE Test Case Pushdown finished. The result will be examined. *****" << std::endl;
+        return success;
+    }
+}
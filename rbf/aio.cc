@@ -0,0 +1,362 @@
+#include "aio.h"
+#include <thread>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if !defined(NO_IO_URING) && defined(__linux__) && defined(__NR_io_uring_setup) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define USE_IO_URING 1
+#endif
+#endif
+
+using namespace std;
+
+/**
+Worker threads of the fallback engine. They are shared by every AsyncIOQueue and serve the requests in
+submission order; each finished request is handed back to the queue it came from.
+**/
+class IOWorkerPool {
+public:
+    static IOWorkerPool &instance() {
+        static IOWorkerPool _io_worker_pool;
+        return _io_worker_pool;
+    }
+
+    void enqueue(AsyncIOQueue *queue, PageIORequest *request) {
+        {
+            lock_guard<mutex> guard(latch);
+            jobs.push_back(Job(queue, request));
+        }
+        jobCondition.notify_one();
+    }
+
+private:
+    typedef pair<AsyncIOQueue *, PageIORequest *> Job;
+
+    IOWorkerPool() : stopping(false) {
+        for(unsigned i = 0 ; i < AIO_WORKER_THREADS ; ++i) {
+            workers.push_back(thread(&IOWorkerPool::work, this));
+        }
+    }
+
+    ~IOWorkerPool() {
+        {
+            lock_guard<mutex> guard(latch);
+            stopping = true;
+        }
+        jobCondition.notify_all();
+        for(unsigned i = 0 ; i < workers.size() ; ++i) {
+            workers[i].join();
+        }
+    }
+
+    void work() {
+        for( ; ; ) {
+            Job job;
+            {
+                unique_lock<mutex> guard(latch);
+                while(jobs.empty() && !stopping) {
+                    jobCondition.wait(guard);
+                }
+                if(jobs.empty()) {
+                    return;
+                }
+                job = jobs.front();
+                jobs.pop_front();
+            }
+            job.second->result = AsyncIOQueue::execute(*job.second);
+            job.first->finished(job.second);
+        }
+    }
+
+    vector<thread> workers;
+    deque<Job> jobs;
+    mutex latch;
+    condition_variable jobCondition;
+    bool stopping;
+};
+
+AsyncIOQueue::AsyncIOQueue(unsigned depth) {
+    ring = -1;
+    sqRing = cqRing = sqes = NULL;
+    toSubmit = 0;
+    inFlight = 0;
+    if(!setupRing(depth == 0 ? 1 : depth)) {
+        //Constructing the workers here makes them outlive a queue that is itself a static object
+        IOWorkerPool::instance();
+    }
+}
+
+AsyncIOQueue::~AsyncIOQueue() {
+    drain();
+#ifdef USE_IO_URING
+    if(ring >= 0) {
+        munmap(sqes, sqesSize);
+        if(cqRing != sqRing) {
+            munmap(cqRing, cqRingSize);
+        }
+        munmap(sqRing, sqRingSize);
+        close(ring);
+    }
+#endif
+}
+
+RC AsyncIOQueue::execute(PageIORequest &request) {
+    off_t offset = static_cast<off_t>(request.pageNum+1)*request.pageSize;
+    if(request.type == PAGE_WRITE) {
+        return pwrite(request.fd, request.buffer, request.pageSize, offset) == request.pageSize ? 0 : -1;
+    }
+    ssize_t res = pread(request.fd, request.buffer, request.pageSize, offset);
+    if(res < 0) {
+        return -1;
+    }
+    memset(request.buffer+res, 0, request.pageSize-res);
+    return 0;
+}
+
+RC AsyncIOQueue::submit(const std::vector<PageIORequest *> &requests) {
+    return requests.empty() ? 0 : submit(requests.data(), requests.size());
+}
+
+RC AsyncIOQueue::submit(PageIORequest *const requests[], unsigned count) {
+    unique_lock<mutex> guard(latch);
+    if(ring < 0) {
+        inFlight += count;
+        guard.unlock();
+        for(unsigned i = 0 ; i < count ; ++i) {
+            IOWorkerPool::instance().enqueue(this, requests[i]);
+        }
+        return 0;
+    }
+
+#ifdef USE_IO_URING
+    for(unsigned i = 0 ; i < count ; ++i) {
+        //The completion ring must never overflow: with a full pipe, wait for a request to finish first
+        if(inFlight == cqEntries) {
+            vector<PageIORequest *> reaped;
+            if(submitEntries() != 0 || enter(0, 1) < 0) {
+                failRequests(requests+i, count-i);
+                return -1;
+            }
+            reapRing(reaped);
+            done.insert(done.end(), reaped.begin(), reaped.end());
+        }
+        if(toSubmit == sqEntries && submitEntries() != 0) {
+            failRequests(requests+i, count-i);
+            return -1;
+        }
+        prepareEntry(requests[i]);
+    }
+    if(submitEntries() != 0) {
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+//Requests of a batch that never reached the engine: complete() won't return them
+void AsyncIOQueue::failRequests(PageIORequest *const requests[], unsigned count) {
+    for(unsigned i = 0 ; i < count ; ++i) {
+        requests[i]->result = -1;
+    }
+}
+
+unsigned AsyncIOQueue::complete(std::vector<PageIORequest *> &completed, unsigned minCompletions) {
+    unique_lock<mutex> guard(latch);
+    unsigned count = 0;
+    for( ; ; ) {
+        while(!done.empty()) {
+            completed.push_back(done.front());
+            done.pop_front();
+            ++count;
+        }
+#ifdef USE_IO_URING
+        if(ring >= 0) {
+            count += reapRing(completed);
+        }
+#endif
+        if(count >= minCompletions || inFlight == 0) {
+            return count;
+        }
+        if(ring < 0) {
+            doneCondition.wait(guard);
+        }
+#ifdef USE_IO_URING
+        else if(enter(0, 1) < 0) {
+            return count;
+        }
+#endif
+    }
+}
+
+RC AsyncIOQueue::drain() {
+    vector<PageIORequest *> completed;
+    RC rc = 0;
+    while(outstanding() > 0) {
+        completed.clear();
+        complete(completed, outstanding());
+        for(unsigned i = 0 ; i < completed.size() ; ++i) {
+            if(completed[i]->result != 0) {
+                rc = -1;
+            }
+        }
+    }
+    return rc;
+}
+
+unsigned AsyncIOQueue::outstanding() {
+    lock_guard<mutex> guard(latch);
+    return inFlight + done.size();
+}
+
+void AsyncIOQueue::finished(PageIORequest *request) {
+    {
+        lock_guard<mutex> guard(latch);
+        --inFlight;
+        done.push_back(request);
+    }
+    doneCondition.notify_all();
+}
+
+#ifdef USE_IO_URING
+
+bool AsyncIOQueue::setupRing(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring = syscall(__NR_io_uring_setup, entries, &params);
+    if(ring < 0) {
+        ring = -1;
+        return false; //old kernel, or io_uring forbidden by seccomp
+    }
+    sqEntries = params.sq_entries;
+    cqEntries = params.cq_entries;
+
+    sqRingSize = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries*sizeof(struct io_uring_cqe);
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if(singleMap) {
+        sqRingSize = cqRingSize = max(sqRingSize, cqRingSize);
+    }
+    sqRing = mmap(NULL, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+    cqRing = singleMap ? sqRing : mmap(NULL, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    sqesSize = params.sq_entries*sizeof(struct io_uring_sqe);
+    sqes = mmap(NULL, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+    if(sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED) {
+        if(sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if(cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if(sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+        sqRing = cqRing = sqes = NULL;
+        close(ring);
+        ring = -1;
+        return false;
+    }
+
+    byte *sq = static_cast<byte *>(sqRing);
+    sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    byte *cq = static_cast<byte *>(cqRing);
+    cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes = cq + params.cq_off.cqes;
+    return true;
+}
+
+//Caller must hold the latch and make sure there is room in both rings
+void AsyncIOQueue::prepareEntry(PageIORequest *request) {
+    request->iov.iov_base = request->buffer;
+    request->iov.iov_len = request->pageSize;
+
+    unsigned tail = *sqTail;
+    unsigned index = tail & *sqMask;
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(sqes) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = request->type == PAGE_WRITE ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = request->fd;
+    sqe->addr = reinterpret_cast<unsigned long long>(&request->iov);
+    sqe->len = 1;
+    sqe->off = static_cast<unsigned long long>(request->pageNum+1)*request->pageSize;
+    sqe->user_data = reinterpret_cast<unsigned long long>(request);
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail+1, __ATOMIC_RELEASE);
+    ++toSubmit;
+    ++inFlight;
+}
+
+//Returns how many entries the kernel took, -1 on error. Caller must hold the latch
+int AsyncIOQueue::enter(unsigned toSubmit, unsigned minCompletions) {
+    if(toSubmit == 0 && minCompletions == 0) {
+        return 0;
+    }
+    unsigned flags = minCompletions > 0 ? IORING_ENTER_GETEVENTS : 0;
+    for( ; ; ) {
+        int res = syscall(__NR_io_uring_enter, ring, toSubmit, minCompletions, flags, NULL, 0);
+        if(res >= 0) {
+            return res;
+        }
+        if(errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+/**
+Passes the prepared entries to the kernel. It may take fewer of them than offered (e.g. when it runs short of
+memory): the rest is offered again until it takes none. Those are then taken back out of the submission ring, and
+their requests fail with result -1 without being in flight. Caller must hold the latch.
+**/
+RC AsyncIOQueue::submitEntries() {
+    while(toSubmit > 0) {
+        int res = enter(toSubmit, 0);
+        if(res <= 0) {
+            unsigned tail = *sqTail;
+            for(unsigned i = tail-toSubmit ; i != tail ; ++i) {
+                struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(sqes) + (i & *sqMask);
+                reinterpret_cast<PageIORequest *>(sqe->user_data)->result = -1;
+            }
+            __atomic_store_n(sqTail, tail-toSubmit, __ATOMIC_RELEASE);
+            inFlight -= toSubmit;
+            toSubmit = 0;
+            return -1;
+        }
+        toSubmit -= res;
+    }
+    return 0;
+}
+
+//Caller must hold the latch
+unsigned AsyncIOQueue::reapRing(std::vector<PageIORequest *> &completed) {
+    unsigned head = *cqHead;
+    unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+    unsigned count = 0;
+    for( ; head != tail ; ++head, ++count) {
+        struct io_uring_cqe *cqe = static_cast<struct io_uring_cqe *>(cqes) + (head & *cqMask);
+        PageIORequest *request = reinterpret_cast<PageIORequest *>(cqe->user_data);
+        if(request->type == PAGE_WRITE) {
+            request->result = cqe->res == static_cast<int>(request->pageSize) ? 0 : -1;
+        }
+        else if(cqe->res < 0) {
+            request->result = -1;
+        }
+        else {
+            memset(request->buffer+cqe->res, 0, request->pageSize-cqe->res);
+            request->result = 0;
+        }
+        completed.push_back(request);
+    }
+    __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    inFlight -= count;
+    return count;
+}
+
+#else
+
+bool AsyncIOQueue::setupRing(unsigned) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef _aio_h_
+#define _aio_h_
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <sys/uio.h>
+
+#include "pfm.h"
+
+#define AIO_QUEUE_DEPTH 64          // Default number of requests a queue keeps in flight
+#define AIO_WORKER_THREADS 4        // Threads of the fallback engine, shared by all queues
+
+typedef enum {
+    PAGE_READ = 0,
+    PAGE_WRITE
+} PageIOType;
+
+// One page transfer. The file is given by its descriptor (FileHandle::fd, IXFileHandle::fd or the buffer pool's
+// own descriptor) and, like everywhere else, data page n is stored right after the hidden page.
+struct PageIORequest {
+    int fd;
+    PageNum pageNum;
+    unsigned pageSize;          // page size of the file
+    PageIOType type;
+    byte *buffer;               // pageSize bytes, must stay valid until the request completes
+    void *userData;             // left untouched, for the caller to match completions
+    RC result;                  // 0 on success, -1 otherwise. A read past the end of file returns zeros
+    struct iovec iov;           // used by the engine
+};
+
+/**
+A queue of asynchronous page reads and writes. Requests are submitted in batches and reaped with complete(),
+in completion order. Each user (a scan, the buffer pool...) owns its queue, so nobody reaps completions of others.
+The queue uses io_uring when the kernel allows it, otherwise the requests are served by a small pool of worker
+threads doing pread/pwrite. Define NO_IO_URING to always use the threads.
+**/
+class AsyncIOQueue {
+public:
+    explicit AsyncIOQueue(unsigned depth = AIO_QUEUE_DEPTH);
+    ~AsyncIOQueue();                                                    // Waits for the requests still in flight
+
+    // Queue a batch of requests. On failure, the requests that didn't get to the engine have their result set to -1
+    // and are not returned by complete(); the others are in flight as usual.
+    RC submit(PageIORequest *const requests[], unsigned count);
+    RC submit(const std::vector<PageIORequest *> &requests);
+
+    // Appends finished requests to "completed", blocking until at least minCompletions of them are available
+    // (or until nothing is in flight any more). Returns how many were appended.
+    unsigned complete(std::vector<PageIORequest *> &completed, unsigned minCompletions);
+    RC drain();                                                         // Wait for everything, -1 if a request failed
+
+    unsigned outstanding();                                             // Submitted and not yet returned by complete()
+    bool usesIoUring() const { return ring >= 0; }
+
+    static RC execute(PageIORequest &request);                          // Synchronous transfer, used by the workers
+
+private:
+    AsyncIOQueue(const AsyncIOQueue &);                                 // Prevent copying (not defined)
+    AsyncIOQueue &operator=(const AsyncIOQueue &);                      // Prevent assignment (not defined)
+
+    // io_uring
+    bool setupRing(unsigned entries);
+    void prepareEntry(PageIORequest *request);
+    int enter(unsigned toSubmit, unsigned minCompletions);
+    RC submitEntries();
+    static void failRequests(PageIORequest *const requests[], unsigned count);
+    unsigned reapRing(std::vector<PageIORequest *> &completed);
+
+    int ring;                                                           // -1 when the worker threads are used
+    unsigned sqEntries;
+    unsigned cqEntries;
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    void *sqes;
+    size_t sqesSize;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    void *cqes;
+    unsigned toSubmit;                                                  // entries prepared, not passed to the kernel
+
+    // worker threads
+    friend class IOWorkerPool;
+    void finished(PageIORequest *request);
+
+    std::mutex latch;
+    std::condition_variable doneCondition;
+    std::deque<PageIORequest *> done;                                   // completed, not yet returned
+    unsigned inFlight;
+};
+
+#endif
@@ -0,0 +1,793 @@
+#include <cstring>
+#include <algorithm>
+#include "colstore.h"
+
+using namespace std;
+
+//Pages past the end of a file read as zeros
+static RC readPageOrZeros(FileHandle &fileHandle, PageNum pageNum, byte *data) {
+    if(pageNum >= fileHandle.getNumberOfPages()) {
+        memset(data, 0, fileHandle.getPageSize());
+        return 0;
+    }
+    return fileHandle.readPage(pageNum, data);
+}
+
+//Writing past the end of a file appends the zero pages before the page
+static RC writePageOrAppend(FileHandle &fileHandle, PageNum pageNum, const byte *data) {
+    if(pageNum < fileHandle.getNumberOfPages()) {
+        return fileHandle.writePage(pageNum, data);
+    }
+    if(pageNum > fileHandle.getNumberOfPages()) {
+        vector<byte> zeros(fileHandle.getPageSize(), 0);
+        while(pageNum > fileHandle.getNumberOfPages()) {
+            if(fileHandle.appendPage(zeros.data()) != 0) {
+                return -1;
+            }
+        }
+    }
+    return fileHandle.appendPage(data);
+}
+
+//The deleted rows bitmap follows the first page of the table's file
+static PageNum deletedPage(unsigned row, unsigned pageSize) {
+    return 1 + row / (pageSize*8);
+}
+
+static bool isDeleted(const byte *page, unsigned row, unsigned pageSize) {
+    unsigned bit = row % (pageSize*8);
+    return page[bit/8] & (1 << (7-bit%8));
+}
+
+//First page of the table's file: the number of rows, then the end of the heap of every field
+static uint64_t heapEnd(const byte *metaPage, unsigned field) {
+    uint64_t end;
+    memcpy(&end, metaPage + sizeof(unsigned) + field*sizeof(uint64_t), sizeof(uint64_t));
+    return end;
+}
+
+static void setHeapEnd(byte *metaPage, unsigned field, uint64_t end) {
+    memcpy(metaPage + sizeof(unsigned) + field*sizeof(uint64_t), &end, sizeof(uint64_t));
+}
+
+void ColumnBatch::clear() {
+    rows.clear();
+    columns.clear();
+}
+
+RC ColumnPage::load(PageNum pageNum) {
+    if(pageNum == ColumnPage::pageNum) {
+        return 0;
+    }
+    if(flush() != 0) {
+        return -1;
+    }
+    data.resize(fileHandle.getPageSize());
+    if(readPageOrZeros(fileHandle, pageNum, data.data()) != 0) {
+        ColumnPage::pageNum = UINT_MAX;
+        return -1;
+    }
+    ColumnPage::pageNum = pageNum;
+    return 0;
+}
+
+RC ColumnPage::flush() {
+    if(!dirty) {
+        return 0;
+    }
+    dirty = false;
+    return writePageOrAppend(fileHandle, pageNum, data.data());
+}
+
+std::string ColumnFile::fileName(const std::string &tableName, unsigned field) {
+    return tableName + ".c" + to_string(field);
+}
+
+std::string ColumnFile::heapFileName(const std::string &tableName, unsigned field) {
+    return fileName(tableName, field) + ".h";
+}
+
+//As many rows as their null bits and values fit in a page
+unsigned ColumnFile::rowsPerPage(unsigned pageSize, AttrType type) {
+    const unsigned w = width(type);
+    unsigned rows = pageSize*8 / (8*w + 1);
+    while((rows+7)/8 + rows*w > pageSize) {
+        --rows;
+    }
+    return rows;
+}
+
+RC ColumnFile::open(const std::string &tableName, unsigned field, AttrType type) {
+    ColumnFile::type = type;
+    if(PagedFileManager::instance().openFile(fileName(tableName, field), values.fileHandle) != 0) {
+        return -1;
+    }
+    rowsPerPageCount = rowsPerPage(values.fileHandle.getPageSize(), type);
+    if(type == TypeVarChar && PagedFileManager::instance().openFile(heapFileName(tableName, field), heap.fileHandle) != 0) {
+        PagedFileManager::instance().closeFile(values.fileHandle);
+        return -1;
+    }
+    return 0;
+}
+
+RC ColumnFile::close() {
+    RC rc = values.flush() == 0 && PagedFileManager::instance().closeFile(values.fileHandle) == 0 ? 0 : -1;
+    if(type == TypeVarChar && (heap.flush() != 0 || PagedFileManager::instance().closeFile(heap.fileHandle) != 0)) {
+        rc = -1;
+    }
+    values.pageNum = heap.pageNum = UINT_MAX;
+    return rc;
+}
+
+//The pages are read again from the buffer pool next time, where other handles of the files may have changed them
+RC ColumnFile::release() {
+    RC rc = values.flush() == 0 && (type != TypeVarChar || heap.flush() == 0) ? 0 : -1;
+    values.pageNum = heap.pageNum = UINT_MAX;
+    return rc;
+}
+
+ColumnFiles::ColumnFiles(const std::string &tableName, const Schema &schema)
+    : tableName(tableName), columns(schema.size()), opened(schema.size(), false) {
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        types.push_back(schema.getType(i));
+    }
+}
+
+ColumnFiles::~ColumnFiles() {
+    for(unsigned i = 0 ; i < columns.size() ; ++i) {
+        if(opened[i]) {
+            columns[i].close();
+        }
+    }
+}
+
+bool ColumnFiles::isFor(const std::string &tableName, const Schema &schema) const {
+    if(tableName != ColumnFiles::tableName || schema.size() != types.size()) {
+        return false;
+    }
+    for(unsigned i = 0 ; i < types.size() ; ++i) {
+        if(schema.getType(i) != types[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ColumnFile *ColumnFiles::get(unsigned field) {
+    if(field >= columns.size()) {
+        return NULL;
+    }
+    if(!opened[field]) {
+        if(columns[field].open(tableName, field, types[field]) != 0) {
+            return NULL;
+        }
+        opened[field] = true;
+    }
+    return &columns[field];
+}
+
+RC ColumnFiles::release() {
+    RC rc = 0;
+    for(unsigned i = 0 ; i < columns.size() ; ++i) {
+        if(opened[i] && columns[i].release() != 0) {
+            rc = -1;
+        }
+    }
+    return rc;
+}
+
+RC ColumnFile::locate(unsigned row, byte *&entry, bool &null) {
+    if(values.load(row / rowsPerPageCount) != 0) {
+        return -1;
+    }
+    const unsigned index = row % rowsPerPageCount;
+    null = values.data[index/8] & (1 << (7-index%8));
+    entry = values.data.data() + (rowsPerPageCount+7)/8 + index*width(type);
+    return 0;
+}
+
+RC ColumnFile::heapAccess(uint64_t offset, unsigned length, byte *buffer, bool write) {
+    const unsigned pageSize = heap.fileHandle.getPageSize();
+    while(length > 0) {
+        if(heap.load(offset / pageSize) != 0) {
+            return -1;
+        }
+        const unsigned inPage = offset % pageSize;
+        const unsigned n = min(length, pageSize - inPage);
+        if(write) {
+            memcpy(heap.data.data() + inPage, buffer, n);
+            heap.dirty = true;
+        }
+        else {
+            memcpy(buffer, heap.data.data() + inPage, n);
+        }
+        offset += n;
+        buffer += n;
+        length -= n;
+    }
+    return 0;
+}
+
+RC ColumnFile::read(unsigned row, const byte *&value, std::vector<byte> &buffer) {
+    byte *entry;
+    bool null;
+    if(locate(row, entry, null) != 0) {
+        return -1;
+    }
+    if(null) {
+        value = NULL;
+        return 0;
+    }
+    if(type != TypeVarChar) {
+        value = entry;
+        return 0;
+    }
+    uint64_t offset;
+    unsigned length;
+    memcpy(&offset, entry, sizeof(uint64_t));
+    memcpy(&length, entry + sizeof(uint64_t), sizeof(unsigned));
+    buffer.resize(sizeof(unsigned) + length);
+    memcpy(buffer.data(), &length, sizeof(unsigned));
+    value = buffer.data();
+    return heapAccess(offset, length, buffer.data() + sizeof(unsigned), false);
+}
+
+//A varchar that isn't longer than the one it replaces takes its place in the heap, otherwise it is appended
+RC ColumnFile::write(unsigned row, const byte *value, uint64_t &heapEnd) {
+    byte *entry;
+    bool null;
+    if(locate(row, entry, null) != 0) {
+        return -1;
+    }
+    values.dirty = true;
+    const unsigned index = row % rowsPerPageCount;
+    if(value == NULL) {
+        values.data[index/8] |= (1 << (7-index%8));
+        memset(entry, 0, width(type));
+        return 0;
+    }
+    values.data[index/8] &= ~(1 << (7-index%8));
+    if(type != TypeVarChar) {
+        memcpy(entry, value, sizeof(unsigned));
+        return 0;
+    }
+    unsigned length, oldLength;
+    uint64_t offset;
+    memcpy(&length, value, sizeof(unsigned));
+    memcpy(&offset, entry, sizeof(uint64_t));
+    memcpy(&oldLength, entry + sizeof(uint64_t), sizeof(unsigned));
+    if(null || oldLength < length) {
+        offset = heapEnd;
+        heapEnd += length;
+    }
+    memcpy(entry, &offset, sizeof(uint64_t));
+    memcpy(entry + sizeof(uint64_t), &length, sizeof(unsigned));
+    return heapAccess(offset, length, const_cast<byte *>(value) + sizeof(unsigned), true);
+}
+
+RC ColumnFile::gather(unsigned begin, unsigned count, byte *values, std::vector<byte> &nulls) {
+    nulls.resize(count);
+    unsigned done = 0;
+    while(done < count) {
+        const unsigned row = begin + done;
+        byte *entry;
+        bool null;
+        if(locate(row, entry, null) != 0) {
+            return -1;
+        }
+        const unsigned index = row % rowsPerPageCount;
+        const unsigned n = min(count - done, rowsPerPageCount - index);
+        memcpy(values + done*sizeof(unsigned), entry, n*sizeof(unsigned));
+        const byte *nullBits = ColumnFile::values.data.data();
+        for(unsigned i = 0 ; i < n ; ++i) {
+            nulls[done+i] = (nullBits[(index+i)/8] >> (7-(index+i)%8)) & 1;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+ColumnStoreManager &ColumnStoreManager::instance() {
+    static ColumnStoreManager _cs_manager = ColumnStoreManager();
+    return _cs_manager;
+}
+
+RC ColumnStoreManager::createTable(const std::string &tableName, const Schema &schema, unsigned pageSize) {
+    if(sizeof(unsigned) + schema.size()*sizeof(uint64_t) > pageSize) {
+        return -1;
+    }
+    if(PagedFileManager::instance().createFile(tableName, pageSize, COLUMN_LAYOUT) != 0) {
+        return -1;
+    }
+    FileHandle tableFile;
+    if(PagedFileManager::instance().openFile(tableName, tableFile) != 0) {
+        return -1;
+    }
+    vector<byte> metaPage(pageSize, 0);
+    RC rc = tableFile.appendPage(metaPage.data());
+    if(PagedFileManager::instance().closeFile(tableFile) != 0) {
+        rc = -1;
+    }
+    for(unsigned i = 0 ; rc == 0 && i < schema.size() ; ++i) {
+        rc = PagedFileManager::instance().createFile(ColumnFile::fileName(tableName, i), pageSize);
+        if(rc == 0 && schema.getType(i) == TypeVarChar) {
+            rc = PagedFileManager::instance().createFile(ColumnFile::heapFileName(tableName, i), pageSize);
+        }
+    }
+    return rc;
+}
+
+RC ColumnStoreManager::destroyTable(const std::string &tableName, const Schema &schema) {
+    RC rc = PagedFileManager::instance().destroyFile(tableName);
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        if(PagedFileManager::instance().destroyFile(ColumnFile::fileName(tableName, i)) != 0) {
+            rc = -1;
+        }
+        if(schema.getType(i) == TypeVarChar && PagedFileManager::instance().destroyFile(ColumnFile::heapFileName(tableName, i)) != 0) {
+            rc = -1;
+        }
+    }
+    return rc;
+}
+
+RC ColumnStoreManager::insertRecord(FileHandle &tableFile, const std::string &tableName, const Schema &schema,
+                                    const void *data, RID &rid) {
+    std::vector<RID> rids;
+    if(insertRecords(tableFile, tableName, schema, std::vector<const void *>(1, data), rids) != 0) {
+        return -1;
+    }
+    rid = rids[0];
+    return 0;
+}
+
+ColumnFiles &ColumnStoreManager::columnsOf(FileHandle &tableFile, const std::string &tableName, const Schema &schema) {
+    if(!tableFile.columnFiles || !tableFile.columnFiles->isFor(tableName, schema)) {
+        tableFile.columnFiles.reset();
+        tableFile.columnFiles = std::make_shared<ColumnFiles>(tableName, schema);
+    }
+    return *tableFile.columnFiles;
+}
+
+/**
+The rows are appended column by column, so each page of a column file is written once per call however many rows
+go to it.
+**/
+RC ColumnStoreManager::insertRecords(FileHandle &tableFile, const std::string &tableName, const Schema &schema,
+                                     const std::vector<const void *> &data, std::vector<RID> &rids) {
+    vector<byte> metaPage(tableFile.getPageSize());
+    if(tableFile.readPage(0, metaPage.data()) != 0) {
+        return -1;
+    }
+    ColumnFiles &columns = columnsOf(tableFile, tableName, schema);
+    const unsigned rowCount = getRowCount(metaPage.data());
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        ColumnFile *column = columns.get(i);
+        if(column == NULL) {
+            columns.release();
+            return -1;
+        }
+        uint64_t end = heapEnd(metaPage.data(), i);
+        for(unsigned r = 0 ; r < data.size() ; ++r) {
+            unsigned length;
+            if(column->write(rowCount + r, schema.findField(data[r], i, length), end) != 0) {
+                columns.release();
+                return -1;
+            }
+        }
+        if(column->release() != 0) {
+            columns.release();
+            return -1;
+        }
+        setHeapEnd(metaPage.data(), i, end);
+    }
+    rids.clear();
+    for(unsigned r = 0 ; r < data.size() ; ++r) {
+        rids.push_back(RID{rowCount + r, 0});
+    }
+    const unsigned newRowCount = rowCount + data.size();
+    memcpy(metaPage.data(), &newRowCount, sizeof(unsigned));
+    return tableFile.writePage(0, metaPage.data());
+}
+
+//-1 unless "rid" is a row of the table that isn't deleted
+RC ColumnStoreManager::checkRow(FileHandle &tableFile, const RID &rid, byte *metaPage) {
+    const unsigned pageSize = tableFile.getPageSize();
+    if(tableFile.readPage(0, metaPage) != 0 || rid.slotNum != 0 || rid.pageNum >= getRowCount(metaPage)) {
+        return -1;
+    }
+    vector<byte> page(pageSize);
+    if(readPageOrZeros(tableFile, deletedPage(rid.pageNum, pageSize), page.data()) != 0) {
+        return -1;
+    }
+    return isDeleted(page.data(), rid.pageNum, pageSize) ? -1 : 0;
+}
+
+RC ColumnStoreManager::readFields(ColumnFiles &columns, const Schema &schema, unsigned row,
+                                  const std::vector<unsigned> &fields, void *data) {
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(fields.size());
+    byte *nullInfo = static_cast<byte *>(data);
+    byte *cur = nullInfo + nullInfoFieldLength;
+    memset(nullInfo, 0, nullInfoFieldLength);
+    vector<byte> buffer;
+    for(unsigned i = 0 ; i < fields.size() ; ++i) {
+        ColumnFile *column = columns.get(fields[i]);
+        if(column == NULL) {
+            return -1;
+        }
+        const byte *value;
+        RC rc = column->read(row, value, buffer);
+        if(rc == 0 && value == NULL) {
+            nullInfo[i/8] |= (1 << (7-i%8));
+        }
+        else if(rc == 0) {
+            unsigned length = sizeof(unsigned);
+            if(schema.getType(fields[i]) == TypeVarChar) {
+                memcpy(&length, value, sizeof(unsigned));
+                length += sizeof(unsigned);
+            }
+            memcpy(cur, value, length);
+            cur += length;
+        }
+        if(column->release() != 0 || rc != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+RC ColumnStoreManager::readRecord(FileHandle &tableFile, const std::string &tableName, const Schema &schema,
+                                  const RID &rid, void *data) {
+    vector<byte> metaPage(tableFile.getPageSize());
+    if(checkRow(tableFile, rid, metaPage.data()) != 0) {
+        return -1;
+    }
+    vector<unsigned> fields(schema.size());
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        fields[i] = i;
+    }
+    return readFields(columnsOf(tableFile, tableName, schema), schema, rid.pageNum, fields, data);
+}
+
+RC ColumnStoreManager::readAttribute(FileHandle &tableFile, const std::string &tableName, const Schema &schema,
+                                     const RID &rid, const std::string &attributeName, void *data) {
+    int index = schema.indexOf(attributeName);
+    vector<byte> metaPage(tableFile.getPageSize());
+    if(index == -1 || checkRow(tableFile, rid, metaPage.data()) != 0) {
+        return -1;
+    }
+    return readFields(columnsOf(tableFile, tableName, schema), schema, rid.pageNum, vector<unsigned>(1, index), data);
+}
+
+RC ColumnStoreManager::updateRecord(FileHandle &tableFile, const std::string &tableName, const Schema &schema,
+                                    const void *data, const RID &rid) {
+    vector<byte> metaPage(tableFile.getPageSize());
+    if(checkRow(tableFile, rid, metaPage.data()) != 0) {
+        return -1;
+    }
+    ColumnFiles &columns = columnsOf(tableFile, tableName, schema);
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        ColumnFile *column = columns.get(i);
+        if(column == NULL) {
+            return -1;
+        }
+        uint64_t end = heapEnd(metaPage.data(), i);
+        unsigned length;
+        RC rc = column->write(rid.pageNum, schema.findField(data, i, length), end);
+        if(column->release() != 0 || rc != 0) {
+            return -1;
+        }
+        setHeapEnd(metaPage.data(), i, end);
+    }
+    return tableFile.writePage(0, metaPage.data());
+}
+
+//The row keeps its position, only its bit in the deleted rows bitmap is set
+RC ColumnStoreManager::deleteRecord(FileHandle &tableFile, const RID &rid) {
+    const unsigned pageSize = tableFile.getPageSize();
+    vector<byte> metaPage(pageSize);
+    if(checkRow(tableFile, rid, metaPage.data()) != 0) {
+        return -1;
+    }
+    vector<byte> page(pageSize);
+    const PageNum pageNum = deletedPage(rid.pageNum, pageSize);
+    if(readPageOrZeros(tableFile, pageNum, page.data()) != 0) {
+        return -1;
+    }
+    const unsigned bit = rid.pageNum % (pageSize*8);
+    page[bit/8] |= (1 << (7-bit%8));
+    return writePageOrAppend(tableFile, pageNum, page.data());
+}
+
+RC ColumnStoreManager::scan(FileHandle &tableFile, const std::string &tableName, const Schema &schema,
+                            const std::vector<ScanPredicate> &predicates, const std::vector<std::string> &attributeNames,
+                            CS_ScanIterator &cs_ScanIterator) {
+    vector<ScanCondition> conditions;
+    RecordBasedFileManager::resolvePredicates(schema, predicates, conditions);
+    vector<unsigned> projected;
+    for(unsigned i = 0 ; i < attributeNames.size() ; ++i) {
+        int index = schema.indexOf(attributeNames[i]);
+        if(index == -1) {
+            PagedFileManager::instance().closeFile(tableFile);
+            return -1;
+        }
+        projected.push_back(index);
+    }
+    columnsOf(tableFile, tableName, schema);
+    return cs_ScanIterator.open(tableFile, tableFile.columnFiles, schema, conditions, projected);
+}
+
+RC CS_ScanIterator::open(FileHandle &tableFile, const std::shared_ptr<ColumnFiles> &columns, const Schema &schema,
+                         const std::vector<ScanCondition> &conditions, const std::vector<unsigned> &projected) {
+    CS_ScanIterator::tableFile.fileHandle = tableFile;
+    CS_ScanIterator::columns = columns;
+    CS_ScanIterator::tableFile.pageNum = UINT_MAX;
+    CS_ScanIterator::tableFile.dirty = false;
+    CS_ScanIterator::schema = schema;
+    CS_ScanIterator::conditions = conditions;
+    CS_ScanIterator::projected = projected;
+    next = 0;
+    position = 0;
+    current.clear();
+
+    if(CS_ScanIterator::tableFile.load(0) != 0) {
+        close();
+        return -1;
+    }
+    rowCount = ColumnStoreManager::getRowCount(CS_ScanIterator::tableFile.data.data());
+    //Only the columns the scan looks at are opened
+    vector<unsigned> fields(projected);
+    for(unsigned i = 0 ; i < conditions.size() ; ++i) {
+        if(conditions[i].field < schema.size()) {
+            fields.push_back(conditions[i].field);
+        }
+    }
+    for(unsigned i = 0 ; i < fields.size() ; ++i) {
+        if(columns->get(fields[i]) == NULL) {
+            close();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+//"selection" gets a bit per row of the batch, set unless the row is deleted
+RC CS_ScanIterator::readDeleted(unsigned begin, unsigned count) {
+    const unsigned pageSize = tableFile.fileHandle.getPageSize();
+    selection.assign((count+63)/64, 0);
+    for(unsigned i = 0 ; i < count ; ++i) {
+        if(tableFile.load(deletedPage(begin+i, pageSize)) != 0) {
+            return -1;
+        }
+        if(!isDeleted(tableFile.data.data(), begin+i, pageSize)) {
+            selection[i/64] |= uint64_t(1) << i%64;
+        }
+    }
+    return 0;
+}
+
+//Clears the bits of "selection" whose rows fail a condition; an int/real condition is checked for all of them at once
+RC CS_ScanIterator::evaluate(unsigned begin, unsigned count) {
+    const unsigned words = (count+63)/64;
+    for(unsigned c = 0 ; c < conditions.size() ; ++c) {
+        const ScanCondition &condition = conditions[c];
+        if(condition.field >= schema.size()) {
+            return -1;
+        }
+        ColumnFile &column = *columns->get(condition.field);
+        if(condition.type == TypeVarChar) {
+            for(unsigned i = 0 ; i < count ; ++i) {
+                if(!(selection[i/64] >> i%64 & 1)) {
+                    continue;
+                }
+                const byte *value;
+                if(column.read(begin+i, value, buffer) != 0) {
+                    return -1;
+                }
+                unsigned length;
+                if(value != NULL) {
+                    memcpy(&length, value, sizeof(unsigned));
+                }
+                if(value == NULL || !RBFM_ScanIterator::conditionHolds(condition, value + sizeof(unsigned), length)) {
+                    selection[i/64] &= ~(uint64_t(1) << i%64);
+                }
+            }
+        }
+        else {
+            passed.resize(words);
+            if(condition.type == TypeInt) {
+                intColumn.resize(count);
+                if(column.gather(begin, count, reinterpret_cast<byte *>(intColumn.data()), nulls) != 0) {
+                    return -1;
+                }
+                selectInts(intColumn.data(), count, condition.compOp, *static_cast<const int *>(condition.value), passed.data());
+            }
+            else {
+                realColumn.resize(count);
+                if(column.gather(begin, count, reinterpret_cast<byte *>(realColumn.data()), nulls) != 0) {
+                    return -1;
+                }
+                selectReals(realColumn.data(), count, condition.compOp, *static_cast<const float *>(condition.value), passed.data());
+            }
+            for(unsigned i = 0 ; i < count ; ++i) {
+                if(nulls[i]) {
+                    passed[i/64] &= ~(uint64_t(1) << i%64);
+                }
+            }
+            for(unsigned w = 0 ; w < words ; ++w) {
+                selection[w] &= passed[w];
+            }
+        }
+        if(std::all_of(selection.begin(), selection.end(), [](uint64_t word) { return word == 0; })) {
+            break;
+        }
+    }
+    return 0;
+}
+
+//The selected rows of the batch and their projected attributes
+RC CS_ScanIterator::fill(unsigned begin, unsigned count, ColumnBatch &batch) {
+    for(unsigned i = 0 ; i < count ; ++i) {
+        if(selection[i/64] >> i%64 & 1) {
+            batch.rows.push_back(begin+i);
+        }
+    }
+    batch.columns.resize(projected.size());
+    for(unsigned p = 0 ; p < projected.size() ; ++p) {
+        ColumnFile &column = *columns->get(projected[p]);
+        ColumnVector &columnVector = batch.columns[p];
+        columnVector.type = column.getType();
+        columnVector.nulls.clear();
+        columnVector.ints.clear();
+        columnVector.reals.clear();
+        columnVector.offsets.assign(1, 0);
+        columnVector.chars.clear();
+        if(columnVector.type == TypeVarChar) {
+            for(unsigned r = 0 ; r < batch.rows.size() ; ++r) {
+                const byte *value;
+                if(column.read(batch.rows[r], value, buffer) != 0) {
+                    return -1;
+                }
+                columnVector.nulls.push_back(value == NULL);
+                if(value != NULL) {
+                    unsigned length;
+                    memcpy(&length, value, sizeof(unsigned));
+                    columnVector.chars.insert(columnVector.chars.end(), value + sizeof(unsigned), value + sizeof(unsigned) + length);
+                }
+                columnVector.offsets.push_back(columnVector.chars.size());
+            }
+            continue;
+        }
+        //The whole range is gathered, then the selected rows are picked
+        intColumn.resize(count);
+        if(column.gather(begin, count, reinterpret_cast<byte *>(intColumn.data()), nulls) != 0) {
+            return -1;
+        }
+        for(unsigned r = 0 ; r < batch.rows.size() ; ++r) {
+            const unsigned i = batch.rows[r] - begin;
+            columnVector.nulls.push_back(nulls[i]);
+            if(columnVector.type == TypeInt) {
+                columnVector.ints.push_back(intColumn[i]);
+            }
+            else {
+                float real;
+                memcpy(&real, &intColumn[i], sizeof(float));
+                columnVector.reals.push_back(real);
+            }
+        }
+    }
+    return 0;
+}
+
+RC CS_ScanIterator::getNextBatch(ColumnBatch &batch) {
+    batch.clear();
+    while(next < rowCount) {
+        const unsigned begin = next;
+        const unsigned count = min<unsigned>(CS_BATCH_SIZE, rowCount - begin);
+        next += count;
+        if(readDeleted(begin, count) != 0 || evaluate(begin, count) != 0) {
+            return -1;
+        }
+        if(std::any_of(selection.begin(), selection.end(), [](uint64_t word) { return word != 0; })) {
+            return fill(begin, count, batch) == 0 ? 0 : -1;
+        }
+    }
+    return RBFM_EOF;
+}
+
+//Index in "current" of the next row, a new batch is read when it is used up
+RC CS_ScanIterator::nextRow(unsigned &index) {
+    if(position >= current.size()) {
+        RC rc = getNextBatch(current);
+        if(rc != 0) {
+            return rc;
+        }
+        position = 0;
+    }
+    index = position++;
+    return 0;
+}
+
+RC CS_ScanIterator::getNextRecord(RID &rid, void *data) {
+    unsigned index;
+    RC rc = nextRow(index);
+    if(rc != 0) {
+        return rc;
+    }
+    rid = RID{current.rows[index], 0};
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(projected.size());
+    byte *nullInfo = static_cast<byte *>(data);
+    byte *cur = nullInfo + nullInfoFieldLength;
+    memset(nullInfo, 0, nullInfoFieldLength);
+    for(unsigned p = 0 ; p < projected.size() ; ++p) {
+        const ColumnVector &columnVector = current.columns[p];
+        if(columnVector.nulls[index]) {
+            nullInfo[p/8] |= (1 << (7-p%8));
+        }
+        else if(columnVector.type == TypeInt) {
+            memcpy(cur, &columnVector.ints[index], sizeof(int));
+            cur += sizeof(int);
+        }
+        else if(columnVector.type == TypeReal) {
+            memcpy(cur, &columnVector.reals[index], sizeof(float));
+            cur += sizeof(float);
+        }
+        else {
+            unsigned length = columnVector.offsets[index+1] - columnVector.offsets[index];
+            memcpy(cur, &length, sizeof(unsigned));
+            memcpy(cur + sizeof(unsigned), columnVector.chars.data() + columnVector.offsets[index], length);
+            cur += sizeof(unsigned) + length;
+        }
+    }
+    return 0;
+}
+
+//The view holds the projected attributes, field i being the i-th of them
+RC CS_ScanIterator::getNextRecordView(RID &rid, RecordView &view) {
+    unsigned index;
+    RC rc = nextRow(index);
+    if(rc != 0) {
+        return rc;
+    }
+    rid = RID{current.rows[index], 0};
+    const unsigned fieldCount = projected.size();
+    unsigned length = 0;
+    recordFormat.resize((fieldCount+1)*sizeof(unsigned));
+    for(unsigned p = 0 ; p < fieldCount ; ++p) {
+        const ColumnVector &columnVector = current.columns[p];
+        memcpy(recordFormat.data() + p*sizeof(unsigned), &length, sizeof(unsigned));
+        if(columnVector.nulls[index]) {
+            continue;
+        }
+        const byte *value;
+        unsigned valueLength = sizeof(unsigned);
+        if(columnVector.type == TypeInt) {
+            value = reinterpret_cast<const byte *>(&columnVector.ints[index]);
+        }
+        else if(columnVector.type == TypeReal) {
+            value = reinterpret_cast<const byte *>(&columnVector.reals[index]);
+        }
+        else {
+            unsigned charCount = columnVector.offsets[index+1] - columnVector.offsets[index];
+            recordFormat.insert(recordFormat.end(), reinterpret_cast<const byte *>(&charCount), reinterpret_cast<const byte *>(&charCount) + sizeof(unsigned));
+            value = reinterpret_cast<const byte *>(columnVector.chars.data() + columnVector.offsets[index]);
+            valueLength = charCount;
+            length += sizeof(unsigned);
+        }
+        recordFormat.insert(recordFormat.end(), value, value + valueLength);
+        length += valueLength;
+    }
+    memcpy(recordFormat.data() + fieldCount*sizeof(unsigned), &length, sizeof(unsigned));
+    view = RecordView(recordFormat.data(), fieldCount);
+    return 0;
+}
+
+//The column files are closed with the last handle of the table
+RC CS_ScanIterator::close() {
+    RC rc = columns && columns->release() != 0 ? -1 : 0;
+    columns.reset();
+    if(tableFile.fileHandle.fd >= 0 && PagedFileManager::instance().closeFile(tableFile.fileHandle) != 0) {
+        rc = -1;
+    }
+    current.clear();
+    return rc;
+}
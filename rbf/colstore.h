@@ -0,0 +1,196 @@
+#ifndef _colstore_h_
+#define _colstore_h_
+
+#include <string>
+#include <vector>
+#include <climits>
+#include <cstdint>
+
+#include "rbfm.h"
+
+#define CS_BATCH_SIZE 1024          // Rows a column scan evaluates at once
+
+// The values of one attribute for the rows of a ColumnBatch
+struct ColumnVector {
+    AttrType type;
+    std::vector<byte> nulls;            // 1 if the value of the row is NULL, its value below is then 0 (or empty)
+    std::vector<int> ints;              // TypeInt
+    std::vector<float> reals;           // TypeReal
+    std::vector<unsigned> offsets;      // TypeVarChar: row i is chars[offsets[i], offsets[i+1])
+    std::vector<char> chars;
+};
+
+// Rows returned together by a column scan: their row numbers, then the projected attributes in the order asked for
+struct ColumnBatch {
+    std::vector<unsigned> rows;
+    std::vector<ColumnVector> columns;
+
+    unsigned size() const { return rows.size(); }
+    void clear();
+};
+
+// One page of a file of a column table held in memory while it is accessed, written back when another page is needed.
+// Pages past the end of the file read as zeros, writing one appends it (and the zero pages before it).
+struct ColumnPage {
+    FileHandle fileHandle;
+    std::vector<byte> data;
+    PageNum pageNum = UINT_MAX;
+    bool dirty = false;
+
+    RC load(PageNum pageNum);
+    RC flush();
+};
+
+/**
+A column of a column table. Its file holds the rows by position: page p holds rows p*R to (p+1)*R-1, where R is
+rowsPerPage(), as a null bitmap (a bit per row) followed by the values. An int/real is its 4 bytes, a varchar is the
+offset (8 bytes) and the length (4 bytes) of its characters in a second file, the column's heap, to which they are
+appended.
+**/
+class ColumnFile {
+public:
+    RC open(const std::string &tableName, unsigned field, AttrType type);
+    RC close();                                                         // Writes back what was changed
+    RC release();                                                       // Same, the files stay open
+
+    static std::string fileName(const std::string &tableName, unsigned field);
+    static std::string heapFileName(const std::string &tableName, unsigned field);
+    static unsigned width(AttrType type) { return type == TypeVarChar ? sizeof(uint64_t) + sizeof(unsigned) : sizeof(unsigned); }
+    static unsigned rowsPerPage(unsigned pageSize, AttrType type);
+
+    // The value of "row", NULL if it is NULL. A varchar is returned in the API format (length, characters) in "buffer"
+    RC read(unsigned row, const byte *&value, std::vector<byte> &buffer);
+    // Sets the value of "row", "value" is in the API format, NULL for a NULL; "heapEnd" is the end of the heap
+    RC write(unsigned row, const byte *value, uint64_t &heapEnd);
+    // The int/real values of rows [begin, begin+count) into "values", NULLs as 0 and flagged in "nulls"
+    RC gather(unsigned begin, unsigned count, byte *values, std::vector<byte> &nulls);
+
+    AttrType getType() const { return type; }
+
+private:
+    RC locate(unsigned row, byte *&entry, bool &null);
+    RC heapAccess(uint64_t offset, unsigned length, byte *buffer, bool write);
+
+    AttrType type = TypeInt;
+    unsigned rowsPerPageCount = 0;
+    ColumnPage values;
+    ColumnPage heap;                                                    // varchar only
+};
+
+/**
+The column files of a table, opened as they are first needed and kept in the FileHandle of the table's file (see
+ColumnStoreManager::columnsOf()) until it is closed, so that the calls made through the same handle don't open and
+close them every time. Like the page count of a handle, the page counts of the column files reach their hidden pages
+when they are closed.
+**/
+class ColumnFiles {
+public:
+    ColumnFiles(const std::string &tableName, const Schema &schema);
+    ~ColumnFiles();
+    ColumnFiles(const ColumnFiles &) = delete;
+    ColumnFiles &operator=(const ColumnFiles &) = delete;
+
+    bool isFor(const std::string &tableName, const Schema &schema) const;
+    ColumnFile *get(unsigned field);                                    // Opens it if needed, NULL on errors
+    RC release();                                                       // Writes back the pages held by the open files
+
+private:
+    std::string tableName;
+    std::vector<AttrType> types;                                        // by field
+    std::vector<ColumnFile> columns;                                    // by field, the ones in use are open
+    std::vector<bool> opened;
+};
+
+// ColumnStoreManager::scan() iterator, it goes through the rows a batch at a time
+class CS_ScanIterator {
+public:
+    CS_ScanIterator() = default;
+    ~CS_ScanIterator() = default;
+
+    // Only meant for ColumnStoreManager::scan(). "tableFile" is closed if the scan can't be opened
+    RC open(FileHandle &tableFile, const std::shared_ptr<ColumnFiles> &columns, const Schema &schema,
+            const std::vector<ScanCondition> &conditions, const std::vector<unsigned> &projected);
+
+    // The next rows passing the conditions, at most CS_BATCH_SIZE of them; RBFM_EOF at the end, -1 on errors
+    RC getNextBatch(ColumnBatch &batch);
+
+    // The same rows one at a time, "data" in the format of RecordBasedFileManager::insertRecord()
+    RC getNextRecord(RID &rid, void *data);
+    // Same as a view of the row in the record format of RecordBasedFileManager, valid until the next call
+    RC getNextRecordView(RID &rid, RecordView &view);
+
+    RC close();
+
+private:
+    RC readDeleted(unsigned begin, unsigned count);
+    RC evaluate(unsigned begin, unsigned count);
+    RC fill(unsigned begin, unsigned count, ColumnBatch &batch);
+    RC nextRow(unsigned &index);
+
+    ColumnPage tableFile;                                               // the deleted rows bitmap
+    Schema schema;
+    std::vector<ScanCondition> conditions;
+    std::vector<unsigned> projected;
+    std::shared_ptr<ColumnFiles> columns;                               // those of the table's handle
+    unsigned rowCount = 0;                                              // when the scan started
+    unsigned next = 0;                                                  // first row of the next batch
+
+    std::vector<uint64_t> selection, passed;                            // bit per row of the batch
+    std::vector<byte> nulls;
+    std::vector<int> intColumn;
+    std::vector<float> realColumn;
+    std::vector<byte> buffer;
+    ColumnBatch current;                                                // rows returned by getNextRecord()
+    unsigned position = 0;
+    std::vector<byte> recordFormat;
+};
+
+/**
+Column store: an alternative to the record-based files for tables that are mostly scanned for a few attributes.
+Every attribute of a table lives in its own paged file (see ColumnFile), rows are identified by their position,
+given as the RID {row number, 0}. The table's own file keeps the number of rows and the end of the varchar heaps on
+its first page, and a bitmap of the deleted rows on the next ones; it is created with COLUMN_LAYOUT, which is how
+RelationManager tells column tables apart. Rows are only appended; a deleted row keeps its position. The characters
+of a varchar that is updated to a longer one or deleted are not reclaimed.
+The methods take the table's file, already open, and open the column files they need once per handle.
+**/
+class ColumnStoreManager {
+public:
+    static ColumnStoreManager &instance();
+
+    static bool isColumnTable(const FileHandle &tableFile) { return tableFile.getPageFormat() == COLUMN_LAYOUT; }
+
+    RC createTable(const std::string &tableName, const Schema &schema, unsigned pageSize = PAGE_SIZE);
+    RC destroyTable(const std::string &tableName, const Schema &schema);
+
+    RC insertRecord(FileHandle &tableFile, const std::string &tableName, const Schema &schema, const void *data, RID &rid);
+    RC insertRecords(FileHandle &tableFile, const std::string &tableName, const Schema &schema,
+                     const std::vector<const void *> &data, std::vector<RID> &rids);
+    RC readRecord(FileHandle &tableFile, const std::string &tableName, const Schema &schema, const RID &rid, void *data);
+    RC readAttribute(FileHandle &tableFile, const std::string &tableName, const Schema &schema, const RID &rid,
+                     const std::string &attributeName, void *data);
+    RC updateRecord(FileHandle &tableFile, const std::string &tableName, const Schema &schema, const void *data, const RID &rid);
+    RC deleteRecord(FileHandle &tableFile, const RID &rid);
+
+    // Like RecordBasedFileManager::scan(), only the columns of the predicates and of the projection are read.
+    // The iterator takes over "tableFile"; it is closed at once if a projected attribute is unknown (-1)
+    RC scan(FileHandle &tableFile, const std::string &tableName, const Schema &schema,
+            const std::vector<ScanPredicate> &predicates, const std::vector<std::string> &attributeNames,
+            CS_ScanIterator &cs_ScanIterator);
+
+    static unsigned getRowCount(const byte *metaPage) { unsigned rowCount; memcpy(&rowCount, metaPage, sizeof(unsigned)); return rowCount; }
+
+protected:
+    ColumnStoreManager() = default;
+    ~ColumnStoreManager() = default;
+    ColumnStoreManager(const ColumnStoreManager &) = default;
+    ColumnStoreManager &operator=(const ColumnStoreManager &) = default;
+
+private:
+    // The column files of the table, kept in "tableFile"
+    ColumnFiles &columnsOf(FileHandle &tableFile, const std::string &tableName, const Schema &schema);
+    RC checkRow(FileHandle &tableFile, const RID &rid, byte *metaPage);
+    RC readFields(ColumnFiles &columns, const Schema &schema, unsigned row, const std::vector<unsigned> &fields, void *data);
+};
+
+#endif
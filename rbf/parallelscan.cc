@@ -0,0 +1,141 @@
+#include <cstring>
+#include <algorithm>
+#include "parallelscan.h"
+
+using namespace std;
+
+RC RBFM_ParallelScanIterator::open(unsigned workers) {
+    if(!threads.empty()) {
+        return -1;
+    }
+    if(workers == 0) {
+        workers = max(1u, thread::hardware_concurrency());
+    }
+    FileHandle &fileHandle = scan.getFileHandle();
+    pageCount = fileHandle.getNumberOfPages();
+    vector<Attribute> attributes;
+    for(unsigned field : scan.getAttrToExtractInd()) {
+        attributes.push_back(scan.getRecordDescriptor()[field]);
+    }
+    projection = Schema(attributes);
+
+    cursor = 0;
+    queues.assign(workers, deque<Chunk>());
+    running = workers;
+    stopping = false;
+    failed = false;
+    readPages = bufferHits = bufferMisses = 0;
+    current = Chunk();
+    position = 0;
+    nextQueue = 0;
+    for(unsigned i = 0 ; i < workers ; ++i) {
+        threads.emplace_back(&RBFM_ParallelScanIterator::work, this, i);
+    }
+    return 0;
+}
+
+void RBFM_ParallelScanIterator::work(unsigned worker) {
+    RBFM_ScanIterator morselScan = scan;
+    FileHandle &fileHandle = morselScan.getFileHandle();
+    const unsigned reads = fileHandle.readPageCounter, hits = fileHandle.bufferHitCounter, misses = fileHandle.bufferMissCounter;
+    vector<byte> record(fileHandle.getPageSize());
+
+    unique_lock<mutex> lock(latch, defer_lock);
+    PageNum firstPage;
+    while((firstPage = cursor.fetch_add(PARALLEL_SCAN_MORSEL_PAGES)) < pageCount) {
+        morselScan.setPageRange(firstPage, min(firstPage + PARALLEL_SCAN_MORSEL_PAGES, pageCount));
+        Chunk chunk;
+        chunk.offsets.push_back(0);
+        RID rid;
+        RC rc;
+        while((rc = morselScan.getNextRecord(rid, record.data())) == 0) {
+            const unsigned length = projection.getDataLength(record.data());
+            chunk.rids.push_back(rid);
+            chunk.data.insert(chunk.data.end(), record.begin(), record.begin() + length);
+            chunk.offsets.push_back(chunk.data.size());
+        }
+
+        lock.lock();
+        if(rc != RBFM_EOF || !morselScan.isExhausted()) {
+            failed = true;
+        }
+        if(!chunk.rids.empty()) {
+            consumed.wait(lock, [&]() { return stopping || failed || queues[worker].size() < PARALLEL_SCAN_QUEUE_CHUNKS; });
+        }
+        if(stopping || failed) {
+            break;
+        }
+        if(!chunk.rids.empty()) {
+            queues[worker].push_back(move(chunk));
+            produced.notify_one();
+        }
+        lock.unlock();
+    }
+
+    if(!lock.owns_lock()) {
+        lock.lock();
+    }
+    --running;
+    readPages += fileHandle.readPageCounter - reads;
+    bufferHits += fileHandle.bufferHitCounter - hits;
+    bufferMisses += fileHandle.bufferMissCounter - misses;
+    produced.notify_one();
+}
+
+RC RBFM_ParallelScanIterator::getNextRecord(RID &rid, void *data) {
+    if(position == current.rids.size()) {
+        unique_lock<mutex> lock(latch);
+        while(true) {
+            if(failed) {
+                return -1;
+            }
+            unsigned i = 0;
+            while(i < queues.size() && queues[(nextQueue+i) % queues.size()].empty()) {
+                ++i;
+            }
+            if(i < queues.size()) {
+                const unsigned queue = (nextQueue+i) % queues.size();
+                current = move(queues[queue].front());
+                queues[queue].pop_front();
+                position = 0;
+                nextQueue = queue+1;
+                consumed.notify_all();
+                break;
+            }
+            if(running == 0) {
+                return RBFM_EOF;
+            }
+            produced.wait(lock);
+        }
+    }
+    rid = current.rids[position];
+    const unsigned length = current.offsets[position+1] - current.offsets[position];
+    if(length > 0) {
+        memcpy(data, current.data.data() + current.offsets[position], length);
+    }
+    ++position;
+    return 0;
+}
+
+RC RBFM_ParallelScanIterator::close() {
+    {
+        lock_guard<mutex> guard(latch);
+        stopping = true;
+    }
+    consumed.notify_all();
+    for(thread &worker : threads) {
+        worker.join();
+    }
+    threads.clear();
+    queues.clear();
+    current = Chunk();
+    position = 0;
+
+    FileHandle &fileHandle = scan.getFileHandle();
+    fileHandle.readPageCounter += readPages;
+    fileHandle.bufferHitCounter += bufferHits;
+    fileHandle.bufferMissCounter += bufferMisses;
+    readPages = bufferHits = bufferMisses = 0;
+    RC rc = scan.close();
+    return failed ? -1 : rc;
+}
@@ -0,0 +1,77 @@
+#ifndef _parallelscan_h_
+#define _parallelscan_h_
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "rbfm.h"
+
+#define PARALLEL_SCAN_MORSEL_PAGES 16       // Consecutive pages a worker takes at once
+#define PARALLEL_SCAN_QUEUE_CHUNKS 4        // Morsels a worker may have scanned ahead of the consumer
+
+/**
+RecordBasedFileManager::parallelScan() iterator. The pages of the file are cut into morsels of
+PARALLEL_SCAN_MORSEL_PAGES pages, which the worker threads take in order from a shared cursor until none is left.
+Each worker runs its own copy of the scan (see RBFM_ScanIterator::setPageRange()) over its morsel, checking the
+conditions and projecting the records on the page as usual, and queues the records it got as one chunk. The
+consumer takes the chunks from the workers' queues in turn, so the records come in no particular order. A worker
+waits while its queue is full.
+The file is scanned as it was when the scan started; its records shouldn't be changed while it runs.
+**/
+class RBFM_ParallelScanIterator {
+public:
+    RBFM_ParallelScanIterator() = default;
+    ~RBFM_ParallelScanIterator() { close(); }
+
+    RBFM_ParallelScanIterator(const RBFM_ParallelScanIterator &) = delete;
+    RBFM_ParallelScanIterator &operator=(const RBFM_ParallelScanIterator &) = delete;
+
+    // The scan the workers copy, set up by RecordBasedFileManager::parallelScan()
+    RBFM_ScanIterator &getScanIterator() { return scan; }
+
+    // Only meant for RecordBasedFileManager::parallelScan(): starts the workers
+    RC open(unsigned workers);
+
+    // "data" follows the same format as RecordBasedFileManager::insertRecord(), restricted to the projected
+    // attributes. RBFM_EOF at the end, -1 if a worker failed
+    RC getNextRecord(RID &rid, void *data);
+
+    // Stops the workers, their page reads are added to the counters of the file. -1 if a worker failed: this is
+    // how a failed scan is told from its end
+    RC close();
+
+private:
+    // Records found by a worker in one morsel: record i is data[offsets[i], offsets[i+1])
+    struct Chunk {
+        std::vector<RID> rids;
+        std::vector<unsigned> offsets;
+        std::vector<byte> data;
+    };
+
+    void work(unsigned worker);
+
+    RBFM_ScanIterator scan;
+    Schema projection;                                                  // of the records returned
+    unsigned pageCount = 0;                                             // when the scan started
+    std::atomic<unsigned> cursor{0};                                    // first page of the next morsel
+    std::vector<std::thread> threads;
+    std::vector<std::deque<Chunk> > queues;                             // by worker
+
+    std::mutex latch;                                                   // guards the members below
+    std::condition_variable produced;                                   // a chunk was queued or a worker is done
+    std::condition_variable consumed;                                   // a chunk was taken or the scan is closing
+    unsigned running = 0;                                               // workers not done yet
+    bool stopping = false;
+    bool failed = false;
+    unsigned readPages = 0, bufferHits = 0, bufferMisses = 0;           // of the workers' handles
+
+    Chunk current;                                                      // taken by the consumer
+    unsigned position = 0;                                              // next record of "current"
+    unsigned nextQueue = 0;                                             // where the consumer looks first
+};
+
+#endif
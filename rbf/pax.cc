@@ -0,0 +1,298 @@
+#include <cstring>
+#include <algorithm>
+#include "pax.h"
+
+using namespace std;
+
+#define PAX_TRAILER_FIELDS 4
+
+PaxPage::PaxPage(byte *page, unsigned pageSize, const Schema &schema) : page(page), pageSize(pageSize), schema(schema) {
+    layout(getCapacity());
+}
+
+//Offsets of the minipages for "capacity" slots
+void PaxPage::layout(unsigned capacity) {
+    nullOffset = capacity;
+    fieldOffsets.resize(schema.size()+1);
+    unsigned offset = nullOffset + capacity*schema.getNullIndicatorSize();
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        fieldOffsets[i] = offset;
+        offset += capacity*entrySize(i);
+    }
+    fieldOffsets[schema.size()] = offset;
+}
+
+void PaxPage::format(unsigned varBytes) {
+    const unsigned usable = pageSize - PAX_TRAILER_FIELDS*sizeof(unsigned);
+    unsigned slotSize = 1 + schema.getNullIndicatorSize();
+    unsigned expectedVarBytes = 0;
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        slotSize += entrySize(i);
+        if(schema.getType(i) == TypeVarChar) {
+            expectedVarBytes += schema[i].length/2;
+        }
+    }
+    unsigned capacity = usable / (slotSize + expectedVarBytes);
+    //The first record must fit, whatever its varchars
+    capacity = varBytes >= usable ? 0 : min(capacity, (usable-varBytes) / slotSize);
+
+    memset(page, 0, pageSize);
+    layout(capacity);
+    setTrailer(1, heapStart());
+    setTrailer(2, 0);
+    setTrailer(3, capacity);
+    setTrailer(4, 0);
+}
+
+const char *PaxPage::getVarChar(unsigned slot, unsigned field, unsigned &length) const {
+    unsigned offset;
+    const byte *e = entry(slot, field);
+    memcpy(&offset, e, sizeof(unsigned));
+    memcpy(&length, e + sizeof(unsigned), sizeof(unsigned));
+    return reinterpret_cast<const char *>(page + offset);
+}
+
+unsigned PaxPage::project(unsigned slot, const std::vector<unsigned> &fields, void *data) const {
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(fields.size());
+    byte *nullInfo = static_cast<byte *>(data);
+    byte *cur = nullInfo + nullInfoFieldLength;
+    memset(nullInfo, 0, nullInfoFieldLength);
+    for(unsigned i = 0 ; i < fields.size() ; ++i) {
+        unsigned field = fields[i];
+        if(isNull(slot, field)) {
+            nullInfo[i/8] |= (1 << (7 - i%8));
+        }
+        else if(schema.getType(field) != TypeVarChar) {
+            memcpy(cur, getFixed(slot, field), sizeof(unsigned));
+            cur += sizeof(unsigned);
+        }
+        else {
+            unsigned length;
+            const char *chars = getVarChar(slot, field, length);
+            memcpy(cur, &length, sizeof(unsigned));
+            memcpy(cur + sizeof(unsigned), chars, length);
+            cur += sizeof(unsigned) + length;
+        }
+    }
+    return cur - nullInfo;
+}
+
+unsigned PaxPage::project(unsigned slot, void *data) const {
+    const unsigned nullInfoFieldLength = schema.getNullIndicatorSize();
+    byte *cur = static_cast<byte *>(data) + nullInfoFieldLength;
+    //The null indicators are stored as they come
+    memcpy(data, page + nullOffset + slot*nullInfoFieldLength, nullInfoFieldLength);
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        if(isNull(slot, i)) {
+            continue;
+        }
+        if(schema.getType(i) != TypeVarChar) {
+            memcpy(cur, getFixed(slot, i), sizeof(unsigned));
+            cur += sizeof(unsigned);
+        }
+        else {
+            unsigned length;
+            const char *chars = getVarChar(slot, i, length);
+            memcpy(cur, &length, sizeof(unsigned));
+            memcpy(cur + sizeof(unsigned), chars, length);
+            cur += sizeof(unsigned) + length;
+        }
+    }
+    return cur - static_cast<byte *>(data);
+}
+
+void PaxPage::toRecordFormat(unsigned slot, std::vector<byte> &recordFormat) const {
+    const unsigned fieldCount = schema.size();
+    unsigned length = 0;
+    recordFormat.resize((fieldCount+1)*sizeof(unsigned));
+    for(unsigned i = 0 ; i < fieldCount ; ++i) {
+        memcpy(recordFormat.data() + i*sizeof(unsigned), &length, sizeof(unsigned));
+        if(isNull(slot, i)) {
+            continue;
+        }
+        unsigned varLength = 0;
+        const byte *value = getFixed(slot, i);
+        if(schema.getType(i) == TypeVarChar) {
+            value = reinterpret_cast<const byte *>(getVarChar(slot, i, varLength));
+            recordFormat.insert(recordFormat.end(), reinterpret_cast<const byte *>(&varLength), reinterpret_cast<const byte *>(&varLength) + sizeof(unsigned));
+            recordFormat.insert(recordFormat.end(), value, value + varLength);
+        }
+        else {
+            recordFormat.insert(recordFormat.end(), value, value + sizeof(unsigned));
+        }
+        length += schema.getType(i) == TypeVarChar ? sizeof(unsigned) + varLength : sizeof(unsigned);
+    }
+    memcpy(recordFormat.data() + fieldCount*sizeof(unsigned), &length, sizeof(unsigned));
+}
+
+unsigned PaxPage::heapFree() const {
+    return pageSize - PAX_TRAILER_FIELDS*sizeof(unsigned) - trailer(1) + trailer(4);
+}
+
+bool PaxPage::findSlot(unsigned varBytes, unsigned &slot) {
+    if(heapFree() < varBytes) {
+        return false;
+    }
+    const unsigned slotCount = getSlotCount();
+    const byte *free = static_cast<const byte *>(memchr(page, PAX_FREE_SLOT, slotCount));
+    if(free != NULL) {
+        slot = free - page;
+        return true;
+    }
+    if(slotCount < getCapacity()) {
+        slot = slotCount;
+        return true;
+    }
+    return false;
+}
+
+bool PaxPage::hasRoom(unsigned slot, unsigned varBytes) const {
+    unsigned own = 0;
+    if(holdsRecord(slot)) {
+        for(unsigned i = 0 ; i < schema.size() ; ++i) {
+            if(schema.getType(i) == TypeVarChar && !isNull(slot, i)) {
+                unsigned length;
+                getVarChar(slot, i, length);
+                own += length;
+            }
+        }
+    }
+    return heapFree() + own >= varBytes;
+}
+
+void PaxPage::release(unsigned slot) {
+    if(!holdsRecord(slot)) {
+        return;
+    }
+    unsigned garbage = trailer(4);
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        if(schema.getType(i) == TypeVarChar && !isNull(slot, i)) {
+            unsigned length;
+            getVarChar(slot, i, length);
+            garbage += length;
+        }
+    }
+    setTrailer(4, garbage);
+}
+
+//Moves the varchars of the records to the start of the heap, in the order they are stored
+void PaxPage::compact() {
+    std::vector<std::pair<unsigned, byte *> > entries; //(offset, entry) of every non-empty varchar
+    for(unsigned s = 0 ; s < getSlotCount() ; ++s) {
+        if(!holdsRecord(s)) {
+            continue;
+        }
+        for(unsigned i = 0 ; i < schema.size() ; ++i) {
+            if(schema.getType(i) == TypeVarChar && !isNull(s, i)) {
+                unsigned offset;
+                memcpy(&offset, entry(s, i), sizeof(unsigned));
+                entries.push_back(std::make_pair(offset, entry(s, i)));
+            }
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    unsigned end = heapStart();
+    for(unsigned e = 0 ; e < entries.size() ; ++e) {
+        unsigned length;
+        memcpy(&length, entries[e].second + sizeof(unsigned), sizeof(unsigned));
+        memmove(page + end, page + entries[e].first, length);
+        memcpy(entries[e].second, &end, sizeof(unsigned));
+        end += length;
+    }
+    setTrailer(1, end);
+    setTrailer(4, 0);
+}
+
+void PaxPage::put(unsigned slot, const void *data, PaxSlotState state) {
+    release(slot);
+    if(pageSize - PAX_TRAILER_FIELDS*sizeof(unsigned) - trailer(1) < varBytes(schema, data)) {
+        page[slot] = PAX_FREE_SLOT; //its varchars are garbage already
+        compact();
+    }
+    page[slot] = state;
+    if(slot >= getSlotCount()) {
+        setTrailer(2, slot+1);
+    }
+    const unsigned nullInfoFieldLength = schema.getNullIndicatorSize();
+    memcpy(page + nullOffset + slot*nullInfoFieldLength, data, nullInfoFieldLength);
+
+    const byte *cur = static_cast<const byte *>(data) + nullInfoFieldLength;
+    unsigned heapEnd = trailer(1);
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        byte *e = entry(slot, i);
+        if(Schema::isNull(data, i)) {
+            memset(e, 0, entrySize(i));
+        }
+        else if(schema.getType(i) != TypeVarChar) {
+            memcpy(e, cur, sizeof(unsigned));
+            cur += sizeof(unsigned);
+        }
+        else {
+            unsigned length;
+            memcpy(&length, cur, sizeof(unsigned));
+            memcpy(page + heapEnd, cur + sizeof(unsigned), length);
+            memcpy(e, &heapEnd, sizeof(unsigned));
+            memcpy(e + sizeof(unsigned), &length, sizeof(unsigned));
+            heapEnd += length;
+            cur += sizeof(unsigned) + length;
+        }
+    }
+    setTrailer(1, heapEnd);
+}
+
+void PaxPage::erase(unsigned slot) {
+    release(slot);
+    page[slot] = PAX_FREE_SLOT;
+}
+
+//The page number goes in the entry of the first field, the slot number after it: in the same entry for a varchar,
+//in the next field's one otherwise. A record that is a single int/real never grows, so it is never moved.
+RID PaxPage::forward(unsigned slot) const {
+    RID rid;
+    memcpy(&rid.pageNum, entry(slot, 0), sizeof(unsigned));
+    memcpy(&rid.slotNum, schema.getType(0) == TypeVarChar ? entry(slot, 0) + sizeof(unsigned) : entry(slot, 1), sizeof(unsigned));
+    return rid;
+}
+
+void PaxPage::setTombstone(unsigned slot, const RID &movedTo) {
+    release(slot);
+    page[slot] = PAX_TOMBSTONE;
+    memcpy(entry(slot, 0), &movedTo.pageNum, sizeof(unsigned));
+    memcpy(schema.getType(0) == TypeVarChar ? entry(slot, 0) + sizeof(unsigned) : entry(slot, 1), &movedTo.slotNum, sizeof(unsigned));
+}
+
+/**
+Free-space map entry of a PAX page: 0 when all its slots are taken, otherwise 1 plus its free heap bytes in
+FSM_CATEGORY_SIZE units (rounded down). A record fits when the entry is at least neededCategory().
+**/
+byte PaxPage::category() const {
+    if(getSlotCount() == getCapacity() && memchr(page, PAX_FREE_SLOT, getSlotCount()) == NULL) {
+        return 0;
+    }
+    return static_cast<byte>(1 + min<unsigned>(heapFree() / FSM_CATEGORY_SIZE(pageSize), 254));
+}
+
+unsigned PaxPage::neededCategory(unsigned varBytes, unsigned pageSize) {
+    return 1 + (varBytes + FSM_CATEGORY_SIZE(pageSize) - 1) / FSM_CATEGORY_SIZE(pageSize);
+}
+
+unsigned PaxPage::varBytes(const Schema &schema, const void *data) {
+    const byte *values = static_cast<const byte *>(data) + schema.getNullIndicatorSize();
+    unsigned offset = 0;
+    unsigned bytes = 0;
+    for(unsigned i = 0 ; i < schema.size() ; ++i) {
+        if(Schema::isNull(data, i)) {
+            continue;
+        }
+        if(schema.getType(i) == TypeVarChar) {
+            unsigned length;
+            memcpy(&length, values + offset, sizeof(unsigned));
+            bytes += length;
+            offset += sizeof(unsigned) + length;
+        }
+        else {
+            offset += schema[i].length;
+        }
+    }
+    return bytes;
+}
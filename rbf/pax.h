@@ -0,0 +1,95 @@
+#ifndef _pax_h_
+#define _pax_h_
+
+#include <vector>
+#include <cstring>
+
+#include "rbfm.h"
+
+typedef enum {
+    PAX_FREE_SLOT = 0,
+    PAX_RECORD,
+    PAX_TOMBSTONE,
+    PAX_MOVED           // a record whose home slot is a tombstone elsewhere, scans reach it from there only
+} PaxSlotState;
+
+/**
+A data page of a PAX (partition attributes across) file. The records of the page are split by attribute: every field
+has its own minipage holding that field for all the slots, so a scan only touches the fields it needs and an int/real
+field is a plain array. From the start of the page:
+    state minipage      a byte per slot, see PaxSlotState
+    null minipage       the null indicators of each slot, as in the format of insertRecord()
+    field minipages     per field and slot: int/real 4 bytes, varchar its (offset, length) in the heap
+    heap                the characters of the varchars, growing towards the end of the page
+The page ends with four unsigned values: (from the end) the end of the heap, the number of slots in use (like the
+slot count of the row layout, at the same place), the capacity of the page in slots, and the bytes of the heap that
+are no longer referenced; the heap is compacted when they are needed. The capacity is chosen when the page is
+formatted, from the size of the fixed part of a record and half of the declared length of its varchars.
+A tombstone keeps the RID of the record in the entries of its first field(s), see forward(); the slot it points at
+is marked PAX_MOVED.
+RIDs are (page, slot) as in the row layout, a slot never moves.
+**/
+class PaxPage {
+public:
+    PaxPage(byte *page, unsigned pageSize, const Schema &schema);
+
+    void reset(byte *page) { PaxPage::page = page; layout(getCapacity()); }  // Another page of the same file
+
+    // Empty page, with room for a first record holding "varBytes" bytes of varchar characters
+    void format(unsigned varBytes);
+
+    unsigned getSlotCount() const { return trailer(2); }
+    unsigned getCapacity() const { return trailer(3); }
+    PaxSlotState getState(unsigned slot) const { return static_cast<PaxSlotState>(page[slot]); }
+    bool holdsRecord(unsigned slot) const { return page[slot] == PAX_RECORD || page[slot] == PAX_MOVED; }
+    bool isNull(unsigned slot, unsigned field) const { return Schema::isNull(page + nullOffset + slot*schema.getNullIndicatorSize(), field); }
+
+    // Minipage of an int/real field, the values of all the slots one after the other
+    const byte *getFixed(unsigned field) const { return page + fieldOffsets[field]; }
+    const byte *getFixed(unsigned slot, unsigned field) const { return page + fieldOffsets[field] + slot*sizeof(unsigned); }
+    const char *getVarChar(unsigned slot, unsigned field, unsigned &length) const;
+
+    // The record of "slot" in the format of readRecord(), only the listed fields if given. Returns its length
+    unsigned project(unsigned slot, const std::vector<unsigned> &fields, void *data) const;
+    unsigned project(unsigned slot, void *data) const;
+    // The record of "slot" in the row layout (see RecordBasedFileManager::transformDataToRecordFormat())
+    void toRecordFormat(unsigned slot, std::vector<byte> &recordFormat) const;
+
+    // A slot for a new record with "varBytes" bytes of varchars, false if the page has no room for it
+    bool findSlot(unsigned varBytes, unsigned &slot);
+    // Whether the record of "slot" can be replaced by one with "varBytes" bytes of varchars
+    bool hasRoom(unsigned slot, unsigned varBytes) const;
+    // Stores "data" (format of insertRecord()) in "slot", which must have room for it. "state" is PAX_RECORD or
+    // PAX_MOVED
+    void put(unsigned slot, const void *data, PaxSlotState state = PAX_RECORD);
+    void erase(unsigned slot);
+
+    RID forward(unsigned slot) const;                                    // Where the record of a tombstone is
+    void setTombstone(unsigned slot, const RID &movedTo);
+
+    byte category() const;                                              // Free-space map entry, see below
+
+    // Bytes of varchar characters of a record
+    static unsigned varBytes(const Schema &schema, const void *data);
+    // How much of a PAX page a record of "varBytes" needs according to the free-space map, see category()
+    static unsigned neededCategory(unsigned varBytes, unsigned pageSize);
+
+private:
+    unsigned trailer(unsigned i) const { unsigned value; memcpy(&value, page + pageSize - i*sizeof(unsigned), sizeof(unsigned)); return value; }
+    void setTrailer(unsigned i, unsigned value) { memcpy(page + pageSize - i*sizeof(unsigned), &value, sizeof(unsigned)); }
+    byte *entry(unsigned slot, unsigned field) const { return page + fieldOffsets[field] + slot*entrySize(field); }
+    unsigned entrySize(unsigned field) const { return schema.getType(field) == TypeVarChar ? 2*sizeof(unsigned) : sizeof(unsigned); }
+    unsigned heapStart() const { return fieldOffsets.back(); }
+    unsigned heapFree() const;                                          // Garbage included
+    void release(unsigned slot);                                        // The varchars of the slot become garbage
+    void compact();
+    void layout(unsigned capacity);
+
+    byte *page;
+    unsigned pageSize;
+    const Schema &schema;
+    unsigned nullOffset;
+    std::vector<unsigned> fieldOffsets;                                 // minipage of each field, then the heap
+};
+
+#endif
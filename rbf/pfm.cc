@@ -1,5 +1,9 @@
 #include "pfm.h"
+#include "aio.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
 
 using namespace std;
 
@@ -10,7 +14,7 @@ PagedFileManager &PagedFileManager::instance() {
     return _pf_manager;
 }
 
-PagedFileManager::PagedFileManager() = default;
+PagedFileManager::PagedFileManager() : extentSize(EXTENT_SIZE) {}
 
 PagedFileManager::~PagedFileManager() { delete _pf_manager; }
 
@@ -18,76 +22,125 @@ PagedFileManager::PagedFileManager(const PagedFileManager &) = default;
 
 PagedFileManager &PagedFileManager::operator=(const PagedFileManager &) = default;
 
-RC PagedFileManager::createFile(const std::string &fileName) {
-    //File already exists!
-    if(access(fileName.c_str(),F_OK) == 0)
+//Clock, process and a counter: files created under the same name, one after the other or by another process, get
+//different ids. 0 is left to the files written before the ids were recorded
+static unsigned newCreationId() {
+    static std::atomic<unsigned> created(0);
+    const uint64_t now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    unsigned id = (unsigned) (now ^ now >> 32) ^ (unsigned) getpid() << 16 ^ ++created * 2654435761u;
+    return id == 0 ? 1 : id;
+}
+
+//The hidden page is as large as the other pages, so that data page n starts at (n+1)*pageSize
+RC PagedFileManager::createFile(const std::string &fileName, unsigned pageSize, unsigned pageFormat) {
+    if(!isValidPageSize(pageSize))
         return -1;
-    
-    FILE *fp = fopen(fileName.c_str(),"wb+");
+    //O_EXCL: file already exists!
+    int fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
     //File open error!
-    if(!fp)
+    if(fd < 0)
         return -1;
 
-    byte cnt[PAGE_SIZE];
-    memset(cnt,0,sizeof(cnt));
-    fseek(fp,0,SEEK_SET);
-    fwrite(cnt,1,PAGE_SIZE,fp);
-    //if fp is not closed,there could be undefined behaviors, e.g.  counter value undefined.
-    //This is because when two file descriptors exist concurrently, they read like the other never writes.(they read original data)
-    fclose(fp);
+    std::vector<byte> cnt(pageSize, 0);
+    reinterpret_cast<unsigned *>(cnt.data())[HEADER_PAGE_SIZE] = pageSize;
+    reinterpret_cast<unsigned *>(cnt.data())[HEADER_PAGE_FORMAT] = pageFormat;
+    reinterpret_cast<unsigned *>(cnt.data())[HEADER_CREATION_ID] = newCreationId();
+    ssize_t res = pwrite(fd, cnt.data(), pageSize, 0);
+    if(close(fd) != 0 || res != pageSize)
+        return -1;
+    //a new file may reuse the inode of a destroyed one, so stale frames must not survive
+    BufferPool::instance().invalidateFile(fileName);
     return 0;
 }
 
 RC PagedFileManager::destroyFile(const std::string &fileName) {
+    BufferPool::instance().invalidateFile(fileName);
     return remove(fileName.c_str());
 }
 
 RC PagedFileManager::openFile(const std::string &fileName, FileHandle &fileHandle) {
-    //File doesn't exist!
-    if(access(fileName.c_str(),F_OK)) {
+    //fileHandle is already a handle for some open file!
+    if(fileHandle.fd >= 0) {
         return -1;
     }
 
-    //fileHandle is already a handle for some open file!
-    if(fileHandle.fp) {
+    fileHandle.fd = open(fileName.c_str(), O_RDWR);
+    //File doesn't exist or open error!
+    if(fileHandle.fd < 0) {
         return -1;
     }
 
-    fileHandle.fp = fopen(fileName.c_str(),"rb+");
-    //File open error!
-    if(!fileHandle.fp) {
+    unsigned cnt[HEADER_FIELDS];
+    if(readHeader(fileHandle.fd, cnt) != 0
+       || BufferPool::instance().registerFile(fileName, cnt[HEADER_PAGE_SIZE], fileHandle.fileId) != 0) {
+        close(fileHandle.fd);
+        fileHandle.fd = -1;
         return -1;
     }
-    
-    unsigned cnt[5];
-    fseek(fileHandle.fp,0,SEEK_SET);
-    fread(cnt,sizeof(unsigned),5,fileHandle.fp);
     fileHandle.readPageCounter = cnt[0];
     fileHandle.writePageCounter =  cnt[1];
     fileHandle.appendPageCounter = cnt[2];
     fileHandle.noPages = cnt[3];
     fileHandle.lastTableID = cnt[4];
+    fileHandle.pageSize = cnt[HEADER_PAGE_SIZE];
+    fileHandle.pageFormat = cnt[HEADER_PAGE_FORMAT];
+    fileHandle.creationId = cnt[HEADER_CREATION_ID];
+    fileHandle.fileName = fileName;
+    fileHandle.zoneMap.reset();
+    fileHandle.columnFiles.reset();
     return 0;
 }
 
+bool PagedFileManager::isValidPageSize(unsigned pageSize) {
+    return pageSize >= PAGE_SIZE && pageSize <= MAX_PAGE_SIZE && (pageSize & (pageSize-1)) == 0;
+}
+
+//Files written before page sizes were recorded have a zero there, they use the default size
+RC PagedFileManager::readHeader(int fd, unsigned header[HEADER_FIELDS]) {
+    if(pread(fd, header, HEADER_FIELDS*sizeof(unsigned), 0) != HEADER_FIELDS*sizeof(unsigned)) {
+        return -1;
+    }
+    if(header[HEADER_PAGE_SIZE] == 0) {
+        header[HEADER_PAGE_SIZE] = PAGE_SIZE;
+    }
+    return isValidPageSize(header[HEADER_PAGE_SIZE]) ? 0 : -1;
+}
+
+RC PagedFileManager::setExtentSize(unsigned numberOfPages) {
+    if(numberOfPages == 0) {
+        return -1;
+    }
+    extentSize = numberOfPages;
+    return 0;
+}
+
+unsigned PagedFileManager::getExtentSize() const {
+    return extentSize;
+}
+
 RC PagedFileManager::closeFile(FileHandle &fileHandle) {
-    if(fileHandle.fp == NULL) {
+    if(fileHandle.fd < 0) {
         return -1;
     }
-    fseek(fileHandle.fp, 0, SEEK_SET);
     unsigned cnt[5];
     cnt[0] = fileHandle.readPageCounter;
     cnt[1] = fileHandle.writePageCounter;
     cnt[2] = fileHandle.appendPageCounter;
     cnt[3] = fileHandle.noPages;
     cnt[4] = fileHandle.lastTableID;
-    fwrite(cnt,sizeof(unsigned),5,fileHandle.fp);
+    fileHandle.zoneMap.reset();
+    fileHandle.columnFiles.reset();
+    RC rc = pwrite(fileHandle.fd, cnt, sizeof(cnt), 0) == sizeof(cnt) ? 0 : -1;
+    //Dirty frames are written back, the pool keeps caching the file's pages
+    if(BufferPool::instance().flushFile(fileHandle.fileId) != 0) {
+        rc = -1;
+    }
     //File close error!
-    if(fclose(fileHandle.fp) == EOF) {
-        return -1;
+    if(close(fileHandle.fd) != 0) {
+        rc = -1;
     }
-    fileHandle.fp = NULL;
-    return 0;
+    fileHandle.fd = -1;
+    return rc;
 }
 
 FileHandle::FileHandle() {
@@ -96,7 +149,14 @@ FileHandle::FileHandle() {
     appendPageCounter = 0;
     noPages = 0;
     lastTableID = 0;
-    fp = NULL;
+    pageSize = PAGE_SIZE;
+    pageFormat = 0;
+    creationId = 0;
+    bufferHitCounter = 0;
+    bufferMissCounter = 0;
+    fd = -1;
+    fileId = 0;
+    mappedReads = false;
 }
 
 FileHandle::~FileHandle() = default;
@@ -107,14 +167,17 @@ RC FileHandle::readPage(PageNum pageNum, void *data) {
         readPageCounter++;
         return -1;
     }
-    
-    fseek( fp, (pageNum+1)*PAGE_SIZE, SEEK_SET );
-    unsigned res = fread(data,sizeof(char),PAGE_SIZE,fp);
-    //File read error!
-    if(res != PAGE_SIZE && feof(fp) != EOF)
+
+    byte *frame;
+    bool hit, waited;
+    if(BufferPool::instance().pinPage(fileId, pageNum, true, frame, hit, &waited) != 0)
         return -1;
-    
+    memcpy(data, frame, pageSize);
+    BufferPool::instance().unpinPage(fileId, pageNum, false);
+
+    hit ? bufferHitCounter++ : bufferMissCounter++;
     readPageCounter++;
+    readAhead.pageRead(fileId, pageNum, noPages, hit, waited);
     return 0;
 }
 
@@ -125,29 +188,132 @@ RC FileHandle::writePage(PageNum pageNum, const void *data) {
         writePageCounter++;
         return -1;
     }
-    
-    fseek( fp, (pageNum+1)*PAGE_SIZE, SEEK_SET );
-    unsigned res = fwrite(data,sizeof(char),PAGE_SIZE,fp);
-    //File write error!
-    if(res != PAGE_SIZE)
+
+    //The whole page is overwritten, so there is no need to read it first
+    byte *frame;
+    bool hit;
+    if(BufferPool::instance().pinPage(fileId, pageNum, false, frame, hit) != 0)
         return -1;
-    
+    memcpy(frame, data, pageSize);
+    BufferPool::instance().unpinPage(fileId, pageNum, true);
+
     writePageCounter++;
     return 0;
 }
 
 RC FileHandle::appendPage(const void *data) {
-    fseek( fp, 0, SEEK_END );
-    unsigned res = fwrite(data,sizeof(char),PAGE_SIZE,fp);
-    //File append error!
-    if(res != PAGE_SIZE)
+    if(BufferPool::instance().reservePage(fileId, noPages, PagedFileManager::instance().getExtentSize()) != 0)
         return -1;
-    
+    byte *frame;
+    bool hit;
+    if(BufferPool::instance().pinPage(fileId, noPages, false, frame, hit) != 0)
+        return -1;
+    memcpy(frame, data, pageSize);
+    BufferPool::instance().unpinPage(fileId, noPages, true);
+
     noPages++;
     appendPageCounter++;
     return 0;
 }
 
+RC FileHandle::readPages(PageNum firstPage, unsigned count, void *data) {
+    std::vector<void *> pages(count);
+    for(unsigned i = 0 ; i < count ; ++i) {
+        pages[i] = static_cast<byte *>(data) + i*pageSize;
+    }
+    return readPages(firstPage, count, pages.data());
+}
+
+RC FileHandle::readPages(PageNum firstPage, unsigned count, void *const pages[]) {
+    //Intend to read non-existing pages!
+    if(firstPage > noPages || count > noPages-firstPage){
+        readPageCounter += count;
+        return -1;
+    }
+
+    unsigned hits;
+    if(BufferPool::instance().readPages(fileId, firstPage, count, reinterpret_cast<byte *const *>(pages), hits) != 0)
+        return -1;
+
+    bufferHitCounter += hits;
+    bufferMissCounter += count-hits;
+    readPageCounter += count;
+    return 0;
+}
+
+RC FileHandle::writePages(PageNum firstPage, unsigned count, const void *data) {
+    std::vector<const void *> pages(count);
+    for(unsigned i = 0 ; i < count ; ++i) {
+        pages[i] = static_cast<const byte *>(data) + i*pageSize;
+    }
+    return writePages(firstPage, count, pages.data());
+}
+
+RC FileHandle::writePages(PageNum firstPage, unsigned count, const void *const pages[]) {
+    //Intend to update non-existing pages!
+    if(firstPage > noPages || count > noPages-firstPage){
+        writePageCounter += count;
+        return -1;
+    }
+
+    if(BufferPool::instance().writePages(fileId, firstPage, count, reinterpret_cast<const byte *const *>(pages)) != 0)
+        return -1;
+
+    writePageCounter += count;
+    return 0;
+}
+
+RC FileHandle::pinPage(PageNum pageNum, byte *&data) {
+    if(pageNum >= noPages){
+        readPageCounter++;
+        return -1;
+    }
+
+    bool hit, waited;
+    if(BufferPool::instance().pinPage(fileId, pageNum, true, data, hit, &waited) != 0)
+        return -1;
+
+    hit ? bufferHitCounter++ : bufferMissCounter++;
+    readPageCounter++;
+    readAhead.pageRead(fileId, pageNum, noPages, hit, waited);
+    return 0;
+}
+
+RC FileHandle::unpinPage(PageNum pageNum, bool dirty) {
+    RC rc = BufferPool::instance().unpinPage(fileId, pageNum, dirty);
+    if(rc == 0 && dirty) {
+        writePageCounter++;
+    }
+    return rc;
+}
+
+RC FileHandle::setMappedReads(bool enabled, bool sequential) {
+    if(fd < 0) {
+        return -1;
+    }
+    mappedReads = enabled;
+    return enabled ? BufferPool::instance().adviseSequential(fileId, sequential) : 0;
+}
+
+RC FileHandle::mapPage(PageNum pageNum, const byte *&data) {
+    if(pageNum >= noPages){
+        readPageCounter++;
+        return -1;
+    }
+    if(BufferPool::instance().mapPage(fileId, pageNum, data) != 0)
+        return -1;
+    readPageCounter++;
+    return 0;
+}
+
+RC FileHandle::accessPage(PageNum pageNum, const byte *&data, byte *buffer) {
+    if(mappedReads) {
+        return mapPage(pageNum, data);
+    }
+    data = buffer;
+    return readPage(pageNum, buffer);
+}
+
 unsigned FileHandle::getNumberOfPages() {
     return noPages;
 }
@@ -159,6 +325,29 @@ RC FileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePage
     return 0;
 }
 
+RC FileHandle::collectBufferCounterValues(unsigned &hitCount, unsigned &missCount) {
+    hitCount = bufferHitCounter;
+    missCount = bufferMissCounter;
+    return 0;
+}
+
+RC FileHandle::flush() {
+    if(fd < 0) {
+        return -1;
+    }
+    unsigned cnt[5];
+    cnt[0] = readPageCounter;
+    cnt[1] = writePageCounter;
+    cnt[2] = appendPageCounter;
+    cnt[3] = noPages;
+    cnt[4] = lastTableID;
+    if(pwrite(fd, cnt, sizeof(cnt), 0) != sizeof(cnt)) {
+        return -1;
+    }
+    //the pool's descriptor is on the same file, so its fdatasync() covers the hidden page too
+    return BufferPool::instance().flushFile(fileId, true);
+}
+
 unsigned int FileHandle::getLastTableId() const {
     return lastTableID;
 }
@@ -166,3 +355,1064 @@ unsigned int FileHandle::getLastTableId() const {
 void FileHandle::setLastTableId(unsigned int lastTableId) {
     lastTableID = lastTableId;
 }
+
+ReadAhead::ReadAhead() {
+    lastPage = UINT_MAX; //page 0 then counts as the next page
+    run = 0;
+    window = READ_AHEAD_MIN_PAGES;
+    prefetchedEnd = 0;
+    sequential = false;
+}
+
+void ReadAhead::pageRead(unsigned fileId, PageNum pageNum, unsigned numberOfPages, bool hit, bool waited) {
+    //The record layer reads the same page several times in a row
+    if(pageNum == lastPage) {
+        return;
+    }
+    if(pageNum == lastPage+1) {
+        ++run;
+        if(pageNum < prefetchedEnd) {
+            if(waited) {
+                window = std::min(2*window, static_cast<unsigned>(READ_AHEAD_MAX_PAGES)); //the reader caught up with the reads
+            }
+            else if(!hit) {
+                window = std::max(window/2, static_cast<unsigned>(READ_AHEAD_MIN_PAGES)); //evicted before it was read
+            }
+        }
+    }
+    else {
+        run = 0;
+        prefetchedEnd = pageNum+1;
+    }
+    lastPage = pageNum;
+    if(!sequential && run < READ_AHEAD_TRIGGER) {
+        return;
+    }
+
+    //Top the window up once half of it was consumed, so that the requests go out in batches
+    if(prefetchedEnd > pageNum+1+window/2) {
+        return;
+    }
+    PageNum first = std::max(prefetchedEnd, pageNum+1);
+    PageNum end = std::min(pageNum+1+window, numberOfPages);
+    if(first < end) {
+        BufferPool::instance().prefetchPages(fileId, first, end-first);
+        prefetchedEnd = end;
+    }
+}
+
+
+BufferPool &BufferPool::instance() {
+    static BufferPool _buffer_pool;
+    return _buffer_pool;
+}
+
+BufferPool::BufferPool() {
+    policy = CLOCK_REPLACEMENT;
+    ioQueue = new AsyncIOQueue();
+    prefetchQueue = new AsyncIOQueue();
+    prefetchRequests = NULL;
+    loadingFrames = 0;
+    busyFrames = 0;
+    pagesWritten = 0;
+    allocateFrames(BUFFER_POOL_FRAMES);
+    writerDelay = BG_WRITER_DELAY;
+    writerStopping = false;
+    writerThread = std::thread(&BufferPool::backgroundWriter, this);
+}
+
+//Dirty frames of files that were never closed are written back at exit
+BufferPool::~BufferPool() {
+    {
+        std::unique_lock<std::mutex> guard(latch);
+        writerStopping = true;
+        waitForIdleFrames(guard);
+    }
+    writerWakeup.notify_all();
+    writerThread.join();
+    flushAll();
+    for(unsigned i = 0 ; i < files.size() ; ++i) {
+        unmapFile(i);
+        if(files[i].fd >= 0) {
+            close(files[i].fd);
+            files[i].fd = -1;
+        }
+    }
+    delete ioQueue;
+    delete prefetchQueue;
+    delete[] prefetchRequests;
+}
+
+void BufferPool::allocateFrames(unsigned numberOfFrames) {
+    frames.assign(numberOfFrames, Frame());
+    frameData.assign(numberOfFrames, std::vector<byte>(PAGE_SIZE, 0));
+    delete[] prefetchRequests;
+    prefetchRequests = new PageIORequest[numberOfFrames];
+    freeFrames.clear();
+    for(unsigned i = numberOfFrames ; i > 0 ; --i) {
+        frames[i-1].valid = false;
+        frames[i-1].dirty = false;
+        frames[i-1].referenced = false;
+        frames[i-1].pinCount = 0;
+        frames[i-1].loading = false;
+        frames[i-1].prefetched = false;
+        frames[i-1].writing = false;
+        freeFrames.push_back(i-1);
+    }
+    //twice as many buckets as frames (rounded up to a power of two) keeps the chains short
+    unsigned numberOfBuckets = 1;
+    while(numberOfBuckets < 2*numberOfFrames) {
+        numberOfBuckets <<= 1;
+    }
+    buckets.assign(numberOfBuckets, -1);
+    lruHead = lruTail = -1;
+    clockHand = 0;
+}
+
+RC BufferPool::setCapacity(unsigned numberOfFrames) {
+    if(numberOfFrames == 0) {
+        return -1;
+    }
+    std::unique_lock<std::mutex> guard(latch);
+    waitForIdleFrames(guard);
+    for(unsigned i = 0 ; i < frames.size() ; ++i) {
+        if(frames[i].valid && frames[i].pinCount > 0) {
+            return -1;
+        }
+    }
+    for(unsigned i = 0 ; i < frames.size() ; ++i) {
+        if(frames[i].valid && frames[i].dirty && writeFrame(i) != 0) {
+            return -1;
+        }
+    }
+    allocateFrames(numberOfFrames);
+    return 0;
+}
+
+unsigned BufferPool::getCapacity() {
+    std::lock_guard<std::mutex> guard(latch);
+    return frames.size();
+}
+
+void BufferPool::setReplacementPolicy(ReplacementPolicy policy) {
+    std::lock_guard<std::mutex> guard(latch);
+    this->policy = policy;
+}
+
+ReplacementPolicy BufferPool::getReplacementPolicy() {
+    std::lock_guard<std::mutex> guard(latch);
+    return policy;
+}
+
+RC BufferPool::registerFile(const std::string &fileName, unsigned pageSize, unsigned &fileId) {
+    struct stat fileInfo;
+    if(stat(fileName.c_str(), &fileInfo) != 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> guard(latch);
+    for(unsigned i = 0 ; i < files.size() ; ++i) {
+        if(files[i].fd >= 0 && files[i].device == fileInfo.st_dev && files[i].inode == fileInfo.st_ino) {
+            fileId = i;
+            return 0;
+        }
+    }
+
+    //Slots of destroyed files are reused
+    unsigned i = 0;
+    while(i < files.size() && files[i].fd >= 0) {
+        ++i;
+    }
+    if(i == files.size()) {
+        files.push_back(PoolFile());
+    }
+    files[i].device = fileInfo.st_dev;
+    files[i].inode = fileInfo.st_ino;
+    files[i].mapping = NULL;
+    files[i].mappedLength = 0;
+    files[i].mappedFileLength = 0;
+    files[i].retiredMappings.clear();
+    files[i].sequential = false;
+    files[i].pageSize = pageSize;
+    files[i].fd = open(fileName.c_str(), O_RDWR);
+    if(files[i].fd < 0) {
+        return -1;
+    }
+    files[i].allocatedPages = fileInfo.st_size > pageSize ? (fileInfo.st_size-pageSize) / pageSize : 0;
+    fileId = i;
+    return 0;
+}
+
+void BufferPool::invalidateFile(const std::string &fileName) {
+    struct stat fileInfo;
+    if(stat(fileName.c_str(), &fileInfo) != 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard(latch);
+    //nobody must write into frames that are about to be reused, nor use the descriptor about to be closed
+    waitForIdleFrames(guard);
+    for(unsigned fileId = 0 ; fileId < files.size() ; ++fileId) {
+        if(files[fileId].fd >= 0 && files[fileId].device == fileInfo.st_dev && files[fileId].inode == fileInfo.st_ino) {
+            for(unsigned i = 0 ; i < frames.size() ; ++i) {
+                if(frames[i].valid && frames[i].fileId == fileId) {
+                    dropFrame(i);
+                }
+            }
+            unmapFile(fileId);
+            close(files[fileId].fd);
+            files[fileId].fd = -1;
+        }
+    }
+}
+
+RC BufferPool::pinPage(unsigned fileId, PageNum pageNum, bool readFromDisk, byte *&frame, bool &hit, bool *waited) {
+    std::unique_lock<std::mutex> guard(latch);
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+    if(waited != NULL) {
+        *waited = false;
+    }
+    if(loadingFrames > 0) {
+        reapPrefetches(0);
+    }
+
+    int found = lookupFrame(fileId, pageNum);
+    if(found != -1 && frames[found].loading) {
+        if(waited != NULL) {
+            *waited = true;
+        }
+        found = waitForPage(guard, fileId, pageNum); //a failed read dropped the frame, the page is read again below
+    }
+    unsigned frameNo;
+    hit = found != -1;
+    if(hit) {
+        frameNo = found;
+        lruUnlink(frameNo);
+    }
+    else {
+        if(findVictim(frameNo) != 0) {
+            return -1; //every frame is pinned
+        }
+        assignFrame(frameNo, fileId, pageNum);
+        frames[frameNo].valid = true;
+        hashInsert(frameNo);
+    }
+
+    lruPushFront(frameNo);
+    frames[frameNo].referenced = true;
+    frames[frameNo].pinCount++;
+    frame = frameBuffer(frameNo);
+    if(hit || !readFromDisk) {
+        return 0;
+    }
+
+    //The other pinners of the page wait for the frame, the rest of the pool goes on during the read
+    const int fd = files[fileId].fd;
+    const unsigned pageSize = files[fileId].pageSize;
+    frames[frameNo].loading = true;
+    ++busyFrames;
+    guard.unlock();
+    RC rc = readFrame(fd, pageSize, pageNum, frame);
+    guard.lock();
+    frames[frameNo].loading = false;
+    --busyFrames;
+    if(rc != 0) {
+        dropFrame(frameNo);
+    }
+    frameDone.notify_all();
+    return rc;
+}
+
+RC BufferPool::unpinPage(unsigned fileId, PageNum pageNum, bool dirty) {
+    std::lock_guard<std::mutex> guard(latch);
+    int frameNo = lookupFrame(fileId, pageNum);
+    if(frameNo == -1 || frames[frameNo].pinCount == 0) {
+        return -1;
+    }
+    frames[frameNo].pinCount--;
+    if(dirty) {
+        frames[frameNo].dirty = true;
+    }
+    return 0;
+}
+
+RC BufferPool::mapPage(unsigned fileId, PageNum pageNum, const byte *&data) {
+    std::unique_lock<std::mutex> guard(latch);
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+
+    //The page on disk must be current, and an appended page must exist in the file before it's mapped
+    int frameNo = lookupFrame(fileId, pageNum);
+    while(frameNo != -1 && frames[frameNo].writing) {
+        frameDone.wait(guard);
+        frameNo = lookupFrame(fileId, pageNum);
+    }
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+    if(frameNo != -1 && frames[frameNo].dirty && writeFrame(frameNo) != 0) {
+        return -1;
+    }
+
+    size_t end = static_cast<size_t>(pageNum+2)*files[fileId].pageSize;
+    if(end > files[fileId].mappedFileLength && remapFile(fileId, end) != 0) {
+        return -1;
+    }
+    data = files[fileId].mapping + end - files[fileId].pageSize;
+    return 0;
+}
+
+RC BufferPool::adviseSequential(unsigned fileId, bool sequential) {
+    std::lock_guard<std::mutex> guard(latch);
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+    files[fileId].sequential = sequential;
+    if(files[fileId].mapping != NULL) {
+        madvise(files[fileId].mapping, files[fileId].mappedLength, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+    }
+    return 0;
+}
+
+RC BufferPool::reservePage(unsigned fileId, PageNum pageNum, unsigned extentSize) {
+    std::lock_guard<std::mutex> guard(latch);
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+    PoolFile &file = files[fileId];
+    if(pageNum < file.allocatedPages) {
+        return 0;
+    }
+    //The extent is counted in pages of PAGE_SIZE bytes, and a file grows by at most its size so that small files stay
+    //small. Whole extents go past the current end (and past the page, should it skip some)
+    unsigned extentPages = std::max(static_cast<unsigned>(static_cast<size_t>(extentSize)*PAGE_SIZE/file.pageSize), 1u);
+    extentPages = std::min(extentPages, std::max(file.allocatedPages, 1u));
+    unsigned newAllocatedPages = file.allocatedPages + extentPages;
+    if(newAllocatedPages <= pageNum) {
+        newAllocatedPages = pageNum + extentPages;
+    }
+    off_t offset = static_cast<off_t>(file.allocatedPages+1)*file.pageSize;
+    off_t length = static_cast<off_t>(newAllocatedPages-file.allocatedPages)*file.pageSize;
+#ifdef __linux__
+    //The size of the file only grows as pages are written back: the blocks past it read as zeros, and are never mapped
+    int res = fallocate(file.fd, FALLOC_FL_KEEP_SIZE, offset, length);
+#else
+    int res = posix_fallocate(file.fd, offset, length);
+#endif
+    //Not supported by the file system: the page is allocated when it's written back, one at a time
+    if(res != 0) {
+        newAllocatedPages = pageNum+1;
+    }
+    file.allocatedPages = newAllocatedPages;
+    return 0;
+}
+
+RC BufferPool::prefetchPages(unsigned fileId, PageNum firstPage, unsigned count) {
+    std::lock_guard<std::mutex> guard(latch);
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+    std::vector<PageIORequest *> batch;
+    for(PageNum pageNum = firstPage ; pageNum < firstPage+count ; ++pageNum) {
+        if(lookupFrame(fileId, pageNum) == -1 && startPrefetch(fileId, pageNum, 0, 0, batch) != 0) {
+            break;
+        }
+    }
+    return submitPrefetches(batch);
+}
+
+RC BufferPool::prefetchChain(unsigned fileId, PageNum pageNum, unsigned linkOffset, unsigned hops, unsigned &cachedAhead) {
+    std::lock_guard<std::mutex> guard(latch);
+    cachedAhead = 0;
+    if(fileId >= files.size() || files[fileId].fd < 0 || linkOffset > files[fileId].pageSize-sizeof(int)) {
+        return -1;
+    }
+    std::vector<PageIORequest *> batch;
+    PageNum firstPage = pageNum;
+    for( ; ; ) {
+        int frameNo = lookupFrame(fileId, pageNum);
+        if(frameNo == -1) {
+            startPrefetch(fileId, pageNum, linkOffset, hops, batch);
+            break;
+        }
+        if(frames[frameNo].loading && !frames[frameNo].prefetched) {
+            break; //read by a pinner, which will follow the chain itself
+        }
+        if(frames[frameNo].loading) {
+            //its completion goes on with the chain
+            frames[frameNo].chainOffset = linkOffset;
+            frames[frameNo].chainHops = std::max(frames[frameNo].chainHops, hops);
+            break;
+        }
+        if(pageNum != firstPage) {
+            ++cachedAhead;
+        }
+        int next;
+        memcpy(&next, frameBuffer(frameNo)+linkOffset, sizeof(int));
+        if(hops == 0 || next < 0) {
+            break;
+        }
+        pageNum = next;
+        --hops;
+    }
+    return submitPrefetches(batch);
+}
+
+RC BufferPool::readPages(unsigned fileId, PageNum firstPage, unsigned count, byte *const pages[], unsigned &hits) {
+    std::unique_lock<std::mutex> guard(latch);
+    hits = 0;
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+    if(loadingFrames > 0) {
+        reapPrefetches(0);
+    }
+
+    //The pages in the pool are copied under the latch, the runs of the others are read without it. A page still being
+    //read into its frame is read from the file as well, the frame will get the same bytes
+    const int fd = files[fileId].fd;
+    const unsigned pageSize = files[fileId].pageSize;
+    std::vector<std::vector<struct iovec> > runs;
+    std::vector<PageNum> runStarts;
+    bool inRun = false;
+    for(PageNum pageNum = firstPage ; pageNum < firstPage+count ; ++pageNum) {
+        int frameNo = lookupFrame(fileId, pageNum);
+        if(frameNo != -1 && !frames[frameNo].loading) {
+            memcpy(pages[pageNum-firstPage], frameBuffer(frameNo), pageSize);
+            frames[frameNo].referenced = true;
+            ++hits;
+            inRun = false;
+            continue;
+        }
+        if(!inRun) {
+            runs.push_back(std::vector<struct iovec>());
+            runStarts.push_back(pageNum);
+            inRun = true;
+        }
+        struct iovec page = {pages[pageNum-firstPage], pageSize};
+        runs.back().push_back(page);
+    }
+    if(runs.empty()) {
+        return 0;
+    }
+
+    ++busyFrames; //the descriptor stays open until the runs are read
+    guard.unlock();
+    RC rc = 0;
+    for(unsigned i = 0 ; i < runs.size() && rc == 0 ; ++i) {
+        rc = transferRun(fd, pageSize, runStarts[i], runs[i], false);
+    }
+    guard.lock();
+    --busyFrames;
+    frameDone.notify_all();
+    return rc;
+}
+
+RC BufferPool::writePages(unsigned fileId, PageNum firstPage, unsigned count, const byte *const pages[]) {
+    std::unique_lock<std::mutex> guard(latch);
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+
+    const unsigned pageSize = files[fileId].pageSize;
+    std::vector<struct iovec> run;
+    PageNum runStart = firstPage;
+    for(PageNum pageNum = firstPage ; pageNum < firstPage+count ; ++pageNum) {
+        int frameNo = lookupFrame(fileId, pageNum);
+        //The read would overwrite the new page with the old one. The pages before are written first: once the latch
+        //is released, they may be read into frames
+        if(frameNo != -1 && frames[frameNo].loading) {
+            if(writeRun(fileId, runStart, run) != 0) {
+                return -1;
+            }
+            frameNo = waitForPage(guard, fileId, pageNum);
+        }
+        if(frameNo != -1) {
+            if(writeRun(fileId, runStart, run) != 0) {
+                return -1;
+            }
+            memcpy(frameBuffer(frameNo), pages[pageNum-firstPage], pageSize);
+            frames[frameNo].dirty = true;
+            frames[frameNo].referenced = true;
+            continue;
+        }
+        if(run.empty()) {
+            runStart = pageNum;
+        }
+        struct iovec page = {const_cast<byte *>(pages[pageNum-firstPage]), pageSize};
+        run.push_back(page);
+    }
+    return writeRun(fileId, runStart, run);
+}
+
+RC BufferPool::flushFile(unsigned fileId, bool sync) {
+    std::unique_lock<std::mutex> guard(latch);
+    if(flushFileFrames(guard, fileId) != 0) {
+        return -1;
+    }
+    return sync ? syncFiles(guard, std::vector<unsigned>(1, fileId)) : 0;
+}
+
+RC BufferPool::flushAll() {
+    std::unique_lock<std::mutex> guard(latch);
+    RC rc = 0;
+    for(unsigned i = 0 ; i < files.size() ; ++i) {
+        if(files[i].fd >= 0 && flushFileFrames(guard, i) != 0) {
+            rc = -1;
+        }
+    }
+    return rc;
+}
+
+RC BufferPool::checkpoint() {
+    std::unique_lock<std::mutex> guard(latch);
+    RC rc = 0;
+    std::vector<unsigned> fileIds;
+    for(unsigned i = 0 ; i < files.size() ; ++i) {
+        if(files[i].fd >= 0) {
+            if(flushFileFrames(guard, i) != 0) {
+                rc = -1;
+            }
+            fileIds.push_back(i);
+        }
+    }
+    return syncFiles(guard, fileIds) != 0 ? -1 : rc;
+}
+
+void BufferPool::setBackgroundWriterDelay(unsigned milliseconds) {
+    {
+        std::lock_guard<std::mutex> guard(latch);
+        writerDelay = milliseconds;
+    }
+    writerWakeup.notify_all();
+}
+
+unsigned BufferPool::getPagesWritten() {
+    std::lock_guard<std::mutex> guard(latch);
+    return pagesWritten;
+}
+
+//The frames of the file being written back by another thread are waited for: they must be on disk when the flush
+//returns. Caller must hold the latch through "guard"
+RC BufferPool::flushFileFrames(std::unique_lock<std::mutex> &guard, unsigned fileId) {
+    for(unsigned i = 0 ; i < frames.size() ; ++i) {
+        while(frames[i].valid && frames[i].writing && frames[i].fileId == fileId) {
+            frameDone.wait(guard);
+        }
+    }
+    if(fileId >= files.size() || files[fileId].fd < 0) {
+        return -1;
+    }
+    std::vector<unsigned> dirtyFrames;
+    for(unsigned i = 0 ; i < frames.size() ; ++i) {
+        if(frames[i].valid && frames[i].dirty && frames[i].fileId == fileId) {
+            dirtyFrames.push_back(i);
+        }
+    }
+    return writeFrames(guard, dirtyFrames);
+}
+
+/**
+Writes back dirty frames in one batch, sorted by file and page so that the queue can merge neighbours. The latch is
+released during the writes: the pages are copied, so that they can go on changing, and their frames are pinned and
+marked writing, so that they can't be evicted before they are on disk. A frame whose write failed is dirty again.
+Caller must hold the latch through "guard".
+**/
+RC BufferPool::writeFrames(std::unique_lock<std::mutex> &guard, const std::vector<unsigned> &frameNos) {
+    std::vector<std::pair<std::pair<unsigned, PageNum>, unsigned> > sorted;
+    size_t length = 0;
+    for(unsigned i = 0 ; i < frameNos.size() ; ++i) {
+        const Frame &frame = frames[frameNos[i]];
+        if(frame.dirty && !frame.writing) {
+            sorted.push_back(std::make_pair(std::make_pair(frame.fileId, frame.pageNum), frameNos[i]));
+            length += files[frame.fileId].pageSize;
+        }
+    }
+    if(sorted.empty()) {
+        return 0;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    std::vector<byte> copies(length);
+    std::vector<PageIORequest> requests(sorted.size());
+    std::vector<PageIORequest *> batch(sorted.size());
+    size_t offset = 0;
+    for(unsigned i = 0 ; i < sorted.size() ; ++i) {
+        Frame &frame = frames[sorted[i].second];
+        requests[i].fd = files[frame.fileId].fd;
+        requests[i].pageNum = frame.pageNum;
+        requests[i].type = PAGE_WRITE;
+        requests[i].pageSize = files[frame.fileId].pageSize;
+        requests[i].buffer = &copies[offset];
+        requests[i].result = -1;
+        batch[i] = &requests[i];
+        memcpy(requests[i].buffer, frameBuffer(sorted[i].second), requests[i].pageSize);
+        offset += requests[i].pageSize;
+        frame.pinCount++;
+        frame.writing = true;
+        frame.dirty = false;
+    }
+
+    ++busyFrames;
+    guard.unlock();
+    if(batch.size() == 1) {
+        off_t position = static_cast<off_t>(requests[0].pageNum+1)*requests[0].pageSize;
+        requests[0].result = pwrite(requests[0].fd, requests[0].buffer, requests[0].pageSize, position) == requests[0].pageSize ? 0 : -1;
+    }
+    else {
+        //The queue may be shared with another writer: each one looks at the results of its own requests only
+        ioQueue->submit(batch);
+        ioQueue->drain();
+    }
+    guard.lock();
+    --busyFrames;
+
+    RC rc = 0;
+    for(unsigned i = 0 ; i < sorted.size() ; ++i) {
+        Frame &frame = frames[sorted[i].second];
+        frame.pinCount--;
+        frame.writing = false;
+        if(requests[i].result == 0) {
+            ++pagesWritten;
+        }
+        else {
+            frame.dirty = true;
+            rc = -1;
+        }
+    }
+    frameDone.notify_all();
+    return rc;
+}
+
+//fdatasync() the files without holding the latch. Caller must hold the latch through "guard"
+RC BufferPool::syncFiles(std::unique_lock<std::mutex> &guard, const std::vector<unsigned> &fileIds) {
+    std::vector<int> fds;
+    for(unsigned i = 0 ; i < fileIds.size() ; ++i) {
+        if(fileIds[i] >= files.size() || files[fileIds[i]].fd < 0) {
+            return -1;
+        }
+        fds.push_back(files[fileIds[i]].fd);
+    }
+    ++busyFrames; //the descriptors stay open until they are synced
+    guard.unlock();
+    RC rc = 0;
+    for(unsigned i = 0 ; i < fds.size() ; ++i) {
+        if(fdatasync(fds[i]) != 0) {
+            rc = -1;
+        }
+    }
+    guard.lock();
+    --busyFrames;
+    frameDone.notify_all();
+    return rc;
+}
+
+void BufferPool::backgroundWriter() {
+    std::unique_lock<std::mutex> guard(latch);
+    while(!writerStopping) {
+        if(writerDelay == 0) {
+            writerWakeup.wait(guard);
+        }
+        else {
+            writerWakeup.wait_for(guard, std::chrono::milliseconds(writerDelay));
+        }
+        if(!writerStopping && writerDelay > 0) {
+            writeColdFrames(guard);
+        }
+    }
+}
+
+/**
+One round of the background writer: the dirty unpinned frames among the next quarter of the pool that the
+replacement policy will consider (from the CLOCK hand, or from the tail of the LRU list) are written back in one
+batch. Caller must hold the latch through "guard".
+**/
+void BufferPool::writeColdFrames(std::unique_lock<std::mutex> &guard) {
+    std::vector<unsigned> dirtyFrames;
+    unsigned lookahead = std::max(static_cast<unsigned>(frames.size()/4), 1u);
+    if(policy == LRU_REPLACEMENT) {
+        for(int i = lruTail ; i != -1 && lookahead > 0 && dirtyFrames.size() < BG_WRITER_MAX_PAGES ; i = frames[i].lruPrev, --lookahead) {
+            if(frames[i].dirty && frames[i].pinCount == 0) {
+                dirtyFrames.push_back(i);
+            }
+        }
+    }
+    else {
+        for(unsigned step = 0 ; step < lookahead && dirtyFrames.size() < BG_WRITER_MAX_PAGES ; ++step) {
+            unsigned i = (clockHand+step) % frames.size();
+            if(frames[i].valid && frames[i].dirty && frames[i].pinCount == 0) {
+                dirtyFrames.push_back(i);
+            }
+        }
+    }
+    writeFrames(guard, dirtyFrames);
+}
+
+/**
+Takes a frame for an asynchronous read of the page and adds the request to "batch". The frame is in the page table
+right away, pinned by the pool until the read completes. At most a quarter of the pool is being prefetched
+at any time, so that read-ahead never evicts the whole working set. Caller must hold the latch.
+**/
+RC BufferPool::startPrefetch(unsigned fileId, PageNum pageNum, unsigned linkOffset, unsigned hops,
+                             std::vector<PageIORequest *> &batch) {
+    unsigned frameNo;
+    //pages that were never written back aren't on disk
+    if(4*(loadingFrames+batch.size()) >= frames.size() || pageNum >= files[fileId].allocatedPages
+       || findVictim(frameNo) != 0) {
+        return -1;
+    }
+    assignFrame(frameNo, fileId, pageNum);
+    Frame &frame = frames[frameNo];
+    frame.valid = true;
+    frame.referenced = true; //give the page a chance to be read before the hand comes back
+    frame.pinCount = 1;
+    frame.loading = true;
+    frame.prefetched = true;
+    frame.chainOffset = linkOffset;
+    frame.chainHops = hops;
+    hashInsert(frameNo);
+    lruPushFront(frameNo);
+
+    PageIORequest &request = prefetchRequests[frameNo];
+    request.fd = files[fileId].fd;
+    request.pageNum = pageNum;
+    request.type = PAGE_READ;
+    request.pageSize = files[fileId].pageSize;
+    request.buffer = frameBuffer(frameNo);
+    request.userData = reinterpret_cast<void *>(static_cast<size_t>(frameNo));
+    request.result = 0;
+    batch.push_back(&request);
+    return 0;
+}
+
+//Caller must hold the latch
+RC BufferPool::submitPrefetches(const std::vector<PageIORequest *> &batch) {
+    loadingFrames += batch.size();
+    if(prefetchQueue->submit(batch) == 0) {
+        return 0;
+    }
+    //Part of the batch may be in flight anyway: wait for it, then forget the frames that were never submitted
+    while(prefetchQueue->outstanding() > 0) {
+        reapPrefetches(1);
+    }
+    for(unsigned i = 0 ; i < batch.size() ; ++i) {
+        unsigned frameNo = reinterpret_cast<size_t>(batch[i]->userData);
+        if(frames[frameNo].loading) {
+            frames[frameNo].loading = false;
+            frames[frameNo].prefetched = false;
+            --loadingFrames;
+            dropFrame(frameNo);
+        }
+    }
+    frameDone.notify_all();
+    return -1;
+}
+
+//Releases the frames whose prefetch completed, waiting for at least minCompletions of them. Caller must hold the latch
+void BufferPool::reapPrefetches(unsigned minCompletions) {
+    std::vector<PageIORequest *> completed;
+    prefetchQueue->complete(completed, minCompletions);
+    finishPrefetches(completed);
+}
+
+/**
+Releases the frames of completed prefetches, which the queue may have returned to any thread. A page of a chain
+starts the read of the next page. Caller must hold the latch.
+**/
+void BufferPool::finishPrefetches(const std::vector<PageIORequest *> &completed) {
+    std::vector<PageIORequest *> batch;
+    for(unsigned i = 0 ; i < completed.size() ; ++i) {
+        unsigned frameNo = reinterpret_cast<size_t>(completed[i]->userData);
+        Frame &frame = frames[frameNo];
+        frame.loading = false;
+        frame.prefetched = false;
+        frame.pinCount--;
+        --loadingFrames;
+        if(completed[i]->result != 0) {
+            dropFrame(frameNo);
+            continue;
+        }
+        if(frame.chainHops > 0) {
+            int next;
+            memcpy(&next, completed[i]->buffer+frame.chainOffset, sizeof(int));
+            if(next >= 0 && lookupFrame(frame.fileId, next) == -1) {
+                startPrefetch(frame.fileId, next, frame.chainOffset, frame.chainHops-1, batch);
+            }
+        }
+    }
+    if(!batch.empty()) {
+        submitPrefetches(batch);
+    }
+    if(!completed.empty()) {
+        frameDone.notify_all();
+    }
+}
+
+/**
+Waits until the page is no longer being read, without holding the latch meanwhile, and returns its frame (-1 if the
+read failed and dropped it). Whoever gets the completion of a prefetch releases its frame and wakes the others up.
+Caller must hold the latch through "guard".
+**/
+int BufferPool::waitForPage(std::unique_lock<std::mutex> &guard, unsigned fileId, PageNum pageNum) {
+    int frameNo = lookupFrame(fileId, pageNum);
+    while(frameNo != -1 && frames[frameNo].loading) {
+        if(frames[frameNo].prefetched && prefetchQueue->outstanding() > 0) {
+            std::vector<PageIORequest *> completed;
+            guard.unlock();
+            prefetchQueue->complete(completed, 1);
+            guard.lock();
+            finishPrefetches(completed);
+        }
+        else {
+            frameDone.wait(guard);
+        }
+        frameNo = lookupFrame(fileId, pageNum);
+    }
+    return frameNo;
+}
+
+//Waits until no frame is transferred without the latch any more. Caller must hold the latch through "guard"
+void BufferPool::waitForIdleFrames(std::unique_lock<std::mutex> &guard) {
+    while(busyFrames > 0 || loadingFrames > 0) {
+        if(loadingFrames > 0 && prefetchQueue->outstanding() > 0) {
+            reapPrefetches(1);
+        }
+        else {
+            frameDone.wait(guard);
+        }
+    }
+}
+
+/**
+Picks a frame to hold a new page: a free frame if there is one, otherwise an unpinned victim chosen by
+the replacement policy. A dirty victim is written back before it's reused. Caller must hold the latch.
+**/
+RC BufferPool::findVictim(unsigned &frameNo) {
+    if(!freeFrames.empty()) {
+        frameNo = freeFrames.back();
+        freeFrames.pop_back();
+        return 0;
+    }
+
+    bool found = false;
+    if(policy == LRU_REPLACEMENT) {
+        for(int i = lruTail ; i != -1 ; i = frames[i].lruPrev) {
+            if(frames[i].pinCount == 0) {
+                frameNo = i;
+                found = true;
+                break;
+            }
+        }
+    }
+    else {
+        //Second chance: each unpinned frame loses its reference bit on the first pass of the hand
+        for(unsigned steps = 0 ; steps < 2*frames.size() ; ++steps) {
+            Frame &frame = frames[clockHand];
+            unsigned current = clockHand;
+            clockHand = (clockHand+1) % frames.size();
+            if(frame.pinCount > 0) {
+                continue;
+            }
+            if(frame.referenced) {
+                frame.referenced = false;
+                continue;
+            }
+            frameNo = current;
+            found = true;
+            break;
+        }
+    }
+    if(!found) {
+        return -1;
+    }
+
+    if(frames[frameNo].dirty && writeFrame(frameNo) != 0) {
+        return -1;
+    }
+    hashRemove(frameNo);
+    lruUnlink(frameNo);
+    frames[frameNo].valid = false;
+    return 0;
+}
+
+//Caller must hold the latch
+RC BufferPool::writeFrame(unsigned frameNo) {
+    int fd = files[frames[frameNo].fileId].fd;
+    if(fd < 0) {
+        return -1;
+    }
+    unsigned pageSize = files[frames[frameNo].fileId].pageSize;
+    off_t offset = static_cast<off_t>(frames[frameNo].pageNum+1)*pageSize;
+    if(pwrite(fd, frameBuffer(frameNo), pageSize, offset) != pageSize) {
+        return -1;
+    }
+    frames[frameNo].dirty = false;
+    ++pagesWritten;
+    return 0;
+}
+
+//Needs no latch: the caller owns the frame while it's loading
+RC BufferPool::readFrame(int fd, unsigned pageSize, PageNum pageNum, byte *data) {
+    off_t offset = static_cast<off_t>(pageNum+1)*pageSize;
+    ssize_t res = pread(fd, data, pageSize, offset);
+    //File read error!
+    if(res < 0) {
+        return -1;
+    }
+    //Pages past the end of file (appended but not written back yet by another pool user) read as zeros
+    if(res != pageSize) {
+        memset(data+res, 0, pageSize-res);
+    }
+    return 0;
+}
+
+/**
+Moves a run of consecutive pages that have no frame between the file and the buffers of "run", then empties "run".
+A call moves at most IOV_MAX pages. Pages past the end of file read as zeros. Needs no latch.
+**/
+RC BufferPool::transferRun(int fd, unsigned pageSize, PageNum firstPage, std::vector<struct iovec> &run, bool write) {
+    for(unsigned done = 0 ; done < run.size() ; ) {
+        unsigned pages = std::min(static_cast<unsigned>(run.size())-done, static_cast<unsigned>(IOV_MAX));
+        off_t offset = static_cast<off_t>(firstPage+done+1)*pageSize;
+        size_t length = static_cast<size_t>(pages)*pageSize;
+        ssize_t res = write ? pwritev(fd, &run[done], pages, offset)
+                            : preadv(fd, &run[done], pages, offset);
+        if(res < 0 || (write && static_cast<size_t>(res) != length)) {
+            run.clear();
+            return -1;
+        }
+        for(unsigned i = res/pageSize ; i < pages ; ++i) {
+            size_t filled = std::max(static_cast<size_t>(res), static_cast<size_t>(i)*pageSize) - static_cast<size_t>(i)*pageSize;
+            memset(static_cast<byte *>(run[done+i].iov_base)+filled, 0, pageSize-filled);
+        }
+        done += pages;
+    }
+    run.clear();
+    return 0;
+}
+
+//Writes a run of pages that have no frame and grows the file as needed. Caller must hold the latch
+RC BufferPool::writeRun(unsigned fileId, PageNum firstPage, std::vector<struct iovec> &run) {
+    const unsigned pages = run.size();
+    if(transferRun(files[fileId].fd, files[fileId].pageSize, firstPage, run, true) != 0) {
+        return -1;
+    }
+    pagesWritten += pages;
+    if(pages > 0) {
+        files[fileId].allocatedPages = std::max(files[fileId].allocatedPages, static_cast<unsigned>(firstPage+pages));
+    }
+    return 0;
+}
+
+/**
+Takes the pages the file has grown by since the last call. A new mapping is only needed once the file has outgrown
+the current one: it gets at least twice the length, so that a growing file is mapped again a logarithmic number of
+times. The old mapping is kept until the file is dropped from the pool, since the pages handed out still point into it.
+Only complete pages of the file are handed out (touching a mapped byte past the end of file would raise SIGBUS).
+Caller must hold the latch.
+**/
+RC BufferPool::remapFile(unsigned fileId, size_t minLength) {
+    struct stat fileInfo;
+    if(fstat(files[fileId].fd, &fileInfo) != 0) {
+        return -1;
+    }
+    size_t length = static_cast<size_t>(fileInfo.st_size) / files[fileId].pageSize * files[fileId].pageSize;
+    if(length < minLength) {
+        return -1;
+    }
+
+    if(length > files[fileId].mappedLength) {
+        size_t reserved = std::max(length, 2*files[fileId].mappedLength);
+        void *mapping = mmap(NULL, reserved, PROT_READ, MAP_SHARED, files[fileId].fd, 0);
+        if(mapping == MAP_FAILED) {
+            return -1;
+        }
+        if(files[fileId].sequential) {
+            madvise(mapping, reserved, MADV_SEQUENTIAL);
+        }
+        if(files[fileId].mapping != NULL) {
+            files[fileId].retiredMappings.push_back(std::make_pair(files[fileId].mapping, files[fileId].mappedLength));
+        }
+        files[fileId].mapping = static_cast<byte *>(mapping);
+        files[fileId].mappedLength = reserved;
+    }
+    files[fileId].mappedFileLength = length;
+    return 0;
+}
+
+//Caller must hold the latch
+void BufferPool::unmapFile(unsigned fileId) {
+    if(files[fileId].mapping != NULL) {
+        munmap(files[fileId].mapping, files[fileId].mappedLength);
+        files[fileId].mapping = NULL;
+        files[fileId].mappedLength = 0;
+        files[fileId].mappedFileLength = 0;
+    }
+    for(unsigned i = 0 ; i < files[fileId].retiredMappings.size() ; ++i) {
+        munmap(files[fileId].retiredMappings[i].first, files[fileId].retiredMappings[i].second);
+    }
+    files[fileId].retiredMappings.clear();
+}
+
+//Gives a free frame to a page, growing its buffer for files with large pages. Caller must hold the latch
+void BufferPool::assignFrame(unsigned frameNo, unsigned fileId, PageNum pageNum) {
+    frames[frameNo].fileId = fileId;
+    frames[frameNo].pageNum = pageNum;
+    frames[frameNo].dirty = false;
+    if(frameData[frameNo].size() < files[fileId].pageSize) {
+        frameData[frameNo].resize(files[fileId].pageSize);
+    }
+}
+
+//Forget the frame without writing it back. Caller must hold the latch
+void BufferPool::dropFrame(unsigned frameNo) {
+    hashRemove(frameNo);
+    lruUnlink(frameNo);
+    frames[frameNo].valid = false;
+    frames[frameNo].dirty = false;
+    frames[frameNo].pinCount = 0;
+    freeFrames.push_back(frameNo);
+}
+
+unsigned BufferPool::bucketOf(unsigned fileId, PageNum pageNum) const {
+    return (pageNum*2654435761u ^ fileId*40503u) & (buckets.size()-1);
+}
+
+int BufferPool::lookupFrame(unsigned fileId, PageNum pageNum) const {
+    for(int i = buckets[bucketOf(fileId, pageNum)] ; i != -1 ; i = frames[i].hashNext) {
+        if(frames[i].pageNum == pageNum && frames[i].fileId == fileId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void BufferPool::hashInsert(unsigned frameNo) {
+    int &head = buckets[bucketOf(frames[frameNo].fileId, frames[frameNo].pageNum)];
+    frames[frameNo].hashNext = head;
+    head = frameNo;
+}
+
+void BufferPool::hashRemove(unsigned frameNo) {
+    int *link = &buckets[bucketOf(frames[frameNo].fileId, frames[frameNo].pageNum)];
+    while(*link != static_cast<int>(frameNo)) {
+        link = &frames[*link].hashNext;
+    }
+    *link = frames[frameNo].hashNext;
+}
+
+void BufferPool::lruUnlink(unsigned frameNo) {
+    Frame &frame = frames[frameNo];
+    (frame.lruPrev == -1 ? lruHead : frames[frame.lruPrev].lruNext) = frame.lruNext;
+    (frame.lruNext == -1 ? lruTail : frames[frame.lruNext].lruPrev) = frame.lruPrev;
+}
+
+void BufferPool::lruPushFront(unsigned frameNo) {
+    frames[frameNo].lruPrev = -1;
+    frames[frameNo].lruNext = lruHead;
+    (lruHead == -1 ? lruTail : frames[lruHead].lruPrev) = frameNo;
+    lruHead = frameNo;
+}
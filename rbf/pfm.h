@@ -5,25 +5,239 @@ typedef unsigned PageNum;
 typedef int RC;
 typedef unsigned char byte;
 
-#define PAGE_SIZE 4096
+#define PAGE_SIZE 4096              // Default page size, and the smallest one
+#define MAX_PAGE_SIZE 65536         // Largest page size, buffers that may hold a page of any file use it
+
+#define BUFFER_POOL_FRAMES 1024     // Default number of frames in the shared buffer pool
+#define EXTENT_SIZE 64              // Default number of PAGE_SIZE pages preallocated at once when a file grows
+#define BG_WRITER_DELAY 100         // Milliseconds between two rounds of the background writer, 0 disables it
+#define BG_WRITER_MAX_PAGES 64      // Dirty pages written back by the background writer per round
+#define READ_AHEAD_MIN_PAGES 4      // Bounds of the adaptive read-ahead window of a handle
+#define READ_AHEAD_MAX_PAGES 64
+#define READ_AHEAD_TRIGGER 3        // Consecutive page reads after which a handle is considered sequential
+
+#define HEADER_FIELDS 8             // Unsigned values at the start of the hidden page:
+#define HEADER_PAGE_SIZE 5          //  the page size (0 in older files: PAGE_SIZE)
+#define HEADER_PAGE_FORMAT 6        //  how the pages are organized, left to the layer above (0 in older files)
+#define HEADER_CREATION_ID 7        //  tells apart the files created under the same name (0 in older files)
 
 #include <string>
 #include <climits>
 #include <stdio.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
 
 class FileHandle;
+class ZoneMap;
+class ColumnFiles;
+class AsyncIOQueue;
+struct PageIORequest;
+
+typedef enum {
+    LRU_REPLACEMENT = 0,
+    CLOCK_REPLACEMENT
+} ReplacementPolicy;
+
+/**
+The buffer pool is shared by every FileHandle and IXFileHandle of the process.
+Files are identified by their (device, inode) pair, so all handles opened on the same file share the same frames.
+Pages are cached write-back: writes only dirty the frame, which goes to disk when it is evicted, when a handle of
+its file is closed or flushed, or when the background writer gets to it. The writer wakes up every few milliseconds
+and writes back the dirty frames that the replacement policy is about to pick, so that evictions rarely have to
+write synchronously, while the pages still being modified keep absorbing their writes.
+Handles are freely copied around (e.g. by the scan iterators), so the pool keeps its own descriptor of a file until the file is destroyed instead of counting handles. The hidden header page never goes through the pool.
+All file accesses are positional (pread/pwrite), there is no shared file offset to seek.
+A file can also be read through a read-only shared mapping (mapPage): dirty frames of a page are written back
+before a pointer into the mapping is handed out, so the mapping never shows stale data at that moment.
+Pages can be prefetched: their frames are filled asynchronously, and pinPage() waits for a page that is still being read.
+The latch guards the frames and the page table, never the transfers: a page missing from the pool is read without it,
+its frame published as loading in the meantime so that the other pinners of the page wait for that read only. Write-backs
+write copies of the pages, so that their frames can go on changing in the meantime.
+**/
+class BufferPool {
+public:
+    static BufferPool &instance();                                      // Access to the _buffer_pool instance
+
+    RC setCapacity(unsigned numberOfFrames);                            // Resize the pool (fails if some frame is pinned)
+    unsigned getCapacity();
+    void setReplacementPolicy(ReplacementPolicy policy);
+    ReplacementPolicy getReplacementPolicy();
+
+    RC registerFile(const std::string &fileName, unsigned pageSize, unsigned &fileId);  // Called whenever a file is opened
+    void invalidateFile(const std::string &fileName);                   // Drop all frames of a created/destroyed file
+
+    // Pins the page in a frame and returns the frame's memory. If readFromDisk is false, the frame isn't filled
+    // from the file because the caller is about to overwrite the whole page. "hit" tells if the page was resident,
+    // "waited" (if given) if it was a prefetched page whose read hadn't completed yet.
+    RC pinPage(unsigned fileId, PageNum pageNum, bool readFromDisk, byte *&frame, bool &hit, bool *waited = NULL);
+    RC unpinPage(unsigned fileId, PageNum pageNum, bool dirty);
+
+    // Returns a pointer to the page inside a read-only mapping of the file. The mapping grows with the file; the
+    // pointer stays valid until the file is created again or destroyed, so several readers can hold pages at once.
+    RC mapPage(unsigned fileId, PageNum pageNum, const byte *&data);
+    RC adviseSequential(unsigned fileId, bool sequential);              // madvise() the mapping for full scans
+
+    // Makes sure that the file has room for data page "pageNum" on disk. Files grow by whole extents of
+    // "extentSize" pages of PAGE_SIZE bytes (at least a page of the file, at most its size so far) allocated with
+    // fallocate(). The size of the file isn't changed: it grows as the pages are written.
+    RC reservePage(unsigned fileId, PageNum pageNum, unsigned extentSize);
+
+    // Read-ahead. Starts asynchronous reads of the pages of [firstPage, firstPage+count) that aren't cached, as long
+    // as frames can be spared for them. prefetchChain() follows a chain of pages instead (e.g. the leaves of an index):
+    // the next page number is the int stored at "linkOffset" of each page (negative ends the chain), for at most
+    // "hops" pages after pageNum. The cached part of the chain is walked right away, "cachedAhead" tells its length;
+    // the rest is read one page after the other as the reads complete.
+    RC prefetchPages(unsigned fileId, PageNum firstPage, unsigned count);
+    RC prefetchChain(unsigned fileId, PageNum pageNum, unsigned linkOffset, unsigned hops, unsigned &cachedAhead);
+
+    // Vectored transfer of the pages [firstPage, firstPage+count), one buffer per page. Resident pages are copied from
+    // or to their frames (written pages are dirtied like by writePage); every run of the other pages is moved by a single
+    // preadv()/pwritev() between the file and the caller's buffers, without taking frames. "hits" counts the resident pages.
+    RC readPages(unsigned fileId, PageNum firstPage, unsigned count, byte *const pages[], unsigned &hits);
+    RC writePages(unsigned fileId, PageNum firstPage, unsigned count, const byte *const pages[]);
+
+    RC flushFile(unsigned fileId, bool sync = false);                   // Write back all dirty frames of a file, fdatasync() it if "sync"
+    RC flushAll();                                                      // Write back all dirty frames
+    RC checkpoint();                                                    // Write back all dirty frames and fdatasync() every file
+    void setBackgroundWriterDelay(unsigned milliseconds);               // 0 stops the background writer
+    unsigned getPagesWritten();                                         // Pages written to the files so far, write-backs and writePages()
+
+protected:
+    BufferPool();                                                       // Prevent construction
+    ~BufferPool();                                                      // Prevent unwanted destruction
+    BufferPool(const BufferPool &);                                     // Prevent construction by copying (not defined)
+    BufferPool &operator=(const BufferPool &);                          // Prevent assignment (not defined)
+
+private:
+    struct PoolFile {
+        dev_t device;
+        ino_t inode;
+        int fd;                 //descriptor owned by the pool, so that dirty frames can be evicted at any time
+        unsigned allocatedPages;    //data pages physically present in the file, the logical count is in the header
+        byte *mapping;          //read-only mapping of the whole file, NULL until the first mapPage()
+        size_t mappedLength;    //may go past the end of file, to leave the file room to grow
+        size_t mappedFileLength;    //part of the mapping known to be in the file, what mapPage() hands out
+        std::vector<std::pair<byte *, size_t> > retiredMappings;    //outgrown mappings, still pointed into
+        bool sequential;        //MADV_SEQUENTIAL requested, reapplied after remapping
+        unsigned pageSize;
+    };
+
+    struct Frame {
+        unsigned fileId;
+        PageNum pageNum;
+        bool valid;
+        bool dirty;
+        bool referenced;        //CLOCK reference bit
+        unsigned pinCount;
+        int hashNext;           //next frame in the same page table bucket
+        int lruPrev;            //neighbours in the LRU list, whose head is the most recently used frame
+        int lruNext;
+        bool loading;           //page being read into the frame without the latch, pinned until the read completes
+        bool prefetched;        //the read is a prefetch: the pool holds the pin, the completion is reaped by reapPrefetches()
+        bool writing;           //a copy of the page is being written back without the latch, pinned until the write completes
+        unsigned chainOffset;   //prefetchChain(): where the link to the next page is, and how many pages are left
+        unsigned chainHops;
+    };
+
+    RC findVictim(unsigned &frameNo);
+    RC writeFrame(unsigned frameNo);
+    static RC readFrame(int fd, unsigned pageSize, PageNum pageNum, byte *data);
+    void dropFrame(unsigned frameNo);
+    RC flushFileFrames(std::unique_lock<std::mutex> &guard, unsigned fileId);
+    RC writeFrames(std::unique_lock<std::mutex> &guard, const std::vector<unsigned> &frameNos);
+    RC syncFiles(std::unique_lock<std::mutex> &guard, const std::vector<unsigned> &fileIds);
+    void backgroundWriter();
+    void writeColdFrames(std::unique_lock<std::mutex> &guard);
+    static RC transferRun(int fd, unsigned pageSize, PageNum firstPage, std::vector<struct iovec> &run, bool write);
+    RC writeRun(unsigned fileId, PageNum firstPage, std::vector<struct iovec> &run);
+    RC remapFile(unsigned fileId, size_t minLength);
+    void unmapFile(unsigned fileId);
+    void allocateFrames(unsigned numberOfFrames);
+    void assignFrame(unsigned frameNo, unsigned fileId, PageNum pageNum);
+    byte *frameBuffer(unsigned frameNo) { return frameData[frameNo].data(); }
+    RC startPrefetch(unsigned fileId, PageNum pageNum, unsigned linkOffset, unsigned hops,
+                     std::vector<PageIORequest *> &batch);
+    RC submitPrefetches(const std::vector<PageIORequest *> &batch);
+    void reapPrefetches(unsigned minCompletions);
+    void finishPrefetches(const std::vector<PageIORequest *> &completed);
+    int waitForPage(std::unique_lock<std::mutex> &guard, unsigned fileId, PageNum pageNum);
+    void waitForIdleFrames(std::unique_lock<std::mutex> &guard);
+
+    int lookupFrame(unsigned fileId, PageNum pageNum) const;
+    unsigned bucketOf(unsigned fileId, PageNum pageNum) const;
+    void hashInsert(unsigned frameNo);
+    void hashRemove(unsigned frameNo);
+    void lruUnlink(unsigned frameNo);
+    void lruPushFront(unsigned frameNo);
+
+    std::vector<PoolFile> files;
+    std::vector<Frame> frames;
+    std::vector<std::vector<byte> > frameData;                          //a buffer per frame, as large as the biggest page it held
+    std::vector<unsigned> freeFrames;
+    std::vector<int> buckets;                                           //page table: (fileId, pageNum) -> frame chain
+    int lruHead;
+    int lruTail;
+    unsigned clockHand;
+    ReplacementPolicy policy;
+    AsyncIOQueue *ioQueue;                                              //write-back of dirty frames in batches
+    AsyncIOQueue *prefetchQueue;                                        //read-ahead, reaped by the pool's own calls
+    PageIORequest *prefetchRequests;                                    //one per frame, the frame is the userData
+    unsigned loadingFrames;                                             //prefetches in flight
+    unsigned busyFrames;                                                //frames or page runs being transferred by a thread without the latch
+    std::condition_variable frameDone;                                  //a transfer done without the latch completed
+    unsigned pagesWritten;
+    std::thread writerThread;
+    std::condition_variable writerWakeup;
+    unsigned writerDelay;
+    bool writerStopping;
+    std::mutex latch;
+};
+
+/**
+Sequential access detection of a handle. After READ_AHEAD_TRIGGER consecutive page reads (or right away when a scan
+announces itself with setSequential()), the handle keeps a window of pages prefetched ahead of the reader.
+The window adapts to how fast the pages are consumed: it doubles when the reader had to wait for a prefetched page,
+and is halved when a prefetched page was evicted before it was read.
+**/
+class ReadAhead {
+public:
+    ReadAhead();
+    void setSequential(bool sequential) { this->sequential = sequential; }
+    void pageRead(unsigned fileId, PageNum pageNum, unsigned numberOfPages, bool hit, bool waited);
+    unsigned getWindow() const { return window; }
+
+private:
+    PageNum lastPage;
+    unsigned run;               //consecutive page reads so far
+    unsigned window;
+    PageNum prefetchedEnd;      //pages up to there (excluded) were requested already
+    bool sequential;
+};
 
 class PagedFileManager {
 public:
     static PagedFileManager &instance();                                // Access to the _pf_manager instance
 
-    RC createFile(const std::string &fileName);                         // Create a new file
     RC destroyFile(const std::string &fileName);                        // Destroy a file
+    RC createFile(const std::string &fileName, unsigned pageSize = PAGE_SIZE, unsigned pageFormat = 0);  // Create a new file with pages of "pageSize" bytes
     RC openFile(const std::string &fileName, FileHandle &fileHandle);   // Open a file
     RC closeFile(FileHandle &fileHandle);                               // Close a file
 
+    RC setExtentSize(unsigned numberOfPages);                           // Number of PAGE_SIZE pages the files grow by
+    unsigned getExtentSize() const;
+
+    static bool isValidPageSize(unsigned pageSize);                     // A power of two from PAGE_SIZE to MAX_PAGE_SIZE
+    static RC readHeader(int fd, unsigned header[HEADER_FIELDS]);       // Read the hidden page of an open file
+
 protected:
     PagedFileManager();                                                 // Prevent construction
     ~PagedFileManager();                                                // Prevent unwanted destruction
@@ -32,6 +246,7 @@ protected:
 
 private:
     static PagedFileManager *_pf_manager;
+    unsigned extentSize;
 };
 
 class FileHandle {
@@ -42,13 +257,25 @@ public:
     unsigned appendPageCounter;
     unsigned noPages;
     unsigned lastTableID;
+    unsigned pageSize;                                                  // set by createFile(), recorded in the hidden page
+    unsigned pageFormat;                                                // same
+    unsigned creationId;                                                // same, picked by createFile()
+    // buffer pool statistics of readPage(), they are not persisted in the hidden page
+    unsigned bufferHitCounter;
+    unsigned bufferMissCounter;
 
     unsigned int getLastTableId() const;
 
     void setLastTableId(unsigned int lastTableId);
     //used only in case of "Tables" system catalog
 
-    FILE *fp;
+    int fd;                                                             // -1 when no file is open, only used with pread/pwrite
+    std::string fileName;                                               // given to openFile()
+    unsigned fileId;                                                    // Id of the file in the BufferPool
+    bool mappedReads;                                                   // accessPage() returns pointers into a mapping
+    ReadAhead readAhead;                                                // prefetching of readPage()/pinPage()
+    std::shared_ptr<ZoneMap> zoneMap;                                   // of the file, opened by the record manager on first use
+    std::shared_ptr<ColumnFiles> columnFiles;                           // of a column table, opened by the column store on first use
 
     FileHandle();                                                       // Default constructor
     ~FileHandle();                                                      // Destructor
@@ -56,9 +283,29 @@ public:
     RC readPage(PageNum pageNum, void *data);                           // Get a specific page
     RC writePage(PageNum pageNum, const void *data);                    // Write a specific page
     RC appendPage(const void *data);                                    // Append a specific page
+    // Several consecutive pages at once, either packed in one buffer or scattered in a buffer per page.
+    // The counters count pages, so this is accounted like "count" calls to readPage()/writePage().
+    RC readPages(PageNum firstPage, unsigned count, void *data);
+    RC readPages(PageNum firstPage, unsigned count, void *const pages[]);
+    RC writePages(PageNum firstPage, unsigned count, const void *data);
+    RC writePages(PageNum firstPage, unsigned count, const void *const pages[]);
     unsigned getNumberOfPages();                                        // Get the number of pages in the file
+    unsigned getPageSize() const { return pageSize; }                   // Size of the pages read and written
+    unsigned getPageFormat() const { return pageFormat; }               // Given to createFile()
+    unsigned getCreationId() const { return creationId; }               // Not 0 unless the file is an older one
     RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount,
                             unsigned &appendPageCount);                 // Put current counter values into variables
+    RC collectBufferCounterValues(unsigned &hitCount, unsigned &missCount);  // Put buffer pool hits/misses into variables
+    RC flush();                                                         // Make the file durable: counters, dirty pages, fdatasync()
+
+    RC pinPage(PageNum pageNum, byte *&data);                           // Pin a page in the buffer pool and access it in place
+    RC unpinPage(PageNum pageNum, bool dirty);                          // Release a pinned page, "dirty" if it was modified
+
+    // Zero-copy read path for read-mostly files. Writes keep going through writePage().
+    RC setMappedReads(bool enabled, bool sequential = false);           // sequential: madvise the mapping for full scans
+    RC mapPage(PageNum pageNum, const byte *&data);                     // Pointer to the page inside the file mapping
+    // Read-only access to a page: a pointer into the mapping if mapped reads are enabled, "buffer" filled by readPage() otherwise
+    RC accessPage(PageNum pageNum, const byte *&data, byte *buffer);
 };
 
 #endif
@@ -2,7 +2,16 @@
 #include <cstring>
 #include <cmath>
 #include <map>
+#include <algorithm>
 #include "rbfm.h"
+#include "pax.h"
+#include "zonemap.h"
+#include "parallelscan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define RBFM_SIMD 1
+#endif
 
 using namespace std;
 
@@ -21,11 +30,31 @@ RecordBasedFileManager::RecordBasedFileManager(const RecordBasedFileManager &) =
 
 RecordBasedFileManager &RecordBasedFileManager::operator=(const RecordBasedFileManager &) = default;
 
-RC RecordBasedFileManager::createFile(const std::string &fileName) {
-    return PagedFileManager::instance().createFile(fileName);
+//Record-based files start with their first free-space map page, the layout is recorded in the hidden page
+RC RecordBasedFileManager::createFile(const std::string &fileName, unsigned pageSize, PageLayout layout) {
+    if(layout == COLUMN_LAYOUT) {
+        return -1;
+    }
+    RC rc = PagedFileManager::instance().createFile(fileName, pageSize, pageFormat(layout));
+    if(rc != 0) {
+        return rc;
+    }
+    FileHandle fileHandle;
+    rc = PagedFileManager::instance().openFile(fileName, fileHandle);
+    if(rc != 0) {
+        return rc;
+    }
+    byte fsmPage[MAX_PAGE_SIZE];
+    memset(fsmPage, 0, pageSize);
+    rc = fileHandle.appendPage(fsmPage);
+    if(PagedFileManager::instance().closeFile(fileHandle) != 0) {
+        return -1;
+    }
+    return rc != 0 ? rc : ZoneMap::create(fileName, pageSize);
 }
 
 RC RecordBasedFileManager::destroyFile(const std::string &fileName) {
+    ZoneMap::destroy(fileName); //not every file has one
     return PagedFileManager::instance().destroyFile(fileName);
 }
 
@@ -33,18 +62,99 @@ RC RecordBasedFileManager::openFile(const std::string &fileName, FileHandle &fil
     return PagedFileManager::instance().openFile(fileName, fileHandle);
 }
 
+//The zone map kept by the handle is closed first, its pages are then written back with those of the file
 RC RecordBasedFileManager::closeFile(FileHandle &fileHandle) {
-    return PagedFileManager::instance().closeFile(fileHandle);
+    fileHandle.zoneMap.reset();
+    RC rc = ZoneMap::flush(fileHandle);
+    return PagedFileManager::instance().closeFile(fileHandle) != 0 ? -1 : rc;
+}
+
+Schema::Schema(const std::vector<Attribute> &attributes) : attributes(attributes), fixedOffsets(1, 0) {
+    nullIndicatorBytes = nullIndicatorSize(attributes.size());
+    types.reserve(attributes.size());
+    for(unsigned i = 0 ; i < attributes.size() ; ++i) {
+        types.push_back(attributes[i].type);
+        indices.insert(std::make_pair(attributes[i].name, i)); //the first one wins for duplicated names
+        if(fixedOffsets.size() == i+1 && attributes[i].type != TypeVarChar) {
+            fixedOffsets.push_back(fixedOffsets.back() + attributes[i].length);
+        }
+    }
+    if(isFixedWidth()) {
+        //The field offsets of such records, as transformDataToRecordFormat() writes them
+        const byte *offsets = reinterpret_cast<const byte *>(fixedOffsets.data());
+        fixedRecordHeaders[false].assign(offsets, offsets + fixedOffsets.size()*sizeof(unsigned));
+        fixedRecordHeaders[true].assign(nullIndicatorBytes, 0);
+        for(unsigned offset : fixedOffsets) {
+            const uint16_t compactOffset = offset;
+            fixedRecordHeaders[true].insert(fixedRecordHeaders[true].end(),
+                                            reinterpret_cast<const byte *>(&compactOffset),
+                                            reinterpret_cast<const byte *>(&compactOffset) + sizeof(uint16_t));
+        }
+    }
+}
+
+bool Schema::hasNulls(const void *data) const {
+    const byte *nullInfo = static_cast<const byte *>(data);
+    for(unsigned i = 0 ; i < attributes.size()/8 ; ++i) {
+        if(nullInfo[i] != 0) {
+            return true;
+        }
+    }
+    //the bits of the last byte past the last field are left alone
+    return attributes.size()%8 != 0 && (nullInfo[attributes.size()/8] & 0xFF << 8-attributes.size()%8 & 0xFF) != 0;
+}
+
+int Schema::indexOf(const std::string &name) const {
+    std::unordered_map<std::string, unsigned>::const_iterator it = indices.find(name);
+    return it == indices.end() ? -1 : static_cast<int>(it->second);
+}
+
+const byte *Schema::findField(const void *data, unsigned field, unsigned &length) const {
+    const byte *values = static_cast<const byte *>(data) + nullIndicatorBytes;
+    if(isNull(data, field)) {
+        length = 0;
+        return NULL;
+    }
+    unsigned offset = 0;
+    unsigned i = 0;
+    if(field < fixedOffsets.size()) {
+        //Within the fixed-width prefix only NULLs before the field move it
+        for( ; i < field && !isNull(data, i) ; ++i) ;
+        offset = fixedOffsets[i];
+    }
+    for( ; i < field ; ++i) {
+        if(isNull(data, i)) {
+            continue;
+        }
+        offset += types[i] == TypeVarChar ? sizeof(unsigned) + *reinterpret_cast<const unsigned *>(values + offset) : attributes[i].length;
+    }
+    length = types[field] == TypeVarChar ? sizeof(unsigned) + *reinterpret_cast<const unsigned *>(values + offset) : attributes[field].length;
+    return values + offset;
+}
+
+unsigned Schema::getDataLength(const void *data) const {
+    const byte *values = static_cast<const byte *>(data) + nullIndicatorBytes;
+    unsigned offset = 0;
+    for(unsigned i = 0 ; i < types.size() ; ++i) {
+        if(isNull(data, i)) {
+            continue;
+        }
+        offset += types[i] == TypeVarChar ? sizeof(unsigned) + *reinterpret_cast<const unsigned *>(values + offset) : attributes[i].length;
+    }
+    return nullIndicatorBytes + offset;
 }
 
-RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const Schema &recordDescriptor,
                                         const void *data, RID &rid) {
+    if(isPax(fileHandle)) {
+        return insertPaxRecord(fileHandle, recordDescriptor, data, rid);
+    }
     std::vector<byte> recordFormat;
-    transformDataToRecordFormat(recordDescriptor, data, recordFormat);
+    transformDataToRecordFormat(recordDescriptor, data, recordFormat, hasCompactRecords(fileHandle));
 
     unsigned pageNumber;
     unsigned targetSlotNumber;
-    byte page[PAGE_SIZE] ;
+    byte page[MAX_PAGE_SIZE] ;
     //memset(page, 0, PAGE_SIZE);
     //*reinterpret_cast<unsigned*>(page + PAGE_SIZE - sizeof(unsigned)*2) = 1; //size of slot directory
 
@@ -61,24 +171,32 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const std::vecto
     rid.pageNum = pageNumber;
     rid.slotNum = targetSlotNumber;
 
-    return 0;
+    ZoneMap *zoneMap = zoneMapOf(fileHandle, recordDescriptor);
+    return zoneMap == NULL ? 0 : zoneMap->widen(pageNumber, data);
 }
 
-void RecordBasedFileManager::transformDataToRecordFormat(const std::vector<Attribute> &recordDescriptor, const void *data, std::vector<byte> &recordFormat) {
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(recordDescriptor.size()/8.0));
+void RecordBasedFileManager::transformDataToRecordFormat(const Schema &recordDescriptor, const void *data, std::vector<byte> &recordFormat, bool compact) {
+    const unsigned nullInfoFieldLength = recordDescriptor.getNullIndicatorSize();
     const byte* actualData = reinterpret_cast<const byte*>(data) + nullInfoFieldLength;
+
+    if(recordDescriptor.isFixedWidth() && !recordDescriptor.hasNulls(data)) {
+        //The header is the same for all such records and the values are copied at once; they take at least 4 bytes,
+        //so a compact record is already large enough for a tombstone
+        const std::vector<byte> &header = recordDescriptor.getFixedRecordHeader(compact);
+        recordFormat.insert(recordFormat.end(), header.begin(), header.end());
+        recordFormat.insert(recordFormat.end(), actualData, actualData + recordDescriptor.getFixedLength());
+        return;
+    }
     unsigned actualDataSizeInBytes = 0;
 
     std::vector<unsigned> fieldOffsets(recordDescriptor.size()+1); //array of field offsets equals to the number of fields + 1 additional offset to the end of the record
 
     for(unsigned i = 0 ; i < recordDescriptor.size() ; ++i) {
-        const byte* byteInNullInfoField = reinterpret_cast<const byte*>(data) + i/8;
-        bool nullField = *byteInNullInfoField & (1 << 7-i%8);
-        if(nullField) {
+        if(Schema::isNull(data, i)) {
             fieldOffsets[i+1] = fieldOffsets[i];
         }
         else {
-            if(recordDescriptor[i].type == AttrType::TypeInt || recordDescriptor[i].type == AttrType::TypeReal) {
+            if(recordDescriptor.getType(i) != AttrType::TypeVarChar) {
                 fieldOffsets[i+1] = fieldOffsets[i] + recordDescriptor[i].length;
                 actualDataSizeInBytes += recordDescriptor[i].length;
             }
@@ -90,103 +208,533 @@ void RecordBasedFileManager::transformDataToRecordFormat(const std::vector<Attri
         }
     }
 
-    recordFormat.insert(recordFormat.end(),
-                        reinterpret_cast<const byte*>(fieldOffsets.data()),
-                        reinterpret_cast<const byte*>(fieldOffsets.data()) + fieldOffsets.size()*sizeof(unsigned));
+    if(compact) { //null indicators as given, then 2-byte offsets: a record fits in a page, so they do too
+        recordFormat.insert(recordFormat.end(), reinterpret_cast<const byte*>(data), actualData);
+        for(unsigned offset : fieldOffsets) {
+            const uint16_t compactOffset = offset;
+            recordFormat.insert(recordFormat.end(),
+                                reinterpret_cast<const byte*>(&compactOffset),
+                                reinterpret_cast<const byte*>(&compactOffset) + sizeof(uint16_t));
+        }
+    }
+    else {
+        recordFormat.insert(recordFormat.end(),
+                            reinterpret_cast<const byte*>(fieldOffsets.data()),
+                            reinterpret_cast<const byte*>(fieldOffsets.data()) + fieldOffsets.size()*sizeof(unsigned));
+    }
 
     recordFormat.insert(recordFormat.end(),
                         actualData,
                         actualData + actualDataSizeInBytes);
-
+    if(compact && recordFormat.size() < 2*sizeof(unsigned)) { //room for a tombstone, should the record move
+        recordFormat.resize(2*sizeof(unsigned), 0);
+    }
 }
 
 
-RC RecordBasedFileManager::readFirstFreePage(FileHandle &fileHandle, unsigned startPage, unsigned &pageNumber, const unsigned recordLength, byte *page, unsigned &targetSlotNumber) {
+/**
+Finds a data page with room for a record of "recordLength" bytes, starting with "startPage". Candidates come from
+the free-space map, so only the FSM page(s) and the chosen data page are read; a file without a map has its pages
+read one after the other, wrapping around. A new data page is appended if no page has enough room. On return, "page"
+holds the chosen page with its slot directory already grown if needed.
+**/
+RC RecordBasedFileManager::readFirstFreePage(FileHandle &fileHandle, unsigned startPage, unsigned &pageNumber, const unsigned recordLength, byte *page, unsigned &targetSlotNumber, const Schema *paxSchema) {
+    const unsigned pageSize = fileHandle.getPageSize();
     unsigned numberOfPages = fileHandle.getNumberOfPages();
+    unsigned neededCategory = paxSchema != NULL ? PaxPage::neededCategory(recordLength, pageSize)
+                                                : (recordLength + FSM_CATEGORY_SIZE(pageSize) - 1) / FSM_CATEGORY_SIZE(pageSize);
 
-    if(numberOfPages > 0) {
-        bool lastPageNotAnalyzed = true;
-
-        for(unsigned i = startPage; i < startPage || lastPageNotAnalyzed; ) {
-            RC rcode = fileHandle.readPage(i, page);
+    if(startPage >= numberOfPages && numberOfPages > 0) {
+        startPage = numberOfPages-1;
+    }
+    if(!hasFreeSpaceMap(fileHandle)) {
+        for(unsigned i = 0 ; i < numberOfPages ; ++i) {
+            pageNumber = (startPage+i) % numberOfPages;
+            RC rcode = fileHandle.readPage(pageNumber, page);
             if(rcode != 0) {
                 return rcode;
             }
-
-            unsigned freeSpaceOffset = *reinterpret_cast<unsigned*>(page + PAGE_SIZE - sizeof(unsigned));
-            unsigned slotDirectorySize = *reinterpret_cast<unsigned*>(page + PAGE_SIZE - sizeof(unsigned)*2);
-            unsigned slotDirectoryBeginningOffset = PAGE_SIZE - sizeof(unsigned)*4;
-
-            //we are searching for empty slot so as to determine whether we'd need to create a new slot or not
-            bool emptySlotFound = false;
-            for(int i = 0, *slot = reinterpret_cast<int*>(page + slotDirectoryBeginningOffset) ; i < slotDirectorySize ; ++i, slot -= 2) {
-                if(*slot == -1) { //we probably don't have to check for slot_length != -1 in here, as there is no case when *slot == -1 && *slot_length == -1
-                    targetSlotNumber = i;
-                    emptySlotFound = true;
-                    break;
-                }
+            if(paxSchema != NULL ? PaxPage(page, pageSize, *paxSchema).findSlot(recordLength, targetSlotNumber)
+                                 : findSlotForRecord(page, pageSize, recordLength, targetSlotNumber)) {
+                return 0;
             }
-
-            long totalFreeSpaceInBytes = PAGE_SIZE - sizeof(unsigned)*2 - slotDirectorySize*sizeof(unsigned)*2 - freeSpaceOffset;
-            if(!emptySlotFound) {
-                totalFreeSpaceInBytes -= sizeof(unsigned)*2;
-                /* According to C++ standard, integer overflow in ints is undefined,
-                 * so it'd be better to replace it with:
-                 *  //for subtraction
-                 *   #include <limits.h>
-                 *   int a = <something>;
-                 *   int x = <something>;
-                 *   if ((x > 0) && (a < INT_MIN + x)) // `a - x` would underflow
-                */
+        }
+    }
+    else if(numberOfPages > 1) {
+        unsigned numberOfMaps = (numberOfPages-1) / (FSM_PAGE_ENTRIES(pageSize)+1) + 1;
+        unsigned startMap = startPage / (FSM_PAGE_ENTRIES(pageSize)+1);
+        byte fsmPage[MAX_PAGE_SIZE];
+
+        //The start page is tried first, then the maps are searched from the start page's one, wrapping around
+        for(unsigned m = 0 ; m < numberOfMaps ; ++m) {
+            unsigned fsmPageNumber = ((startMap+m) % numberOfMaps) * (FSM_PAGE_ENTRIES(pageSize)+1);
+            RC rcode = fileHandle.readPage(fsmPageNumber, fsmPage);
+            if(rcode != 0) {
+                return rcode;
             }
+            unsigned entries = min<unsigned>(FSM_PAGE_ENTRIES(pageSize), numberOfPages-fsmPageNumber-1);
+            unsigned first = m == 0 && !isFreeSpaceMapPage(fileHandle, startPage) ? startPage-fsmPageNumber-1 : 0;
 
-            if(totalFreeSpaceInBytes > 0 && recordLength <= totalFreeSpaceInBytes) {
-                pageNumber = i;
-                if(!emptySlotFound) {
-                    *reinterpret_cast<unsigned*>(page + PAGE_SIZE - sizeof(unsigned)*2) += 1;
-                    targetSlotNumber = slotDirectorySize;
+            for(unsigned e = 0 ; e < entries ; ++e) {
+                unsigned entry = e == 0 ? first : (e <= first ? e-1 : e);
+                if(fsmPage[entry] < neededCategory) {
+                    continue;
+                }
+                pageNumber = fsmPageNumber+entry+1;
+                rcode = fileHandle.readPage(pageNumber, page);
+                if(rcode != 0) {
+                    return rcode;
+                }
+                if(paxSchema != NULL ? PaxPage(page, pageSize, *paxSchema).findSlot(recordLength, targetSlotNumber)
+                                     : findSlotForRecord(page, pageSize, recordLength, targetSlotNumber)) {
+                    return 0;
+                }
+                //The entry promised more room than the slot directory and the record need together: fix it and go on
+                fsmPage[entry] = paxSchema != NULL ? PaxPage(page, pageSize, *paxSchema).category() : freeSpaceCategory(page, pageSize);
+                rcode = fileHandle.writePage(fsmPageNumber, fsmPage);
+                if(rcode != 0) {
+                    return rcode;
                 }
-                return 0;
             }
+        }
+    }
 
-            if(i == numberOfPages-1) {
-                lastPageNotAnalyzed = false;
-                i = 0;
-            }
-            else {
-                ++i;
-            }
+    RC rcode = appendDataPage(fileHandle, page, pageNumber);
+    if(rcode != 0) {
+        return rcode;
+    }
+    targetSlotNumber = 0;
+    if(paxSchema != NULL) {
+        //The new page is laid out when it gets its first record, it is written with it
+        PaxPage paxPage(page, pageSize, *paxSchema);
+        paxPage.format(recordLength);
+        return paxPage.findSlot(recordLength, targetSlotNumber) ? 0 : -1;
+    }
+    return 0;
+}
+
+/**
+Checks whether the record fits in the page, either in an empty slot or in a new one. If it fits, the target slot is
+returned and the slot directory is grown when a new slot is needed.
+**/
+bool RecordBasedFileManager::findSlotForRecord(byte *page, const unsigned pageSize, const unsigned recordLength, unsigned &targetSlotNumber) {
+    unsigned slotDirectorySize = *reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned)*2);
+
+    //we are searching for empty slot so as to determine whether we'd need to create a new slot or not
+    unsigned emptySlot = nextSlot(page, pageSize, 0, false);
+    bool emptySlotFound = emptySlot < slotDirectorySize;
+    if(emptySlotFound) {
+        targetSlotNumber = emptySlot;
+    }
+
+    if(!emptySlotFound && hasSlotBitmap(page) && slotDirectorySize >= ROW_PAGE_BITMAP_BYTES(pageSize)*8) {
+        return false; //only records without fields are small enough to get there
+    }
+
+    //a new slot takes room from the free space as well
+    if(recordLength > 0 && makeRoom(page, pageSize, emptySlotFound ? recordLength : recordLength + sizeof(unsigned)*2)) {
+        if(!emptySlotFound) {
+            *reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned)*2) += 1;
+            targetSlotNumber = slotDirectorySize;
         }
+        return true;
     }
+    return false;
+}
 
-    memset(page, 0, PAGE_SIZE);
-    *reinterpret_cast<unsigned*>(page + PAGE_SIZE - sizeof(unsigned)*2) = 1; //size of slot directory
+//Appends an empty data page with one (still unused) slot, preceded by a new FSM page when the last map is full
+RC RecordBasedFileManager::appendDataPage(FileHandle &fileHandle, byte *page, unsigned &pageNumber) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    memset(page, 0, pageSize);
+    if(isFreeSpaceMapPage(fileHandle, fileHandle.getNumberOfPages())) {
+        RC rcode = fileHandle.appendPage(page);
+        if(rcode != 0) {
+            return rcode;
+        }
+    }
+    formatRowPage(page, pageSize, hasCompactRecords(fileHandle));
+    *reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned)*2) = 1; //size of slot directory
     RC rcode = fileHandle.appendPage(page);
     if(rcode != 0) {
         return rcode;
     }
-
     pageNumber = fileHandle.getNumberOfPages()-1;
-    targetSlotNumber = 0;
+    return 0;
+}
+
+//Free bytes left for a record that needs a new slot, in FSM_CATEGORY_SIZE units. Dead bytes count as free, the page
+//is compacted when a record needs them
+byte RecordBasedFileManager::freeSpaceCategory(const byte *page, const unsigned pageSize) {
+    unsigned freeSpaceOffset = *reinterpret_cast<const unsigned*>(page + pageSize - sizeof(unsigned));
+    unsigned slotDirectorySize = *reinterpret_cast<const unsigned*>(page + pageSize - sizeof(unsigned)*2);
+    long freeBytes = pageSize - sizeof(unsigned)*2 - (slotDirectorySize+1)*sizeof(unsigned)*2 - (long)freeSpaceOffset + deadBytes(page);
+    if(freeBytes <= 0) {
+        return 0;
+    }
+    return static_cast<byte>(min<long>(freeBytes / FSM_CATEGORY_SIZE(pageSize), 255));
+}
+
+void RecordBasedFileManager::formatRowPage(byte *page, const unsigned pageSize, bool compactRecords) {
+    memset(page, 0, pageSize);
+    const unsigned header[2] = { ROW_PAGE_MAGIC, compactRecords ? ROW_PAGE_COMPACT_RECORDS : 0u };
+    memcpy(page, header, sizeof(header));
+    *reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned)) = ROW_PAGE_HEADER_SIZE(pageSize); //free space offset
+}
+
+void RecordBasedFileManager::setSlotLive(byte *page, const unsigned slotNumber, bool live) {
+    if(!hasSlotBitmap(page)) {
+        return;
+    }
+    byte *word = page + 2*sizeof(unsigned) + slotNumber/64*sizeof(uint64_t);
+    uint64_t bits;
+    memcpy(&bits, word, sizeof(bits));
+    bits = live ? bits | uint64_t(1) << slotNumber%64 : bits & ~(uint64_t(1) << slotNumber%64);
+    memcpy(word, &bits, sizeof(bits));
+}
+
+unsigned RecordBasedFileManager::nextSlot(const byte *page, const unsigned pageSize, unsigned slotNumber, bool live) {
+    const unsigned slotCount = *reinterpret_cast<const unsigned*>(page + pageSize - sizeof(unsigned)*2);
+    if(!hasSlotBitmap(page)) {
+        while(slotNumber < slotCount && (*reinterpret_cast<const int*>(page + pageSize - sizeof(unsigned)*4 - slotNumber*sizeof(unsigned)*2) != -1) != live) {
+            ++slotNumber;
+        }
+        return min(slotNumber, slotCount);
+    }
+    const byte *bitmap = page + 2*sizeof(unsigned);
+    for(unsigned w = slotNumber/64 ; w*64 < slotCount ; ++w) {
+        uint64_t bits;
+        memcpy(&bits, bitmap + w*sizeof(uint64_t), sizeof(bits));
+        if(!live) {
+            bits = ~bits;
+        }
+        if(w == slotNumber/64) {
+            bits &= ~uint64_t(0) << slotNumber%64;
+        }
+        if(bits != 0) {
+            return min(w*64 + __builtin_ctzll(bits), slotCount);
+        }
+    }
+    return slotCount;
+}
+
+//The records are moved up by the size of the header, the slots follow them
+bool RecordBasedFileManager::upgradeRowPage(byte *page, const unsigned pageSize) {
+    if(hasSlotBitmap(page)) {
+        return false;
+    }
+    const unsigned headerSize = ROW_PAGE_HEADER_SIZE(pageSize);
+    unsigned *freeSpaceOffset = reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned));
+    const unsigned slotCount = *reinterpret_cast<const unsigned*>(page + pageSize - sizeof(unsigned)*2);
+    if(*freeSpaceOffset + headerSize > pageSize - sizeof(unsigned)*2 - slotCount*sizeof(unsigned)*2
+       || slotCount > ROW_PAGE_BITMAP_BYTES(pageSize)*8) {
+        return false;
+    }
+    memmove(page + headerSize, page, *freeSpaceOffset);
+    *freeSpaceOffset += headerSize;
+    memset(page + 2*sizeof(unsigned), 0, ROW_PAGE_BITMAP_BYTES(pageSize));
+    const unsigned header[2] = { ROW_PAGE_MAGIC, 0 };
+    memcpy(page, header, sizeof(header));
+    for(unsigned s = 0 ; s < slotCount ; ++s) {
+        int *offset = reinterpret_cast<int*>(page + pageSize - sizeof(unsigned)*4 - s*sizeof(unsigned)*2);
+        if(*offset != -1) {
+            *offset += headerSize;
+            setSlotLive(page, s, true);
+        }
+    }
+    return true;
+}
+
+void RecordBasedFileManager::setDeadBytes(byte *page, unsigned bytes) {
+    unsigned word;
+    memcpy(&word, page + sizeof(unsigned), sizeof(unsigned));
+    word = (word & ((1u << ROW_PAGE_FLAG_BITS)-1)) | bytes << ROW_PAGE_FLAG_BITS;
+    memcpy(page + sizeof(unsigned), &word, sizeof(unsigned));
+}
+
+void RecordBasedFileManager::freeSlot(byte *page, const unsigned pageSize, const unsigned slotNumber) {
+    int *recordOffset = (int *)(page+pageSize-2*(slotNumber+2)*sizeof(int));
+    int *recordLen = (int *)(page+pageSize-(2*slotNumber+3)*sizeof(int));
+    if(*recordLen == -1) { //a tombstone holds a RID
+        *recordLen = 2*sizeof(unsigned);
+    }
+    if(!hasSlotBitmap(page)) {
+        shiftRecord(page, pageSize, 0, slotNumber);
+        return;
+    }
+    setDeadBytes(page, deadBytes(page) + *recordLen);
+    *recordOffset = -1;
+    *recordLen = 0;
+    setSlotLive(page, slotNumber, false);
+}
+
+//The live records are slid down in the order they are on the page, so each one moves at most once
+void RecordBasedFileManager::compactRowPage(byte *page, const unsigned pageSize) {
+    if(deadBytes(page) == 0) {
+        return;
+    }
+    const unsigned slotCount = *reinterpret_cast<const unsigned*>(page + pageSize - sizeof(unsigned)*2);
+    std::vector<std::pair<unsigned, unsigned> > records; //(offset, slot)
+    for(unsigned s = nextSlot(page, pageSize, 0, true) ; s < slotCount ; s = nextSlot(page, pageSize, s+1, true)) {
+        records.push_back(std::make_pair(*reinterpret_cast<const unsigned*>(page + pageSize - sizeof(unsigned)*4 - s*sizeof(unsigned)*2), s));
+    }
+    std::sort(records.begin(), records.end());
+    unsigned freeSpaceOffset = ROW_PAGE_HEADER_SIZE(pageSize);
+    for(const std::pair<unsigned, unsigned> &record : records) {
+        unsigned *recordOffset = reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned)*4 - record.second*sizeof(unsigned)*2);
+        const int recordLen = *reinterpret_cast<const int*>(page + pageSize - sizeof(unsigned)*3 - record.second*sizeof(unsigned)*2);
+        const unsigned size = recordLen == -1 ? 2*sizeof(unsigned) : recordLen;
+        memmove(page + freeSpaceOffset, page + record.first, size);
+        *recordOffset = freeSpaceOffset;
+        freeSpaceOffset += size;
+    }
+    *reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned)) = freeSpaceOffset;
+    setDeadBytes(page, 0);
+}
+
+bool RecordBasedFileManager::makeRoom(byte *page, const unsigned pageSize, const unsigned bytes) {
+    const unsigned freeSpaceOffset = *reinterpret_cast<const unsigned*>(page + pageSize - sizeof(unsigned));
+    const unsigned slotDirectorySize = *reinterpret_cast<const unsigned*>(page + pageSize - sizeof(unsigned)*2);
+    const long freeBytes = pageSize - sizeof(unsigned)*2 - slotDirectorySize*sizeof(unsigned)*2 - (long)freeSpaceOffset;
+    if(freeBytes >= (long)bytes) {
+        return true;
+    }
+    if(freeBytes + deadBytes(page) < (long)bytes) {
+        return false;
+    }
+    compactRowPage(page, pageSize);
+    return true;
+}
+
+RC RecordBasedFileManager::compactFile(FileHandle &fileHandle, unsigned &compacted) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    compacted = 0;
+    if(isPax(fileHandle)) {
+        return 0;
+    }
+    byte page[MAX_PAGE_SIZE];
+    for(unsigned p = 0 ; p < fileHandle.getNumberOfPages() ; ++p) {
+        if(isFreeSpaceMapPage(fileHandle, p)) {
+            continue;
+        }
+        RC rc = fileHandle.readPage(p, page);
+        if(rc != 0) {
+            return rc;
+        }
+        if(deadBytes(page) == 0) {
+            continue;
+        }
+        compactRowPage(page, pageSize);
+        if((rc = fileHandle.writePage(p, page)) != 0 || (rc = updateFreeSpaceMap(fileHandle, p, page)) != 0) {
+            return rc;
+        }
+        ++compacted;
+    }
+    return 0;
+}
+
+RC RecordBasedFileManager::upgradeFile(FileHandle &fileHandle, unsigned &upgraded) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    upgraded = 0;
+    if(isPax(fileHandle)) {
+        return 0;
+    }
+    byte page[MAX_PAGE_SIZE];
+    for(unsigned p = 0 ; p < fileHandle.getNumberOfPages() ; ++p) {
+        if(isFreeSpaceMapPage(fileHandle, p)) {
+            continue;
+        }
+        RC rc = fileHandle.readPage(p, page);
+        if(rc != 0) {
+            return rc;
+        }
+        if(!upgradeRowPage(page, pageSize)) {
+            continue;
+        }
+        if((rc = fileHandle.writePage(p, page)) != 0 || (rc = updateFreeSpaceMap(fileHandle, p, page)) != 0) {
+            return rc;
+        }
+        ++upgraded;
+    }
+    return 0;
+}
+
+RC RecordBasedFileManager::updateFreeSpaceMap(FileHandle &fileHandle, const unsigned pageNumber, const byte *page) {
+    return setFreeSpaceCategory(fileHandle, pageNumber, freeSpaceCategory(page, fileHandle.getPageSize()));
+}
+
+//Nothing to do in a file without a map
+RC RecordBasedFileManager::setFreeSpaceCategory(FileHandle &fileHandle, const unsigned pageNumber, const byte category) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    if(!hasFreeSpaceMap(fileHandle)) {
+        return 0;
+    }
+    unsigned fsmPageNumber = pageNumber / (FSM_PAGE_ENTRIES(pageSize)+1) * (FSM_PAGE_ENTRIES(pageSize)+1);
+    byte fsmPage[MAX_PAGE_SIZE];
+    RC rcode = fileHandle.readPage(fsmPageNumber, fsmPage);
+    if(rcode != 0) {
+        return rcode;
+    }
+    byte &entry = fsmPage[pageNumber-fsmPageNumber-1];
+    if(entry == category) {
+        return 0;
+    }
+    entry = category;
+    return fileHandle.writePage(fsmPageNumber, fsmPage);
+}
+
+//Same for many data pages: each FSM page is read and written once
+RC RecordBasedFileManager::updateFreeSpaceMap(FileHandle &fileHandle, std::vector<std::pair<unsigned, byte> > &categories) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    if(!hasFreeSpaceMap(fileHandle)) {
+        return 0;
+    }
+    std::sort(categories.begin(), categories.end());
+    byte fsmPage[MAX_PAGE_SIZE];
+    for(unsigned i = 0 ; i < categories.size() ; ) {
+        unsigned fsmPageNumber = categories[i].first / (FSM_PAGE_ENTRIES(pageSize)+1) * (FSM_PAGE_ENTRIES(pageSize)+1);
+        RC rcode = fileHandle.readPage(fsmPageNumber, fsmPage);
+        if(rcode != 0) {
+            return rcode;
+        }
+        bool changed = false;
+        for( ; i < categories.size() && categories[i].first < fsmPageNumber+FSM_PAGE_ENTRIES(pageSize)+1 ; ++i) {
+            byte &entry = fsmPage[categories[i].first-fsmPageNumber-1];
+            changed |= entry != categories[i].second;
+            entry = categories[i].second;
+        }
+        if(changed && (rcode = fileHandle.writePage(fsmPageNumber, fsmPage)) != 0) {
+            return rcode;
+        }
+    }
     return 0;
 }
 
 RC RecordBasedFileManager::insertRecordOnPage(FileHandle &fileHandle, const std::vector<byte> &recordFormat, const unsigned pageNumber, const unsigned targetSlotNumber, byte *page) {
-    unsigned freeSpaceOffset = *reinterpret_cast<unsigned*>(page + PAGE_SIZE - sizeof(unsigned));
+    placeRecord(page, fileHandle.getPageSize(), recordFormat, targetSlotNumber);
+
+    RC rcode = fileHandle.writePage(pageNumber, page);
+    if(rcode != 0) {
+        return rcode;
+    }
+    return updateFreeSpaceMap(fileHandle, pageNumber, page);
+}
+
+//Copies the record at the beginning of the free space and points the slot at it, the page stays in memory
+void RecordBasedFileManager::placeRecord(byte *page, const unsigned pageSize, const std::vector<byte> &recordFormat, const unsigned targetSlotNumber) {
+    unsigned freeSpaceOffset = *reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned));
     memcpy(page+freeSpaceOffset, recordFormat.data(), recordFormat.size());
 
-    *reinterpret_cast<int*>(page + PAGE_SIZE - sizeof(unsigned)*4 - targetSlotNumber*sizeof(unsigned)*2) = freeSpaceOffset;
-    *reinterpret_cast<unsigned *>(page + PAGE_SIZE - sizeof(unsigned)*3 - targetSlotNumber*sizeof(unsigned)*2) = recordFormat.size();
-    *reinterpret_cast<unsigned*>(page + PAGE_SIZE - sizeof(unsigned)) += recordFormat.size();
+    *reinterpret_cast<int*>(page + pageSize - sizeof(unsigned)*4 - targetSlotNumber*sizeof(unsigned)*2) = freeSpaceOffset;
+    *reinterpret_cast<unsigned *>(page + pageSize - sizeof(unsigned)*3 - targetSlotNumber*sizeof(unsigned)*2) = recordFormat.size();
+    *reinterpret_cast<unsigned*>(page + pageSize - sizeof(unsigned)) += recordFormat.size();
+    setSlotLive(page, targetSlotNumber, true);
+}
+
+RC RecordBasedFileManager::insertRecords(FileHandle &fileHandle, const Schema &recordDescriptor,
+                                         const std::vector<const void *> &data, std::vector<RID> &rids) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    rids.resize(data.size());
+    if(isPax(fileHandle)) {
+        //No batching for PAX pages, the records go one by one
+        for(unsigned i = 0 ; i < data.size() ; ++i) {
+            RC rcode = insertPaxRecord(fileHandle, recordDescriptor, data[i], rids[i]);
+            if(rcode != 0) {
+                return rcode;
+            }
+        }
+        return 0;
+    }
+
+    byte page[MAX_PAGE_SIZE];
+    unsigned pageNumber;
+    bool pageLoaded = false;
+    bool newPage = false; //built in memory, not in the file yet
+    std::vector<byte> recordFormat;
+    std::vector<std::pair<unsigned, byte> > freeSpace; //FSM entries of the written pages, recorded at the end
+    for(unsigned i = 0 ; i < data.size() ; ++i) {
+        recordFormat.clear();
+        transformDataToRecordFormat(recordDescriptor, data[i], recordFormat, hasCompactRecords(fileHandle));
+
+        unsigned targetSlotNumber;
+        if(!pageLoaded) {
+            RC rcode = readFirstFreePage(fileHandle, fileHandle.getNumberOfPages()-1, pageNumber, recordFormat.size(), page, targetSlotNumber);
+            if(rcode != 0) {
+                return rcode;
+            }
+            pageLoaded = true;
+        }
+        else if(!findSlotForRecord(page, pageSize, recordFormat.size(), targetSlotNumber)) {
+            //The page is full: write it, then go on with a new one right after the end of the file
+            RC rcode = writeBatchPage(fileHandle, pageNumber, page, newPage);
+            if(rcode != 0) {
+                return rcode;
+            }
+            freeSpace.push_back(std::make_pair(pageNumber, freeSpaceCategory(page, pageSize)));
+            newPage = true;
+            pageNumber = fileHandle.getNumberOfPages();
+            if(isFreeSpaceMapPage(fileHandle, pageNumber)) {
+                ++pageNumber;
+            }
+            formatRowPage(page, pageSize, hasCompactRecords(fileHandle));
+            if(!findSlotForRecord(page, pageSize, recordFormat.size(), targetSlotNumber)) {
+                return -1; //larger than a page
+            }
+        }
+
+        placeRecord(page, pageSize, recordFormat, targetSlotNumber);
+        rids[i].pageNum = pageNumber;
+        rids[i].slotNum = targetSlotNumber;
+    }
+    if(!pageLoaded) {
+        return 0;
+    }
+    RC rcode = writeBatchPage(fileHandle, pageNumber, page, newPage);
+    if(rcode != 0) {
+        return rcode;
+    }
+    freeSpace.push_back(std::make_pair(pageNumber, freeSpaceCategory(page, pageSize)));
+    if((rcode = updateFreeSpaceMap(fileHandle, freeSpace)) != 0) {
+        return rcode;
+    }
+    ZoneMap *zoneMap = zoneMapOf(fileHandle, recordDescriptor);
+    if(zoneMap == NULL) {
+        return 0;
+    }
+    for(unsigned i = 0 ; i < data.size() ; ++i) {
+        if((rcode = zoneMap->widen(rids[i].pageNum, data[i])) != 0) {
+            return rcode;
+        }
+    }
+    return 0;
+}
 
-    return fileHandle.writePage(pageNumber, page);
+//Writes a page filled by insertRecords(), its FSM entry is left to the caller. A new page is appended, after a new
+//FSM page if the next page is a map
+RC RecordBasedFileManager::writeBatchPage(FileHandle &fileHandle, const unsigned pageNumber, const byte *page, bool newPage) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    RC rcode;
+    if(newPage) {
+        if(isFreeSpaceMapPage(fileHandle, fileHandle.getNumberOfPages())) {
+            byte fsmPage[MAX_PAGE_SIZE];
+            memset(fsmPage, 0, pageSize);
+            rcode = fileHandle.appendPage(fsmPage);
+            if(rcode != 0) {
+                return rcode;
+            }
+        }
+        rcode = fileHandle.appendPage(page);
+    }
+    else {
+        rcode = fileHandle.writePage(pageNumber, page);
+    }
+    return rcode;
 }
 
-void RecordBasedFileManager::shiftRecord(byte *page,const unsigned dataSize, const unsigned slotNumber){
-    unsigned *freeSpace = (unsigned *)(page+PAGE_SIZE-sizeof(unsigned));
-    unsigned *slotSize = (unsigned *)(page+PAGE_SIZE-2*sizeof(unsigned));
-    unsigned *recordOffset = (unsigned *)(page+PAGE_SIZE-2*(slotNumber+2)*sizeof(unsigned));
-    unsigned *recordLen = (unsigned *)(page+PAGE_SIZE-(2*slotNumber+3)*sizeof(unsigned));
+void RecordBasedFileManager::shiftRecord(byte *page, const unsigned pageSize, const unsigned dataSize, const unsigned slotNumber){
+    unsigned *freeSpace = (unsigned *)(page+pageSize-sizeof(unsigned));
+    unsigned *slotSize = (unsigned *)(page+pageSize-2*sizeof(unsigned));
+    unsigned *recordOffset = (unsigned *)(page+pageSize-2*(slotNumber+2)*sizeof(unsigned));
+    unsigned *recordLen = (unsigned *)(page+pageSize-(2*slotNumber+3)*sizeof(unsigned));
     unsigned bytesToBeShifted = *freeSpace-(*recordOffset+*recordLen);
 
     //for overlapping memory blocks, memmove is a safer approach than memcpy,
@@ -196,87 +744,161 @@ void RecordBasedFileManager::shiftRecord(byte *page,const unsigned dataSize, con
     //Change slot offsets and field offsets
     int diff = (int)*recordLen-(int)dataSize;
     for(int i = 0;i < *slotSize;i++){
-        int *slotOffset = (int *)(page+PAGE_SIZE-2*(i+2)*sizeof(int));
+        int *slotOffset = (int *)(page+pageSize-2*(i+2)*sizeof(int));
         if(*slotOffset != -1 && *slotOffset > *recordOffset){
             *slotOffset -= diff;
         }
     }
-    if(dataSize == 0)
+    if(dataSize == 0) {
         *recordOffset = -1;
+        setSlotLive(page, slotNumber, false);
+    }
     *freeSpace -= diff;
     *recordLen = dataSize;
 }
 
-RC RecordBasedFileManager::readRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const RID &rid, void *data) {
-    byte page[PAGE_SIZE];
-    RC rcode = fileHandle.readPage(rid.pageNum, page);
+RC RecordBasedFileManager::readRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, void *data) {
+    if(isPax(fileHandle)) {
+        return readPaxRecord(fileHandle, recordDescriptor, rid, data);
+    }
+    //The record is decoded straight from the buffer pool frame into "data"
+    RecordView view;
+    PageNum pinnedPage;
+    RC rcode = pinRecord(fileHandle, recordDescriptor, rid, view, pinnedPage);
     if(rcode != 0) {
         return rcode;
     }
-    //int cnt = 1;
-    //cout<<cnt++<<endl;
+    view.project(recordDescriptor, data);
+    return fileHandle.unpinPage(pinnedPage, false);
+}
 
-    int fieldOffsetsLocation = *reinterpret_cast<int*>(page + PAGE_SIZE - sizeof(unsigned)*4 - rid.slotNum*sizeof(unsigned)*2);
+RC RecordBasedFileManager::viewRecord(const byte *page, unsigned pageSize, unsigned slotNum, unsigned fieldCount, RecordView &view, RID &movedTo) {
+    view = RecordView();
+    int fieldOffsetsLocation = *reinterpret_cast<const int*>(page + pageSize - sizeof(unsigned)*4 - slotNum*sizeof(unsigned)*2);
     //Record has already been deleted, so no record to be read!
     if(fieldOffsetsLocation == -1)
         return -1;
-    //cout<<cnt++<<endl;
 
-    int recordLen = *(int *)(page + PAGE_SIZE - sizeof(unsigned)*3 - rid.slotNum*sizeof(unsigned)*2);
-    //Recursively visit tombstones until a page with real record is found
+    int recordLen = *(const int *)(page + pageSize - sizeof(unsigned)*3 - slotNum*sizeof(unsigned)*2);
     if(recordLen == -1){
-        RID cur;
-        cur.pageNum = *(unsigned *)(page + fieldOffsetsLocation);
-        cur.slotNum = *(unsigned *)(page + fieldOffsetsLocation + sizeof(unsigned));
-        //cout<<"Current rid: "<<cur.pageNum<<" "<<cur.slotNum<<" "<<cnt++<<endl;
-        return readRecord(fileHandle,recordDescriptor,cur,data);
+        movedTo.pageNum = *(const unsigned *)(page + fieldOffsetsLocation);
+        movedTo.slotNum = *(const unsigned *)(page + fieldOffsetsLocation + sizeof(unsigned));
+        return 0;
     }
+    view = RecordView(page + fieldOffsetsLocation, fieldCount, hasCompactRecords(page));
+    return 0;
+}
 
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(recordDescriptor.size()/8.0));
-    std::vector<byte> readData(nullInfoFieldLength, 0);
+RC RecordBasedFileManager::pinRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, RecordView &view, PageNum &pinnedPage) {
+    if(isPax(fileHandle)) {
+        return -1;
+    }
+    byte *page;
+    RC rcode = fileHandle.pinPage(rid.pageNum, page);
+    if(rcode != 0) {
+        return rcode;
+    }
+    RID movedTo;
+    rcode = viewRecord(page, fileHandle.getPageSize(), rid.slotNum, recordDescriptor.size(), view, movedTo);
+    if(rcode != 0 || !view.isValid()) {
+        fileHandle.unpinPage(rid.pageNum, false);
+        //Recursively visit tombstones until a page with real record is found
+        return rcode != 0 ? rcode : pinRecord(fileHandle, recordDescriptor, movedTo, view, pinnedPage);
+    }
+    pinnedPage = rid.pageNum;
+    return 0;
+}
 
-    for(unsigned i = 0, *fieldOffsets = reinterpret_cast<unsigned*>(page+fieldOffsetsLocation) ; i < recordDescriptor.size() ; ++i, fieldOffsets++) {
-        if(*fieldOffsets == *(fieldOffsets+1)) {
-            unsigned byteInNullInfoField = i/8;
-            readData[byteInNullInfoField] |= (1 << 7-i%8);
+unsigned RecordView::project(const std::vector<unsigned> &fields, void *data) const {
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(fields.size());
+    byte *nullInfo = static_cast<byte *>(data);
+    byte *cur = nullInfo + nullInfoFieldLength;
+    memset(nullInfo, 0, nullInfoFieldLength);
+    for(unsigned i = 0 ; i < fields.size() ; ++i) {
+        unsigned length;
+        const byte *field = getField(fields[i], length);
+        if(length == 0) {
+            nullInfo[i/8] |= (1 << (7-i%8));
         }
         else {
-            if(recordDescriptor[i].type == AttrType::TypeInt || recordDescriptor[i].type == AttrType::TypeReal) {
-                //cout<<"INT OR REAL: "<<cnt++<<endl;
-                byte* beginningOfRecord = page + fieldOffsetsLocation + (recordDescriptor.size()+1)*sizeof(unsigned) + *fieldOffsets;
-                readData.insert(readData.end(), beginningOfRecord, beginningOfRecord + recordDescriptor[i].length);
-                //cout<<"Value: "<<*(unsigned *)beginningOfRecord<<endl;
-            }
-            else { //recordDescriptor[i].type == AttrType::TypeVarChar
-                //cout<<"STRING: "<<cnt++<<endl;
-                byte* beginningOfStrLength = page + fieldOffsetsLocation + (recordDescriptor.size()+1)*sizeof(unsigned) + *fieldOffsets;
-                byte* beginningOfStrContent = beginningOfStrLength + sizeof(unsigned);
-                readData.insert(readData.end(), beginningOfStrLength, beginningOfStrContent);
-                readData.insert(readData.end(), beginningOfStrContent, beginningOfStrContent + *reinterpret_cast<unsigned*>(beginningOfStrLength));
-                //cout<<"Value: "<<*(unsigned *)beginningOfStrLength<<" "<<*(char *)beginningOfStrContent<<endl;
+            memcpy(cur, field, length);
+            cur += length;
+        }
+    }
+    return cur - nullInfo;
+}
+
+unsigned RecordView::project(void *data) const {
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(fieldCount);
+    byte *nullInfo = static_cast<byte *>(data);
+    if(compact) {
+        memcpy(nullInfo, record, nullInfoFieldLength);
+    }
+    else {
+        memset(nullInfo, 0, nullInfoFieldLength);
+        for(unsigned i = 0 ; i < fieldCount ; ++i) {
+            if(isNull(i)) {
+                nullInfo[i/8] |= (1 << (7-i%8));
             }
         }
     }
-    memcpy(data, readData.data(), readData.size());
-    return 0;
+    //Null fields take no room, so the values are stored one after the other already
+    unsigned length = offset(fieldCount)-offset(0);
+    memcpy(nullInfo + nullInfoFieldLength, record + valuesOffset() + offset(0), length);
+    return nullInfoFieldLength + length;
+}
+
+//A record of such a descriptor has NULLs exactly when its values are shorter than all of them together
+bool RecordView::hasFixedLayout(const Schema &schema) const {
+    return schema.isFixedWidth() && schema.size() == fieldCount && offset(fieldCount)-offset(0) == schema.getFixedLength();
+}
+
+unsigned RecordView::project(const Schema &schema, const std::vector<unsigned> &fields, void *data) const {
+    if(!hasFixedLayout(schema)) {
+        return project(fields, data);
+    }
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(fields.size());
+    byte *nullInfo = static_cast<byte *>(data);
+    byte *cur = nullInfo + nullInfoFieldLength;
+    memset(nullInfo, 0, nullInfoFieldLength);
+    const byte *values = record + valuesOffset();
+    for(unsigned field : fields) {
+        memcpy(cur, values + schema.getFixedOffset(field), schema[field].length);
+        cur += schema[field].length;
+    }
+    return cur - nullInfo;
+}
+
+unsigned RecordView::project(const Schema &schema, void *data) const {
+    if(!hasFixedLayout(schema)) {
+        return project(data);
+    }
+    const unsigned nullInfoFieldLength = schema.getNullIndicatorSize();
+    memset(data, 0, nullInfoFieldLength);
+    memcpy(static_cast<byte *>(data) + nullInfoFieldLength, record + valuesOffset(), schema.getFixedLength());
+    return nullInfoFieldLength + schema.getFixedLength();
 }
 
 /**
 Important Note: The first field(offset field) in slot is set to -1 if deleted;
 The second field(length field) is set to -1 if the slot is tombstone. If so, the record content is filled with the actual RID.
 **/
-RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const Schema &recordDescriptor,
     const RID &rid) {
+    if(isPax(fileHandle)) {
+        return deletePaxRecord(fileHandle, recordDescriptor, rid);
+    }
+    const unsigned pageSize = fileHandle.getPageSize();
     unsigned p = rid.pageNum,s = rid.slotNum;
-    byte pageStart[PAGE_SIZE];
+    byte pageStart[MAX_PAGE_SIZE];
     RC rcode = fileHandle.readPage(p,pageStart);
     if(rcode != 0) {
         return rcode;
     }
 
     //NOTE: record offset and record length can be -1 so that they have to be treated as integers
-    int *recordOffset = (int *)(pageStart+PAGE_SIZE-2*(s+2)*sizeof(unsigned));
-    int *recordLen = (int *)(pageStart+PAGE_SIZE-(2*s+3)*sizeof(unsigned));
+    int *recordOffset = (int *)(pageStart+pageSize-2*(s+2)*sizeof(unsigned));
+    int *recordLen = (int *)(pageStart+pageSize-(2*s+3)*sizeof(unsigned));
 
     if(*recordLen == -1){
         RID cur;
@@ -286,23 +908,24 @@ RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const std::vecto
         //that was pointing to a tombstone, otherwise, if someone called the deleteRecord for the second time on
         //the same RID, it theoretically could mess up things in other files
         if(deleteRecord(fileHandle,recordDescriptor,cur) != -1) {
-            *recordLen = 0;
-            //If previous chain of calls to delete a record succeeded, we can delete tombstones, by shifting
-            //the remaining records 8 bytes towards the beginning of the page.
+            //If previous chain of calls to delete a record succeeded, we can delete tombstones, their 8 bytes
+            //become dead bytes of the page.
             //However, in a perfect program, the deletion of tombstones (and thus of the record) would have to be reverted,
             //if we spotted an error code in the process. It complicates the program significantly, though, and in our case
             //such error test cases will not take place anyway.
-            shiftRecord(pageStart, 0, s);
-            return fileHandle.writePage(p,pageStart);
+            freeSlot(pageStart, pageSize, s);
+            rcode = fileHandle.writePage(p,pageStart);
+            return rcode != 0 ? rcode : updateFreeSpaceMap(fileHandle, p, pageStart);
         } else {
             return -1;
         }
     }
         //If the record has not been deleted,then delete it
     else if(*recordOffset != -1){
-        //Shift records
-        shiftRecord(pageStart,0,s);
-        return fileHandle.writePage(p,pageStart);
+        //Only the slot is freed, the page is compacted when its space is needed
+        freeSlot(pageStart,pageSize,s);
+        rcode = fileHandle.writePage(p,pageStart);
+        return rcode != 0 ? rcode : updateFreeSpaceMap(fileHandle, p, pageStart);
     }
     else {
         return -1; //trying to delete a deleted record
@@ -310,13 +933,13 @@ RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const std::vecto
 }
 
 RC RecordBasedFileManager::printRecord(const std::vector<Attribute> &recordDescriptor, const void *data) {
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(recordDescriptor.size()/8.0));
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(recordDescriptor.size());
     const byte* actualData = reinterpret_cast<const byte*>(data) + nullInfoFieldLength;
 
     for(unsigned i = 0 ; i < recordDescriptor.size() ; ++i) {
         cout << recordDescriptor[i].name << ": ";
         const byte* byteInNullInfoField = reinterpret_cast<const byte*>(data) + i/8;
-        bool nullField = *byteInNullInfoField & (1 << 7-i%8);
+        bool nullField = *byteInNullInfoField & (1 << (7-i%8));
         if(nullField) {
             cout << "NULL\t";
         }
@@ -343,17 +966,35 @@ RC RecordBasedFileManager::printRecord(const std::vector<Attribute> &recordDescr
     return 0;
 }
 
-RC RecordBasedFileManager::moveToNextAvailableRecord(FileHandle& fileHandle, RID& rid) {
+RC RecordBasedFileManager::moveToNextAvailableRecord(FileHandle& fileHandle, RID& rid, byte *buffer, const byte *&page, PageNum &bufferedPage, const RBFM_ScanIterator *scan) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    const PageNum endPage = scan != NULL ? scan->getEndPage() : UINT_MAX;
     //We first consider the position given in rid itself
-    for( ; rid.pageNum < fileHandle.getNumberOfPages() ; ++rid.pageNum, rid.slotNum=0) {
-        byte page[PAGE_SIZE];
-        RC rcode = fileHandle.readPage(rid.pageNum,page);
-        if(rcode != 0) {
-            return -1;
+    for( ; rid.pageNum < fileHandle.getNumberOfPages() && rid.pageNum < endPage ; ++rid.pageNum, rid.slotNum=0) {
+        if(isFreeSpaceMapPage(fileHandle, rid.pageNum)) {
+            continue;
+        }
+        if(rid.pageNum != bufferedPage && scan != NULL && scan->skipsPage(rid.pageNum)) {
+            continue;
+        }
+        if(rid.pageNum != bufferedPage) {
+            bufferedPage = UINT_MAX;
+            RC rcode = fileHandle.accessPage(rid.pageNum,page,buffer); //read in place with mapped reads
+            if(rcode != 0) {
+                return -1;
+            }
+            bufferedPage = rid.pageNum;
         }
-        unsigned slotDirectorySize = *reinterpret_cast<unsigned *>(page + PAGE_SIZE - sizeof(unsigned)*2);
-        while(rid.slotNum < slotDirectorySize && *reinterpret_cast<int*>(page + PAGE_SIZE - sizeof(unsigned)*4 - rid.slotNum*sizeof(unsigned)*2) == -1) {
-            ++rid.slotNum;
+        //Both layouts keep the number of slots at the same place, a PAX page starts with their states. Moved PAX
+        //records are skipped, they are visited through their tombstones
+        unsigned slotDirectorySize = *reinterpret_cast<const unsigned *>(page + pageSize - sizeof(unsigned)*2);
+        if(isPax(fileHandle)) {
+            while(rid.slotNum < slotDirectorySize && (page[rid.slotNum] == PAX_FREE_SLOT || page[rid.slotNum] == PAX_MOVED)) {
+                ++rid.slotNum;
+            }
+        }
+        else {
+            rid.slotNum = nextSlot(page, pageSize, rid.slotNum, true);
         }
         if(rid.slotNum < slotDirectorySize) {
             return 0; //we found non-empty slot
@@ -365,151 +1006,448 @@ RC RecordBasedFileManager::moveToNextAvailableRecord(FileHandle& fileHandle, RID
 /**
 Important Note: The first field(offset field) in slot is set to -1 if deleted;
 The second field(length field) is set to -1 if the slot is tombstone. If so, the record content is filled with the actual RID.
+A record is never more than one hop away from its home slot: when a moved record has to move again, the tombstone
+in the home slot is rewritten to point at the new place (or the record goes back home if it fits there now).
 **/
-RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const void *data, const RID &rid) {
+RC RecordBasedFileManager::updateRowRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data, const RID &rid) {
+    const unsigned pageSize = fileHandle.getPageSize();
 
     vector<byte> formattedData;
-    transformDataToRecordFormat(recordDescriptor,data,formattedData);
+    transformDataToRecordFormat(recordDescriptor,data,formattedData,hasCompactRecords(fileHandle));
     unsigned dataSize =  formattedData.size();
-    //int cnt = 1;
-    //cout<<cnt++<<endl;
 
     unsigned p = rid.pageNum,s = rid.slotNum;
-    byte pageStart[PAGE_SIZE];
+    byte pageStart[MAX_PAGE_SIZE];
     RC rc = fileHandle.readPage(p,pageStart);
     if(rc != 0)
         return rc;
 
-    unsigned *freeSpace = (unsigned *)(pageStart+PAGE_SIZE-sizeof(unsigned));
-    unsigned *slotSize = (unsigned *)(pageStart+PAGE_SIZE-2*sizeof(unsigned));
-    int *recordOffset = (int *)(pageStart+PAGE_SIZE-2*(s+2)*sizeof(int));
-    int *recordLen = (int *)(pageStart+PAGE_SIZE-(2*s+3)*sizeof(int));
+    int *recordOffset = (int *)(pageStart+pageSize-2*(s+2)*sizeof(int));
+    int *recordLen = (int *)(pageStart+pageSize-(2*s+3)*sizeof(int));
 
     //If the record rid refers to doesn't exist,return
     if(*recordOffset == -1) return -1;
-    //cout<<cnt++<<endl;
-    //If the slot is a tombstone,loop until it's not a tombstone
+
     if(*recordLen == -1){
         RID cur;
         cur.pageNum = *(unsigned *)(pageStart+*recordOffset);
         cur.slotNum = *(unsigned *)(pageStart+*recordOffset+sizeof(unsigned));
-        //cout<<cnt++<<endl;
-        return updateRecord(fileHandle,recordDescriptor,data,cur);
+        return updateForwardedRecord(fileHandle,formattedData,rid,pageStart,cur);
+    }
+
+    if(!resizeRecord(pageStart,pageSize,formattedData,s)){
+        //Find free space for the update in another page, also use tombstone
+        unsigned pageNumber,slotNumber;
+        byte page[MAX_PAGE_SIZE];
+        unsigned upper = fileHandle.getNumberOfPages();
+
+        rc = readFirstFreePage(fileHandle,p+1 == upper?0:p+1,pageNumber,dataSize,page,slotNumber);
+        if(rc != 0)
+            return rc;
+
+        rc = insertRecordOnPage(fileHandle,formattedData,pageNumber,slotNumber,page);
+        if(rc != 0)
+            return rc;
+
+        //delete original record with the RID that points to the moved record
+        //Note: the length of the original record must be greater than 2*sizeof(unsigned)
+        shiftRecord(pageStart,pageSize,2*sizeof(unsigned),s);
+        *(unsigned *)(pageStart+*recordOffset) = pageNumber;
+        *(unsigned *)(pageStart+*recordOffset+sizeof(unsigned)) = slotNumber;
+
+        //set length field to -1 as a indicator that this slot is a tombstone
+        *recordLen = -1;
+    }
+    rc = fileHandle.writePage(p,pageStart);
+    return rc != 0 ? rc : updateFreeSpaceMap(fileHandle, p, pageStart);
+}
+
+//The new version widens the zone map of the page it ends up on and of its home page, scans may reach it from either
+RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data, const RID &rid) {
+    RC rc = isPax(fileHandle) ? updatePaxRecord(fileHandle, recordDescriptor, data, rid)
+                              : updateRowRecord(fileHandle, recordDescriptor, data, rid);
+    ZoneMap *zoneMap = rc != 0 ? NULL : zoneMapOf(fileHandle, recordDescriptor);
+    if(zoneMap == NULL) {
+        return rc;
+    }
+    RID location;
+    if((rc = locateRecord(fileHandle, recordDescriptor, rid, location)) != 0 || (rc = zoneMap->widen(rid.pageNum, data)) != 0) {
+        return rc;
+    }
+    return location.pageNum == rid.pageNum ? 0 : zoneMap->widen(location.pageNum, data);
+}
+
+//A handle opened on another file, or used with another descriptor, gets a map of its own
+ZoneMap *RecordBasedFileManager::zoneMapOf(FileHandle &fileHandle, const Schema &recordDescriptor) {
+    if(!fileHandle.zoneMap || !fileHandle.zoneMap->isOpenFor(recordDescriptor)) {
+        fileHandle.zoneMap.reset();
+        fileHandle.zoneMap = std::make_shared<ZoneMap>();
+        fileHandle.zoneMap->open(fileHandle, recordDescriptor);
+    }
+    return fileHandle.zoneMap->isUsable() ? fileHandle.zoneMap.get() : NULL;
+}
+
+RC RecordBasedFileManager::locateRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, RID &location) {
+    location = rid;
+    if(rid.pageNum >= fileHandle.getNumberOfPages() || isFreeSpaceMapPage(fileHandle, rid.pageNum)) {
+        return -1;
+    }
+    byte *page;
+    if(fileHandle.pinPage(rid.pageNum, page) != 0) {
+        return -1;
+    }
+    RC rc = 0;
+    if(isPax(fileHandle)) {
+        PaxPage paxPage(page, fileHandle.getPageSize(), recordDescriptor);
+        if(rid.slotNum >= paxPage.getSlotCount() || paxPage.getState(rid.slotNum) == PAX_FREE_SLOT) {
+            rc = -1;
+        }
+        else if(paxPage.getState(rid.slotNum) == PAX_TOMBSTONE) {
+            location = paxPage.forward(rid.slotNum);
+        }
+    }
+    else {
+        RecordView view;
+        RID movedTo;
+        rc = viewRecord(page, fileHandle.getPageSize(), rid.slotNum, recordDescriptor.size(), view, movedTo);
+        if(rc == 0 && !view.isValid()) {
+            location = movedTo;
+        }
     }
+    fileHandle.unpinPage(rid.pageNum, false);
+    return rc;
+}
+
+//Replaces the record in slot "slotNumber" with "recordFormat" if the page has room for it, the page stays in memory
+bool RecordBasedFileManager::resizeRecord(byte *page, const unsigned pageSize, const std::vector<byte> &recordFormat, const unsigned slotNumber) {
+    int *recordOffset = (int *)(page+pageSize-2*(slotNumber+2)*sizeof(int));
+    unsigned recordLen = *(unsigned *)(page+pageSize-(2*slotNumber+3)*sizeof(int));
+    unsigned dataSize = recordFormat.size();
 
-    if(*recordLen >= dataSize){
-        //cout<<"Left shift: "<<cnt++<<endl;
-        memcpy(pageStart+*recordOffset,formattedData.data(),dataSize);
+    if(recordLen >= dataSize){
+        memcpy(page+*recordOffset,recordFormat.data(),dataSize);
         //Shift towards the begining of page
-        if(*recordLen > dataSize) {
-            shiftRecord(pageStart,dataSize,s);
+        if(recordLen > dataSize) {
+            shiftRecord(page,pageSize,dataSize,slotNumber);
         }
+        return true;
+    }
+    //Check if there is enough free space in this page for the augmentation
+    if(!makeRoom(page,pageSize,dataSize-recordLen)) {
+        return false;
+    }
+    //Shift towards the end of page
+    shiftRecord(page,pageSize,dataSize,slotNumber);
+    memcpy(page+*recordOffset,recordFormat.data(),dataSize);
+    return true;
+}
+
+/**
+Update of a record whose home slot "homeSlot" of "homePage" is a tombstone pointing at "movedTo". The record is
+updated where it is if it still fits there. Otherwise it goes back home if there is room, or to another page; in
+both cases its old copy is deleted and the home slot is fixed, so no second hop is ever created.
+**/
+RC RecordBasedFileManager::updateForwardedRecord(FileHandle &fileHandle, const std::vector<byte> &recordFormat, const RID &home, byte *homePage, const RID &movedTo) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    const unsigned dataSize = recordFormat.size();
+    byte movedPage[MAX_PAGE_SIZE];
+    RC rc = fileHandle.readPage(movedTo.pageNum,movedPage);
+    if(rc != 0)
+        return rc;
+
+    int movedOffset = *(int *)(movedPage+pageSize-2*(movedTo.slotNum+2)*sizeof(int));
+    int *movedLen = (int *)(movedPage+pageSize-(2*movedTo.slotNum+3)*sizeof(int));
+    if(movedOffset == -1)
+        return -1;
+    if(*movedLen == -1) {
+        //A chain left by an older version of the file: the home slot skips the middle hop, which is deleted, and the
+        //record is updated one hop away
+        RID next;
+        next.pageNum = *(unsigned *)(movedPage+movedOffset);
+        next.slotNum = *(unsigned *)(movedPage+movedOffset+sizeof(unsigned));
+        int homeOffset = *(int *)(homePage+pageSize-2*(home.slotNum+2)*sizeof(int));
+        *(unsigned *)(homePage+homeOffset) = next.pageNum;
+        *(unsigned *)(homePage+homeOffset+sizeof(unsigned)) = next.slotNum;
+        if((rc = fileHandle.writePage(home.pageNum,homePage)) != 0)
+            return rc;
+        freeSlot(movedPage,pageSize,movedTo.slotNum);
+        if((rc = fileHandle.writePage(movedTo.pageNum,movedPage)) != 0 || (rc = updateFreeSpaceMap(fileHandle, movedTo.pageNum, movedPage)) != 0)
+            return rc;
+        return updateForwardedRecord(fileHandle,recordFormat,home,homePage,next);
+    }
+
+    if(resizeRecord(movedPage,pageSize,recordFormat,movedTo.slotNum)) {
+        rc = fileHandle.writePage(movedTo.pageNum,movedPage);
+        return rc != 0 ? rc : updateFreeSpaceMap(fileHandle, movedTo.pageNum, movedPage);
+    }
+
+    int *homeOffset = (int *)(homePage+pageSize-2*(home.slotNum+2)*sizeof(int));
+    int *homeLen = (int *)(homePage+pageSize-(2*home.slotNum+3)*sizeof(int));
+
+    if(makeRoom(homePage,pageSize,dataSize > 2*sizeof(unsigned) ? dataSize-2*sizeof(unsigned) : 0)) {
+        //The record goes back home, the tombstone grows into it
+        *homeLen = 2*sizeof(unsigned);
+        shiftRecord(homePage,pageSize,dataSize,home.slotNum);
+        memcpy(homePage+*homeOffset,recordFormat.data(),dataSize);
     }
     else {
-        //Check if there is enough free space in this page for the augmentation
-        //If so, do not use tombstone
-        unsigned freeSpaceLeft = PAGE_SIZE-2*sizeof(unsigned)-2*sizeof(unsigned)*(*slotSize)-*freeSpace;
-
-        if(freeSpaceLeft >= dataSize-*recordLen){
-            //Shift towards the end of page
-            //cout<<"freeSpace enough: "<<cnt++<<endl;
-            shiftRecord(pageStart,dataSize,s);
-            memcpy(pageStart+*recordOffset,formattedData.data(),dataSize);
-        }else{
-            //Find free space for the update in another page, also use tombstone
-            //cout<<"freeSpace not enough: "<<cnt++<<endl;
-            unsigned pageNumber,slotNumber;
-            byte page[PAGE_SIZE];
-            unsigned upper = fileHandle.getNumberOfPages();
-
-            rc = readFirstFreePage(fileHandle,p+1 == upper?0:p+1,pageNumber,dataSize,page,slotNumber);
-            if(rc != 0)
-                return rc;
+        //Neither page has room: the record moves to a third one (readFirstFreePage() can't pick any of the two)
+        unsigned pageNumber,slotNumber;
+        byte page[MAX_PAGE_SIZE];
+        unsigned upper = fileHandle.getNumberOfPages();
+        rc = readFirstFreePage(fileHandle,movedTo.pageNum+1 == upper?0:movedTo.pageNum+1,pageNumber,dataSize,page,slotNumber);
+        if(rc != 0)
+            return rc;
+        rc = insertRecordOnPage(fileHandle,recordFormat,pageNumber,slotNumber,page);
+        if(rc != 0)
+            return rc;
+        *(unsigned *)(homePage+*homeOffset) = pageNumber;
+        *(unsigned *)(homePage+*homeOffset+sizeof(unsigned)) = slotNumber;
+    }
+
+    //The old copy is deleted once the home slot no longer points at it
+    rc = fileHandle.writePage(home.pageNum,homePage);
+    if(rc != 0 || (rc = updateFreeSpaceMap(fileHandle, home.pageNum, homePage)) != 0)
+        return rc;
+    freeSlot(movedPage,pageSize,movedTo.slotNum);
+    rc = fileHandle.writePage(movedTo.pageNum,movedPage);
+    return rc != 0 ? rc : updateFreeSpaceMap(fileHandle, movedTo.pageNum, movedPage);
+}
 
-            rc = insertRecordOnPage(fileHandle,formattedData,pageNumber,slotNumber,page);
-            if(rc != 0)
+/**
+Maintenance: every record that was moved away from its page by updateRecord() and fits on that page again (e.g. after
+deletions there) is copied back into its home slot, and its copy on the other page is deleted. Afterwards reading such
+a record takes a single page again. RIDs don't change. "reclaimed" is the number of records brought back.
+**/
+RC RecordBasedFileManager::reclaimForwardedRecords(FileHandle &fileHandle, unsigned &reclaimed) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    reclaimed = 0;
+    if(isPax(fileHandle)) {
+        return 0; //not done for PAX files, their updates only bring records back home
+    }
+    byte homePage[MAX_PAGE_SIZE];
+    byte movedPage[MAX_PAGE_SIZE];
+    for(unsigned p = 0 ; p < fileHandle.getNumberOfPages() ; ++p) {
+        if(isFreeSpaceMapPage(fileHandle, p)) {
+            continue;
+        }
+        RC rc = fileHandle.readPage(p,homePage);
+        if(rc != 0)
+            return rc;
+        unsigned slotSize = *(unsigned *)(homePage+pageSize-2*sizeof(unsigned));
+        bool changed = false;
+        for(unsigned s = 0 ; s < slotSize ; ++s) {
+            int *homeOffset = (int *)(homePage+pageSize-2*(s+2)*sizeof(int));
+            int *homeLen = (int *)(homePage+pageSize-(2*s+3)*sizeof(int));
+            if(*homeOffset == -1 || *homeLen != -1)
+                continue;
+            RID movedTo;
+            movedTo.pageNum = *(unsigned *)(homePage+*homeOffset);
+            movedTo.slotNum = *(unsigned *)(homePage+*homeOffset+sizeof(unsigned));
+            if(movedTo.pageNum == p)
+                continue;
+            if((rc = fileHandle.readPage(movedTo.pageNum,movedPage)) != 0)
+                return rc;
+            int movedOffset = *(int *)(movedPage+pageSize-2*(movedTo.slotNum+2)*sizeof(int));
+            int movedLen = *(int *)(movedPage+pageSize-(2*movedTo.slotNum+3)*sizeof(int));
+            if(movedOffset == -1 || movedLen == -1)
+                continue; //chains are left to updateRecord()
+
+            if(!makeRoom(homePage,pageSize,movedLen > 2*(int)sizeof(unsigned) ? movedLen-2*sizeof(unsigned) : 0))
+                continue;
+            *homeLen = 2*sizeof(unsigned);
+            shiftRecord(homePage,pageSize,movedLen,s);
+            memcpy(homePage+*homeOffset,movedPage+movedOffset,movedLen);
+            changed = true;
+
+            //The home page must be on disk before the only other copy goes away
+            if((rc = fileHandle.writePage(p,homePage)) != 0)
                 return rc;
+            freeSlot(movedPage,pageSize,movedTo.slotNum);
+            if((rc = fileHandle.writePage(movedTo.pageNum,movedPage)) != 0 || (rc = updateFreeSpaceMap(fileHandle, movedTo.pageNum, movedPage)) != 0)
+                return rc;
+            ++reclaimed;
+        }
+        if(changed && (rc = updateFreeSpaceMap(fileHandle, p, homePage)) != 0)
+            return rc;
+    }
+    return 0;
+}
 
-            //delete original record with the RID that points to the moved record
-            //Note: the length of the original record must be greater than 2*sizeof(unsigned)
-            shiftRecord(pageStart,2*sizeof(unsigned),s);
-            *(unsigned *)(pageStart+*recordOffset) = pageNumber;
-            *(unsigned *)(pageStart+*recordOffset+sizeof(unsigned)) = slotNumber;
+/**
+PAX files: the slot of a record stays the same until it is deleted, like in the row layout, but a PAX page holds a
+fixed number of slots, so a page with free bytes may still be full. The free-space map tells both, see
+PaxPage::category(). A tombstone points straight at the record, an update never forwards it twice.
+**/
+RC RecordBasedFileManager::insertPaxRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data, RID &rid) {
+    byte page[MAX_PAGE_SIZE];
+    unsigned pageNumber, slotNumber;
+    RC rc = readFirstFreePage(fileHandle, fileHandle.getNumberOfPages()-1, pageNumber, PaxPage::varBytes(recordDescriptor, data), page, slotNumber, &recordDescriptor);
+    if(rc != 0)
+        return rc;
+    PaxPage(page, fileHandle.getPageSize(), recordDescriptor).put(slotNumber, data);
+    rc = writePaxPage(fileHandle, pageNumber, page, recordDescriptor);
+    if(rc != 0)
+        return rc;
+    rid.pageNum = pageNumber;
+    rid.slotNum = slotNumber;
+    ZoneMap *zoneMap = zoneMapOf(fileHandle, recordDescriptor);
+    return zoneMap == NULL ? 0 : zoneMap->widen(pageNumber, data);
+}
+
+//Like readRecord(), or filterAttributes() when "attributesToExtract" is given
+RC RecordBasedFileManager::readPaxRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, void *data, const std::vector<unsigned> *attributesToExtract) {
+    if(rid.pageNum >= fileHandle.getNumberOfPages() || isFreeSpaceMapPage(fileHandle, rid.pageNum))
+        return -1;
+    byte *page;
+    RC rc = fileHandle.pinPage(rid.pageNum, page);
+    if(rc != 0)
+        return rc;
+    PaxPage paxPage(page, fileHandle.getPageSize(), recordDescriptor);
+    if(rid.slotNum >= paxPage.getSlotCount() || paxPage.getState(rid.slotNum) == PAX_FREE_SLOT) {
+        fileHandle.unpinPage(rid.pageNum, false);
+        return -1;
+    }
+    if(paxPage.getState(rid.slotNum) == PAX_TOMBSTONE) {
+        RID movedTo = paxPage.forward(rid.slotNum);
+        fileHandle.unpinPage(rid.pageNum, false);
+        return readPaxRecord(fileHandle, recordDescriptor, movedTo, data, attributesToExtract);
+    }
+    if(attributesToExtract != NULL)
+        paxPage.project(rid.slotNum, *attributesToExtract, data);
+    else
+        paxPage.project(rid.slotNum, data);
+    return fileHandle.unpinPage(rid.pageNum, false);
+}
+
+RC RecordBasedFileManager::updatePaxRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data, const RID &rid) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    const unsigned varBytes = PaxPage::varBytes(recordDescriptor, data);
+    if(rid.pageNum >= fileHandle.getNumberOfPages() || isFreeSpaceMapPage(fileHandle, rid.pageNum))
+        return -1;
+    byte homePage[MAX_PAGE_SIZE];
+    RC rc = fileHandle.readPage(rid.pageNum, homePage);
+    if(rc != 0)
+        return rc;
+    PaxPage home(homePage, pageSize, recordDescriptor);
+    if(rid.slotNum >= home.getSlotCount() || home.getState(rid.slotNum) == PAX_FREE_SLOT)
+        return -1;
 
-            //set length field to -1 as a indicator that this slot is a tombstone
-            *recordLen = -1;
+    //Stores the record on a page with room for it other than "after" and the home page, searching from "after" on
+    auto moveAway = [&](unsigned after, RID &movedTo) {
+        byte page[MAX_PAGE_SIZE];
+        unsigned upper = fileHandle.getNumberOfPages();
+        RC rc = readFirstFreePage(fileHandle, after+1 == upper ? 0 : after+1, movedTo.pageNum, varBytes, page, movedTo.slotNum, &recordDescriptor);
+        if(rc != 0)
+            return rc;
+        PaxPage(page, pageSize, recordDescriptor).put(movedTo.slotNum, data, PAX_MOVED);
+        return writePaxPage(fileHandle, movedTo.pageNum, page, recordDescriptor);
+    };
+
+    if(home.holdsRecord(rid.slotNum)) {
+        if(home.hasRoom(rid.slotNum, varBytes)) {
+            home.put(rid.slotNum, data, home.getState(rid.slotNum));
+        }
+        else {
+            RID movedTo;
+            if((rc = moveAway(rid.pageNum, movedTo)) != 0)
+                return rc;
+            home.setTombstone(rid.slotNum, movedTo);
         }
+        return writePaxPage(fileHandle, rid.pageNum, homePage, recordDescriptor);
     }
-    return fileHandle.writePage(p,pageStart);
+
+    RID movedTo = home.forward(rid.slotNum);
+    byte movedPage[MAX_PAGE_SIZE];
+    if((rc = fileHandle.readPage(movedTo.pageNum, movedPage)) != 0)
+        return rc;
+    PaxPage moved(movedPage, pageSize, recordDescriptor);
+    if(movedTo.slotNum >= moved.getSlotCount() || !moved.holdsRecord(movedTo.slotNum))
+        return -1;
+    if(moved.hasRoom(movedTo.slotNum, varBytes)) {
+        moved.put(movedTo.slotNum, data, PAX_MOVED);
+        return writePaxPage(fileHandle, movedTo.pageNum, movedPage, recordDescriptor);
+    }
+    //The record goes back home if there is room, otherwise to a third page; the old copy goes away afterwards
+    if(home.hasRoom(rid.slotNum, varBytes)) {
+        home.put(rid.slotNum, data);
+    }
+    else {
+        RID newPlace;
+        if((rc = moveAway(movedTo.pageNum, newPlace)) != 0)
+            return rc;
+        home.setTombstone(rid.slotNum, newPlace);
+    }
+    if((rc = writePaxPage(fileHandle, rid.pageNum, homePage, recordDescriptor)) != 0)
+        return rc;
+    moved.erase(movedTo.slotNum);
+    return writePaxPage(fileHandle, movedTo.pageNum, movedPage, recordDescriptor);
+}
+
+RC RecordBasedFileManager::deletePaxRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid) {
+    if(rid.pageNum >= fileHandle.getNumberOfPages() || isFreeSpaceMapPage(fileHandle, rid.pageNum))
+        return -1;
+    byte page[MAX_PAGE_SIZE];
+    RC rc = fileHandle.readPage(rid.pageNum, page);
+    if(rc != 0)
+        return rc;
+    PaxPage paxPage(page, fileHandle.getPageSize(), recordDescriptor);
+    if(rid.slotNum >= paxPage.getSlotCount() || paxPage.getState(rid.slotNum) == PAX_FREE_SLOT)
+        return -1; //trying to delete a deleted record
+    if(paxPage.getState(rid.slotNum) == PAX_TOMBSTONE && (rc = deletePaxRecord(fileHandle, recordDescriptor, paxPage.forward(rid.slotNum))) != 0)
+        return rc;
+    paxPage.erase(rid.slotNum);
+    return writePaxPage(fileHandle, rid.pageNum, page, recordDescriptor);
+}
+
+RC RecordBasedFileManager::writePaxPage(FileHandle &fileHandle, const unsigned pageNumber, byte *page, const Schema &recordDescriptor) {
+    RC rc = fileHandle.writePage(pageNumber, page);
+    return rc != 0 ? rc : setFreeSpaceCategory(fileHandle, pageNumber, PaxPage(page, fileHandle.getPageSize(), recordDescriptor).category());
 }
 
 /**
 Important Note: This is readRecord lookalike, it extracts only the column names with the indices listed in "attributesToExtract" vector.
 **/
-RC RecordBasedFileManager::filterAttributes(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const RID &rid, void *data, const std::vector<unsigned> &attributesToExtract) {
+RC RecordBasedFileManager::filterAttributes(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, void *data, const std::vector<unsigned> &attributesToExtract) {
     if(attributesToExtract.empty()) { //just as precaution
         return 0;
     }
 
-    byte page[PAGE_SIZE];
-    RC rcode = fileHandle.readPage(rid.pageNum, page);
+    byte buffer[MAX_PAGE_SIZE];
+    const byte *page;
+    RC rcode = fileHandle.accessPage(rid.pageNum, page, buffer);
     if(rcode != 0) {
         return rcode;
     }
+    return filterAttributes(fileHandle, page, recordDescriptor, rid, data, attributesToExtract);
+}
 
-    int fieldOffsetsLocation = *reinterpret_cast<int*>(page + PAGE_SIZE - sizeof(unsigned)*4 - rid.slotNum*sizeof(unsigned)*2);
-    if(fieldOffsetsLocation == -1)
-        return -1;
-
-    int recordLen = *(int *)(page + PAGE_SIZE - sizeof(unsigned)*3 - rid.slotNum*sizeof(unsigned)*2);
-    if(recordLen == -1){
-        RID cur;
-        cur.pageNum = *(unsigned *)(page + fieldOffsetsLocation);
-        cur.slotNum = *(unsigned *)(page + fieldOffsetsLocation + sizeof(unsigned));
-        return filterAttributes(fileHandle,recordDescriptor,cur,data, attributesToExtract);
+RC RecordBasedFileManager::filterAttributes(FileHandle &fileHandle, const byte *page, const Schema &recordDescriptor, const RID &rid, void *data, const std::vector<unsigned> &attributesToExtract) {
+    if(attributesToExtract.empty()) {
+        return 0;
     }
 
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(attributesToExtract.size()/8.0));
-    std::vector<byte> readData(nullInfoFieldLength, 0);
-
-    for(unsigned i = 0 ; i < attributesToExtract.size() ; ++i) {
-        unsigned attrInd = attributesToExtract[i];
-        unsigned *fieldOffsets = reinterpret_cast<unsigned*>(page+fieldOffsetsLocation) + attrInd;
-
-        if(*fieldOffsets == *(fieldOffsets+1)) {
-            unsigned byteInNullInfoField = i/8;
-            readData[byteInNullInfoField] |= (1 << 7-i%8);
-        }
-        else {
-            if(recordDescriptor[attrInd].type == AttrType::TypeInt || recordDescriptor[attrInd].type == AttrType::TypeReal) {
-                byte* beginningOfRecord = page + fieldOffsetsLocation + (recordDescriptor.size()+1)*sizeof(unsigned) + *fieldOffsets;
-                readData.insert(readData.end(), beginningOfRecord, beginningOfRecord + recordDescriptor[attrInd].length);
-            }
-            else { //recordDescriptor[attrInd].type == AttrType::TypeVarChar
-                byte* beginningOfStrLength = page + fieldOffsetsLocation + (recordDescriptor.size()+1)*sizeof(unsigned) + *fieldOffsets;
-                byte* beginningOfStrContent = beginningOfStrLength + sizeof(unsigned);
-                readData.insert(readData.end(), beginningOfStrLength, beginningOfStrContent);
-                readData.insert(readData.end(), beginningOfStrContent, beginningOfStrContent + *reinterpret_cast<unsigned*>(beginningOfStrLength));
-            }
-        }
-    }
-    memcpy(data, readData.data(), readData.size());
+    RecordView view;
+    RID movedTo;
+    if(viewRecord(page, fileHandle.getPageSize(), rid.slotNum, recordDescriptor.size(), view, movedTo) != 0)
+        return -1;
+    if(!view.isValid())
+        return filterAttributes(fileHandle,recordDescriptor,movedTo,data, attributesToExtract);
+    view.project(recordDescriptor, attributesToExtract, data);
     return 0;
 }
 
 //The actual data in *data is also prefixed with a null byte, just as in format used in the other RecordBasedFileManager's methods
-RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor,
+RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const Schema &recordDescriptor,
     const RID &rid, const std::string &attributeName, void *data) {
-    unsigned attributeIndex = -1;
-    for(int i = 0 ; i < recordDescriptor.size() ; ++i) {
-        if(recordDescriptor[i].name == attributeName) {
-            attributeIndex = i;
-            break;
-        }
-    }
+    int attributeIndex = recordDescriptor.indexOf(attributeName);
     if(attributeIndex == -1) {
         return -1;
     }
+    if(isPax(fileHandle)) {
+        std::vector<unsigned> attributesToExtract(1, attributeIndex);
+        return readPaxRecord(fileHandle, recordDescriptor, rid, data, &attributesToExtract);
+    }
     return filterAttributes(fileHandle, recordDescriptor, rid, data, std::vector<unsigned>(1, attributeIndex));
 }
 
@@ -517,41 +1455,143 @@ RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const std::vect
 //I only introduced setters/getters in order not to declare friendship between classes. We're not supposed to invoke
 //RBFM_ScanIterator's setter classes on their own, because at the end of our changes we should also invoke RBFM_ScanIterator::fillAttrIndices(), like here
 RC RecordBasedFileManager::scan(FileHandle &fileHandle,
-                                const std::vector<Attribute> &recordDescriptor,
+                                const Schema &recordDescriptor,
                                 const std::string &conditionAttribute,
                                 const CompOp compOp,
                                 const void *value,
                                 const std::vector<std::string> &attributeNames,
                                 RBFM_ScanIterator &rbfm_ScanIterator) {
+    std::vector<ScanPredicate> predicates;
+    if(compOp != CompOp::NO_OP) {
+        predicates.push_back(ScanPredicate{conditionAttribute, compOp, value});
+    }
+    return scan(fileHandle, recordDescriptor, predicates, attributeNames, rbfm_ScanIterator);
+}
+
+RC RecordBasedFileManager::scan(FileHandle &fileHandle,
+                                const Schema &recordDescriptor,
+                                const std::vector<ScanPredicate> &predicates,
+                                const std::vector<std::string> &attributeNames,
+                                RBFM_ScanIterator &rbfm_ScanIterator) {
     rbfm_ScanIterator.setFileHandle(fileHandle);
+    //A scan over a mapped file walks the pages in order, let the kernel read ahead
+    if(fileHandle.mappedReads) {
+        rbfm_ScanIterator.getFileHandle().setMappedReads(true, true);
+    }
+    //otherwise prefetch the heap pages into the buffer pool ahead of the iterator
+    rbfm_ScanIterator.getFileHandle().readAhead.setSequential(true);
     rbfm_ScanIterator.setRecordDescriptor(recordDescriptor);
-    rbfm_ScanIterator.setConditionAttribute(conditionAttribute);
-    rbfm_ScanIterator.setCompOp(compOp);
-    rbfm_ScanIterator.setValue(value);
     rbfm_ScanIterator.setCurrRID();
 
-    //some preprocessing
-    std::map<string,unsigned> namesToPos;
-    for(int i = 0 ; i < recordDescriptor.size() ; ++i) {
-        namesToPos[recordDescriptor[i].name] = i;
-        if (recordDescriptor[i].name == conditionAttribute) {
-            rbfm_ScanIterator.setAttrForCompInd(i);
+    std::vector<ScanCondition> conditions;
+    resolvePredicates(recordDescriptor, predicates, conditions);
+    rbfm_ScanIterator.setConditions(conditions);
+    //Only the int/real conditions can skip pages, the zone map isn't even opened without one
+    std::shared_ptr<ZoneMap> zoneMap;
+    for(unsigned i = 0 ; i < conditions.size() && !zoneMap ; ++i) {
+        if(conditions[i].field < recordDescriptor.size() && conditions[i].type != TypeVarChar) {
+            zoneMap = std::make_shared<ZoneMap>();
         }
     }
+    if(zoneMap && zoneMap->open(fileHandle, recordDescriptor) != 0) {
+        zoneMap.reset();
+    }
+    rbfm_ScanIterator.setZoneMap(zoneMap);
+
+    //A projected attribute the descriptor doesn't have fails the scan
     for(int i = 0 ; i < attributeNames.size() ; ++i) {
-        rbfm_ScanIterator.getAttrToExtractInd().push_back(namesToPos[attributeNames[i]]);
+        int index = recordDescriptor.indexOf(attributeNames[i]);
+        if(index == -1) {
+            return -1;
+        }
+        rbfm_ScanIterator.getAttrToExtractInd().push_back(index);
     }
 
     return 0;
 }
 
+RC RecordBasedFileManager::parallelScan(FileHandle &fileHandle,
+                                        const Schema &recordDescriptor,
+                                        const std::vector<ScanPredicate> &predicates,
+                                        const std::vector<std::string> &attributeNames,
+                                        unsigned workers,
+                                        RBFM_ParallelScanIterator &rbfm_ParallelScanIterator) {
+    RC rc = scan(fileHandle, recordDescriptor, predicates, attributeNames, rbfm_ParallelScanIterator.getScanIterator());
+    return rc != 0 ? rc : rbfm_ParallelScanIterator.open(workers);
+}
+
+void RecordBasedFileManager::resolvePredicates(const Schema &recordDescriptor, const std::vector<ScanPredicate> &predicates, std::vector<ScanCondition> &conditions) {
+    conditions.clear();
+    for(unsigned i = 0 ; i < predicates.size() ; ++i) {
+        if(predicates[i].compOp == CompOp::NO_OP) { //holds for every record, NULLs included
+            continue;
+        }
+        ScanCondition condition;
+        int index = recordDescriptor.indexOf(predicates[i].attribute);
+        condition.field = index == -1 ? recordDescriptor.size() : index; //stays out of range if there is no such attribute
+        condition.type = index == -1 ? TypeInt : recordDescriptor.getType(index);
+        condition.compOp = predicates[i].compOp;
+        condition.value = predicates[i].value;
+        conditions.push_back(condition);
+    }
+    //Without statistics: numbers are cheaper to compare than strings, and equality is the most selective operator
+    std::stable_sort(conditions.begin(), conditions.end(), [&recordDescriptor](const ScanCondition &a, const ScanCondition &b) {
+        return conditionRank(a, recordDescriptor.size()) < conditionRank(b, recordDescriptor.size());
+    });
+}
+
+//Evaluation order of the conditions of a scan; a condition on a missing attribute comes first as it fails the scan
+unsigned RecordBasedFileManager::conditionRank(const ScanCondition &condition, unsigned fieldCount) {
+    if(condition.field >= fieldCount) {
+        return 0;
+    }
+    unsigned selectivity = condition.compOp == CompOp::EQ_OP ? 0 : (condition.compOp == CompOp::NE_OP ? 2 : 1);
+    return 1 + (condition.type == TypeVarChar ? 3 : 0) + selectivity;
+}
+
+bool RBFM_ScanIterator::skipsPage(PageNum pageNum) const {
+    return zoneMap && !zoneMap->mayMatch(pageNum, conditions);
+}
+
 /**
 This function go through all the records in the file pointed by 'fileHandle', find the records that satisfy filter condition,
 then extract fields referred by 'conditionAttribute' from these records.
 **/
 RC RBFM_ScanIterator::getNextRecord(RID &rid, void *data) {
-    byte record[PAGE_SIZE]; //we have to read the attribute for comparison into an array of a page size
-                            //because in case of a string attribute, it would be hard to predict its size
+    RecordView view;
+    if(RecordBasedFileManager::isPax(fileHandle)) {
+        return nextPaxRecord(rid, attrToExtractInd.empty() ? NULL : data, NULL);
+    }
+    RC rc = getNextRecordView(rid, view);
+    if(rc != 0) {
+        return rc;
+    }
+    if(!attrToExtractInd.empty()) {
+        view.project(recordDescriptor, attrToExtractInd, data);
+    }
+    return 0;
+}
+
+//Moves currRID to the next record from there on, and keeps where its page is
+RC RBFM_ScanIterator::moveToNextRecord() {
+    const byte *scanned = scannedPage();
+    RC rc = RecordBasedFileManager::instance().moveToNextAvailableRecord(fileHandle, currRID, page.data(), scanned, bufferedPage, this);
+    mappedPage = scanned != page.data() ? scanned : NULL;
+    return rc;
+}
+
+RC RBFM_ScanIterator::getNextRecordView(RID &rid, RecordView &view) {
+    //The slot directory is walked and the records are read in place in the current page (a copy, or the page inside
+    //the file mapping with mapped reads), so the file is only accessed once per page. A tombstone is the exception:
+    //its record is read from the page it moved to.
+    const unsigned pageSize = fileHandle.getPageSize();
+    if(RecordBasedFileManager::isPax(fileHandle)) {
+        return nextPaxRecord(rid, NULL, &view);
+    }
+    if(page.size() < pageSize) {
+        page.resize(pageSize);
+        movedPage.resize(pageSize);
+    }
 
     //Throughout the function, we keep iterating over RIDs and keep the most current one in currRID.
     //At the end of the function, we copy its members (page number and slot number) into "rid" parameter.
@@ -559,61 +1599,394 @@ RC RBFM_ScanIterator::getNextRecord(RID &rid, void *data) {
     //read next record in the file (if there is any)
 
     for( ; true ; ++currRID.slotNum) { //iterate over table till we find next record satisfying the condition
-        //cout << "Beginning of getNextRecord's for loop, currRID.slotNum=" << currRID.slotNum <<", currRID.pageNum=" << currRID.pageNum << "\n";
-        if(RecordBasedFileManager::instance().moveToNextAvailableRecord(fileHandle, currRID) == RBFM_EOF) {
-            //cout << "\tReturn EOF\n";
+        if(moveToNextRecord() == RBFM_EOF) {
             return RBFM_EOF;
         }
-        if(compOp == CompOp::NO_OP) { //TA said: "NO_OP simply returns all types including NULL"
-            break;
+        //The int/real conditions are checked for all the records of a page at once, on a new page
+        if(vectorConditions > 0) {
+            if(selectedPage != bufferedPage) {
+                selectRecords();
+            }
+            if(!(selection[currRID.slotNum/64] >> currRID.slotNum%64 & 1)) {
+                currRID.slotNum = nextSelected(currRID.slotNum) - 1; //the loop moves on to it
+                continue;
+            }
+        }
+        RID movedTo;
+        if(RecordBasedFileManager::viewRecord(scannedPage(), pageSize, currRID.slotNum, recordDescriptor.size(), view, movedTo) != 0) {
+            return -1;
+        }
+        unsigned checkedConditions = view.isValid() ? vectorConditions : 0; //a tombstone's record is checked here
+        while(!view.isValid()) { //tombstone
+            const byte *moved;
+            if(fileHandle.accessPage(movedTo.pageNum, moved, movedPage.data()) != 0) {
+                return -1;
+            }
+            if(RecordBasedFileManager::viewRecord(moved, pageSize, movedTo.slotNum, recordDescriptor.size(), view, movedTo) != 0) {
+                return -1;
+            }
         }
 
-        RC rc = RecordBasedFileManager::instance().readAttribute(fileHandle, recordDescriptor, currRID, conditionAttribute, record);
-        if(rc != 0) {
-            return rc;
+        //The record is still in the page copy: one that fails a condition is never copied out
+        bool satisfied;
+        if(satisfiesConditions(view, checkedConditions, satisfied) != 0) {
+            return -1;
         }
-        if(record[0] != 0) { //some bit is set in the null info field
-            continue;   //we couldn't use NULL field in comparisons
+        if(satisfied) {
+            break;
         }
+    }
+    rid.slotNum = currRID.slotNum;
+    rid.pageNum = currRID.pageNum;
+    ++currRID.slotNum;
+    return 0;
+}
 
-        if(recordDescriptor[attrForCompInd].type == AttrType::TypeInt) {
-            //cout << "\tThe issue is in TypeInt\n";
-            if(performCompOp(*reinterpret_cast<const int*>(value), *reinterpret_cast<int*>(record+1))) {
-                //cout << "\tpassed int test\n";
-                break;
-            }
+/**
+The scan of a PAX file. The conditions and the projection read the minipages of their fields only: a record is
+projected into "data" straight from them. The record is only rebuilt in the row layout when a "view" is asked for.
+**/
+RC RBFM_ScanIterator::nextPaxRecord(RID &rid, void *data, RecordView *view) {
+    const unsigned pageSize = fileHandle.getPageSize();
+    if(page.size() < pageSize) {
+        page.resize(pageSize);
+        movedPage.resize(pageSize);
+    }
+    PaxPage current(const_cast<byte *>(scannedPage()), pageSize, recordDescriptor);
+    PageNum currentPage = bufferedPage;
+    PaxPage moved(movedPage.data(), pageSize, recordDescriptor);
+    const PaxPage *record;
+    unsigned recordSlot;
+
+    for( ; true ; ++currRID.slotNum) {
+        if(moveToNextRecord() == RBFM_EOF) {
+            return RBFM_EOF;
         }
-        else if(recordDescriptor[attrForCompInd].type == AttrType::TypeReal) {
-            //cout << "\tThe issue is in TypeReal\n";
-            if(performCompOp(*reinterpret_cast<const float*>(value), *reinterpret_cast<float*>(record+1))) {
-                //cout << "\tpassed float test\n";
-                break;
+        if(currentPage != bufferedPage) {
+            current.reset(const_cast<byte *>(scannedPage()));
+            currentPage = bufferedPage;
+        }
+        if(vectorConditions > 0) {
+            if(selectedPage != bufferedPage) {
+                selectPaxRecords();
+            }
+            if(!(selection[currRID.slotNum/64] >> currRID.slotNum%64 & 1)) {
+                currRID.slotNum = nextSelected(currRID.slotNum) - 1;
+                continue;
             }
         }
-        else { //recordDescriptor[attrForCompInd].type == AttrType::TypeVarChar
-            //cout << "\tThe issue is in TypeVarChar\n";
-            unsigned* recordLen = reinterpret_cast<unsigned *>(record+1);
-            char* recordCont = reinterpret_cast<char*>(record+1+sizeof(unsigned));
-            const unsigned* valueLen = reinterpret_cast<const unsigned*>(value);
-            const char* valueCont = reinterpret_cast<const char*>(reinterpret_cast<const byte*>(value)+sizeof(unsigned));
-            if(performCompOp(string(valueCont, *valueLen), string(recordCont, *recordLen))) {
-                //cout << "\tpassed string test\n";
-                break;
+        record = &current;
+        recordSlot = currRID.slotNum;
+        unsigned checkedConditions = vectorConditions;
+        if(current.getState(currRID.slotNum) == PAX_TOMBSTONE) {
+            RID movedTo = current.forward(currRID.slotNum);
+            const byte *movedData;
+            if(fileHandle.accessPage(movedTo.pageNum, movedData, movedPage.data()) != 0) {
+                return -1;
             }
+            moved.reset(const_cast<byte *>(movedData));
+            if(movedTo.slotNum >= moved.getSlotCount() || !moved.holdsRecord(movedTo.slotNum)) {
+                return -1;
+            }
+            record = &moved;
+            recordSlot = movedTo.slotNum;
+            checkedConditions = 0;
+        }
+
+        bool satisfied;
+        if(satisfiesConditions(*record, recordSlot, checkedConditions, satisfied) != 0) {
+            return -1;
+        }
+        if(satisfied) {
+            break;
         }
     }
-    //cout << "\tBefore filtering away attributes\n";
-    RC rc = RecordBasedFileManager::instance().filterAttributes(fileHandle, recordDescriptor, currRID, data, attrToExtractInd);
-    if(rc != 0) {
-        return rc;
+    if(data != NULL) {
+        record->project(recordSlot, attrToExtractInd, data);
+    }
+    if(view != NULL) {
+        record->toRecordFormat(recordSlot, recordFormat);
+        *view = RecordView(recordFormat.data(), recordDescriptor.size());
     }
-    //cout << "End of getNextRecord, currRID.slotNum=" << currRID.slotNum << ", currRID.pageNum=" << currRID.pageNum <<"\n";
     rid.slotNum = currRID.slotNum;
     rid.pageNum = currRID.pageNum;
     ++currRID.slotNum;
     return 0;
 }
 
+/**
+Selection kernels: bit i of "bits" is set when "values[i] compOp value" holds (the record's value on the left, as in
+performCompOp()). They overwrite whole words, count may be anything. SSE2 handles 4 values per compare, AVX2 8 of
+them when the CPU has it; the scalar loop does the rest and is the only one on other architectures or for NO_OP.
+**/
+static SelectionKernel selectionKernel = AVX2_SELECTION;
+
+void setSelectionKernel(SelectionKernel kernel) {
+    selectionKernel = kernel;
+}
+
+template <typename T>
+static void selectScalar(const T *values, unsigned begin, unsigned count, CompOp compOp, T value, uint64_t *bits) {
+    for(unsigned i = begin ; i < count ; ++i) {
+        if(RBFM_ScanIterator::performCompOp(compOp, value, values[i])) {
+            bits[i/64] |= uint64_t(1) << i%64;
+        }
+    }
+}
+
+#ifdef RBFM_SIMD
+//Comparisons SSE2 doesn't have are negations of the ones it has
+static bool negatedInSSE(CompOp compOp) {
+    return compOp == CompOp::LE_OP || compOp == CompOp::GE_OP || compOp == CompOp::NE_OP;
+}
+
+static unsigned selectIntsSSE(const int *values, unsigned count, CompOp compOp, int value, uint64_t *bits) {
+    const __m128i operand = _mm_set1_epi32(value);
+    const unsigned invert = negatedInSSE(compOp) ? 0xF : 0;
+    unsigned i = 0;
+    for( ; i+4 <= count ; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values+i));
+        __m128i cmp;
+        if(compOp == CompOp::EQ_OP || compOp == CompOp::NE_OP) cmp = _mm_cmpeq_epi32(v, operand);
+        else if(compOp == CompOp::LT_OP || compOp == CompOp::GE_OP) cmp = _mm_cmplt_epi32(v, operand);
+        else cmp = _mm_cmpgt_epi32(v, operand);
+        uint64_t mask = _mm_movemask_ps(_mm_castsi128_ps(cmp)) ^ invert;
+        bits[i/64] |= mask << i%64;
+    }
+    return i;
+}
+
+static unsigned selectRealsSSE(const float *values, unsigned count, CompOp compOp, float value, uint64_t *bits) {
+    const __m128 operand = _mm_set1_ps(value);
+    unsigned i = 0;
+    for( ; i+4 <= count ; i += 4) {
+        __m128 v = _mm_loadu_ps(values+i);
+        __m128 cmp;
+        switch(compOp) {
+            case CompOp::EQ_OP: cmp = _mm_cmpeq_ps(v, operand); break;
+            case CompOp::LT_OP: cmp = _mm_cmplt_ps(v, operand); break;
+            case CompOp::LE_OP: cmp = _mm_cmple_ps(v, operand); break;
+            case CompOp::GT_OP: cmp = _mm_cmpgt_ps(v, operand); break;
+            case CompOp::GE_OP: cmp = _mm_cmpge_ps(v, operand); break;
+            default: cmp = _mm_cmpneq_ps(v, operand); break;
+        }
+        uint64_t mask = _mm_movemask_ps(cmp);
+        bits[i/64] |= mask << i%64;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static unsigned selectIntsAVX2(const int *values, unsigned count, CompOp compOp, int value, uint64_t *bits) {
+    const __m256i operand = _mm256_set1_epi32(value);
+    const unsigned invert = negatedInSSE(compOp) ? 0xFF : 0;
+    unsigned i = 0;
+    for( ; i+8 <= count ; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values+i));
+        __m256i cmp;
+        if(compOp == CompOp::EQ_OP || compOp == CompOp::NE_OP) cmp = _mm256_cmpeq_epi32(v, operand);
+        else if(compOp == CompOp::LT_OP || compOp == CompOp::GE_OP) cmp = _mm256_cmpgt_epi32(operand, v);
+        else cmp = _mm256_cmpgt_epi32(v, operand);
+        uint64_t mask = _mm256_movemask_ps(_mm256_castsi256_ps(cmp)) ^ invert;
+        bits[i/64] |= mask << i%64;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static unsigned selectRealsAVX2(const float *values, unsigned count, CompOp compOp, float value, uint64_t *bits) {
+    const __m256 operand = _mm256_set1_ps(value);
+    unsigned i = 0;
+    for( ; i+8 <= count ; i += 8) {
+        __m256 v = _mm256_loadu_ps(values+i);
+        __m256 cmp;
+        switch(compOp) {
+            case CompOp::EQ_OP: cmp = _mm256_cmp_ps(v, operand, _CMP_EQ_OQ); break;
+            case CompOp::LT_OP: cmp = _mm256_cmp_ps(v, operand, _CMP_LT_OQ); break;
+            case CompOp::LE_OP: cmp = _mm256_cmp_ps(v, operand, _CMP_LE_OQ); break;
+            case CompOp::GT_OP: cmp = _mm256_cmp_ps(v, operand, _CMP_GT_OQ); break;
+            case CompOp::GE_OP: cmp = _mm256_cmp_ps(v, operand, _CMP_GE_OQ); break;
+            default: cmp = _mm256_cmp_ps(v, operand, _CMP_NEQ_UQ); break;
+        }
+        uint64_t mask = _mm256_movemask_ps(cmp);
+        bits[i/64] |= mask << i%64;
+    }
+    return i;
+}
+
+static bool hasAVX2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+#endif
+
+void selectInts(const int *values, unsigned count, CompOp compOp, int value, uint64_t *bits) {
+    memset(bits, 0, (count+63)/64*sizeof(uint64_t));
+    unsigned done = 0;
+#ifdef RBFM_SIMD
+    if(compOp != CompOp::NO_OP && selectionKernel != SCALAR_SELECTION) {
+        done = selectionKernel == AVX2_SELECTION && hasAVX2() ? selectIntsAVX2(values, count, compOp, value, bits)
+                                                              : selectIntsSSE(values, count, compOp, value, bits);
+    }
+#endif
+    selectScalar(values, done, count, compOp, value, bits);
+}
+
+void selectReals(const float *values, unsigned count, CompOp compOp, float value, uint64_t *bits) {
+    memset(bits, 0, (count+63)/64*sizeof(uint64_t));
+    unsigned done = 0;
+#ifdef RBFM_SIMD
+    if(compOp != CompOp::NO_OP && selectionKernel != SCALAR_SELECTION) {
+        done = selectionKernel == AVX2_SELECTION && hasAVX2() ? selectRealsAVX2(values, count, compOp, value, bits)
+                                                              : selectRealsSSE(values, count, compOp, value, bits);
+    }
+#endif
+    selectScalar(values, done, count, compOp, value, bits);
+}
+
+/**
+Computes "selection" for the page being scanned: the field of each int/real condition is gathered for all the slots
+into a column, the kernels compare the column with the condition's value, and the results are and-ed. Deleted
+slots and NULL fields are cleared, tombstones are kept as their records are elsewhere.
+**/
+void RBFM_ScanIterator::selectRecords() {
+    const unsigned pageSize = fileHandle.getPageSize();
+    const unsigned fieldCount = recordDescriptor.size();
+    const unsigned slotCount = *reinterpret_cast<const unsigned *>(scannedPage() + pageSize - sizeof(unsigned)*2);
+    const unsigned words = (slotCount+63)/64;
+    selection.assign(words, 0);
+    tombstones.assign(words, 0);
+    passed.resize(words);
+    recordOffsets.resize(slotCount);
+    intColumn.resize(slotCount);
+    realColumn.resize(slotCount);
+
+    for(unsigned s = 0 ; s < slotCount ; ++s) {
+        int offset, length;
+        memcpy(&offset, scannedPage() + pageSize - sizeof(unsigned)*4 - s*sizeof(unsigned)*2, sizeof(int));
+        memcpy(&length, scannedPage() + pageSize - sizeof(unsigned)*3 - s*sizeof(unsigned)*2, sizeof(int));
+        recordOffsets[s] = UINT_MAX;
+        if(offset == -1) {
+            continue;
+        }
+        if(length == -1) {
+            tombstones[s/64] |= uint64_t(1) << s%64;
+            continue;
+        }
+        recordOffsets[s] = offset;
+        selection[s/64] |= uint64_t(1) << s%64;
+    }
+
+    const bool compact = RecordBasedFileManager::hasCompactRecords(scannedPage());
+    for(unsigned c = 0 ; c < vectorConditions ; ++c) {
+        const ScanCondition &condition = conditions[c];
+        for(unsigned s = 0 ; s < slotCount ; ++s) {
+            intColumn[s] = 0;
+            realColumn[s] = 0;
+            if(recordOffsets[s] == UINT_MAX) {
+                continue;
+            }
+            const RecordView record(scannedPage() + recordOffsets[s], fieldCount, compact);
+            if(record.isNull(condition.field)) { //NULL never passes a comparison
+                selection[s/64] &= ~(uint64_t(1) << s%64);
+                continue;
+            }
+            unsigned length;
+            const byte *field = record.getField(condition.field, length);
+            if(condition.type == TypeInt) {
+                memcpy(&intColumn[s], field, sizeof(int));
+            }
+            else {
+                memcpy(&realColumn[s], field, sizeof(float));
+            }
+        }
+        if(condition.type == TypeInt) {
+            int value;
+            memcpy(&value, condition.value, sizeof(int));
+            selectInts(intColumn.data(), slotCount, condition.compOp, value, passed.data());
+        }
+        else {
+            float value;
+            memcpy(&value, condition.value, sizeof(float));
+            selectReals(realColumn.data(), slotCount, condition.compOp, value, passed.data());
+        }
+        for(unsigned w = 0 ; w < words ; ++w) {
+            selection[w] &= passed[w];
+        }
+    }
+    for(unsigned w = 0 ; w < words ; ++w) {
+        selection[w] |= tombstones[w];
+    }
+    selectedPage = bufferedPage;
+    selectedSlots = slotCount;
+}
+
+//selectRecords() for a PAX page: the minipage of an int/real field is already a column
+void RBFM_ScanIterator::selectPaxRecords() {
+    PaxPage paxPage(const_cast<byte *>(scannedPage()), fileHandle.getPageSize(), recordDescriptor);
+    const unsigned slotCount = paxPage.getSlotCount();
+    const unsigned words = (slotCount+63)/64;
+    selection.assign(words, 0);
+    tombstones.assign(words, 0);
+    passed.resize(words);
+    intColumn.resize(slotCount);
+    realColumn.resize(slotCount);
+
+    for(unsigned s = 0 ; s < slotCount ; ++s) {
+        if(paxPage.getState(s) == PAX_RECORD) {
+            selection[s/64] |= uint64_t(1) << s%64;
+        }
+        else if(paxPage.getState(s) == PAX_TOMBSTONE) {
+            tombstones[s/64] |= uint64_t(1) << s%64;
+        }
+    }
+
+    for(unsigned c = 0 ; c < vectorConditions ; ++c) {
+        const ScanCondition &condition = conditions[c];
+        for(unsigned s = 0 ; s < slotCount ; ++s) {
+            if(paxPage.isNull(s, condition.field)) { //NULL never passes a comparison
+                selection[s/64] &= ~(uint64_t(1) << s%64);
+            }
+        }
+        if(condition.type == TypeInt) {
+            int value;
+            memcpy(&value, condition.value, sizeof(int));
+            memcpy(intColumn.data(), paxPage.getFixed(condition.field), slotCount*sizeof(int));
+            selectInts(intColumn.data(), slotCount, condition.compOp, value, passed.data());
+        }
+        else {
+            float value;
+            memcpy(&value, condition.value, sizeof(float));
+            memcpy(realColumn.data(), paxPage.getFixed(condition.field), slotCount*sizeof(float));
+            selectReals(realColumn.data(), slotCount, condition.compOp, value, passed.data());
+        }
+        for(unsigned w = 0 ; w < words ; ++w) {
+            selection[w] &= passed[w];
+        }
+    }
+    for(unsigned w = 0 ; w < words ; ++w) {
+        selection[w] |= tombstones[w];
+    }
+    selectedPage = bufferedPage;
+    selectedSlots = slotCount;
+}
+
+//First slot from "slotNum" on whose bit is set in "selection", the number of slots of the page if there is none
+unsigned RBFM_ScanIterator::nextSelected(unsigned slotNum) const {
+    unsigned w = slotNum/64;
+    if(w >= selection.size()) {
+        return slotNum;
+    }
+    uint64_t bits = selection[w] & (~uint64_t(0) << slotNum%64);
+    while(bits == 0) {
+        if(++w == selection.size()) {
+            return selectedSlots;
+        }
+        bits = selection[w];
+    }
+    return w*64 + __builtin_ctzll(bits);
+}
+
 /*
 typedef enum {
     EQ_OP = 0, // no condition// =
@@ -626,8 +1999,7 @@ typedef enum {
 } CompOp;
  */
 template <typename T>
-bool RBFM_ScanIterator::performCompOp(const T& value, const T& actualValue) {
-    //cout << "\t\t\tArrived in performCompOp function\n";
+bool RBFM_ScanIterator::performCompOp(CompOp compOp, const T& value, const T& actualValue) {
     if(compOp == CompOp::EQ_OP) {
         return actualValue == value;
     }
@@ -649,3 +2021,71 @@ bool RBFM_ScanIterator::performCompOp(const T& value, const T& actualValue) {
     return true; //(compOp == CompOp::NO_OP)
 }
 
+RC RBFM_ScanIterator::satisfiesConditions(const RecordView &view, unsigned firstCondition, bool &satisfied) const {
+    satisfied = false;
+    for(unsigned i = firstCondition ; i < conditions.size() ; ++i) {
+        const ScanCondition &condition = conditions[i];
+        if(condition.field >= recordDescriptor.size()) {
+            return -1;
+        }
+        if(view.isNull(condition.field)) {
+            return 0;   //we couldn't use NULL field in comparisons
+        }
+
+        unsigned length;
+        const byte *value = view.getField(condition.field, length);
+        if(condition.type == AttrType::TypeVarChar) {
+            value = reinterpret_cast<const byte *>(view.getVarChar(condition.field, length));
+        }
+        if(!conditionHolds(condition, value, length)) {
+            return 0;
+        }
+    }
+    satisfied = true;
+    return 0;
+}
+
+RC RBFM_ScanIterator::satisfiesConditions(const PaxPage &paxPage, unsigned slot, unsigned firstCondition, bool &satisfied) const {
+    satisfied = false;
+    for(unsigned i = firstCondition ; i < conditions.size() ; ++i) {
+        const ScanCondition &condition = conditions[i];
+        if(condition.field >= recordDescriptor.size()) {
+            return -1;
+        }
+        if(paxPage.isNull(slot, condition.field)) {
+            return 0;
+        }
+        unsigned length = sizeof(unsigned);
+        const byte *value = condition.type == AttrType::TypeVarChar ? reinterpret_cast<const byte *>(paxPage.getVarChar(slot, condition.field, length))
+                                                                    : paxPage.getFixed(slot, condition.field);
+        if(!conditionHolds(condition, value, length)) {
+            return 0;
+        }
+    }
+    satisfied = true;
+    return 0;
+}
+
+bool RBFM_ScanIterator::conditionHolds(const ScanCondition &condition, const byte *value, unsigned length) {
+    if(condition.type == AttrType::TypeInt) {
+        int actual;
+        memcpy(&actual, value, sizeof(int));
+        return performCompOp(condition.compOp, *reinterpret_cast<const int*>(condition.value), actual);
+    }
+    else if(condition.type == AttrType::TypeReal) {
+        float actual;
+        memcpy(&actual, value, sizeof(float));
+        return performCompOp(condition.compOp, *reinterpret_cast<const float*>(condition.value), actual);
+    }
+    //condition.type == AttrType::TypeVarChar
+    unsigned valueLen;
+    memcpy(&valueLen, condition.value, sizeof(unsigned));
+    const byte* valueCont = reinterpret_cast<const byte*>(condition.value)+sizeof(unsigned);
+    //Compared in place, like std::string would: bytes first, then lengths
+    int order = memcmp(value, valueCont, min(length, valueLen));
+    if(order == 0) {
+        order = length < valueLen ? -1 : (length > valueLen ? 1 : 0);
+    }
+    return performCompOp(condition.compOp, 0, order);
+}
+
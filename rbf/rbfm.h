@@ -4,7 +4,10 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <unordered_map>
 #include <climits>
+#include <cstdint>
+#include <memory>
 
 #include "pfm.h"
 
@@ -27,6 +30,72 @@ struct Attribute {
     AttrLength length; // attribute length
 };
 
+/**
+A record descriptor compiled once, e.g. per table: the size of the null indicators, the type of every field, the
+offsets of the leading fixed-width (int/real) fields and a hash from attribute names to field numbers. When all of
+its fields are fixed-width, the layout of its records without NULLs is constant and computed here as well, see
+isFixedWidth(). It is immutable. It converts implicitly from a descriptor, so every method taking a Schema also accepts a
+std::vector<Attribute>, at the price of compiling it on each call; callers that run many of them should keep one.
+**/
+class Schema {
+public:
+    Schema() : fixedOffsets(1, 0), nullIndicatorBytes(0) {}
+    Schema(const std::vector<Attribute> &attributes);
+
+    static unsigned nullIndicatorSize(unsigned fieldCount) { return (fieldCount+7)/8; }   // ceil(fieldCount/8)
+
+    const std::vector<Attribute> &getAttributes() const { return attributes; }
+    operator const std::vector<Attribute> &() const { return attributes; }
+    unsigned size() const { return attributes.size(); }
+    const Attribute &operator[](unsigned field) const { return attributes[field]; }
+    AttrType getType(unsigned field) const { return types[field]; }
+    unsigned getNullIndicatorSize() const { return nullIndicatorBytes; }
+
+    // Number of leading int/real fields; their offsets in the data are fixed as long as none of them is NULL
+    unsigned getFixedPrefix() const { return fixedOffsets.size()-1; }
+
+    // Whether every field is an int/real. A record without NULLs then has its values at constant offsets, the
+    // same in the data and in the stored record: getFixedOffset(), getFixedLength() bytes in all
+    bool isFixedWidth() const { return !attributes.empty() && getFixedPrefix() == attributes.size(); }
+    unsigned getFixedOffset(unsigned field) const { return fixedOffsets[field]; }
+    unsigned getFixedLength() const { return fixedOffsets.back(); }
+    // Header of the stored records without NULLs of a fixed-width descriptor, in the compact format or not (see
+    // RecordView), the values follow it
+    const std::vector<byte> &getFixedRecordHeader(bool compact) const { return fixedRecordHeaders[compact]; }
+
+    int indexOf(const std::string &name) const;                        // Field number, -1 if there is no such attribute
+
+    // "data" is in the format of RecordBasedFileManager::insertRecord()
+    static bool isNull(const void *data, unsigned field) { return static_cast<const byte *>(data)[field/8] & (1 << (7 - field%8)); }
+    bool hasNulls(const void *data) const;
+    // Start of the value of "field" and its length (4+n for a varchar), NULL if the field is NULL
+    const byte *findField(const void *data, unsigned field, unsigned &length) const;
+    unsigned getDataLength(const void *data) const;                     // Null indicators included
+
+private:
+    std::vector<Attribute> attributes;
+    std::vector<AttrType> types;
+    std::vector<unsigned> fixedOffsets;                                 // offsets of the fixed-width prefix, plus its end
+    std::vector<byte> fixedRecordHeaders[2];                            // by compact format, if isFixedWidth()
+    std::unordered_map<std::string, unsigned> indices;
+    unsigned nullIndicatorBytes;
+};
+
+// How the data pages of a record-based file store their records, chosen when the file is created
+typedef enum {
+    ROW_LAYOUT = 0,     // records one after the other, behind a slot directory
+    PAX_LAYOUT,         // one minipage per attribute, see PaxPage in pax.h
+    COLUMN_LAYOUT       // not a record-based file: a table with a file per attribute, see ColumnStoreManager in colstore.h
+} PageLayout;
+
+// Flag added to the page format of ROW_LAYOUT files created since the compact record format exists: their records
+// are stored in that format (see RecordView), their pages say so in their header (ROW_PAGE_COMPACT_RECORDS)
+# define COMPACT_RECORDS 0x100
+// Flag added to the page format of the files that have a free-space map (see FSM_PAGE_ENTRIES). Files written before
+// the map existed don't have it: all their pages are data pages, the free ones are found by reading them.
+# define FREE_SPACE_MAP 0x200
+# define PAGE_LAYOUT(pageFormat) ((pageFormat) & 0xFF)     // the PageLayout of a page format, without its flags
+
 // Comparison Operator (NOT needed for part 1 of the project)
 typedef enum {
     EQ_OP = 0, // no condition// =
@@ -45,6 +114,122 @@ typedef enum {
 
 # define RBFM_EOF (-1)  // end of a scan operator
 
+// One conjunct of a scan condition, "attribute compOp value". "value" has the format of the attribute's value in
+// the data of insertRecord() and must stay valid while the scan runs.
+struct ScanPredicate {
+    std::string attribute;
+    CompOp compOp;
+    const void *value;
+};
+
+// A ScanPredicate resolved against the record descriptor, as evaluated by the scan iterator
+struct ScanCondition {
+    unsigned field;      // out of range if the descriptor has no such attribute
+    AttrType type;
+    CompOp compOp;
+    const void *value;
+};
+
+// Selection kernels of the scans: bit i of "bits" is set when "values[i] compOp value" holds, for count values
+void selectInts(const int *values, unsigned count, CompOp compOp, int value, uint64_t *bits);
+void selectReals(const float *values, unsigned count, CompOp compOp, float value, uint64_t *bits);
+
+// Widest instructions the selection kernels may use, as long as the CPU has them
+typedef enum {
+    SCALAR_SELECTION = 0,
+    SSE2_SELECTION,
+    AVX2_SELECTION      // default
+} SelectionKernel;
+void setSelectionKernel(SelectionKernel kernel);
+
+// Free-space map (FSM). Page 0 of a record-based file created with FREE_SPACE_MAP and every (FSM_PAGE_ENTRIES+1)-th page after it are FSM pages,
+// each one holding a byte per data page that follows it: the free bytes of that data page divided by
+// FSM_CATEGORY_SIZE (rounded down, so the map never promises more room than there is). Both follow the page size.
+# define FSM_PAGE_ENTRIES(pageSize) (pageSize)
+# define FSM_CATEGORY_SIZE(pageSize) ((pageSize)/256)
+
+// Slot bitmap of the row layout. A data page starts with a header: ROW_PAGE_MAGIC, a word of flags (its low byte) and
+// dead bytes (the rest, see RecordBasedFileManager::compactRowPage()), then a bit per slot (bit s%64 of the 64-bit
+// word s/64), set when the slot holds a record or a tombstone; the records follow it.
+// A slot takes at least 16 bytes of the page when it's created (its entry and a record of 8 bytes or more), so the
+// bitmap covers every slot a page can have. The next live or free slot is then found a word at a time. Pages written
+// before the bitmap existed have no header, their records start at 0 (so they start with a 0, the first field
+// offset of a record, or with the page number of a tombstone, never with the magic word); they are walked slot by
+// slot until RecordBasedFileManager::upgradeFile() gives them one.
+# define ROW_PAGE_MAGIC 0xFFFFFFFFu
+# define ROW_PAGE_BITMAP_BYTES(pageSize) ((pageSize)/128)
+# define ROW_PAGE_HEADER_SIZE(pageSize) (2*sizeof(unsigned) + ROW_PAGE_BITMAP_BYTES(pageSize))
+# define ROW_PAGE_COMPACT_RECORDS 1     // flag: the records of the page are in the compact format
+# define ROW_PAGE_FLAG_BITS 8
+
+/**
+A record read in place, on the page that holds it, instead of being copied out in the format of readRecord().
+Records start with fieldCount+1 offsets (see transformDataToRecordFormat()), relative to the end of that array, so
+field i is found in O(1) and is NULL when it is empty. An int or real field is 4 bytes, a varchar is its 4-byte
+length followed by the characters, i.e. every field is stored exactly as its value appears in the API format.
+The compact format starts with the null indicators of the API format instead, followed by 2-byte offsets: NULLs are
+read from the indicators, and the header of a narrow record takes about half the room. Its records are padded to
+8 bytes, the room a tombstone needs.
+The view points into the page: it is valid as long as the page doesn't move, i.e. while it's pinned in the
+buffer pool (RecordBasedFileManager::pinRecord()) or until the scan iterator that returned it goes on.
+**/
+class RecordView {
+public:
+    RecordView() : record(NULL), fieldCount(0), compact(false) {}
+    RecordView(const byte *record, unsigned fieldCount, bool compact = false) : record(record), fieldCount(fieldCount), compact(compact) {}
+
+    bool isValid() const { return record != NULL; }
+    unsigned getFieldCount() const { return fieldCount; }
+    bool isNull(unsigned field) const { return compact ? Schema::isNull(record, field) : offset(field) == offset(field+1); }
+
+    // The field as stored, "length" is 0 for NULL
+    const byte *getField(unsigned field, unsigned &length) const {
+        length = offset(field+1)-offset(field);
+        return record + valuesOffset() + offset(field);
+    }
+    int getInt(unsigned field) const { int value; unsigned length; memcpy(&value, getField(field, length), sizeof(int)); return value; }
+    float getReal(unsigned field) const { float value; unsigned length; memcpy(&value, getField(field, length), sizeof(float)); return value; }
+    const char *getVarChar(unsigned field, unsigned &length) const {
+        const byte *data = getField(field, length);
+        memcpy(&length, data, sizeof(unsigned));
+        return reinterpret_cast<const char *>(data + sizeof(unsigned));
+    }
+
+    // Write the listed fields (all of them without a list) in the format of readRecord(): null indicators, then
+    // the values. Returns the number of bytes written.
+    unsigned project(const std::vector<unsigned> &fields, void *data) const;
+    unsigned project(void *data) const;
+    // Same, given the descriptor of the record: a record of a fixed-width descriptor without NULLs is copied from
+    // the constant offsets of its fields (see Schema::isFixedWidth()) instead of through its own offsets
+    unsigned project(const Schema &schema, const std::vector<unsigned> &fields, void *data) const;
+    unsigned project(const Schema &schema, void *data) const;
+
+    // Size of the header of a record in the compact format, before its values
+    static unsigned compactHeaderSize(unsigned fieldCount) { return Schema::nullIndicatorSize(fieldCount) + (fieldCount+1)*sizeof(uint16_t); }
+
+private:
+    unsigned offset(unsigned field) const {
+        if(compact) {
+            uint16_t value;
+            memcpy(&value, record + Schema::nullIndicatorSize(fieldCount) + field*sizeof(uint16_t), sizeof(uint16_t));
+            return value;
+        }
+        unsigned value;
+        memcpy(&value, record + field*sizeof(unsigned), sizeof(unsigned));
+        return value;
+    }
+    unsigned valuesOffset() const { return compact ? compactHeaderSize(fieldCount) : (fieldCount+1)*sizeof(unsigned); }
+    bool hasFixedLayout(const Schema &schema) const;
+
+    const byte *record;
+    unsigned fieldCount;
+    bool compact;
+};
+
+class PaxPage;
+class ZoneMap;
+class RBFM_ParallelScanIterator;
+
 // RBFM_ScanIterator is an iterator to go through records
 // The way to use it is like the following:
 //  RBFM_ScanIterator rbfmScanIterator;
@@ -56,13 +241,32 @@ typedef enum {
 
 class RBFM_ScanIterator {
     FileHandle fileHandle;
-    std::vector<Attribute> recordDescriptor;
-    std::string conditionAttribute;
-    CompOp compOp;
-    const void *value;
+    Schema recordDescriptor;
+    std::vector<ScanCondition> conditions; //All of them must hold, in the order they are evaluated
     RID currRID = { 0, 0 };
-    unsigned attrForCompInd; //Index of attribute to be compared
+    PageNum endPage = UINT_MAX; //The scan stops before this page
     std::vector<unsigned> attrToExtractInd; //Indices of attributes to be extracted
+    std::vector<byte> page; //Copy of the page being scanned, the file is only read again to move to the next page
+    const byte *mappedPage = NULL; //The page being scanned in the file mapping with mapped reads, NULL if it's in "page"
+    PageNum bufferedPage = UINT_MAX; //Page being scanned
+    std::vector<byte> movedPage; //Page holding the current record when its slot is a tombstone
+    unsigned vectorConditions = 0; //Leading int/real conditions, evaluated for a whole page at once by selectRecords()
+    std::vector<uint64_t> selection; //Bit per slot of the page being scanned: set if its record passes them (or is a tombstone)
+    PageNum selectedPage = UINT_MAX; //Page "selection" was computed for
+    std::vector<uint64_t> tombstones, passed; //Scratch bitmaps of selectRecords()
+    std::vector<unsigned> recordOffsets; //Offset of each slot's record, UINT_MAX for deleted slots and tombstones
+    std::vector<int> intColumn; //Values of a condition's field, one per slot
+    std::vector<float> realColumn;
+    unsigned selectedSlots = 0; //Slots of the page "selection" covers
+    std::vector<byte> recordFormat; //Record of a PAX file rebuilt in the row layout for getNextRecordView()
+    std::shared_ptr<const ZoneMap> zoneMap; //Set when the int/real conditions can skip pages, see ZoneMap
+
+    void selectRecords();
+    void selectPaxRecords();
+    unsigned nextSelected(unsigned slotNum) const;
+    RC nextPaxRecord(RID &rid, void *data, RecordView *view);
+    RC moveToNextRecord();
+    const byte *scannedPage() const { return mappedPage != NULL ? mappedPage : page.data(); }
 
 public:
     RBFM_ScanIterator() = default;;
@@ -70,7 +274,14 @@ public:
     ~RBFM_ScanIterator() = default;;
 
     template <typename T>
-    bool performCompOp(const T& value, const T& actualValue);
+    static bool performCompOp(CompOp compOp, const T& value, const T& actualValue);
+
+    // Evaluates the conditions from "firstCondition" on, -1 if one of them names no attribute of the descriptor
+    RC satisfiesConditions(const RecordView &view, unsigned firstCondition, bool &satisfied) const;
+    // Same for the record in "slot" of a PAX page
+    RC satisfiesConditions(const PaxPage &paxPage, unsigned slot, unsigned firstCondition, bool &satisfied) const;
+    // One condition on a non-NULL value: 4 bytes for an int/real, the characters of a varchar and their number
+    static bool conditionHolds(const ScanCondition &condition, const byte *value, unsigned length);
 
     FileHandle& getFileHandle() {
         return fileHandle;
@@ -80,58 +291,66 @@ public:
         RBFM_ScanIterator::fileHandle = fileHandle;
     }
 
-    std::vector<Attribute> &getRecordDescriptor() {
+    const Schema &getRecordDescriptor() const {
         return recordDescriptor;
     }
 
-    void setRecordDescriptor(const std::vector<Attribute> &recordDescriptor) {
+    void setRecordDescriptor(const Schema &recordDescriptor) {
         RBFM_ScanIterator::recordDescriptor = recordDescriptor;
     }
 
-    std::string &getConditionAttribute()  {
-        return conditionAttribute;
+    const std::vector<ScanCondition> &getConditions() const {
+        return conditions;
     }
 
-    void setConditionAttribute(const std::string &conditionAttribute) {
-        RBFM_ScanIterator::conditionAttribute = conditionAttribute;
+    void setConditions(const std::vector<ScanCondition> &conditions) {
+        RBFM_ScanIterator::conditions = conditions;
+        vectorConditions = 0;
+        while(vectorConditions < conditions.size() && conditions[vectorConditions].field < recordDescriptor.size()
+              && conditions[vectorConditions].type != TypeVarChar) {
+            ++vectorConditions;
+        }
+        selectedPage = UINT_MAX;
     }
 
+    void setZoneMap(const std::shared_ptr<const ZoneMap> &zoneMap) {
+        RBFM_ScanIterator::zoneMap = zoneMap;
+    }
+
+    // True if the zone map tells that no record of the page satisfies the conditions
+    bool skipsPage(PageNum pageNum) const;
+
     void setCurrRID(){
     	currRID = {0,0};
+    	bufferedPage = UINT_MAX;
+    	selectedPage = UINT_MAX;
     }
 
     RID &getCurrRID(){
     	return currRID;
     }
 
-    CompOp getCompOp() const {
-        return compOp;
-    }
-
-    void setCompOp(CompOp compOp) {
-        RBFM_ScanIterator::compOp = compOp;
-    }
-
-    const void* getValue() const {
-        return value;
+    // Restricts the scan to the pages [firstPage, endPage) and restarts it at the first one
+    void setPageRange(PageNum firstPage, PageNum endPage) {
+        currRID = {firstPage, 0};
+        RBFM_ScanIterator::endPage = endPage;
+        bufferedPage = UINT_MAX;
+        selectedPage = UINT_MAX;
     }
 
-    void setValue(const void *value) {
-        RBFM_ScanIterator::value = value;
+    PageNum getEndPage() const {
+        return endPage;
     }
 
-    unsigned int getAttrForCompInd() const {
-        return attrForCompInd;
+    // Whether the scan went through all of its pages: RBFM_EOF and an error are both -1, only this tells them apart
+    bool isExhausted() {
+        return currRID.pageNum >= endPage || currRID.pageNum >= fileHandle.getNumberOfPages();
     }
 
     std::vector<unsigned int> &getAttrToExtractInd() {
         return attrToExtractInd;
     }
 
-    void setAttrForCompInd(unsigned int attrForCompInd) {
-        RBFM_ScanIterator::attrForCompInd = attrForCompInd;
-    }
-
     void setAttrToExtractInd(const std::vector<unsigned int> &attrToExtractInd) {
         RBFM_ScanIterator::attrToExtractInd = attrToExtractInd;
     }
@@ -141,6 +360,10 @@ public:
     // "data" follows the same format as RecordBasedFileManager::insertRecord().
     RC getNextRecord(RID &rid, void *data);
 
+    // Same, without copying the record: "view" points into the page being scanned and stays valid until the next
+    // call
+    RC getNextRecordView(RID &rid, RecordView &view);
+
     RC close() { return PagedFileManager::instance().closeFile(fileHandle); };
 };
 
@@ -148,7 +371,17 @@ class RecordBasedFileManager {
 public:
     static RecordBasedFileManager &instance();                          // Access to the _rbf_manager instance
 
-    RC createFile(const std::string &fileName);                         // Create a new record-based file
+    RC createFile(const std::string &fileName, unsigned pageSize = PAGE_SIZE, PageLayout layout = ROW_LAYOUT);  // Create a new record-based file
+
+    static bool isPax(const FileHandle &fileHandle) { return PAGE_LAYOUT(fileHandle.getPageFormat()) == PAX_LAYOUT; }
+
+    // Page format a file of "layout" is created with: it has a free-space map, and the row layout stores its records
+    // in the compact format
+    static unsigned pageFormat(PageLayout layout) {
+        return layout == COLUMN_LAYOUT ? layout : layout | FREE_SPACE_MAP | (layout == ROW_LAYOUT ? COMPACT_RECORDS : 0);
+    }
+    static bool hasCompactRecords(const FileHandle &fileHandle) { return (fileHandle.getPageFormat() & COMPACT_RECORDS) != 0; }
+    static bool hasFreeSpaceMap(const FileHandle &fileHandle) { return (fileHandle.getPageFormat() & FREE_SPACE_MAP) != 0; }
 
     RC destroyFile(const std::string &fileName);                        // Destroy a record-based file
 
@@ -172,18 +405,89 @@ public:
     // For example, refer to the Q8 of Project 1 wiki page.
 
     // Insert a record into a file
-    RC insertRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const void *data, RID &rid);
+    RC insertRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data, RID &rid);
+
+    // Insert many records at once. Pages are filled in memory and each one is written (or appended) once, when
+    // it is full. The first records go where insertRecord() would put them, the others fill new pages.
+    RC insertRecords(FileHandle &fileHandle, const Schema &recordDescriptor, const std::vector<const void *> &data, std::vector<RID> &rids);
+
+    void transformDataToRecordFormat(const Schema &recordDescriptor, const void *data, std::vector<byte> &recordFormat, bool compact = false);
+
+    // In a PAX file "paxSchema" is the descriptor of the records and "recordLength" the bytes of their varchars
+    RC readFirstFreePage(FileHandle &fileHandle, unsigned startPage, unsigned &pageNumber, const unsigned recordLength, byte *page, unsigned &targetSlotNumber, const Schema *paxSchema = NULL);
+
+    bool findSlotForRecord(byte *page, const unsigned pageSize, const unsigned recordLength, unsigned &targetSlotNumber);
+
+    RC appendDataPage(FileHandle &fileHandle, byte *page, unsigned &pageNumber);
+
+    static bool isFreeSpaceMapPage(const FileHandle &fileHandle, unsigned pageNumber) {
+        return hasFreeSpaceMap(fileHandle) && pageNumber % (FSM_PAGE_ENTRIES(fileHandle.getPageSize())+1) == 0;
+    }
+
+    static byte freeSpaceCategory(const byte *page, const unsigned pageSize);
+
+    // Empty data page of the row layout, with its slot bitmap and no slots yet
+    static void formatRowPage(byte *page, const unsigned pageSize, bool compactRecords);
+
+    static bool hasSlotBitmap(const byte *page) { unsigned magic; memcpy(&magic, page, sizeof(unsigned)); return magic == ROW_PAGE_MAGIC; }
+    static bool hasCompactRecords(const byte *page) {
+        unsigned header[2];
+        memcpy(header, page, sizeof(header));
+        return header[0] == ROW_PAGE_MAGIC && (header[1] & ROW_PAGE_COMPACT_RECORDS) != 0;
+    }
+
+    // Marks a slot of a row page as live (record or tombstone) or free in its bitmap, if the page has one
+    static void setSlotLive(byte *page, const unsigned slotNumber, bool live);
+
+    // First slot from "slotNumber" on that is live (or free if "live" is false), the slot count if there is none
+    static unsigned nextSlot(const byte *page, const unsigned pageSize, unsigned slotNumber, bool live);
+
+    // Gives a row page written without the slot bitmap one, moving its records up; false if there is no room for it
+    static bool upgradeRowPage(byte *page, const unsigned pageSize);
+
+    // Bytes of the records deleted from a row page since it was last compacted, always 0 without the slot bitmap
+    static unsigned deadBytes(const byte *page) {
+        unsigned header[2];
+        memcpy(header, page, sizeof(header));
+        return header[0] == ROW_PAGE_MAGIC ? header[1] >> ROW_PAGE_FLAG_BITS : 0;
+    }
+    static void setDeadBytes(byte *page, unsigned bytes);
+
+    // Deletes the record or tombstone of a slot. A page with the slot bitmap only frees the slot and counts its bytes
+    // as dead, they are given back by compactRowPage(); the records of an older page are shifted right away
+    static void freeSlot(byte *page, const unsigned pageSize, const unsigned slotNumber);
+
+    // Moves the records of a row page together, so that its dead bytes join the free space
+    static void compactRowPage(byte *page, const unsigned pageSize);
+
+    // Whether "bytes" more fit between the records and the slot directory, compacting the page if it takes that
+    static bool makeRoom(byte *page, const unsigned pageSize, const unsigned bytes);
+
+    // Compacts every row page of the file that has dead bytes, "compacted" of them. Nothing to do in a PAX file
+    RC compactFile(FileHandle &fileHandle, unsigned &compacted);
+
+    // Upgrades every row page of the file that has room for the slot bitmap, "upgraded" of them. The other pages keep
+    // working without it. Nothing to do in a PAX file
+    RC upgradeFile(FileHandle &fileHandle, unsigned &upgraded);
 
-    void transformDataToRecordFormat(const std::vector<Attribute> &recordDescriptor, const void *data, std::vector<byte> &recordFormat);
+    // Records the free space of a data page in the FSM, must follow every change of a data page
+    RC updateFreeSpaceMap(FileHandle &fileHandle, const unsigned pageNumber, const byte *page);
 
-    RC readFirstFreePage(FileHandle &fileHandle, unsigned startPage, unsigned &pageNumber, const unsigned recordLength, byte *page, unsigned &targetSlotNumber);
+    RC setFreeSpaceCategory(FileHandle &fileHandle, const unsigned pageNumber, const byte category);
+
+    // Same for a batch of (data page, free space category) pairs
+    RC updateFreeSpaceMap(FileHandle &fileHandle, std::vector<std::pair<unsigned, byte> > &categories);
 
     RC insertRecordOnPage(FileHandle &fileHandle, const std::vector<byte> &recordFormat, const unsigned pageNumber, const unsigned targetSlotNumber, byte *page);
 
-    void shiftRecord(byte *page,const unsigned dataSize,const unsigned slotNumber);
+    static void placeRecord(byte *page, const unsigned pageSize, const std::vector<byte> &recordFormat, const unsigned targetSlotNumber);
+
+    RC writeBatchPage(FileHandle &fileHandle, const unsigned pageNumber, const byte *page, bool newPage);
+
+    static void shiftRecord(byte *page, const unsigned pageSize, const unsigned dataSize, const unsigned slotNumber);
 
     // Read a record identified by the given rid.
-    RC readRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const RID &rid, void *data);
+    RC readRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, void *data);
 
     // Print the record that is passed to this utility method.
     // This method will be mainly used for debugging/testing.
@@ -193,34 +497,98 @@ public:
     //        age: NULL  height: 7.5  salary: 7500)
     RC printRecord(const std::vector<Attribute> &recordDescriptor, const void *data);
 
-    RC moveToNextAvailableRecord(FileHandle& fileHandle, RID& rid);
+    // "page" points to page "bufferedPage" of the file; a page is only accessed when the search moves past that one,
+    // read into "buffer", or pointed to in the file mapping with mapped reads. The pages "scan" skips (see
+    // RBFM_ScanIterator::skipsPage()) aren't read at all
+    RC moveToNextAvailableRecord(FileHandle& fileHandle, RID& rid, byte *buffer, const byte *&page, PageNum &bufferedPage, const RBFM_ScanIterator *scan = NULL);
+
+    RC filterAttributes(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, void *data, const std::vector<unsigned> &attributesToExtract);
+
+    // Same, with the page of "rid" already in memory. Only a tombstone makes it read another page
+    RC filterAttributes(FileHandle &fileHandle, const byte *page, const Schema &recordDescriptor, const RID &rid, void *data, const std::vector<unsigned> &attributesToExtract);
 
-    RC filterAttributes(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const RID &rid, void *data, const std::vector<unsigned> &attributesToExtract);
+    // View of the record in slot "slotNum" of "page". -1 if the slot is deleted; for a tombstone the view is left
+    // invalid and "movedTo" is where the record is.
+    static RC viewRecord(const byte *page, unsigned pageSize, unsigned slotNum, unsigned fieldCount, RecordView &view, RID &movedTo);
+
+    // Pins the page of the record (following tombstones) in the buffer pool and returns a view of the record.
+    // The caller releases it with fileHandle.unpinPage(pinnedPage, false). Not available in PAX files (-1): their
+    // records aren't stored in one piece.
+    RC pinRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, RecordView &view, PageNum &pinnedPage);
 
     /*****************************************************************************************************
     * IMPORTANT, PLEASE READ: All methods below this comment (other than the constructor and destructor) *
     * are NOT required to be implemented for Project 1                                                   *
     *****************************************************************************************************/
     // Delete a record identified by the given rid.
-    RC deleteRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const RID &rid);
+    RC deleteRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid);
 
     // Assume the RID does not change after an update
-    RC updateRecord(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const void *data,
+    RC updateRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data,
                     const RID &rid);
 
+    // updateRecord() in the row layout
+    RC updateRowRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data, const RID &rid);
+
+    // Where the record of "rid" is stored: "rid" itself, or the slot its tombstone points at
+    RC locateRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, RID &location);
+
+    // Replaces the record in a slot if its page has room for the new version
+    bool resizeRecord(byte *page, const unsigned pageSize, const std::vector<byte> &recordFormat, const unsigned slotNumber);
+
+    // updateRecord() for a record that lives away from its home slot, keeps it at most one hop away
+    RC updateForwardedRecord(FileHandle &fileHandle, const std::vector<byte> &recordFormat, const RID &home, byte *homePage, const RID &movedTo);
+
+    // Moves records forwarded by updateRecord() back to their home page when it has room for them again
+    RC reclaimForwardedRecords(FileHandle &fileHandle, unsigned &reclaimed);
+
     // Read an attribute given its name and the rid.
-    RC readAttribute(FileHandle &fileHandle, const std::vector<Attribute> &recordDescriptor, const RID &rid,
+    RC readAttribute(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid,
                      const std::string &attributeName, void *data);
 
     // Scan returns an iterator to allow the caller to go through the results one by one.
     RC scan(FileHandle &fileHandle,
-            const std::vector<Attribute> &recordDescriptor,
+            const Schema &recordDescriptor,
             const std::string &conditionAttribute,
             const CompOp compOp,                  // comparision type such as "<" and "="
             const void *value,                    // used in the comparison
             const std::vector<std::string> &attributeNames, // a list of projected attributes
             RBFM_ScanIterator &rbfm_ScanIterator);
 
+    // Same with a conjunction of predicates (none: every record), possibly on several attributes. They are checked
+    // on the page, cheapest and most selective first, so a record failing one of them is never copied.
+    RC scan(FileHandle &fileHandle,
+            const Schema &recordDescriptor,
+            const std::vector<ScanPredicate> &predicates,
+            const std::vector<std::string> &attributeNames,
+            RBFM_ScanIterator &rbfm_ScanIterator);
+
+    // Same scan run by "workers" threads (0: one per core) at once, each one on morsels of consecutive pages; the
+    // records come in no particular order, see RBFM_ParallelScanIterator in parallelscan.h
+    RC parallelScan(FileHandle &fileHandle,
+                    const Schema &recordDescriptor,
+                    const std::vector<ScanPredicate> &predicates,
+                    const std::vector<std::string> &attributeNames,
+                    unsigned workers,
+                    RBFM_ParallelScanIterator &rbfm_ParallelScanIterator);
+
+    static unsigned conditionRank(const ScanCondition &condition, unsigned fieldCount);
+
+    // The predicates as conditions on the fields of the descriptor, in the order a scan evaluates them
+    static void resolvePredicates(const Schema &recordDescriptor, const std::vector<ScanPredicate> &predicates, std::vector<ScanCondition> &conditions);
+
+    // Record operations on PAX files, the methods above switch to them. A record moved by an update is forwarded
+    // by a tombstone in its home slot, at most one hop away, like in the row layout.
+    RC insertPaxRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data, RID &rid);
+    RC readPaxRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid, void *data, const std::vector<unsigned> *attributesToExtract = NULL);
+    RC updatePaxRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const void *data, const RID &rid);
+    RC deletePaxRecord(FileHandle &fileHandle, const Schema &recordDescriptor, const RID &rid);
+    RC writePaxPage(FileHandle &fileHandle, const unsigned pageNumber, byte *page, const Schema &recordDescriptor);
+
+    // The zone map of the file, opened by the first insert or update through the handle and kept in it until the
+    // handle is closed. NULL if the file has none, or none for "recordDescriptor"
+    ZoneMap *zoneMapOf(FileHandle &fileHandle, const Schema &recordDescriptor);
+
 public:
 
 protected:
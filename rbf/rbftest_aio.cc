@@ -0,0 +1,153 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "aio.h"
+
+// Only the queue is linked in, not the record manager test_util.h needs
+const RC success = 0;
+const unsigned queueDepth = 4;
+const unsigned numberOfPages = 40;
+
+// Page p is its number followed by a byte pattern of its own
+void prepareAioPage(PageNum p, byte *page) {
+    memset(page, (p * 5 + 3) & 0xFF, PAGE_SIZE);
+    memcpy(page, &p, sizeof(PageNum));
+}
+
+void prepareRequest(PageIORequest &request, int fd, PageNum pageNum, PageIOType type, byte *buffer) {
+    request.fd = fd;
+    request.pageNum = pageNum;
+    request.pageSize = PAGE_SIZE;
+    request.type = type;
+    request.buffer = buffer;
+    request.userData = NULL;
+    request.result = 1;
+}
+
+// Submits the batch and reaps it: every request comes back once
+void runBatch(AsyncIOQueue &queue, std::vector<PageIORequest> &requests) {
+    std::vector<PageIORequest *> batch;
+    for (unsigned i = 0; i < requests.size(); i++) {
+        batch.push_back(&requests[i]);
+    }
+    RC rc = queue.submit(batch);
+    assert(rc == success && "Submitting a batch should not fail.");
+
+    std::vector<PageIORequest *> completed;
+    while (completed.size() < batch.size()) {
+        const unsigned reaped = queue.complete(completed, 1);
+        assert(reaped > 0 && "Requests in flight should complete.");
+    }
+    assert(completed.size() == batch.size() && queue.outstanding() == 0 && "Every request should complete once.");
+    for (unsigned i = 0; i < completed.size(); i++) {
+        assert(completed[i]->result != 1 && "A completed request should have its result.");
+    }
+}
+
+int RBFTest_Aio(const std::string &fileName) {
+    // Functions tested
+    // 1. Batches many times larger than the queue: the engine is refilled as requests complete
+    // 2. Page writes then reads, in the same batch as other pages: the pages read back as written
+    // 3. Reads past the end of file return zeros, a request on a closed descriptor fails alone
+    // 4. drain() reports the failure, and nothing is left in flight after it
+    std::cout << std::endl << "***** In RBF Test Case Aio *****" << std::endl;
+
+    AsyncIOQueue queue(queueDepth);
+    std::cout << "Engine: " << (queue.usesIoUring() ? "io_uring" : "worker threads") << std::endl;
+#ifdef NO_IO_URING
+    assert(!queue.usesIoUring() && "The queue should use the worker threads.");
+#endif
+
+    int fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0 && "Creating the file should not fail.");
+
+    // Every page written in a single batch, ten times the depth of the queue
+    static byte pages[numberOfPages][PAGE_SIZE];
+    std::vector<PageIORequest> requests(numberOfPages);
+    for (PageNum p = 0; p < numberOfPages; p++) {
+        prepareAioPage(p, pages[p]);
+        prepareRequest(requests[p], fd, p, PAGE_WRITE, pages[p]);
+    }
+    runBatch(queue, requests);
+    for (PageNum p = 0; p < numberOfPages; p++) {
+        assert(requests[p].result == success && "Writing a page should not fail.");
+    }
+
+    // Each page on disk, right after the hidden page
+    byte page[PAGE_SIZE];
+    byte expected[PAGE_SIZE];
+    for (PageNum p = 0; p < numberOfPages; p++) {
+        ssize_t bytes = pread(fd, page, PAGE_SIZE, (off_t) (p + 1) * PAGE_SIZE);
+        prepareAioPage(p, expected);
+        assert(bytes == PAGE_SIZE && memcmp(page, expected, PAGE_SIZE) == 0 && "A page should be on disk as written.");
+    }
+
+    // Reads of the even pages mixed with writes of the odd ones, and reads past the end of file
+    static byte buffers[numberOfPages + queueDepth][PAGE_SIZE];
+    requests.assign(numberOfPages + queueDepth, PageIORequest());
+    for (PageNum p = 0; p < numberOfPages + queueDepth; p++) {
+        const PageIOType type = p % 2 == 1 && p < numberOfPages ? PAGE_WRITE : PAGE_READ;
+        memset(buffers[p], type == PAGE_WRITE ? 0x77 : 0x55, PAGE_SIZE);
+        prepareRequest(requests[p], fd, p, type, buffers[p]);
+    }
+    runBatch(queue, requests);
+    for (PageNum p = 0; p < numberOfPages + queueDepth; p++) {
+        assert(requests[p].result == success && "Transferring a page should not fail.");
+        if (p >= numberOfPages) {
+            memset(expected, 0, PAGE_SIZE);
+            assert(memcmp(buffers[p], expected, PAGE_SIZE) == 0 && "A read past the end of file should return zeros.");
+        } else if (p % 2 == 0) {
+            prepareAioPage(p, expected);
+            assert(memcmp(buffers[p], expected, PAGE_SIZE) == 0 && "A page should read back as written.");
+        } else {
+            ssize_t bytes = pread(fd, page, PAGE_SIZE, (off_t) (p + 1) * PAGE_SIZE);
+            memset(expected, 0x77, PAGE_SIZE);
+            assert(bytes == PAGE_SIZE && memcmp(page, expected, PAGE_SIZE) == 0 && "A page should be on disk as written.");
+        }
+    }
+
+    // One request of the batch fails, the others aren't held back by it
+    int closedFd = open(fileName.c_str(), O_RDONLY);
+    assert(closedFd >= 0 && "Opening the file should not fail.");
+    close(closedFd);
+    requests.assign(2 * queueDepth, PageIORequest());
+    for (PageNum p = 0; p < 2 * queueDepth; p++) {
+        prepareRequest(requests[p], p == queueDepth ? closedFd : fd, p, PAGE_READ, buffers[p]);
+    }
+    runBatch(queue, requests);
+    for (PageNum p = 0; p < 2 * queueDepth; p++) {
+        assert(requests[p].result == (p == queueDepth ? -1 : success) && "Only the request on a closed file should fail.");
+    }
+
+    std::vector<PageIORequest *> batch;
+    for (unsigned i = 0; i < requests.size(); i++) {
+        prepareRequest(requests[i], i % 3 == 0 ? closedFd : fd, i, PAGE_READ, buffers[i]);
+        batch.push_back(&requests[i]);
+    }
+    RC rc = queue.submit(batch);
+    assert(rc == success && "Submitting a batch should not fail.");
+    rc = queue.drain();
+    assert(rc != success && "Draining should report the failed requests.");
+    assert(queue.outstanding() == 0 && "Nothing should be in flight after draining.");
+    rc = queue.drain();
+    assert(rc == success && "Draining an empty queue should not fail.");
+
+    close(fd);
+    remove(fileName.c_str());
+
+    std::cout << "RBF Test Case Aio Finished! The result will be examined." << std::endl << std::endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the asynchronous page transfers, built once for each engine
+    remove("test_aio");
+    return RBFTest_Aio("test_aio");
+}
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <set>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int batchSize = 1000;
+
+void createBatchRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Name";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 300;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Score";
+    attr.type = TypeReal;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Note";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 50;
+    recordDescriptor.push_back(attr);
+}
+
+// Name of 1 to 300 letters picked by "id", Score NULL for every 3rd record, Note NULL for every 5th
+void prepareBatchRecord(int id, void *buffer, int *recordSize) {
+    int offset = 0;
+    const bool nullScore = id % 3 == 0;
+    const bool nullNote = id % 5 == 0;
+    memset(buffer, (nullScore ? 0x20 : 0) | (nullNote ? 0x10 : 0), 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    int nameLength = 1 + (id * 37) % 300;
+    memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+    offset += nameLength;
+    if (!nullScore) {
+        float score = id * 0.5f;
+        memcpy((char *) buffer + offset, &score, sizeof(float));
+        offset += sizeof(float);
+    }
+    if (!nullNote) {
+        int noteLength = id % 50;
+        memcpy((char *) buffer + offset, &noteLength, sizeof(int));
+        offset += sizeof(int);
+        memset((char *) buffer + offset, 'A' + id % 26, noteLength);
+        offset += noteLength;
+    }
+    *recordSize = offset;
+}
+
+// One record, then a batch that fills the rest of its page and many new ones
+void testBatch(RecordBasedFileManager &rbfm, const string &fileName, unsigned pageSize) {
+    vector<Attribute> recordDescriptor;
+    createBatchRecordDescriptor(recordDescriptor);
+    RC rc = rbfm.createFile(fileName, pageSize, ROW_LAYOUT);
+    assert(rc == success && "Creating the file should not fail.");
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    vector<char> record(1000);
+    vector<char> returnedData(1000);
+    int recordSize;
+    RID firstRid;
+    prepareBatchRecord(batchSize, record.data(), &recordSize);
+    rc = rbfm.insertRecord(fileHandle, recordDescriptor, record.data(), firstRid);
+    assert(rc == success && "Inserting a record should not fail.");
+    const unsigned pagesBefore = fileHandle.getNumberOfPages();
+
+    vector<vector<char> > records(batchSize, vector<char>(1000));
+    vector<const void *> data(batchSize);
+    for (int id = 0; id < batchSize; id++) {
+        prepareBatchRecord(id, records[id].data(), &recordSize);
+        data[id] = records[id].data();
+    }
+    unsigned readsBefore, writesBefore, appendsBefore;
+    rc = fileHandle.collectCounterValues(readsBefore, writesBefore, appendsBefore);
+    assert(rc == success && "Collecting the counters should not fail.");
+    vector<RID> rids;
+    rc = rbfm.insertRecords(fileHandle, recordDescriptor, data, rids);
+    assert(rc == success && rids.size() == (size_t) batchSize && "Inserting a batch of records should not fail.");
+    unsigned reads, writes, appends;
+    rc = fileHandle.collectCounterValues(reads, writes, appends);
+    assert(rc == success && "Collecting the counters should not fail.");
+
+    // The first records share the page of the single one, the others fill new pages in order
+    set<unsigned> pages;
+    for (int id = 0; id < batchSize; id++) {
+        assert((id == 0 || rids[id].pageNum >= rids[id - 1].pageNum) && "The records should fill the pages in order.");
+        pages.insert(rids[id].pageNum);
+    }
+    assert(rids[0].pageNum == firstRid.pageNum && "The batch should start on the page with room left.");
+    assert(pages.size() > 10 && "The batch should fill many pages.");
+    const unsigned newPages = fileHandle.getNumberOfPages() - pagesBefore;
+    assert(newPages == pages.size() - 1 && "Every page but the first should be new.");
+
+    // The filled pages are each written or appended once, the free space map is read and written once
+    assert(appends - appendsBefore == newPages && "Each new page should be appended once.");
+    assert(writes - writesBefore == 2 && "The first page and the free space map should be written once.");
+    assert(reads - readsBefore == 3 && "Only the first page and the free space map should be read.");
+
+    for (int id = 0; id < batchSize; id++) {
+        rc = rbfm.readRecord(fileHandle, recordDescriptor, rids[id], returnedData.data());
+        assert(rc == success && "Reading a record should not fail.");
+        prepareBatchRecord(id, record.data(), &recordSize);
+        assert(memcmp(record.data(), returnedData.data(), recordSize) == 0 && "A record should read back as written.");
+    }
+    rc = rbfm.readRecord(fileHandle, recordDescriptor, firstRid, returnedData.data());
+    prepareBatchRecord(batchSize, record.data(), &recordSize);
+    assert(rc == success && memcmp(record.data(), returnedData.data(), recordSize) == 0
+           && "The record already on the page should stay as written.");
+
+    // The free space map knows the new pages: a single record goes to the last one, which has room left
+    RID rid;
+    rc = rbfm.insertRecord(fileHandle, recordDescriptor, record.data(), rid);
+    assert(rc == success && rid.pageNum == rids[batchSize - 1].pageNum && "A record should go to a page with room.");
+
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+}
+
+int RBFTest_Batch(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. insertRecords() with varchars and NULLs, over many pages of 4K and 8K
+    // 2. Each RID it returns reads back its record
+    // 3. One write or append per filled page, the free space map written once
+    cout << endl << "***** In RBF Test Case Batch *****" << endl;
+
+    string fileName = "test_batch";
+    testBatch(rbfm, fileName, PAGE_SIZE);
+    testBatch(rbfm, fileName, 2 * PAGE_SIZE);
+
+    RC rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Batch Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the insertion of many records at once
+    remove("test_batch");
+    return RBFTest_Batch(RecordBasedFileManager::instance());
+}
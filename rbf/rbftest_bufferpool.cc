@@ -0,0 +1,178 @@
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+const unsigned numberOfPages = 16;
+const unsigned numberOfFrames = 4;
+
+// Pin a page straight in the buffer pool, "hit" tells whether it was resident
+RC pin(const FileHandle &fileHandle, PageNum pageNum, byte *&frame, bool &hit) {
+    return BufferPool::instance().pinPage(fileHandle.fileId, pageNum, true, frame, hit);
+}
+
+void unpin(const FileHandle &fileHandle, PageNum pageNum, bool dirty) {
+    RC rc = BufferPool::instance().unpinPage(fileHandle.fileId, pageNum, dirty);
+    assert(rc == success && "Unpinning a pinned page should not fail.");
+}
+
+// Every frame pinned: nothing can be evicted until one of them is released
+void testPinnedFrames(FileHandle &fileHandle, ReplacementPolicy policy) {
+    BufferPool &bufferPool = BufferPool::instance();
+    bufferPool.setReplacementPolicy(policy);
+    RC rc = bufferPool.setCapacity(numberOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+
+    byte *frame;
+    bool hit;
+    for (PageNum p = 0; p < numberOfFrames; p++) {
+        rc = pin(fileHandle, p, frame, hit);
+        assert(rc == success && !hit && "Pinning a page in a free frame should not fail.");
+        assert(frame[0] == p && "The frame should hold the page.");
+    }
+    rc = pin(fileHandle, numberOfFrames, frame, hit);
+    assert(rc != success && "Pinning a page should fail while every frame is pinned.");
+
+    // A second pin on page 0 is released once, the page stays pinned
+    rc = pin(fileHandle, 0, frame, hit);
+    assert(rc == success && hit && "Pinning a resident page should be a hit.");
+    unpin(fileHandle, 0, false);
+    rc = bufferPool.setCapacity(numberOfFrames);
+    assert(rc != success && "Resizing the buffer pool should fail while frames are pinned.");
+
+    // Page 1 is modified and released: it is the only victim, and it is written back when evicted
+    rc = pin(fileHandle, 1, frame, hit);
+    assert(rc == success && hit);
+    unpin(fileHandle, 1, false);
+    frame[1] = 0xAA;
+    unpin(fileHandle, 1, true);
+    rc = pin(fileHandle, numberOfFrames, frame, hit);
+    assert(rc == success && !hit && "Pinning a page should evict the only unpinned frame.");
+    rc = pin(fileHandle, 1, frame, hit);
+    assert(rc != success && "The evicted page has no frame left to come back to.");
+
+    unpin(fileHandle, numberOfFrames, false);
+    rc = pin(fileHandle, 1, frame, hit);
+    assert(rc == success && !hit && "The evicted page should be read back from the file.");
+    assert(frame[0] == 1 && frame[1] == 0xAA && "A dirty page should be written back when it is evicted.");
+    unpin(fileHandle, 1, false);
+
+    for (PageNum p : {0u, 2u, 3u}) {
+        unpin(fileHandle, p, false);
+    }
+    std::cout << "Pinned frames are never evicted (policy " << policy << ")." << std::endl;
+}
+
+// LRU evicts the page released the longest time ago
+void testLRUOrder(FileHandle &fileHandle) {
+    BufferPool &bufferPool = BufferPool::instance();
+    bufferPool.setReplacementPolicy(LRU_REPLACEMENT);
+    RC rc = bufferPool.setCapacity(numberOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+
+    byte *frame;
+    bool hit;
+    for (PageNum p = 0; p < numberOfFrames; p++) {
+        rc = pin(fileHandle, p, frame, hit);
+        assert(rc == success && !hit);
+        unpin(fileHandle, p, false);
+    }
+    // Page 0 is used again, so page 1 becomes the least recently used
+    rc = pin(fileHandle, 0, frame, hit);
+    assert(rc == success && hit);
+    unpin(fileHandle, 0, false);
+    rc = pin(fileHandle, numberOfFrames, frame, hit);
+    assert(rc == success && !hit);
+    unpin(fileHandle, numberOfFrames, false);
+
+    rc = pin(fileHandle, 0, frame, hit);
+    assert(rc == success && hit && "The recently used page should still be resident.");
+    unpin(fileHandle, 0, false);
+    rc = pin(fileHandle, 1, frame, hit);
+    assert(rc == success && !hit && "The least recently used page should have been evicted.");
+    unpin(fileHandle, 1, false);
+    std::cout << "LRU evicts the least recently used page." << std::endl;
+}
+
+int RBFTest_BufferPool(PagedFileManager &pfm) {
+    // Functions tested
+    // 1. Pin/unpin pages with every frame pinned, for both replacement policies
+    // 2. LRU replacement order
+    // 3. Write-back of dirty pages on eviction and on close
+    std::cout << std::endl << "***** In RBF Test Case BufferPool *****" << std::endl;
+
+    RC rc;
+    std::string fileName = "test_bufferpool";
+    BufferPool &bufferPool = BufferPool::instance();
+    // Writes only happen when the test expects them
+    bufferPool.setBackgroundWriterDelay(0);
+
+    rc = pfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = pfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    byte page[PAGE_SIZE];
+    for (unsigned p = 0; p < numberOfPages; p++) {
+        memset(page, p, PAGE_SIZE);
+        rc = fileHandle.appendPage(page);
+        assert(rc == success && "Appending a page should not fail.");
+    }
+
+    testPinnedFrames(fileHandle, LRU_REPLACEMENT);
+    testPinnedFrames(fileHandle, CLOCK_REPLACEMENT);
+    testLRUOrder(fileHandle);
+
+    // A page written through the handle is only dirty in its frame until the file is closed
+    memset(page, 0xBB, PAGE_SIZE);
+    rc = fileHandle.writePage(7, page);
+    assert(rc == success && "Writing a page should not fail.");
+    rc = pfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    // On disk right after the close, data page n starts after the hidden page
+    std::ifstream in(fileName.c_str(), std::ifstream::in | std::ifstream::binary);
+    in.seekg(8 * PAGE_SIZE);
+    in.read(reinterpret_cast<char *>(page), PAGE_SIZE);
+    assert(in && page[0] == 0xBB && page[PAGE_SIZE - 1] == 0xBB && "Closing a file should write back its dirty pages.");
+    in.close();
+
+    rc = pfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    assert(fileHandle.getNumberOfPages() == numberOfPages && "The file should keep its pages.");
+    rc = fileHandle.readPage(7, page);
+    assert(rc == success && page[0] == 0xBB && "The written page should survive a reopen.");
+    rc = fileHandle.readPage(1, page);
+    assert(rc == success && page[0] == 1 && page[1] == 0xAA && "The page written back on eviction should survive a reopen.");
+    rc = pfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = pfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    bufferPool.setReplacementPolicy(LRU_REPLACEMENT);
+    bufferPool.setCapacity(BUFFER_POOL_FRAMES);
+    bufferPool.setBackgroundWriterDelay(BG_WRITER_DELAY);
+
+    std::cout << "RBF Test Case BufferPool Finished! The result will be examined." << std::endl << std::endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the buffer pool under the paged file manager
+    remove("test_bufferpool");
+    return RBFTest_BufferPool(PagedFileManager::instance());
+}
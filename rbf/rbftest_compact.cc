@@ -0,0 +1,184 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numRecords = 60;
+const int shortText = 300;
+const int longText = 900;
+
+void createCompactRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Text";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 1000;
+    recordDescriptor.push_back(attr);
+}
+
+// A record whose Text is "textLength" times the same letter, picked by "id"
+void prepareCompactRecord(int id, int textLength, void *buffer, int *recordSize) {
+    int offset = 0;
+    memset(buffer, 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &textLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, textLength);
+    offset += textLength;
+    *recordSize = offset;
+}
+
+// A record of the test: where it is, its text length, and whether it was deleted
+struct CompactRecord {
+    RID rid;
+    int textLength;
+    bool deleted;
+};
+
+bool sameRID(const RID &a, const RID &b) {
+    return a.pageNum == b.pageNum && a.slotNum == b.slotNum;
+}
+
+// The live records read back as written, the deleted ones can't be read unless a new record took their slot
+void checkRecords(RecordBasedFileManager &rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                  const vector<CompactRecord> &records) {
+    char record[2000];
+    char returnedRecord[2000];
+    int recordSize;
+    for (unsigned id = 0; id < records.size(); id++) {
+        RC rc = rbfm.readRecord(fileHandle, recordDescriptor, records[id].rid, returnedRecord);
+        if (records[id].deleted) {
+            bool reused = false;
+            for (unsigned other = id + 1; other < records.size(); other++) {
+                reused |= !records[other].deleted && sameRID(records[other].rid, records[id].rid);
+            }
+            assert((reused || rc != success) && "Reading a deleted record should fail.");
+            continue;
+        }
+        assert(rc == success && "Reading a record should not fail.");
+        prepareCompactRecord(id, records[id].textLength, record, &recordSize);
+        assert(memcmp(record, returnedRecord, recordSize) == 0 && "The record should read back as written.");
+    }
+}
+
+unsigned deadBytesOfPage(FileHandle &fileHandle, unsigned pageNumber) {
+    byte page[PAGE_SIZE];
+    RC rc = fileHandle.readPage(pageNumber, page);
+    assert(rc == success && "Reading a page should not fail.");
+    return RecordBasedFileManager::deadBytes(page);
+}
+
+int RBFTest_Compact(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. Delete records: their bytes stay on the page as dead bytes
+    // 2. Insert a record that only fits in the dead bytes of a page: the page is compacted for it
+    // 3. Compact the file, then read the surviving records under their RIDs
+    cout << endl << "***** In RBF Test Case Compact *****" << endl;
+
+    RC rc;
+    string fileName = "test_compact";
+    vector<Attribute> recordDescriptor;
+    createCompactRecordDescriptor(recordDescriptor);
+
+    rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    char record[2000];
+    int recordSize;
+    vector<CompactRecord> records;
+    for (int id = 0; id < numRecords; id++) {
+        prepareCompactRecord(id, shortText, record, &recordSize);
+        CompactRecord compactRecord = {{0, 0}, shortText, false};
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, compactRecord.rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        records.push_back(compactRecord);
+    }
+
+    // Every other record of the first data page goes, the others don't move
+    const unsigned firstPage = records[0].rid.pageNum;
+    for (int id = 1; id < numRecords && records[id].rid.pageNum == firstPage; id += 2) {
+        rc = rbfm.deleteRecord(fileHandle, recordDescriptor, records[id].rid);
+        assert(rc == success && "Deleting a record should not fail.");
+        records[id].deleted = true;
+    }
+    assert(deadBytesOfPage(fileHandle, firstPage) >= 2 * shortText && "Deleted records should leave dead bytes.");
+    checkRecords(rbfm, fileHandle, recordDescriptor, records);
+
+    // Long records fill the last page, then wrap around to the first data page, which only has room once compacted
+    bool reused = false;
+    for (int i = 0; i < numRecords && !reused; i++) {
+        const int id = records.size();
+        prepareCompactRecord(id, longText, record, &recordSize);
+        CompactRecord compactRecord = {{0, 0}, longText, false};
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, compactRecord.rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        records.push_back(compactRecord);
+        reused = compactRecord.rid.pageNum == firstPage;
+    }
+    assert(reused && "A long record should go to the dead bytes of the first data page.");
+    assert(deadBytesOfPage(fileHandle, firstPage) == 0 && "The page should be compacted for the long record.");
+    checkRecords(rbfm, fileHandle, recordDescriptor, records);
+
+    // Holes all over the file, then a sweep gives their bytes back
+    for (unsigned id = 0; id < records.size(); id += 3) {
+        if (!records[id].deleted) {
+            rc = rbfm.deleteRecord(fileHandle, recordDescriptor, records[id].rid);
+            assert(rc == success && "Deleting a record should not fail.");
+            records[id].deleted = true;
+        }
+    }
+    unsigned compacted;
+    rc = rbfm.compactFile(fileHandle, compacted);
+    assert(rc == success && "Compacting the file should not fail.");
+    assert(compacted > 1 && "The pages with deleted records should be compacted.");
+    for (unsigned p = 0; p < fileHandle.getNumberOfPages(); p++) {
+        assert(deadBytesOfPage(fileHandle, p) == 0 && "A compacted file has no dead bytes.");
+    }
+    rc = rbfm.compactFile(fileHandle, compacted);
+    assert(rc == success && compacted == 0 && "Compacting the file again should find nothing to do.");
+    checkRecords(rbfm, fileHandle, recordDescriptor, records);
+
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    // The records are still there after a reopen
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    checkRecords(rbfm, fileHandle, recordDescriptor, records);
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Compact Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the lazy deletes and the compaction of the pages
+    remove("test_compact");
+    return RBFTest_Compact(RecordBasedFileManager::instance());
+}
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+const unsigned numberOfPages = 64;
+const unsigned numberOfFrames = 16;
+const unsigned numberOfThreads = 8;
+const unsigned readsPerThread = 400;
+const unsigned pagesPerRead = 4;
+
+// Page p is its number followed by a byte pattern of its own, so that a page read in the wrong buffer shows
+void preparePage(PageNum p, byte *page) {
+    memset(page, (p * 7 + 1) & 0xFF, PAGE_SIZE);
+    memcpy(page, &p, sizeof(PageNum));
+}
+
+void checkPage(PageNum p, const byte *page) {
+    byte expected[PAGE_SIZE];
+    preparePage(p, expected);
+    assert(memcmp(page, expected, PAGE_SIZE) == 0 && "A page should read back as written.");
+}
+
+// Thread t reads the file through a handle of its own: sweeps for the even threads, which start the read-ahead of
+// their handle, random pages for the odd ones, with readPage(), readPages() and pinPage() in turn
+void readFile(const std::string &fileName, unsigned t) {
+    FileHandle fileHandle;
+    RC rc = PagedFileManager::instance().openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    byte page[PAGE_SIZE];
+    byte pages[pagesPerRead][PAGE_SIZE];
+    void *buffers[pagesPerRead];
+    for (unsigned i = 0; i < pagesPerRead; i++) {
+        buffers[i] = pages[i];
+    }
+    unsigned seed = t + 1;
+    for (unsigned r = 0; r < readsPerThread; r++) {
+        seed = seed * 1103515245 + 12345;
+        const PageNum p = t % 2 == 0 ? (r + t) % numberOfPages : (seed >> 8) % numberOfPages;
+        switch (r % 3) {
+            case 0:
+                rc = fileHandle.readPage(p, page);
+                assert(rc == success && "Reading a page should not fail.");
+                checkPage(p, page);
+                break;
+            case 1: {
+                const PageNum first = std::min(p, numberOfPages - pagesPerRead);
+                rc = fileHandle.readPages(first, pagesPerRead, buffers);
+                assert(rc == success && "Reading several pages should not fail.");
+                for (unsigned i = 0; i < pagesPerRead; i++) {
+                    checkPage(first + i, pages[i]);
+                }
+                break;
+            }
+            default: {
+                byte *frame;
+                rc = fileHandle.pinPage(p, frame);
+                assert(rc == success && "Pinning a page should not fail.");
+                checkPage(p, frame);
+                rc = fileHandle.unpinPage(p, false);
+                assert(rc == success && "Unpinning a page should not fail.");
+            }
+        }
+    }
+    rc = PagedFileManager::instance().closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+}
+
+int RBFTest_Concurrent(PagedFileManager &pfm) {
+    // Functions tested
+    // 1. Several threads reading the same file through a pool much smaller than the file: misses are read while
+    //    other threads hit, miss and prefetch
+    // 2. readPage(), readPages() and pinPage() all return the pages as written
+    std::cout << std::endl << "***** In RBF Test Case Concurrent *****" << std::endl;
+
+    RC rc;
+    std::string fileName = "test_concurrent";
+    BufferPool &bufferPool = BufferPool::instance();
+    rc = bufferPool.setCapacity(numberOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+
+    rc = pfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = pfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    byte page[PAGE_SIZE];
+    for (PageNum p = 0; p < numberOfPages; p++) {
+        preparePage(p, page);
+        rc = fileHandle.appendPage(page);
+        assert(rc == success && "Appending a page should not fail.");
+    }
+    // The pages are on disk, the threads have to read most of them from there
+    rc = pfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numberOfThreads; t++) {
+        threads.push_back(std::thread(readFile, fileName, t));
+    }
+    for (unsigned t = 0; t < numberOfThreads; t++) {
+        threads[t].join();
+    }
+
+    // Nothing is left pinned or loading: the pool can be resized
+    rc = bufferPool.setCapacity(BUFFER_POOL_FRAMES);
+    assert(rc == success && "Resizing the buffer pool should not fail once the readers are done.");
+
+    rc = pfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    std::cout << "RBF Test Case Concurrent Finished! The result will be examined." << std::endl << std::endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the buffer pool shared by threads reading the same file
+    remove("test_concurrent");
+    return RBFTest_Concurrent(PagedFileManager::instance());
+}
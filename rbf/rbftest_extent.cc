@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <sys/stat.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+const unsigned extentSize = 16;
+const unsigned numberOfPages = 20;
+
+// Page p of a file of "pageSize" bytes pages: its number, then a byte of its own
+void prepareExtentPage(PageNum p, unsigned pageSize, byte *page) {
+    memset(page, (p * 3 + 1) & 0xFF, pageSize);
+    memcpy(page, &p, sizeof(PageNum));
+}
+
+// Size of the file, and the bytes allocated to it
+void fileSizes(const std::string &fileName, off_t &size, off_t &allocated) {
+    struct stat fileInfo;
+    int res = stat(fileName.c_str(), &fileInfo);
+    assert(res == 0 && "The file should exist.");
+    size = fileInfo.st_size;
+    allocated = static_cast<off_t>(fileInfo.st_blocks) * 512;
+}
+
+// Appends "count" pages, which only reach the file when it is flushed: the preallocated extents don't change its
+// size. The pages read back after a reopen
+void appendAndReadBack(PagedFileManager &pfm, const std::string &fileName, unsigned pageSize, unsigned count) {
+    RC rc = pfm.createFile(fileName, pageSize);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = pfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    byte page[MAX_PAGE_SIZE];
+    off_t size, allocated;
+    for (PageNum p = 0; p < count; p++) {
+        prepareExtentPage(p, pageSize, page);
+        rc = fileHandle.appendPage(page);
+        assert(rc == success && "Appending a page should not fail.");
+    }
+    fileSizes(fileName, size, allocated);
+    assert(size == pageSize && "Preallocating pages should not change the size of the file.");
+
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+    fileSizes(fileName, size, allocated);
+    assert(size == (off_t) (count + 1) * pageSize && "The file should be as long as the pages written.");
+
+    rc = pfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = pfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    assert(fileHandle.getNumberOfPages() == count && "The file should keep its pages.");
+    byte expected[MAX_PAGE_SIZE];
+    for (PageNum p = 0; p < count; p++) {
+        rc = fileHandle.readPage(p, page);
+        assert(rc == success && "Reading a page should not fail.");
+        prepareExtentPage(p, pageSize, expected);
+        assert(memcmp(page, expected, pageSize) == 0 && "A page should read back as written.");
+    }
+
+    // Appended after the reopen, into the blocks preallocated before it
+    prepareExtentPage(count, pageSize, page);
+    rc = fileHandle.appendPage(page);
+    assert(rc == success && "Appending a page should not fail.");
+    rc = pfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = pfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    rc = fileHandle.readPage(count, expected);
+    assert(rc == success && memcmp(page, expected, pageSize) == 0 && "The last page should read back as written.");
+    rc = pfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+}
+
+int RBFTest_Extent(PagedFileManager &pfm) {
+    // Functions tested
+    // 1. setExtentSize(), and its bounds
+    // 2. Preallocated extents don't change the size of the file, only writes do
+    // 3. Small files grow by their size, extents are counted in PAGE_SIZE bytes whatever the page size of the file
+    // 4. Pages appended into preallocated blocks read back as written, before and after a reopen
+    std::cout << std::endl << "***** In RBF Test Case Extent *****" << std::endl;
+
+    RC rc;
+    std::string fileName = "test_extent";
+    // Pages only reach the file when the test flushes them
+    BufferPool::instance().setBackgroundWriterDelay(0);
+    rc = pfm.setExtentSize(0);
+    assert(rc != success && "An empty extent should be refused.");
+    rc = pfm.setExtentSize(extentSize);
+    assert(rc == success && pfm.getExtentSize() == extentSize && "Setting the extent size should not fail.");
+
+    // Grown by 1, 1, 2, 4, 8, then by extents of 16 pages: 32 pages for the 21 written
+    appendAndReadBack(pfm, fileName, PAGE_SIZE, numberOfPages);
+    off_t size, allocated;
+    fileSizes(fileName, size, allocated);
+    assert(allocated >= (off_t) (2 * extentSize + 1) * PAGE_SIZE && "A growing file should be preallocated by extents.");
+    assert(allocated <= (off_t) (3 * extentSize + 1) * PAGE_SIZE && "A file should grow by one extent at a time.");
+    rc = pfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    // A file of a few pages gets no more blocks than it needs
+    appendAndReadBack(pfm, fileName, PAGE_SIZE, 2);
+    fileSizes(fileName, size, allocated);
+    assert(allocated <= (off_t) 8 * PAGE_SIZE && "A small file should stay small.");
+    rc = pfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    // 16 pages of 4K are one page of 64K: the big pages don't make the extents 16 times larger
+    appendAndReadBack(pfm, fileName, MAX_PAGE_SIZE, numberOfPages);
+    fileSizes(fileName, size, allocated);
+    assert(allocated <= (off_t) (numberOfPages + 4) * MAX_PAGE_SIZE && "An extent should be counted in PAGE_SIZE bytes.");
+    rc = pfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = pfm.setExtentSize(EXTENT_SIZE);
+    assert(rc == success && "Setting the extent size should not fail.");
+    BufferPool::instance().setBackgroundWriterDelay(BG_WRITER_DELAY);
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    std::cout << "RBF Test Case Extent Finished! The result will be examined." << std::endl << std::endl;
+
+    return 0;
+}
+
+int main() {
+    // To test how the files grow on disk
+    remove("test_extent");
+    return RBFTest_Extent(PagedFileManager::instance());
+}
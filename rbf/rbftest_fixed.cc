@@ -0,0 +1,202 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <algorithm>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// More fields than a byte of null indicators covers
+const unsigned numFields = 10;
+
+// F0 int, F1 real, F2 int, ...: every field is fixed-width
+void createFixedRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    for (unsigned f = 0; f < numFields; f++) {
+        Attribute attr;
+        attr.name = "F" + to_string(f);
+        attr.type = f % 2 == 0 ? TypeInt : TypeReal;
+        attr.length = (AttrLength) 4;
+        recordDescriptor.push_back(attr);
+    }
+}
+
+// Fields left NULL by each record of the test: none, the first, the last (in the second indicator byte), two, all
+const vector<vector<unsigned>> nullFields = {{}, {0}, {9}, {2, 5}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}};
+
+// Record r: field f is r*100+f for an int, r+f/4 for a real, unless it is in nullFields[r]
+void prepareFixedRecord(unsigned r, void *buffer, int *recordSize) {
+    byte *nullsIndicator = static_cast<byte *>(buffer);
+    const unsigned nullIndicatorSize = Schema::nullIndicatorSize(numFields);
+    memset(nullsIndicator, 0, nullIndicatorSize);
+    int offset = nullIndicatorSize;
+    for (unsigned f = 0; f < numFields; f++) {
+        bool isNull = false;
+        for (unsigned n : nullFields[r]) {
+            isNull |= n == f;
+        }
+        if (isNull) {
+            nullsIndicator[f / 8] |= 1 << (7 - f % 8);
+        }
+        else if (f % 2 == 0) {
+            int value = r * 100 + f;
+            memcpy((char *) buffer + offset, &value, sizeof(int));
+            offset += sizeof(int);
+        }
+        else {
+            float value = r + f / 4.0f;
+            memcpy((char *) buffer + offset, &value, sizeof(float));
+            offset += sizeof(float);
+        }
+    }
+    *recordSize = offset;
+}
+
+// The fast path and the generic decoder return the same bytes, whole and projected
+void checkProjections(const Schema &schema, const RecordView &view, const char *record, int recordSize) {
+    char fixedData[200];
+    char genericData[200];
+    unsigned fixedSize = view.project(schema, fixedData);
+    unsigned genericSize = view.project(genericData);
+    assert(fixedSize == genericSize && memcmp(fixedData, genericData, genericSize) == 0
+           && "The fast path should read the record as the generic decoder does.");
+    assert(fixedSize == (unsigned) recordSize && memcmp(fixedData, record, recordSize) == 0
+           && "The record should read back as written.");
+
+    for (const vector<unsigned> &fields : vector<vector<unsigned>>{{3}, {9, 0}, {1, 2, 5, 8, 9, 4, 0, 3, 7}}) {
+        fixedSize = view.project(schema, fields, fixedData);
+        genericSize = view.project(fields, genericData);
+        assert(fixedSize == genericSize && memcmp(fixedData, genericData, genericSize) == 0
+               && "The fast path should project the record as the generic decoder does.");
+    }
+}
+
+int RBFTest_Fixed(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. Stored records of a descriptor of ints and reals only, in both record formats: the fixed header of the
+    //    records without NULLs, the generic offsets of the others
+    // 2. Whole and projected reads of those records through the fixed layout, against the generic decoder
+    // 3. Insert, read, read an attribute and scan them in a file
+    cout << endl << "***** In RBF Test Case Fixed *****" << endl;
+
+    RC rc;
+    string fileName = "test_fixed";
+    vector<Attribute> recordDescriptor;
+    createFixedRecordDescriptor(recordDescriptor);
+    Schema schema(recordDescriptor);
+    assert(schema.isFixedWidth() && schema.getFixedLength() == 4 * numFields && "Every field of the descriptor is fixed-width.");
+
+    char record[200];
+    int recordSize;
+    for (bool compact : {false, true}) {
+        // The header records without NULLs share: the field offsets, after zeroed null indicators in the compact format
+        vector<byte> header;
+        if (compact) {
+            header.assign(Schema::nullIndicatorSize(numFields), 0);
+        }
+        for (unsigned f = 0; f <= numFields; f++) {
+            unsigned offset = 4 * f;
+            uint16_t compactOffset = offset;
+            const byte *bytes = compact ? reinterpret_cast<const byte *>(&compactOffset) : reinterpret_cast<const byte *>(&offset);
+            header.insert(header.end(), bytes, bytes + (compact ? sizeof(uint16_t) : sizeof(unsigned)));
+        }
+        assert(schema.getFixedRecordHeader(compact) == header && "The fixed header should hold the offsets of the fields.");
+
+        for (unsigned r = 0; r < nullFields.size(); r++) {
+            prepareFixedRecord(r, record, &recordSize);
+            vector<byte> recordFormat;
+            rbfm.transformDataToRecordFormat(schema, record, recordFormat, compact);
+            if (nullFields[r].empty()) {
+                assert(equal(header.begin(), header.end(), recordFormat.begin())
+                       && "A record without NULLs should start with the fixed header.");
+            }
+            RecordView view(recordFormat.data(), numFields, compact);
+            for (unsigned f = 0; f < numFields; f++) {
+                assert(view.isNull(f) == Schema::isNull(record, f) && "The stored record should keep its NULLs.");
+            }
+            checkProjections(schema, view, record, recordSize);
+        }
+    }
+
+    rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    char returnedData[200];
+    vector<RID> rids(nullFields.size());
+    for (unsigned r = 0; r < nullFields.size(); r++) {
+        prepareFixedRecord(r, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, schema, record, rids[r]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    for (unsigned r = 0; r < nullFields.size(); r++) {
+        prepareFixedRecord(r, record, &recordSize);
+        rc = rbfm.readRecord(fileHandle, schema, rids[r], returnedData);
+        assert(rc == success && "Reading a record should not fail.");
+        assert(memcmp(returnedData, record, recordSize) == 0 && "The record should read back as written.");
+
+        // F9 alone: a null indicator byte, then its value unless it is NULL
+        rc = rbfm.readAttribute(fileHandle, schema, rids[r], "F9", returnedData);
+        assert(rc == success && "Reading an attribute should not fail.");
+        assert(((returnedData[0] & 0x80) != 0) == Schema::isNull(record, 9) && "The attribute should keep its NULL.");
+        if (!Schema::isNull(record, 9)) {
+            float value;
+            memcpy(&value, returnedData + 1, sizeof(float));
+            assert(value == r + 9 / 4.0f && "The attribute should read back as written.");
+        }
+    }
+
+    // F2 and F0, in that order: record 3 has F2 NULL, record 4 both. The iterator closes the handle it is given
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm.scan(fileHandle, schema, "", NO_OP, NULL, {"F2", "F0"}, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RID rid;
+    unsigned count = 0;
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+        unsigned r = 0;
+        while (r < rids.size() && !(rids[r].pageNum == rid.pageNum && rids[r].slotNum == rid.slotNum)) {
+            r++;
+        }
+        assert(r < rids.size() && "The scan should return the records of the file.");
+        prepareFixedRecord(r, record, &recordSize);
+        const bool f2Null = Schema::isNull(record, 2), f0Null = Schema::isNull(record, 0);
+        assert(((returnedData[0] & 0x80) != 0) == f2Null && ((returnedData[0] & 0x40) != 0) == f0Null
+               && "The projection should keep the NULLs.");
+        int offset = 1;
+        for (int expected : {f2Null ? -1 : (int) r * 100 + 2, f0Null ? -1 : (int) r * 100}) {
+            if (expected != -1) {
+                int value;
+                memcpy(&value, returnedData + offset, sizeof(int));
+                assert(value == expected && "The projection should read the values of the record.");
+                offset += sizeof(int);
+            }
+        }
+        count++;
+    }
+    rbfmScanIterator.close();
+    assert(count == nullFields.size() && "The scan should return every record.");
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Fixed Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the constant layout of the records of int/real descriptors
+    remove("test_fixed");
+    return RBFTest_Fixed(RecordBasedFileManager::instance());
+}
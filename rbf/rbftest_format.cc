@@ -0,0 +1,257 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const unsigned numFields = 10;
+const unsigned bigLength = 40000;
+const unsigned grownBigLength = 60000;
+
+// Ten fields, so that the null indicators take two bytes: ints, reals and varchars side by side
+void createMixedRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    const AttrType types[numFields] = {TypeInt, TypeVarChar, TypeReal, TypeVarChar, TypeInt,
+                                       TypeVarChar, TypeReal, TypeInt, TypeVarChar, TypeInt};
+    for (unsigned f = 0; f < numFields; f++) {
+        Attribute attr;
+        attr.name = "F" + to_string(f);
+        attr.type = types[f];
+        attr.length = (AttrLength) (types[f] == TypeVarChar ? 20 : 4);
+        recordDescriptor.push_back(attr);
+    }
+}
+
+// A varchar large enough that the fields after it start past 32767 bytes in a page of 64K
+void createWideRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Big";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) grownBigLength;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Score";
+    attr.type = TypeReal;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Tail";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 100;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Count";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+}
+
+bool isNullField(unsigned nulls, unsigned field) {
+    return (nulls >> field & 1) != 0;
+}
+
+// Value of field f of the record of "seed", in the API format
+string fieldValue(const vector<Attribute> &recordDescriptor, int seed, const vector<unsigned> &lengths, unsigned f) {
+    if (recordDescriptor[f].type == TypeInt) {
+        int value = seed * 10 + f;
+        return string(reinterpret_cast<const char *>(&value), sizeof(int));
+    }
+    if (recordDescriptor[f].type == TypeReal) {
+        float value = seed + f / 4.0f;
+        return string(reinterpret_cast<const char *>(&value), sizeof(float));
+    }
+    return string(reinterpret_cast<const char *>(&lengths[f]), sizeof(unsigned)) + string(lengths[f], 'a' + (seed + f) % 26);
+}
+
+// The listed fields of the record in the format of readRecord(): bit f of "nulls" makes field f NULL
+string prepareFormatRecord(const vector<Attribute> &recordDescriptor, const vector<unsigned> &fields, unsigned nulls,
+                           int seed, const vector<unsigned> &lengths) {
+    string record(Schema::nullIndicatorSize(fields.size()), 0);
+    for (unsigned i = 0; i < fields.size(); i++) {
+        if (isNullField(nulls, fields[i])) {
+            record[i / 8] |= (char) (1 << (7 - i % 8));
+        } else {
+            record += fieldValue(recordDescriptor, seed, lengths, fields[i]);
+        }
+    }
+    return record;
+}
+
+vector<unsigned> allFields(const vector<Attribute> &recordDescriptor) {
+    vector<unsigned> fields;
+    for (unsigned f = 0; f < recordDescriptor.size(); f++) {
+        fields.push_back(f);
+    }
+    return fields;
+}
+
+// Every field of the view, then the whole record and a projection in another order
+void checkFormatView(const RecordView &view, const vector<Attribute> &recordDescriptor, unsigned nulls, int seed,
+                     const vector<unsigned> &lengths) {
+    assert(view.isValid() && view.getFieldCount() == recordDescriptor.size() && "The view should hold every field.");
+    for (unsigned f = 0; f < recordDescriptor.size(); f++) {
+        unsigned length;
+        const byte *field = view.getField(f, length);
+        assert(view.isNull(f) == isNullField(nulls, f) && "A field should keep its NULL.");
+        const string value = view.isNull(f) ? string() : fieldValue(recordDescriptor, seed, lengths, f);
+        assert(length == value.size() && memcmp(field, value.data(), length) == 0 && "A field should be stored as given.");
+    }
+
+    vector<char> projected(grownBigLength + 1000);
+    const string record = prepareFormatRecord(recordDescriptor, allFields(recordDescriptor), nulls, seed, lengths);
+    assert(view.project(projected.data()) == record.size() && memcmp(projected.data(), record.data(), record.size()) == 0
+           && "The view should project the record as written.");
+    const vector<unsigned> fields = {(unsigned) recordDescriptor.size() - 1, 0, (unsigned) recordDescriptor.size() / 2, 1};
+    const string expected = prepareFormatRecord(recordDescriptor, fields, nulls, seed, lengths);
+    assert(view.project(fields, projected.data()) == expected.size() && memcmp(projected.data(), expected.data(), expected.size()) == 0
+           && "The view should project the listed fields in order.");
+}
+
+// Every NULL layout of the ten fields, empty and non-empty varchars, in both formats
+void testMixedLayouts(RecordBasedFileManager &rbfm) {
+    vector<Attribute> recordDescriptor;
+    createMixedRecordDescriptor(recordDescriptor);
+    Schema schema(recordDescriptor);
+    for (unsigned nulls = 0; nulls < 1u << numFields; nulls++) {
+        const int seed = nulls * 7;
+        vector<unsigned> lengths(numFields);
+        for (unsigned f = 0; f < numFields; f++) {
+            lengths[f] = (nulls + f) % 5 == 0 ? 0 : (seed + f) % 20;
+        }
+        const string record = prepareFormatRecord(recordDescriptor, allFields(recordDescriptor), nulls, seed, lengths);
+        vector<byte> rowFormat, compactFormat;
+        rbfm.transformDataToRecordFormat(schema, record.data(), rowFormat);
+        rbfm.transformDataToRecordFormat(schema, record.data(), compactFormat, true);
+        assert(compactFormat.size() >= 2 * sizeof(unsigned) && "A compact record should have room for a tombstone.");
+        assert(compactFormat.size() < rowFormat.size() && "The compact header should be the smaller one.");
+        assert(memcmp(compactFormat.data(), record.data(), Schema::nullIndicatorSize(numFields)) == 0
+               && "A compact record should start with the null indicators.");
+        checkFormatView(RecordView(rowFormat.data(), numFields), recordDescriptor, nulls, seed, lengths);
+        checkFormatView(RecordView(compactFormat.data(), numFields, true), recordDescriptor, nulls, seed, lengths);
+    }
+}
+
+// Records of a 64K page whose last fields start past 32767 bytes, the range of a signed 2-byte offset
+void testWideRecords(RecordBasedFileManager &rbfm, const string &fileName) {
+    vector<Attribute> recordDescriptor;
+    createWideRecordDescriptor(recordDescriptor);
+    RC rc = rbfm.createFile(fileName, MAX_PAGE_SIZE);
+    assert(rc == success && "Creating the file should not fail.");
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && RecordBasedFileManager::hasCompactRecords(fileHandle) && "A new file should have compact records.");
+
+    // No NULL, a NULL on either side of the big varchar, the big varchar NULL
+    const vector<unsigned> nullLayouts = {0, 0x4, 0x1 | 0x8, 0x2, 0x10};
+    vector<unsigned> lengths = {0, bigLength, 0, 77, 0};
+    vector<RID> rids(nullLayouts.size());
+    for (unsigned r = 0; r < nullLayouts.size(); r++) {
+        const string record = prepareFormatRecord(recordDescriptor, allFields(recordDescriptor), nullLayouts[r], r, lengths);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record.data(), rids[r]);
+        assert(rc == success && "Inserting a wide record should not fail.");
+    }
+
+    vector<char> returnedData(grownBigLength + 1000);
+    const vector<unsigned> lastFields = {4, 3};
+    for (unsigned r = 0; r < nullLayouts.size(); r++) {
+        const string record = prepareFormatRecord(recordDescriptor, allFields(recordDescriptor), nullLayouts[r], r, lengths);
+        rc = rbfm.readRecord(fileHandle, recordDescriptor, rids[r], returnedData.data());
+        assert(rc == success && memcmp(returnedData.data(), record.data(), record.size()) == 0
+               && "A wide record should read back as written.");
+        const string count = prepareFormatRecord(recordDescriptor, {4}, nullLayouts[r], r, lengths);
+        rc = rbfm.readAttribute(fileHandle, recordDescriptor, rids[r], "Count", returnedData.data());
+        assert(rc == success && memcmp(returnedData.data(), count.data(), count.size()) == 0
+               && "The field after the big varchar should be read from its offset.");
+
+        RecordView view;
+        PageNum pinnedPage;
+        rc = rbfm.pinRecord(fileHandle, recordDescriptor, rids[r], view, pinnedPage);
+        assert(rc == success && "Pinning a record should not fail.");
+        checkFormatView(view, recordDescriptor, nullLayouts[r], r, lengths);
+        rc = fileHandle.unpinPage(pinnedPage, false);
+        assert(rc == success && "Unpinning the page should not fail.");
+    }
+
+    // A condition and a projection on the fields past the big varchar
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+    FileHandle scanHandle;
+    rc = rbfm.openFile(fileName, scanHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    const int minCount = 10;
+    rc = rbfm.scan(scanHandle, recordDescriptor, "Count", GE_OP, &minCount, {"Count", "Tail"}, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RID rid;
+    unsigned count = 0;
+    while (rbfmScanIterator.getNextRecord(rid, returnedData.data()) != RBFM_EOF) {
+        unsigned r = 0;
+        while (r < rids.size() && (rids[r].pageNum != rid.pageNum || rids[r].slotNum != rid.slotNum)) {
+            r++;
+        }
+        assert(r < rids.size() && !isNullField(nullLayouts[r], 4) && r * 10 + 4 >= (unsigned) minCount
+               && "The scan should return the records that satisfy it.");
+        const string expected = prepareFormatRecord(recordDescriptor, lastFields, nullLayouts[r], r, lengths);
+        assert(memcmp(returnedData.data(), expected.data(), expected.size()) == 0 && "The scan should project the last fields.");
+        count++;
+    }
+    rbfmScanIterator.close();
+    assert(count == 3 && "The records with a Count of 10 or more should be returned.");
+
+    // Grown to 60000 bytes: its last offsets come close to what 2 bytes hold
+    lengths[1] = grownBigLength;
+    const string grown = prepareFormatRecord(recordDescriptor, allFields(recordDescriptor), nullLayouts[0], 0, lengths);
+    rc = rbfm.updateRecord(fileHandle, recordDescriptor, grown.data(), rids[0]);
+    assert(rc == success && "Updating a wide record should not fail.");
+    rc = rbfm.readRecord(fileHandle, recordDescriptor, rids[0], returnedData.data());
+    assert(rc == success && memcmp(returnedData.data(), grown.data(), grown.size()) == 0
+           && "A grown record should read back as written.");
+    RecordView view;
+    PageNum pinnedPage;
+    rc = rbfm.pinRecord(fileHandle, recordDescriptor, rids[0], view, pinnedPage);
+    assert(rc == success && "Pinning a record should not fail.");
+    checkFormatView(view, recordDescriptor, nullLayouts[0], 0, lengths);
+    rc = fileHandle.unpinPage(pinnedPage, false);
+    assert(rc == success && "Unpinning the page should not fail.");
+
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+}
+
+int RBFTest_Format(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. The compact record format against the 4-byte offsets: every NULL layout of ten fields, through RecordView
+    // 2. Records of a 64K page with field offsets past 32767: read, read an attribute, pinned, scanned
+    // 3. A record grown to 60000 bytes
+    cout << endl << "***** In RBF Test Case Format *****" << endl;
+
+    string fileName = "test_format";
+    testMixedLayouts(rbfm);
+    testWideRecords(rbfm, fileName);
+
+    RC rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Format Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the record formats
+    remove("test_format");
+    return RBFTest_Format(RecordBasedFileManager::instance());
+}
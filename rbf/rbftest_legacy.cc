@@ -0,0 +1,209 @@
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const unsigned numberOfPages = 2;
+const unsigned recordsPerPage = 40;
+
+// A record of the test, different for every i
+void prepareTestRecord(const vector<Attribute> &recordDescriptor, int i, void *record, int *recordSize) {
+    unsigned char nullsIndicator = 0;
+    string name = "Legacy" + to_string(i);
+    prepareRecord(recordDescriptor.size(), &nullsIndicator, name.size(), name, 20 + i, 160.5f + i, 1000 * i, record, recordSize);
+}
+
+// Writes the file the way the code without the free-space map did: a hidden page holding the counters and the number
+// of pages only, then data pages of records starting at offset 0, each with its slot directory at the end of the page
+void writeBaselineFile(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor) {
+    ofstream out(fileName.c_str(), ios::out | ios::trunc | ios::binary);
+    byte page[PAGE_SIZE];
+    memset(page, 0, PAGE_SIZE);
+    reinterpret_cast<unsigned *>(page)[3] = numberOfPages;
+    out.write(reinterpret_cast<char *>(page), PAGE_SIZE);
+
+    byte record[1000];
+    int recordSize;
+    vector<byte> recordFormat;
+    for (unsigned p = 0; p < numberOfPages; p++) {
+        memset(page, 0, PAGE_SIZE);
+        unsigned freeSpaceOffset = 0;
+        for (unsigned s = 0; s < recordsPerPage; s++) {
+            prepareTestRecord(recordDescriptor, p * recordsPerPage + s, record, &recordSize);
+            recordFormat.clear();
+            rbfm.transformDataToRecordFormat(recordDescriptor, record, recordFormat);
+            memcpy(page + freeSpaceOffset, recordFormat.data(), recordFormat.size());
+            reinterpret_cast<unsigned *>(page + PAGE_SIZE)[-4 - 2 * (int) s] = freeSpaceOffset;
+            reinterpret_cast<unsigned *>(page + PAGE_SIZE)[-3 - 2 * (int) s] = recordFormat.size();
+            freeSpaceOffset += recordFormat.size();
+        }
+        reinterpret_cast<unsigned *>(page + PAGE_SIZE)[-1] = freeSpaceOffset;
+        reinterpret_cast<unsigned *>(page + PAGE_SIZE)[-2] = recordsPerPage;
+        out.write(reinterpret_cast<char *>(page), PAGE_SIZE);
+    }
+    out.close();
+}
+
+// Every record of the file but "deleted" reads back as written, "updated" as its new version
+void checkRecords(RecordBasedFileManager &rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                  const RID &deleted, const RID &updated) {
+    byte record[1000];
+    byte returnedRecord[1000];
+    int recordSize;
+    for (unsigned i = 0; i < numberOfPages * recordsPerPage; i++) {
+        RID rid = {i / recordsPerPage, i % recordsPerPage};
+        RC rc = rbfm.readRecord(fileHandle, recordDescriptor, rid, returnedRecord);
+        if (rid.pageNum == deleted.pageNum && rid.slotNum == deleted.slotNum) {
+            assert(rc != success && "Reading a deleted record should fail.");
+            continue;
+        }
+        assert(rc == success && "Reading a record should not fail.");
+        bool isUpdated = rid.pageNum == updated.pageNum && rid.slotNum == updated.slotNum;
+        prepareTestRecord(recordDescriptor, isUpdated ? 100000 + i : i, record, &recordSize);
+        assert(memcmp(returnedRecord, record, recordSize) == 0 && "A record of the old file should read back as written.");
+    }
+}
+
+// The i-th record of "inserted" reads back as the i-th record inserted
+void checkInsertedRecords(RecordBasedFileManager &rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                          const vector<RID> &inserted) {
+    byte record[1000];
+    byte returnedRecord[1000];
+    int recordSize;
+    for (unsigned i = 0; i < inserted.size(); i++) {
+        prepareTestRecord(recordDescriptor, 200000 + i, record, &recordSize);
+        RC rc = rbfm.readRecord(fileHandle, recordDescriptor, inserted[i], returnedRecord);
+        assert(rc == success && memcmp(returnedRecord, record, recordSize) == 0 && "An inserted record should read back.");
+    }
+}
+
+int RBFTest_Legacy(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. Open a record-based file written before the free-space map existed
+    // 2. Read and scan its records, page 0 included
+    // 3. Insert, update and delete records in it
+    // 4. Upgrade its pages to the slot bitmap, then read and insert records
+    cout << endl << "***** In RBF Test Case Legacy *****" << endl;
+
+    RC rc;
+    string fileName = "test_legacy";
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    writeBaselineFile(rbfm, fileName, recordDescriptor);
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    assert(!RecordBasedFileManager::hasFreeSpaceMap(fileHandle) && "A file of the old format has no free-space map.");
+    assert(fileHandle.getNumberOfPages() == numberOfPages && "The file should keep its pages.");
+
+    RID none = {UINT_MAX, UINT_MAX};
+    checkRecords(rbfm, fileHandle, recordDescriptor, none, none);
+
+    // Page 0 holds records, the scan returns them too. The iterator closes the handle it is given
+    FileHandle scanHandle;
+    rc = rbfm.openFile(fileName, scanHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    vector<string> attributes = {"Salary"};
+    rc = rbfm.scan(scanHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RID rid;
+    byte returnedData[1000];
+    unsigned count = 0;
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+        int salary;
+        memcpy(&salary, returnedData + 1, sizeof(int));
+        assert(salary == 1000 * (int) (rid.pageNum * recordsPerPage + rid.slotNum) && "The scan should return the records of the file.");
+        count++;
+    }
+    rbfmScanIterator.close();
+    assert(count == numberOfPages * recordsPerPage && "The scan should return every record, the ones of page 0 too.");
+
+    // A record deleted from page 0 leaves room there, and an update makes page 0 grow its record
+    RID deleted = {0, 5};
+    rc = rbfm.deleteRecord(fileHandle, recordDescriptor, deleted);
+    assert(rc == success && "Deleting a record should not fail.");
+    RID updated = {0, 7};
+    byte updatedRecord[1000];
+    int recordSize;
+    prepareTestRecord(recordDescriptor, 100000 + 7, updatedRecord, &recordSize);
+    rc = rbfm.updateRecord(fileHandle, recordDescriptor, updatedRecord, updated);
+    assert(rc == success && "Updating a record should not fail.");
+
+    // New records go to the data pages with room, none of them is taken for a map page
+    byte record[1000];
+    vector<RID> inserted;
+    for (int i = 0; i < 20; i++) {
+        prepareTestRecord(recordDescriptor, 200000 + i, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        assert(rid.pageNum < numberOfPages && "A page with room should get the new record.");
+        inserted.push_back(rid);
+    }
+    checkRecords(rbfm, fileHandle, recordDescriptor, deleted, updated);
+
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    // Everything is still there after a reopen
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    assert(!RecordBasedFileManager::hasFreeSpaceMap(fileHandle));
+    checkRecords(rbfm, fileHandle, recordDescriptor, deleted, updated);
+    checkInsertedRecords(rbfm, fileHandle, recordDescriptor, inserted);
+
+    // Both pages have room for the slot bitmap: the upgrade gives it to them, page 0 included, and moves their records
+    unsigned upgraded;
+    rc = rbfm.upgradeFile(fileHandle, upgraded);
+    assert(rc == success && "Upgrading the file should not fail.");
+    assert(upgraded == numberOfPages && "Every page of the file should be upgraded.");
+    rc = rbfm.upgradeFile(fileHandle, upgraded);
+    assert(rc == success && upgraded == 0 && "Upgrading the file again should find nothing to do.");
+    assert(!RecordBasedFileManager::hasFreeSpaceMap(fileHandle) && "The upgrade doesn't add a free-space map.");
+    checkRecords(rbfm, fileHandle, recordDescriptor, deleted, updated);
+    checkInsertedRecords(rbfm, fileHandle, recordDescriptor, inserted);
+
+    // The upgraded pages take new records and keep their old ones, after a reopen too
+    for (int i = 20; i < 30; i++) {
+        prepareTestRecord(recordDescriptor, 200000 + i, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        assert(rid.pageNum < numberOfPages && "A page with room should get the new record.");
+        inserted.push_back(rid);
+    }
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    checkRecords(rbfm, fileHandle, recordDescriptor, deleted, updated);
+    checkInsertedRecords(rbfm, fileHandle, recordDescriptor, inserted);
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Legacy Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the files written before the free-space map existed
+    remove("test_legacy");
+    return RBFTest_Legacy(RecordBasedFileManager::instance());
+}
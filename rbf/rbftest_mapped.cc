@@ -0,0 +1,253 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numRecords = 300;
+const int grownRecords = 3000;
+const int textLength = 200;
+
+void createMappedRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Text";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 1000;
+    recordDescriptor.push_back(attr);
+}
+
+// A record whose Text is "length" times the same letter, picked by "id"
+void prepareMappedRecord(int id, int length, void *buffer, int *recordSize) {
+    int offset = 0;
+    memset(buffer, 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &length, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, length);
+    offset += length;
+    *recordSize = offset;
+}
+
+// Every record the scan returns, in order, read through a mapping or through the buffer pool
+void scanFile(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+              bool mapped, vector<RID> &rids, vector<string> &records) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    rc = fileHandle.setMappedReads(mapped);
+    assert(rc == success && "Setting the read path should not fail.");
+
+    // The iterator closes the handle it is given
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm.scan(fileHandle, recordDescriptor, "", NO_OP, NULL, {"Id", "Text"}, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RID rid;
+    char returnedData[2000];
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+        int length;
+        memcpy(&length, returnedData + 1 + sizeof(int), sizeof(int));
+        rids.push_back(rid);
+        records.push_back(string(returnedData, 1 + 2 * sizeof(int) + length));
+    }
+    rbfmScanIterator.close();
+}
+
+// Scans, readRecord() and readAttribute() return the same through the mapping as through the buffer pool
+void testMappedReads(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+                     PageLayout layout) {
+    RC rc = rbfm.createFile(fileName, PAGE_SIZE, layout);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    char record[2000];
+    char returnedData[2000];
+    int recordSize;
+    vector<RID> rids(numRecords);
+    for (int id = 0; id < numRecords; id++) {
+        prepareMappedRecord(id, 50 + id % 100, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rids[id]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    // Longer records move away from their full pages, their slots become tombstones
+    for (int id = 0; id < numRecords; id += 7) {
+        prepareMappedRecord(id, 900, record, &recordSize);
+        rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, rids[id]);
+        assert(rc == success && "Updating a record should not fail.");
+    }
+
+    // The updates are dirty in the pool: they are written back before their pages are mapped
+    rc = fileHandle.setMappedReads(true);
+    assert(rc == success && "Enabling mapped reads should not fail.");
+    for (int id = 0; id < numRecords; id++) {
+        prepareMappedRecord(id, id % 7 == 0 ? 900 : 50 + id % 100, record, &recordSize);
+        rc = rbfm.readRecord(fileHandle, recordDescriptor, rids[id], returnedData);
+        assert(rc == success && "Reading a record should not fail.");
+        assert(memcmp(record, returnedData, recordSize) == 0 && "A record should read back as written through the mapping.");
+
+        rc = rbfm.readAttribute(fileHandle, recordDescriptor, rids[id], "Id", returnedData);
+        assert(rc == success && "Reading an attribute should not fail.");
+        assert(memcmp(returnedData + 1, &id, sizeof(int)) == 0 && "An attribute should read back as written through the mapping.");
+    }
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    vector<RID> bufferedRids, mappedRids;
+    vector<string> bufferedRecords, mappedRecords;
+    scanFile(rbfm, fileName, recordDescriptor, false, bufferedRids, bufferedRecords);
+    scanFile(rbfm, fileName, recordDescriptor, true, mappedRids, mappedRecords);
+    assert(bufferedRecords.size() >= (unsigned) numRecords && "The scan should return every record.");
+    assert(mappedRecords == bufferedRecords && "A scan should return the same records through the mapping.");
+    for (unsigned i = 0; i < mappedRids.size(); i++) {
+        assert(mappedRids[i].pageNum == bufferedRids[i].pageNum && mappedRids[i].slotNum == bufferedRids[i].slotNum
+               && "A scan should return the same RIDs through the mapping.");
+    }
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+}
+
+// Pages and record views handed out stay valid while the file grows and is mapped again
+void testStablePointers(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor) {
+    RC rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    rc = fileHandle.setMappedReads(true);
+    assert(rc == success && "Enabling mapped reads should not fail.");
+
+    // Records of the same length: the full pages aren't touched by the later inserts
+    char record[2000];
+    int recordSize;
+    RID rid;
+    for (int id = 0; id < numRecords; id++) {
+        prepareMappedRecord(id, textLength, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    const PageNum firstPage = 1;
+    const PageNum lastPage = fileHandle.getNumberOfPages() - 1;
+    const byte *first;
+    rc = fileHandle.mapPage(firstPage, first);
+    assert(rc == success && "Mapping a page should not fail.");
+    const byte *last;
+    rc = fileHandle.mapPage(lastPage, last);
+    assert(rc == success && "Mapping a page should not fail.");
+    const string firstCopy(reinterpret_cast<const char *>(first), PAGE_SIZE);
+
+    // A record view of a scan points into the mapping as well. The other handle learns the page count from the file
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+    FileHandle scanHandle;
+    rc = rbfm.openFile(fileName, scanHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    rc = scanHandle.setMappedReads(true);
+    assert(rc == success && "Enabling mapped reads should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm.scan(scanHandle, recordDescriptor, "", NO_OP, NULL, {"Id", "Text"}, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RecordView view;
+    rc = rbfmScanIterator.getNextRecordView(rid, view);
+    assert(rc == success && "Getting a record view should not fail.");
+    char viewed[2000];
+    const unsigned viewedSize = view.project(viewed);
+
+    // The file grows to many times its size, each new last page is mapped
+    const unsigned readsBefore = fileHandle.readPageCounter;
+    for (int id = numRecords; id < grownRecords; id++) {
+        prepareMappedRecord(id, textLength, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rc = fileHandle.mapPage(rid.pageNum, last);
+        assert(rc == success && "Mapping a new page should not fail.");
+    }
+    assert(fileHandle.getNumberOfPages() > 4 * (lastPage + 1) && "The file should have grown.");
+    assert(fileHandle.readPageCounter - readsBefore >= (unsigned) (grownRecords - numRecords)
+           && "Mapping a page should count as reading it.");
+    char returnedData[2000];
+    rc = rbfm.readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && memcmp(record, returnedData, recordSize) == 0 && "The last record should read back as written.");
+
+    const byte *firstAgain;
+    rc = fileHandle.mapPage(firstPage, firstAgain);
+    assert(rc == success && "Mapping a page should not fail.");
+    assert(firstAgain != first && "The grown file should have been mapped again.");
+    assert(memcmp(first, firstCopy.data(), PAGE_SIZE) == 0 && memcmp(firstAgain, first, PAGE_SIZE) == 0
+           && "A page handed out before the file grew should still be readable.");
+    char projected[2000];
+    assert(view.project(projected) == viewedSize && memcmp(projected, viewed, viewedSize) == 0
+           && "A record view handed out before the file grew should still be readable.");
+
+    // A page written through the pool is written back before it is mapped, the old pointer shares the file
+    byte page[PAGE_SIZE];
+    memcpy(page, first, PAGE_SIZE);
+    page[0] ^= 0xFF;
+    rc = fileHandle.writePage(firstPage, page);
+    assert(rc == success && "Writing a page should not fail.");
+    rc = fileHandle.mapPage(firstPage, firstAgain);
+    assert(rc == success && memcmp(firstAgain, page, PAGE_SIZE) == 0 && "A mapped page should show the last write.");
+    assert(memcmp(first, page, PAGE_SIZE) == 0 && "An old mapping should show the last write as well.");
+
+    rbfmScanIterator.close();
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+}
+
+int RBFTest_Mapped(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. readRecord(), readAttribute() and scans through the mapping of the file, in both layouts, with forwarded
+    //    records: the same results as through the buffer pool
+    // 2. Pointers to pages and record views from the mapping survive the file growing and being mapped again
+    // 3. Writes through the pool show through the mapping
+    cout << endl << "***** In RBF Test Case Mapped *****" << endl;
+
+    string fileName = "test_mapped";
+    vector<Attribute> recordDescriptor;
+    createMappedRecordDescriptor(recordDescriptor);
+
+    // The file grows a page at a time, so that it outgrows its mapping
+    PagedFileManager &pfm = PagedFileManager::instance();
+    RC rc = pfm.setExtentSize(1);
+    assert(rc == success && "Setting the extent size should not fail.");
+
+    testMappedReads(rbfm, fileName, recordDescriptor, ROW_LAYOUT);
+    testMappedReads(rbfm, fileName, recordDescriptor, PAX_LAYOUT);
+    testStablePointers(rbfm, fileName, recordDescriptor);
+
+    rc = pfm.setExtentSize(EXTENT_SIZE);
+    assert(rc == success && "Setting the extent size should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Mapped Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the reads through the mapping of a file
+    remove("test_mapped");
+    return RBFTest_Mapped(RecordBasedFileManager::instance());
+}
@@ -0,0 +1,199 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+const unsigned numberOfPages = 24;
+const unsigned numberOfFrames = 16;
+
+// Page p: its number, then a byte of its own that "version" shifts
+void preparePagesPage(PageNum p, unsigned version, unsigned pageSize, byte *page) {
+    memset(page, (p * 7 + version * 13 + 1) & 0xFF, pageSize);
+    memcpy(page, &p, sizeof(PageNum));
+}
+
+// Page p straight from the file, behind the buffer pool: the hidden page comes first
+void readPageFromFile(const std::string &fileName, PageNum p, unsigned pageSize, byte *page) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    assert(fd >= 0 && "Opening the file should not fail.");
+    ssize_t bytes = pread(fd, page, pageSize, (off_t) (p + 1) * pageSize);
+    assert(bytes == (ssize_t) pageSize && "The page should be on disk.");
+    close(fd);
+}
+
+// Counters of the handle and the pool, before and after a call
+struct PageCounters {
+    unsigned reads, writes, appends, hits, misses, written;
+
+    explicit PageCounters(FileHandle &fileHandle) {
+        fileHandle.collectCounterValues(reads, writes, appends);
+        fileHandle.collectBufferCounterValues(hits, misses);
+        written = BufferPool::instance().getPagesWritten();
+    }
+};
+
+// Every third page is resident, read with readPage() out of order so that nothing is read ahead
+void makeResident(FileHandle &fileHandle, unsigned pageSize) {
+    RC rc = BufferPool::instance().setCapacity(numberOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+    std::vector<byte> page(pageSize);
+    for (PageNum p = numberOfPages; p-- > 0;) {
+        if (p % 3 == 0) {
+            rc = fileHandle.readPage(p, page.data());
+            assert(rc == success && "Reading a page should not fail.");
+        }
+    }
+}
+
+void testPages(PagedFileManager &pfm, const std::string &fileName, unsigned pageSize) {
+    RC rc = pfm.createFile(fileName, pageSize);
+    assert(rc == success && "Creating the file should not fail.");
+    FileHandle fileHandle;
+    rc = pfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    std::vector<byte> data(numberOfPages * pageSize);
+    std::vector<byte> expected(pageSize);
+    for (PageNum p = 0; p < numberOfPages; p++) {
+        preparePagesPage(p, 0, pageSize, data.data() + p * pageSize);
+        rc = fileHandle.appendPage(data.data() + p * pageSize);
+        assert(rc == success && "Appending a page should not fail.");
+    }
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+
+    // Scattered read of [2, 22): a third of the pages come from their frames, the runs between them from the file
+    makeResident(fileHandle, pageSize);
+    const PageNum first = 2;
+    const unsigned count = 20;
+    const unsigned resident = 7;    // 3, 6, ..., 21
+    std::vector<std::vector<byte> > buffers(count, std::vector<byte>(pageSize));
+    std::vector<void *> pages(count);
+    for (unsigned i = 0; i < count; i++) {
+        pages[i] = buffers[i].data();
+    }
+    PageCounters before(fileHandle);
+    rc = fileHandle.readPages(first, count, pages.data());
+    assert(rc == success && "Reading pages should not fail.");
+    PageCounters after(fileHandle);
+    for (unsigned i = 0; i < count; i++) {
+        preparePagesPage(first + i, 0, pageSize, expected.data());
+        assert(memcmp(buffers[i].data(), expected.data(), pageSize) == 0 && "A page should read back as written.");
+    }
+    assert(after.reads - before.reads == count && "Each page read should be counted once.");
+    assert(after.hits - before.hits == resident && after.misses - before.misses == count - resident
+           && "The resident pages should be hits, the others misses.");
+    assert(after.writes == before.writes && after.appends == before.appends && "A read should not count writes.");
+
+    // Packed read of the whole file, nothing resident
+    rc = BufferPool::instance().setCapacity(numberOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+    std::vector<byte> packed(numberOfPages * pageSize);
+    before = PageCounters(fileHandle);
+    rc = fileHandle.readPages(0, numberOfPages, packed.data());
+    assert(rc == success && memcmp(packed.data(), data.data(), packed.size()) == 0 && "The pages should read back as written.");
+    after = PageCounters(fileHandle);
+    assert(after.reads - before.reads == numberOfPages && after.misses - before.misses == numberOfPages
+           && after.hits == before.hits && "Each page read from the file should be counted once, as a miss.");
+
+    // Scattered write of [2, 22): the resident pages are dirtied in their frames, the others written right away
+    makeResident(fileHandle, pageSize);
+    std::vector<const void *> constPages(count);
+    for (unsigned i = 0; i < count; i++) {
+        preparePagesPage(first + i, 1, pageSize, buffers[i].data());
+        constPages[i] = buffers[i].data();
+    }
+    before = PageCounters(fileHandle);
+    rc = fileHandle.writePages(first, count, constPages.data());
+    assert(rc == success && "Writing pages should not fail.");
+    after = PageCounters(fileHandle);
+    assert(after.writes - before.writes == count && "Each page written should be counted once.");
+    assert(after.reads == before.reads && after.appends == before.appends && "A write should not count reads.");
+    assert(after.written - before.written == count - resident && "Only the pages without a frame should reach the file.");
+    for (unsigned i = 0; i < count; i++) {
+        const PageNum p = first + i;
+        readPageFromFile(fileName, p, pageSize, expected.data());
+        assert(expected[sizeof(PageNum)] == ((p * 7 + (p % 3 == 0 ? 0 : 1) * 13 + 1) & 0xFF)
+               && "A resident page should only reach the file when it is written back.");
+    }
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+    for (unsigned i = 0; i < count; i++) {
+        readPageFromFile(fileName, first + i, pageSize, expected.data());
+        assert(memcmp(buffers[i].data(), expected.data(), pageSize) == 0 && "A page should be on disk as written.");
+    }
+
+    // Packed write, then read back through readPage()
+    for (PageNum p = 0; p < numberOfPages; p++) {
+        preparePagesPage(p, 2, pageSize, data.data() + p * pageSize);
+    }
+    before = PageCounters(fileHandle);
+    rc = fileHandle.writePages(0, numberOfPages, data.data());
+    assert(rc == success && "Writing pages should not fail.");
+    after = PageCounters(fileHandle);
+    assert(after.writes - before.writes == numberOfPages && "Each page written should be counted once.");
+    for (PageNum p = 0; p < numberOfPages; p++) {
+        rc = fileHandle.readPage(p, expected.data());
+        assert(rc == success && memcmp(data.data() + p * pageSize, expected.data(), pageSize) == 0
+               && "A page should read back as written.");
+    }
+
+    // Past the last page: nothing is transferred, the pages are counted all the same
+    before = PageCounters(fileHandle);
+    rc = fileHandle.readPages(numberOfPages - 2, 4, packed.data());
+    assert(rc != success && "Reading pages past the end of the file should fail.");
+    rc = fileHandle.writePages(numberOfPages - 2, 4, packed.data());
+    assert(rc != success && "Writing pages past the end of the file should fail.");
+    after = PageCounters(fileHandle);
+    assert(after.reads - before.reads == 4 && after.writes - before.writes == 4 && "Failed transfers should be counted per page.");
+    assert(fileHandle.getNumberOfPages() == numberOfPages && "A failed write should not grow the file.");
+
+    rc = pfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = pfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+}
+
+int RBFTest_Pages(PagedFileManager &pfm) {
+    // Functions tested
+    // 1. readPages() and writePages(), with a buffer per page and packed in one buffer
+    // 2. Resident pages are copied from and to their frames, the others transferred with the file in runs
+    // 3. The counters count pages: reads, writes, buffer hits and misses
+    // 4. Transfers past the end of the file fail
+    std::cout << std::endl << "***** In RBF Test Case Pages *****" << std::endl;
+
+    std::string fileName = "test_pages";
+    BufferPool &bufferPool = BufferPool::instance();
+    const unsigned capacity = bufferPool.getCapacity();
+    // Dirty frames only reach the file when the test flushes them
+    bufferPool.setBackgroundWriterDelay(0);
+
+    testPages(pfm, fileName, PAGE_SIZE);
+    testPages(pfm, fileName, 2 * PAGE_SIZE);
+
+    bufferPool.setBackgroundWriterDelay(BG_WRITER_DELAY);
+    RC rc = bufferPool.setCapacity(capacity);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    std::cout << "RBF Test Case Pages Finished! The result will be examined." << std::endl << std::endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the vectored page transfers
+    remove("test_pages");
+    return RBFTest_Pages(PagedFileManager::instance());
+}
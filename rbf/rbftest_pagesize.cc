@@ -0,0 +1,200 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numRecords = 300;
+
+// Text is declared as long as the widest value the test gives it
+void createPageSizeRecordDescriptor(unsigned pageSize, vector<Attribute> &recordDescriptor) {
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Text";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) (pageSize / 2 + 200);
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Score";
+    attr.type = TypeReal;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+}
+
+// Text of "textLength" times the same letter, picked by "id"; Score is NULL for every 4th record
+void preparePageSizeRecord(int id, int textLength, void *buffer, int *recordSize) {
+    int offset = 0;
+    float score = id / 2.0f;
+    memset(buffer, id % 4 == 0 ? 0x20 : 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &textLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, textLength);
+    offset += textLength;
+    if (id % 4 != 0) {
+        memcpy((char *) buffer + offset, &score, sizeof(float));
+        offset += sizeof(float);
+    }
+    *recordSize = offset;
+}
+
+// A third of the records don't fit in a page of 4096 bytes
+int textLengthOf(int id, unsigned pageSize) {
+    return id % 3 == 0 ? pageSize / 2 + 100 : 20 + id % 50;
+}
+
+void checkPageSizeRecords(RecordBasedFileManager &rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                          const vector<RID> &rids, const vector<int> &textLengths, const vector<bool> &deleted) {
+    vector<char> record(MAX_PAGE_SIZE + 100);
+    vector<char> returnedData(MAX_PAGE_SIZE + 100);
+    int recordSize;
+    for (int id = 0; id < numRecords; id++) {
+        RC rc = rbfm.readRecord(fileHandle, recordDescriptor, rids[id], returnedData.data());
+        if (deleted[id]) {
+            continue;
+        }
+        assert(rc == success && "Reading a record should not fail.");
+        preparePageSizeRecord(id, textLengths[id], record.data(), &recordSize);
+        assert(memcmp(record.data(), returnedData.data(), recordSize) == 0 && "A record should read back as written.");
+    }
+}
+
+// Inserts, updates (some records move away from their page), deletes and scans a file of "pageSize" bytes pages
+void testPageSize(RecordBasedFileManager &rbfm, const string &fileName, unsigned pageSize, PageLayout layout) {
+    vector<Attribute> recordDescriptor;
+    createPageSizeRecordDescriptor(pageSize, recordDescriptor);
+    RC rc = rbfm.createFile(fileName, pageSize, layout);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && fileHandle.getPageSize() == pageSize && "The file should have the page size it was created with.");
+
+    vector<char> record(MAX_PAGE_SIZE + 100);
+    vector<char> returnedData(MAX_PAGE_SIZE + 100);
+    int recordSize;
+    vector<RID> rids(numRecords);
+    vector<int> textLengths(numRecords);
+    vector<bool> deleted(numRecords, false);
+    for (int id = 0; id < numRecords; id++) {
+        textLengths[id] = textLengthOf(id, pageSize);
+        preparePageSizeRecord(id, textLengths[id], record.data(), &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record.data(), rids[id]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    checkPageSizeRecords(rbfm, fileHandle, recordDescriptor, rids, textLengths, deleted);
+
+    // Short records grown past the room left on their pages are forwarded, the wide ones shrink in place
+    unsigned forwarded = 0;
+    for (int id = 1; id < numRecords; id += 5) {
+        textLengths[id] = textLengths[id] < 100 ? pageSize / 2 + 200 : 10;
+        preparePageSizeRecord(id, textLengths[id], record.data(), &recordSize);
+        rc = rbfm.updateRecord(fileHandle, recordDescriptor, record.data(), rids[id]);
+        assert(rc == success && "Updating a record should not fail.");
+        RID location;
+        rc = rbfm.locateRecord(fileHandle, recordDescriptor, rids[id], location);
+        assert(rc == success && "Locating a record should not fail.");
+        forwarded += location.pageNum != rids[id].pageNum;
+    }
+    assert(forwarded > 0 && "Some updated records should have moved to another page.");
+    for (int id = 0; id < numRecords; id += 7) {
+        rc = rbfm.deleteRecord(fileHandle, recordDescriptor, rids[id]);
+        assert(rc == success && "Deleting a record should not fail.");
+        deleted[id] = true;
+    }
+    checkPageSizeRecords(rbfm, fileHandle, recordDescriptor, rids, textLengths, deleted);
+
+    int id = 2;
+    rc = rbfm.readAttribute(fileHandle, recordDescriptor, rids[id], "Text", returnedData.data());
+    int textLength;
+    memcpy(&textLength, returnedData.data() + 1, sizeof(int));
+    assert(rc == success && textLength == textLengths[id] && "Reading an attribute should return the whole varchar.");
+    id = 4;
+    rc = rbfm.readAttribute(fileHandle, recordDescriptor, rids[id], "Score", returnedData.data());
+    assert(rc == success && (returnedData[0] & 0x80) != 0 && "Reading a NULL attribute should return a NULL.");
+
+    // Id >= 100, projected on (Text, Id): every record through its home RID. A row page doesn't tell a forwarded
+    // record from the others, the scan returns it at its new place as well
+    vector<RID> locations(numRecords);
+    for (id = 0; id < numRecords; id++) {
+        if (!deleted[id]) {
+            rc = rbfm.locateRecord(fileHandle, recordDescriptor, rids[id], locations[id]);
+            assert(rc == success && "Locating a record should not fail.");
+        }
+    }
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+    FileHandle scanHandle;
+    rc = rbfm.openFile(fileName, scanHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    int lowId = 100;
+    rc = rbfm.scan(scanHandle, recordDescriptor, "Id", GE_OP, &lowId, {"Text", "Id"}, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RID rid;
+    vector<int> seenHome(numRecords, 0), seenMoved(numRecords, 0);
+    while (rbfmScanIterator.getNextRecord(rid, returnedData.data()) != RBFM_EOF) {
+        memcpy(&textLength, returnedData.data() + 1, sizeof(int));
+        memcpy(&id, returnedData.data() + 1 + sizeof(int) + textLength, sizeof(int));
+        assert(id >= lowId && id < numRecords && !deleted[id] && "The scan should only return live records that match.");
+        assert(textLength == textLengths[id] && returnedData[1 + sizeof(int)] == 'a' + id % 26
+               && returnedData[sizeof(int) + textLength] == 'a' + id % 26 && "The scan should return the whole varchar.");
+        if (rid.pageNum == rids[id].pageNum && rid.slotNum == rids[id].slotNum) {
+            seenHome[id]++;
+        } else {
+            assert(rid.pageNum == locations[id].pageNum && rid.slotNum == locations[id].slotNum
+                   && "The scan should return a record at its home RID or where it moved.");
+            seenMoved[id]++;
+        }
+    }
+    rbfmScanIterator.close();
+    for (id = lowId; id < numRecords; id++) {
+        assert(seenHome[id] == (deleted[id] ? 0 : 1) && "The scan should return every matching record through its home RID once.");
+        assert(seenMoved[id] <= (layout == ROW_LAYOUT ? 1 : 0) && "Only a row page returns a forwarded record where it moved.");
+    }
+
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+}
+
+int RBFTest_PageSize(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. Files of 8K and 64K pages, in both layouts: records with varchars wider than 4096 bytes and NULLs
+    // 2. Updates forwarding records to other pages, deletes, readAttribute()
+    // 3. A scan with a condition and a projection returns the whole varchars, forwarded records once
+    cout << endl << "***** In RBF Test Case PageSize *****" << endl;
+
+    string fileName = "test_pagesize";
+    testPageSize(rbfm, fileName, 2 * PAGE_SIZE, ROW_LAYOUT);
+    testPageSize(rbfm, fileName, MAX_PAGE_SIZE, ROW_LAYOUT);
+    testPageSize(rbfm, fileName, 2 * PAGE_SIZE, PAX_LAYOUT);
+    testPageSize(rbfm, fileName, MAX_PAGE_SIZE, PAX_LAYOUT);
+
+    RC rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case PageSize Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test files whose pages are larger than the default
+    remove("test_pagesize");
+    return RBFTest_PageSize(RecordBasedFileManager::instance());
+}
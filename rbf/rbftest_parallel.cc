@@ -0,0 +1,199 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <algorithm>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "parallelscan.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Enough records for more morsels than workers
+const int numRecords = 20000;
+
+// Record i: EmpName "Par<i>" padded with '.' to "nameLength" characters, Age i%60 (NULL for every 9th record),
+// Height i/4, Salary 3*i
+void prepareParallelRecord(const vector<Attribute> &recordDescriptor, int i, int nameLength, void *record, int *recordSize) {
+    unsigned char nullsIndicator = i % 9 == 0 ? 1 << 6 : 0;
+    string name = "Par" + to_string(i);
+    name.resize(max<size_t>(name.size(), nameLength), '.');
+    prepareRecord(recordDescriptor.size(), &nullsIndicator, name.size(), name, i % 60, i / 4.0f, 3 * i, record, recordSize);
+}
+
+// Salary of the records returned, by RID page and slot
+typedef map<pair<unsigned, unsigned>, int> ScanResult;
+
+void addRecord(ScanResult &result, const RID &rid, const char *data) {
+    assert(data[0] == 0 && "Salary is never NULL.");
+    int salary;
+    memcpy(&salary, data + 1, sizeof(int));
+    assert(result.insert(make_pair(make_pair(rid.pageNum, rid.slotNum), salary)).second && "A record should be returned once.");
+}
+
+ScanResult serialScan(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+                      const vector<ScanPredicate> &predicates) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm.scan(fileHandle, recordDescriptor, predicates, {"Salary"}, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RID rid;
+    char returnedData[200];
+    ScanResult result;
+    while ((rc = rbfmScanIterator.getNextRecord(rid, returnedData)) != RBFM_EOF) {
+        assert(rc == success && "Getting the next record should not fail.");
+        addRecord(result, rid, returnedData);
+    }
+    rbfmScanIterator.close();
+    return result;
+}
+
+ScanResult parallelScan(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+                        const vector<ScanPredicate> &predicates, unsigned workers) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ParallelScanIterator parallelScanIterator;
+    rc = rbfm.parallelScan(fileHandle, recordDescriptor, predicates, {"Salary"}, workers, parallelScanIterator);
+    assert(rc == success && "Scanning the file in parallel should not fail.");
+    RID rid;
+    char returnedData[200];
+    ScanResult result;
+    while ((rc = parallelScanIterator.getNextRecord(rid, returnedData)) != RBFM_EOF) {
+        assert(rc == success && "Getting the next record should not fail.");
+        addRecord(result, rid, returnedData);
+    }
+    rc = parallelScanIterator.close();
+    assert(rc == success && "Closing the parallel scan should not fail.");
+    return result;
+}
+
+int RBFTest_Parallel(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. Parallel scan with and without predicates: the records of the serial scan, under the same RIDs
+    // 2. Closing a parallel scan before its end, with the workers still running
+    // 3. A failing worker fails the scan
+    cout << endl << "***** In RBF Test Case Parallel *****" << endl;
+
+    RC rc;
+    string fileName = "test_parallel";
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    char record[200];
+    int recordSize;
+    vector<RID> rids(numRecords);
+    for (int i = 0; i < numRecords; i++) {
+        prepareParallelRecord(recordDescriptor, i, 0, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    // Some holes, and records growing out of their full pages: scans reach them through their home slots
+    for (int i = 0; i < numRecords; i++) {
+        if (i % 13 == 0) {
+            rc = rbfm.deleteRecord(fileHandle, recordDescriptor, rids[i]);
+            assert(rc == success && "Deleting a record should not fail.");
+        }
+        else if (i % 11 == 0) {
+            prepareParallelRecord(recordDescriptor, i, 30, record, &recordSize);
+            rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+            assert(rc == success && "Updating a record should not fail.");
+        }
+    }
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    assert(rids.back().pageNum > 8 * PARALLEL_SCAN_MORSEL_PAGES && "The file should hold many morsels.");
+
+    // 10 <= Age < 30, no NULL Age passes
+    int ageLow = 10, ageHigh = 30;
+    vector<ScanPredicate> predicates = {{"Age", GE_OP, &ageLow},
+                                        {"Age", LT_OP, &ageHigh}};
+    ScanResult expected = serialScan(rbfm, fileName, recordDescriptor, predicates);
+    assert(!expected.empty() && "The serial scan should return records.");
+    for (unsigned workers : {1u, 3u, 8u, 0u}) {
+        assert(parallelScan(rbfm, fileName, recordDescriptor, predicates, workers) == expected
+               && "A parallel scan should return the records of the serial scan.");
+    }
+    expected = serialScan(rbfm, fileName, recordDescriptor, {});
+    set<int> salaries, liveSalaries;
+    for (const auto &entry : expected) {
+        salaries.insert(entry.second);
+    }
+    for (int i = 0; i < numRecords; i++) {
+        if (i % 13 != 0) {
+            liveSalaries.insert(3 * i);
+        }
+    }
+    assert(salaries == liveSalaries && "The serial scan should return every record.");
+    assert(parallelScan(rbfm, fileName, recordDescriptor, {}, 4) == expected
+           && "A parallel scan should return the records of the serial scan.");
+
+    // The consumer stops after a few records: the workers blocked on their full queues are released
+    for (unsigned taken : {0u, 1u, 50u}) {
+        FileHandle fileHandle;
+        rc = rbfm.openFile(fileName, fileHandle);
+        assert(rc == success && "Opening the file should not fail.");
+        RBFM_ParallelScanIterator parallelScanIterator;
+        rc = rbfm.parallelScan(fileHandle, recordDescriptor, {}, {"Salary"}, 4, parallelScanIterator);
+        assert(rc == success && "Scanning the file in parallel should not fail.");
+        RID rid;
+        char returnedData[200];
+        for (unsigned i = 0; i < taken; i++) {
+            rc = parallelScanIterator.getNextRecord(rid, returnedData);
+            assert(rc == success && "Getting the next record should not fail.");
+        }
+        rc = parallelScanIterator.close();
+        assert(rc == success && "Closing a parallel scan early should not fail.");
+        rc = parallelScanIterator.close();
+        assert(rc != success && "Closing a parallel scan twice should fail.");
+    }
+
+    // A condition on an attribute the records don't have fails every worker
+    int bonus = 0;
+    {
+        FileHandle fileHandle;
+        rc = rbfm.openFile(fileName, fileHandle);
+        assert(rc == success && "Opening the file should not fail.");
+        RBFM_ParallelScanIterator parallelScanIterator;
+        rc = rbfm.parallelScan(fileHandle, recordDescriptor, {{"Bonus", EQ_OP, &bonus}}, {"Salary"}, 4, parallelScanIterator);
+        assert(rc == success && "Starting the parallel scan should not fail.");
+        RID rid;
+        char returnedData[200];
+        rc = parallelScanIterator.getNextRecord(rid, returnedData);
+        assert(rc != success && "The error of a worker should fail the scan.");
+        rc = parallelScanIterator.getNextRecord(rid, returnedData);
+        assert(rc != success && "A failed scan should stay failed.");
+        rc = parallelScanIterator.close();
+        assert(rc != success && "Closing a failed scan should report the failure.");
+    }
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Parallel Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the parallel scans
+    remove("test_parallel");
+    return RBFTest_Parallel(RecordBasedFileManager::instance());
+}
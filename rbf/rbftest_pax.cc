@@ -0,0 +1,196 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <map>
+#include <set>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+// Record i: EmpName "Pax<i>" padded with '.' to "nameLength" characters, Age i%50 (NULL for every 7th record),
+// Height i/2, Salary 10*i
+void preparePaxRecord(const vector<Attribute> &recordDescriptor, int i, int nameLength, void *record, int *recordSize) {
+    unsigned char nullsIndicator = i % 7 == 0 ? 1 << 6 : 0;
+    string name = "Pax" + to_string(i);
+    name.resize(nameLength, '.');
+    prepareRecord(recordDescriptor.size(), &nullsIndicator, name.size(), name, i % 50, i / 2.0f, 10 * i, record, recordSize);
+}
+
+void checkPaxRecord(RecordBasedFileManager &rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                    const RID &rid, int i, int nameLength) {
+    char record[200];
+    char returnedData[200];
+    int recordSize;
+    preparePaxRecord(recordDescriptor, i, nameLength, record, &recordSize);
+    RC rc = rbfm.readRecord(fileHandle, recordDescriptor, rid, returnedData);
+    assert(rc == success && "Reading a record should not fail.");
+    assert(memcmp(record, returnedData, recordSize) == 0 && "The record should read back as last written.");
+}
+
+// Scans the file for Salary >= "lowSalary", returns the records found by their Salary, with their RID
+map<int, RID> scanPax(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+                      int lowSalary) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    RBFM_ScanIterator rbfmScanIterator;
+    vector<string> attributes = {"Salary"};
+    rc = rbfm.scan(fileHandle, recordDescriptor, "Salary", GE_OP, &lowSalary, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    RID rid;
+    char returnedData[200];
+    map<int, RID> returned;
+    while ((rc = rbfmScanIterator.getNextRecord(rid, returnedData)) != RBFM_EOF) {
+        assert(rc == success && "Getting the next record should not fail.");
+        int salary;
+        memcpy(&salary, returnedData + 1, sizeof(int));
+        assert(returned.insert(make_pair(salary / 10, rid)).second && "A record should be returned once.");
+    }
+    rbfmScanIterator.close();
+    return returned;
+}
+
+int RBFTest_Pax(RecordBasedFileManager &rbfm) {
+    // Functions tested on a PAX file
+    // 1. Insert records until the first data page is full
+    // 2. Update a record that no longer fits on its page, then update it again where it moved
+    // 3. Delete records, the moved one included, and reuse their slots
+    // 4. Scan: every live record once, under its own RID
+    cout << endl << "***** In RBF Test Case PAX *****" << endl;
+
+    RC rc;
+    string fileName = "test_pax";
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    rc = rbfm.createFile(fileName, PAGE_SIZE, PAX_LAYOUT);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    assert(RecordBasedFileManager::isPax(fileHandle) && "The file should be a PAX file.");
+
+    // Names of 15 characters, half the declared length: the heap of a page is about full with its slots
+    const int shortName = 15, longName = 30;
+    char record[200];
+    int recordSize;
+    vector<RID> rids;
+    map<int, int> nameLengths;
+    RID rid;
+    for (int i = 0; rids.empty() || rids.back().pageNum == rids[0].pageNum; i++) {
+        preparePaxRecord(recordDescriptor, i, shortName, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+        nameLengths[i] = shortName;
+    }
+    const int numRecords = rids.size() + 20;
+    for (int i = rids.size(); i < numRecords; i++) {
+        preparePaxRecord(recordDescriptor, i, shortName, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        rids.push_back(rid);
+        nameLengths[i] = shortName;
+    }
+    for (int i = 0; i < numRecords; i++) {
+        checkPaxRecord(rbfm, fileHandle, recordDescriptor, rids[i], i, nameLengths[i]);
+    }
+
+    // The records of the full first data page grow, in turn, until one of them has to move off it
+    int moved = -1;
+    RID location;
+    for (int i = 0; moved < 0 && rids[i].pageNum == rids[0].pageNum; i++) {
+        preparePaxRecord(recordDescriptor, i, longName, record, &recordSize);
+        rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+        nameLengths[i] = longName;
+        rc = rbfm.locateRecord(fileHandle, recordDescriptor, rids[i], location);
+        assert(rc == success && "Locating a record should not fail.");
+        if (location.pageNum != rids[i].pageNum) {
+            moved = i;
+        }
+    }
+    assert(moved >= 0 && "A grown record should be moved off its full page.");
+    for (int i = 0; i < numRecords; i++) {
+        checkPaxRecord(rbfm, fileHandle, recordDescriptor, rids[i], i, nameLengths[i]);
+    }
+
+    // Updated again where it is, through its home RID
+    preparePaxRecord(recordDescriptor, moved, shortName, record, &recordSize);
+    rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, rids[moved]);
+    assert(rc == success && "Updating a moved record should not fail.");
+    nameLengths[moved] = shortName;
+    checkPaxRecord(rbfm, fileHandle, recordDescriptor, rids[moved], moved, shortName);
+
+    // Deleting the moved record frees both of its slots; two other records of its page too
+    const int deleted[] = {moved, moved == 7 ? 6 : 7, moved == 8 ? 9 : 8};
+    for (int i : deleted) {
+        rc = rbfm.deleteRecord(fileHandle, recordDescriptor, rids[i]);
+        assert(rc == success && "Deleting a record should not fail.");
+        nameLengths.erase(i);
+        char returnedData[200];
+        rc = rbfm.readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+        assert(rc != success && "Reading a deleted record should fail.");
+    }
+    rc = rbfm.deleteRecord(fileHandle, recordDescriptor, rids[deleted[2]]);
+    assert(rc != success && "Deleting a record twice should fail.");
+
+    // New records fill the last page, then go back to the slots given up on the first data page
+    set<unsigned> freedSlots = {rids[deleted[0]].slotNum, rids[deleted[1]].slotNum, rids[deleted[2]].slotNum};
+    int i = numRecords;
+    for (; freedSlots.size() == 3; i++) {
+        assert(i < 10 * numRecords && "A freed slot should be reused.");
+        preparePaxRecord(recordDescriptor, i, 1, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+        assert((rid.pageNum != rids[0].pageNum || freedSlots.erase(rid.slotNum) == 1) && "A freed slot should be reused.");
+        rids.push_back(rid);
+        nameLengths[i] = 1;
+    }
+    const int lastRecord = i - 1;
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    map<int, RID> returned = scanPax(rbfm, fileName, recordDescriptor, 0);
+    assert(returned.size() == nameLengths.size() && "The scan should return every live record.");
+    for (const auto &entry : returned) {
+        assert(nameLengths.count(entry.first) == 1 && "The scan should only return live records.");
+        assert(entry.second.pageNum == rids[entry.first].pageNum && entry.second.slotNum == rids[entry.first].slotNum
+               && "A record should be scanned under the RID it was inserted with.");
+    }
+    returned = scanPax(rbfm, fileName, recordDescriptor, 10 * lastRecord);
+    assert(returned.size() == 1 && returned.count(lastRecord) == 1 && "The scan should apply its condition.");
+
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    for (const auto &entry : nameLengths) {
+        checkPaxRecord(rbfm, fileHandle, recordDescriptor, rids[entry.first], entry.first, entry.second);
+    }
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case PAX Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the records of a PAX file
+    remove("test_pax");
+    return RBFTest_Pax(RecordBasedFileManager::instance());
+}
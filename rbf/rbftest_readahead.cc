@@ -0,0 +1,186 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numRecords = 1600;
+const int textLength = 400;
+const unsigned extentSize = 8;
+// Enough frames for the whole file: a prefetched page is never evicted before it is read
+const unsigned numOfFrames = 512;
+
+void createReadAheadRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Text";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) textLength;
+    recordDescriptor.push_back(attr);
+}
+
+void prepareReadAheadRecord(int id, void *buffer, int *recordSize) {
+    int offset = 0;
+    memset(buffer, 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &textLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, textLength);
+    offset += textLength;
+    *recordSize = offset;
+}
+
+// Empties the pool: every page read next comes from the file or from a prefetch
+void emptyBufferPool() {
+    RC rc = BufferPool::instance().setCapacity(numOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+}
+
+struct BufferCounters {
+    unsigned hits, misses;
+
+    explicit BufferCounters(FileHandle &fileHandle) {
+        fileHandle.collectBufferCounterValues(hits, misses);
+    }
+};
+
+int RBFTest_ReadAhead(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. The scan of a heap file of many extents announces itself (ReadAhead::setSequential()): only its first
+    //    page is a miss, the others were prefetched
+    // 2. A handle reading pages one after the other starts prefetching after READ_AHEAD_TRIGGER of them, one
+    //    reading every other page never does
+    // 3. BufferPool::prefetchPages(): the pages read next are hits
+    cout << endl << "***** In RBF Test Case ReadAhead *****" << endl;
+
+    RC rc;
+    string fileName = "test_readahead";
+    vector<Attribute> recordDescriptor;
+    createReadAheadRecordDescriptor(recordDescriptor);
+
+    PagedFileManager &pfm = PagedFileManager::instance();
+    BufferPool &bufferPool = BufferPool::instance();
+    const unsigned extentSizeBefore = pfm.getExtentSize();
+    const unsigned capacity = bufferPool.getCapacity();
+    rc = pfm.setExtentSize(extentSize);
+    assert(rc == success && "Setting the extent size should not fail.");
+
+    rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    vector<vector<char> > records(numRecords, vector<char>(textLength + 10));
+    vector<const void *> data(numRecords);
+    int recordSize;
+    for (int id = 0; id < numRecords; id++) {
+        prepareReadAheadRecord(id, records[id].data(), &recordSize);
+        data[id] = records[id].data();
+    }
+    vector<RID> rids;
+    rc = rbfm.insertRecords(fileHandle, recordDescriptor, data, rids);
+    assert(rc == success && "Inserting a batch of records should not fail.");
+    const unsigned numPages = fileHandle.getNumberOfPages();
+    assert(numPages > 20 * extentSize && "The file should span many extents.");
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    // A full scan: its first page is read, the window of pages after it keeps being prefetched
+    emptyBufferPool();
+    FileHandle scanHandle;
+    rc = rbfm.openFile(fileName, scanHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    rc = rbfm.scan(scanHandle, recordDescriptor, "", NO_OP, NULL, {"Id"}, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RID rid;
+    char returnedData[textLength + 10];
+    int count = 0;
+    while (rbfmScanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+        int id;
+        memcpy(&id, returnedData + 1, sizeof(int));
+        assert(id == count && "The scan should return the records in order.");
+        count++;
+    }
+    assert(count == numRecords && "The scan should return every record.");
+    BufferCounters scanned(rbfmScanIterator.getFileHandle());
+    const unsigned scannedPages = numPages - 1; //the free space map page isn't scanned
+    assert(scanned.hits + scanned.misses == scannedPages && "The scan should read each page once.");
+    assert(scanned.misses == 1 && "Only the first page of a sequential scan should miss.");
+    rbfmScanIterator.close();
+
+    // Page by page through readPage(): a new handle counts page 0 as the next one, so the first READ_AHEAD_TRIGGER
+    // pages miss, then the handle prefetches
+    emptyBufferPool();
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    vector<byte> page(fileHandle.getPageSize());
+    BufferCounters before(fileHandle);
+    for (PageNum p = 0; p < numPages; p++) {
+        rc = fileHandle.readPage(p, page.data());
+        assert(rc == success && "Reading a page should not fail.");
+    }
+    BufferCounters after(fileHandle);
+    assert(after.misses - before.misses == READ_AHEAD_TRIGGER && after.hits - before.hits == numPages - READ_AHEAD_TRIGGER
+           && "The pages after the trigger should have been prefetched.");
+
+    // Every other page: no run of consecutive reads, nothing is prefetched
+    emptyBufferPool();
+    before = BufferCounters(fileHandle);
+    for (PageNum p = 0; p < numPages; p += 2) {
+        rc = fileHandle.readPage(p, page.data());
+        assert(rc == success && "Reading a page should not fail.");
+    }
+    after = BufferCounters(fileHandle);
+    assert(after.hits == before.hits && after.misses - before.misses == (numPages + 1) / 2
+           && "A reader skipping pages should not trigger the read-ahead.");
+
+    // Pages prefetched by hand are hits, read backwards so that the handle doesn't prefetch on its own
+    emptyBufferPool();
+    const PageNum first = numPages / 2;
+    const unsigned prefetched = 2 * extentSize;
+    rc = bufferPool.prefetchPages(fileHandle.fileId, first, prefetched);
+    assert(rc == success && "Prefetching pages should not fail.");
+    before = BufferCounters(fileHandle);
+    for (PageNum p = first + prefetched; p-- > first; ) {
+        rc = fileHandle.readPage(p, page.data());
+        assert(rc == success && "Reading a page should not fail.");
+    }
+    after = BufferCounters(fileHandle);
+    assert(after.hits - before.hits == prefetched && after.misses == before.misses && "The prefetched pages should be hits.");
+
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+    rc = bufferPool.setCapacity(capacity);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+    rc = pfm.setExtentSize(extentSizeBefore);
+    assert(rc == success && "Setting the extent size should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case ReadAhead Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the prefetching of sequential reads
+    remove("test_readahead");
+    return RBFTest_ReadAhead(RecordBasedFileManager::instance());
+}
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numRecords = 24;
+const int shortText = 300;
+const int longText = 900;
+
+void createReclaimRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Text";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 1000;
+    recordDescriptor.push_back(attr);
+}
+
+// A record whose Text is "textLength" times the same letter, picked by "id"
+void prepareReclaimRecord(int id, int textLength, void *buffer, int *recordSize) {
+    int offset = 0;
+    memset(buffer, 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &textLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, textLength);
+    offset += textLength;
+    *recordSize = offset;
+}
+
+void checkRecord(RecordBasedFileManager &rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                 const RID &rid, int id, int textLength) {
+    char record[2000];
+    char returnedRecord[2000];
+    int recordSize;
+    prepareReclaimRecord(id, textLength, record, &recordSize);
+    RC rc = rbfm.readRecord(fileHandle, recordDescriptor, rid, returnedRecord);
+    assert(rc == success && "Reading a record should not fail.");
+    assert(memcmp(record, returnedRecord, recordSize) == 0 && "The record should read back as last written.");
+}
+
+bool sameRID(const RID &a, const RID &b) {
+    return a.pageNum == b.pageNum && a.slotNum == b.slotNum;
+}
+
+int RBFTest_Reclaim(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. Update a record that no longer fits on its page: it is forwarded
+    // 2. Reclaim forwarded records once their home page has room again
+    // 3. Update a record at the end of a two-hop chain: the chain becomes a single hop
+    cout << endl << "***** In RBF Test Case Reclaim *****" << endl;
+
+    RC rc;
+    string fileName = "test_reclaim";
+    vector<Attribute> recordDescriptor;
+    createReclaimRecordDescriptor(recordDescriptor);
+
+    rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    char record[2000];
+    int recordSize;
+    vector<RID> rids(numRecords);
+    for (int i = 0; i < numRecords; i++) {
+        prepareReclaimRecord(i, shortText, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    assert(rids[0].pageNum != rids[numRecords - 1].pageNum && "The records should fill more than a page.");
+
+    // The first page is full, the grown record goes to another one
+    prepareReclaimRecord(0, longText, record, &recordSize);
+    rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, rids[0]);
+    assert(rc == success && "Updating a record should not fail.");
+    RID location;
+    rc = rbfm.locateRecord(fileHandle, recordDescriptor, rids[0], location);
+    assert(rc == success && location.pageNum != rids[0].pageNum && "The grown record should be forwarded.");
+    checkRecord(rbfm, fileHandle, recordDescriptor, rids[0], 0, longText);
+
+    unsigned reclaimed;
+    rc = rbfm.reclaimForwardedRecords(fileHandle, reclaimed);
+    assert(rc == success && reclaimed == 0 && "A record can't go back to a page without room.");
+
+    // Deletions make room on the home page, the record comes back
+    for (int i = 1; i <= 3; i++) {
+        assert(rids[i].pageNum == rids[0].pageNum);
+        rc = rbfm.deleteRecord(fileHandle, recordDescriptor, rids[i]);
+        assert(rc == success && "Deleting a record should not fail.");
+    }
+    rc = rbfm.reclaimForwardedRecords(fileHandle, reclaimed);
+    assert(rc == success && reclaimed == 1 && "The forwarded record should be reclaimed.");
+    rc = rbfm.locateRecord(fileHandle, recordDescriptor, rids[0], location);
+    assert(rc == success && sameRID(location, rids[0]) && "The reclaimed record should be in its home slot.");
+    checkRecord(rbfm, fileHandle, recordDescriptor, rids[0], 0, longText);
+    for (int i = 4; i < numRecords; i++) {
+        checkRecord(rbfm, fileHandle, recordDescriptor, rids[i], i, shortText);
+    }
+
+    // A chain as older versions left them: home -> middle -> record. The middle hop is made out of another record,
+    // shrunk to a tombstone the way updateRecord() does it
+    const RID home = rids[4];
+    prepareReclaimRecord(4, longText, record, &recordSize);
+    rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, home);
+    assert(rc == success && "Updating a record should not fail.");
+    RID end;
+    rc = rbfm.locateRecord(fileHandle, recordDescriptor, home, end);
+    assert(rc == success && end.pageNum != home.pageNum && "The grown record should be forwarded.");
+
+    const unsigned pageSize = fileHandle.getPageSize();
+    const RID middle = rids[numRecords - 1];
+    assert(middle.pageNum != home.pageNum && middle.pageNum != end.pageNum);
+    byte page[PAGE_SIZE];
+    rc = fileHandle.readPage(middle.pageNum, page);
+    assert(rc == success && "Reading a page should not fail.");
+    RecordBasedFileManager::shiftRecord(page, pageSize, 2 * sizeof(unsigned), middle.slotNum);
+    int *offset = (int *) (page + pageSize - 2 * (middle.slotNum + 2) * sizeof(int));
+    int *length = (int *) (page + pageSize - (2 * middle.slotNum + 3) * sizeof(int));
+    memcpy(page + *offset, &end, 2 * sizeof(unsigned));
+    *length = -1;
+    rc = fileHandle.writePage(middle.pageNum, page);
+    assert(rc == success && "Writing a page should not fail.");
+    rc = rbfm.updateFreeSpaceMap(fileHandle, middle.pageNum, page);
+    assert(rc == success && "Updating the free-space map should not fail.");
+
+    rc = fileHandle.readPage(home.pageNum, page);
+    assert(rc == success && "Reading a page should not fail.");
+    offset = (int *) (page + pageSize - 2 * (home.slotNum + 2) * sizeof(int));
+    memcpy(page + *offset, &middle, 2 * sizeof(unsigned));
+    rc = fileHandle.writePage(home.pageNum, page);
+    assert(rc == success && "Writing a page should not fail.");
+    checkRecord(rbfm, fileHandle, recordDescriptor, home, 4, longText);
+
+    // The update at the end of the chain points the home slot straight at the record, the middle hop goes away
+    prepareReclaimRecord(4, longText - 100, record, &recordSize);
+    rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, home);
+    assert(rc == success && "Updating a record should not fail.");
+    checkRecord(rbfm, fileHandle, recordDescriptor, home, 4, longText - 100);
+    rc = rbfm.locateRecord(fileHandle, recordDescriptor, home, location);
+    assert(rc == success && sameRID(location, end) && "The home slot should point at the record itself.");
+    rc = rbfm.readRecord(fileHandle, recordDescriptor, middle, record);
+    assert(rc != success && "The middle hop of the chain should be deleted.");
+    for (int i = 5; i < numRecords - 1; i++) {
+        checkRecord(rbfm, fileHandle, recordDescriptor, rids[i], i, shortText);
+    }
+
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Reclaim Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the records forwarded by updateRecord()
+    remove("test_reclaim");
+    return RBFTest_Reclaim(RecordBasedFileManager::instance());
+}
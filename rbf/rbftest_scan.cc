@@ -0,0 +1,216 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <set>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numRecords = 300;
+
+// Record i: EmpName "Scan<i>", Age i%50 (NULL for every 7th record), Height i/2, Salary 10*i
+void prepareScanRecord(const vector<Attribute> &recordDescriptor, int i, void *record, int *recordSize) {
+    unsigned char nullsIndicator = i % 7 == 0 ? 1 << 6 : 0;
+    string name = "Scan" + to_string(i);
+    prepareRecord(recordDescriptor.size(), &nullsIndicator, name.size(), name, i % 50, i / 2.0f, 10 * i, record, recordSize);
+}
+
+// Runs the scan and checks it returns the records of "expected", projected on (Salary, EmpName)
+void checkScan(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+               const vector<ScanPredicate> &predicates, const set<int> &expected) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    RBFM_ScanIterator rbfmScanIterator;
+    vector<string> attributes = {"Salary", "EmpName"};
+    rc = rbfm.scan(fileHandle, recordDescriptor, predicates, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    RID rid;
+    char returnedData[200];
+    set<int> returned;
+    while ((rc = rbfmScanIterator.getNextRecord(rid, returnedData)) != RBFM_EOF) {
+        assert(rc == success && "Getting the next record should not fail.");
+        assert(returnedData[0] == 0 && "The projected fields are never NULL.");
+        int salary;
+        memcpy(&salary, returnedData + 1, sizeof(int));
+        int i = salary / 10;
+        string name = "Scan" + to_string(i);
+        unsigned nameLength;
+        memcpy(&nameLength, returnedData + 1 + sizeof(int), sizeof(unsigned));
+        assert(nameLength == name.size() && memcmp(returnedData + 1 + 2 * sizeof(int), name.data(), nameLength) == 0
+               && "The projected fields should come in the order asked.");
+        assert(returned.insert(i).second && "A record should be returned once.");
+    }
+    rbfmScanIterator.close();
+    assert(returned == expected && "The scan should return exactly the records satisfying every predicate.");
+}
+
+// Every 10th record grows to the longest EmpName: on a full page, its slot is left with a tombstone
+bool isGrown(int i) {
+    return i % 10 == 3;
+}
+
+string scanName(int i) {
+    string name = "Scan" + to_string(i);
+    return isGrown(i) ? name + string(30 - name.size(), '+') : name;
+}
+
+// A scan projecting Salary and EmpName, over every record: each page is read once, and each tombstone reads the
+// page of its record once more
+void checkScanReads(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+                    unsigned forwarded) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    const unsigned numPages = fileHandle.getNumberOfPages();
+
+    RBFM_ScanIterator rbfmScanIterator;
+    vector<string> attributes = {"Salary", "EmpName"};
+    rc = rbfm.scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    const unsigned readsBefore = rbfmScanIterator.getFileHandle().readPageCounter;
+
+    RID rid;
+    char returnedData[200];
+    set<int> returned;
+    while ((rc = rbfmScanIterator.getNextRecord(rid, returnedData)) != RBFM_EOF) {
+        assert(rc == success && "Getting the next record should not fail.");
+        int salary;
+        memcpy(&salary, returnedData + 1, sizeof(int));
+        int i = salary / 10;
+        unsigned nameLength;
+        memcpy(&nameLength, returnedData + 1 + sizeof(int), sizeof(unsigned));
+        assert(nameLength == scanName(i).size() && memcmp(returnedData + 1 + 2 * sizeof(int), scanName(i).data(), nameLength) == 0
+               && "A forwarded record should be projected from the page it moved to.");
+        returned.insert(i);
+    }
+    assert(returned.size() == (size_t) numRecords && "The scan should return every record.");
+    // The free space map page isn't scanned
+    assert(rbfmScanIterator.getFileHandle().readPageCounter - readsBefore == numPages - 1 + forwarded
+           && "The scan should read each page once, and the page of each forwarded record.");
+    rbfmScanIterator.close();
+}
+
+int RBFTest_Scan(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. Scan with a conjunction of predicates on several attributes, NULLs included
+    // 2. Scan with a predicate on a varchar
+    // 3. Scan without predicates
+    // 4. Scan projecting an attribute the records don't have
+    // 5. Scan over tombstones with a projection: one page read per page, and one per tombstone
+    cout << endl << "***** In RBF Test Case Scan *****" << endl;
+
+    RC rc;
+    string fileName = "test_scan";
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    char record[200];
+    int recordSize;
+    vector<RID> rids(numRecords);
+    for (int i = 0; i < numRecords; i++) {
+        prepareScanRecord(recordDescriptor, i, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    // 20 <= Age < 40 AND Salary != 1000 AND Height <= 120: a NULL Age satisfies none of them
+    int ageLow = 20, ageHigh = 40, salary = 1000;
+    float height = 120;
+    vector<ScanPredicate> predicates = {{"Age",    GE_OP, &ageLow},
+                                        {"Salary", NE_OP, &salary},
+                                        {"Height", LE_OP, &height},
+                                        {"Age",    LT_OP, &ageHigh}};
+    set<int> expected;
+    for (int i = 0; i < numRecords; i++) {
+        if (i % 7 != 0 && i % 50 >= ageLow && i % 50 < ageHigh && 10 * i != salary && i / 2.0f <= height) {
+            expected.insert(i);
+        }
+    }
+    checkScan(rbfm, fileName, recordDescriptor, predicates, expected);
+
+    // A varchar predicate with an int one
+    char name[20];
+    unsigned nameLength = 6;
+    memcpy(name, &nameLength, sizeof(unsigned));
+    memcpy(name + sizeof(unsigned), "Scan43", nameLength);
+    int ageZero = 0;
+    predicates = {{"EmpName", EQ_OP, name},
+                  {"Age",     GE_OP, &ageZero}};
+    checkScan(rbfm, fileName, recordDescriptor, predicates, {43});
+
+    // No predicate: every record
+    expected.clear();
+    for (int i = 0; i < numRecords; i++) {
+        expected.insert(i);
+    }
+    checkScan(rbfm, fileName, recordDescriptor, {}, expected);
+
+    // Grown records are forwarded from the full pages, the page pinRecord() pins tells which ones moved
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    unsigned forwarded = 0;
+    for (int i = 0; i < numRecords; i++) {
+        if (!isGrown(i)) {
+            continue;
+        }
+        const string grownName = scanName(i);
+        unsigned char nullsIndicator = i % 7 == 0 ? 1 << 6 : 0;
+        prepareRecord(recordDescriptor.size(), &nullsIndicator, grownName.size(), grownName, i % 50, i / 2.0f, 10 * i, record, &recordSize);
+        rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+        assert(rc == success && "Updating a record should not fail.");
+        RecordView view;
+        PageNum pinnedPage;
+        rc = rbfm.pinRecord(fileHandle, recordDescriptor, rids[i], view, pinnedPage);
+        assert(rc == success && "Pinning a record should not fail.");
+        forwarded += pinnedPage != rids[i].pageNum;
+        rc = fileHandle.unpinPage(pinnedPage, false);
+        assert(rc == success && "Unpinning the page should not fail.");
+    }
+    assert(forwarded > 0 && "Some records should have moved to another page.");
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    checkScanReads(rbfm, fileName, recordDescriptor, forwarded);
+
+    // An attribute the records don't have can't be projected
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    vector<string> attributes = {"Salary", "Bonus"};
+    rc = rbfm.scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, rbfmScanIterator);
+    assert(rc != success && "Projecting an unknown attribute should fail.");
+    rbfmScanIterator.close();
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case Scan Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the scans with several predicates
+    remove("test_scan");
+    return RBFTest_Scan(RecordBasedFileManager::instance());
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <climits>
+#include <cmath>
+#include <limits>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const unsigned maxCount = 203;
+// Around the vector widths (4 and 8 values) and the 64-bit words of the result
+const unsigned counts[] = {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 63, 64, 65, 127, 130, 200};
+const CompOp compOps[] = {EQ_OP, LT_OP, LE_OP, GT_OP, GE_OP, NE_OP, NO_OP};
+
+// Checks the bits of a kernel against the scan's own comparison, one value at a time; bits past "count" are clear
+template <typename T>
+void checkBits(const T *values, unsigned count, CompOp compOp, T value, AttrType type, const uint64_t *bits) {
+    ScanCondition condition = {0, type, compOp, &value};
+    for (unsigned i = 0; i < count; i++) {
+        bool expected = RBFM_ScanIterator::conditionHolds(condition, reinterpret_cast<const byte *>(values + i), sizeof(T));
+        assert(((bits[i / 64] >> i % 64 & 1) != 0) == expected && "A kernel should agree with the scan's comparison.");
+    }
+    for (unsigned i = count; i < (count + 63) / 64 * 64; i++) {
+        assert((bits[i / 64] >> i % 64 & 1) == 0 && "A kernel should not select past the last value.");
+    }
+}
+
+int RBFTest_Select(SelectionKernel kernel) {
+    int ints[maxCount + 1];
+    float reals[maxCount + 1];
+    for (unsigned i = 0; i <= maxCount; i++) {
+        ints[i] = (int) (i * 7919 % 41) - 20;
+        reals[i] = ints[i] / 4.0f;
+    }
+    ints[3] = INT_MIN;
+    ints[10] = INT_MAX;
+    reals[2] = numeric_limits<float>::quiet_NaN();
+    reals[9] = -numeric_limits<float>::infinity();
+    reals[13] = numeric_limits<float>::infinity();
+    reals[21] = -0.0f;
+    reals[70] = numeric_limits<float>::quiet_NaN();
+
+    const int intValues[] = {0, 5, -20, INT_MIN, INT_MAX};
+    const float realValues[] = {0.0f, 1.25f, -5.0f, numeric_limits<float>::infinity(), numeric_limits<float>::quiet_NaN()};
+
+    uint64_t bits[(maxCount + 63) / 64];
+    setSelectionKernel(kernel);
+    for (unsigned count : counts) {
+        for (CompOp compOp : compOps) {
+            // From an aligned start and from the next value, the loads are unaligned then
+            for (unsigned start = 0; start <= 1; start++) {
+                for (int value : intValues) {
+                    memset(bits, 0xFF, sizeof(bits));
+                    selectInts(ints + start, count, compOp, value, bits);
+                    checkBits(ints + start, count, compOp, value, TypeInt, bits);
+                }
+                for (float value : realValues) {
+                    memset(bits, 0xFF, sizeof(bits));
+                    selectReals(reals + start, count, compOp, value, bits);
+                    checkBits(reals + start, count, compOp, value, TypeReal, bits);
+                }
+            }
+        }
+    }
+    setSelectionKernel(AVX2_SELECTION);
+    cout << "The selection kernels (" << kernel << ") agree with the scan's comparison." << endl;
+    return 0;
+}
+
+int main() {
+    // To test the selection kernels of the scans against their scalar comparison
+    cout << endl << "***** In RBF Test Case Select *****" << endl;
+    RBFTest_Select(SCALAR_SELECTION);
+    RBFTest_Select(SSE2_SELECTION);
+    RBFTest_Select(AVX2_SELECTION);
+    cout << "RBF Test Case Select Finished! The result will be examined." << endl << endl;
+    return 0;
+}
@@ -0,0 +1,295 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numRecords = 400;
+const int grownNameLength = 200;
+const unsigned numOfFrames = 4;
+
+void createViewRecordDescriptor(vector<Attribute> &recordDescriptor) {
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Name";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) grownNameLength;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Score";
+    attr.type = TypeReal;
+    attr.length = (AttrLength) 4;
+    recordDescriptor.push_back(attr);
+
+    attr.name = "Note";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 40;
+    recordDescriptor.push_back(attr);
+}
+
+// Name of "nameLength" letters, Score NULL for every 3rd record, Note NULL for every 4th and empty for every 5th
+void prepareViewRecord(int id, int nameLength, void *buffer, int *recordSize) {
+    int offset = 0;
+    const bool nullScore = id % 3 == 0;
+    const bool nullNote = id % 4 == 0;
+    memset(buffer, (nullScore ? 0x20 : 0) | (nullNote ? 0x10 : 0), 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+    offset += nameLength;
+    if (!nullScore) {
+        float score = id * 0.25f;
+        memcpy((char *) buffer + offset, &score, sizeof(float));
+        offset += sizeof(float);
+    }
+    if (!nullNote) {
+        int noteLength = id % 5 == 0 ? 0 : id % 40;
+        memcpy((char *) buffer + offset, &noteLength, sizeof(int));
+        offset += sizeof(int);
+        memset((char *) buffer + offset, 'A' + id % 26, noteLength);
+        offset += noteLength;
+    }
+    *recordSize = offset;
+}
+
+int initialNameLength(int id) {
+    return 20 + id % 30;
+}
+
+// The record of "id" through every accessor of the view, whole and projected
+void checkView(const RecordView &view, int id, int nameLength) {
+    char record[1000];
+    int recordSize;
+    prepareViewRecord(id, nameLength, record, &recordSize);
+
+    assert(view.isValid() && view.getFieldCount() == 4 && "The view should hold the fields of the descriptor.");
+    assert(!view.isNull(0) && view.getInt(0) == id && "The int field should be read in place.");
+    unsigned length;
+    const char *name = view.getVarChar(1, length);
+    assert(!view.isNull(1) && length == (unsigned) nameLength && string(name, length) == string(nameLength, 'a' + id % 26)
+           && "The varchar field should be read in place.");
+    assert(view.isNull(2) == (id % 3 == 0) && "The real field should keep its NULL.");
+    if (view.isNull(2)) {
+        view.getField(2, length);
+        assert(length == 0 && "A NULL field should take no room.");
+    } else {
+        assert(view.getReal(2) == id * 0.25f && "The real field should be read in place.");
+    }
+    assert(view.isNull(3) == (id % 4 == 0) && "The varchar field should keep its NULL.");
+    if (!view.isNull(3)) {
+        const char *note = view.getVarChar(3, length);
+        const unsigned noteLength = id % 5 == 0 ? 0 : id % 40;
+        assert(length == noteLength && string(note, length) == string(noteLength, 'A' + id % 26)
+               && "An empty varchar should not be NULL.");
+    }
+
+    char projected[1000];
+    assert(view.project(projected) == (unsigned) recordSize && memcmp(projected, record, recordSize) == 0
+           && "The view should project the record as written.");
+
+    // Note, then Id: their NULL bits move with them
+    char expected[100];
+    int offset = 1;
+    expected[0] = view.isNull(3) ? (char) 0x80 : 0;
+    if (!view.isNull(3)) {
+        const char *note = view.getVarChar(3, length);
+        memcpy(expected + offset, &length, sizeof(int));
+        memcpy(expected + offset + sizeof(int), note, length);
+        offset += sizeof(int) + length;
+    }
+    memcpy(expected + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    assert(view.project({3, 0}, projected) == (unsigned) offset && memcmp(projected, expected, offset) == 0
+           && "The view should project the listed fields in order.");
+}
+
+// Updated records grow past the room of their page, deleted ones are gone
+bool isUpdated(int id) {
+    return id % 10 == 1;
+}
+
+bool isDeleted(int id) {
+    return id % 7 == 0 && !isUpdated(id);
+}
+
+int nameLengthOf(int id) {
+    return isUpdated(id) ? grownNameLength : initialNameLength(id);
+}
+
+// Records pinned in the pool: tombstones followed, the view kept while other pages go through the pool
+void testPinRecord(RecordBasedFileManager &rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor,
+                   const vector<RID> &rids) {
+    int forwarded = 0;
+    for (int id = 0; id < numRecords; id++) {
+        RecordView view;
+        PageNum pinnedPage;
+        RC rc = rbfm.pinRecord(fileHandle, recordDescriptor, rids[id], view, pinnedPage);
+        if (isDeleted(id)) {
+            assert(rc != success && "Pinning a deleted record should fail.");
+            continue;
+        }
+        assert(rc == success && "Pinning a record should not fail.");
+        assert((isUpdated(id) || pinnedPage == rids[id].pageNum) && "A record in place should be pinned on its page.");
+        if (pinnedPage != rids[id].pageNum) {
+            forwarded++;
+        }
+        checkView(view, id, nameLengthOf(id));
+        rc = fileHandle.unpinPage(pinnedPage, false);
+        assert(rc == success && "Unpinning the page should not fail.");
+    }
+    assert(forwarded > 0 && "Some records should have moved to another page.");
+
+    // A pinned frame outlives every other page of the file going through a pool of a few frames
+    BufferPool &bufferPool = BufferPool::instance();
+    const unsigned capacity = bufferPool.getCapacity();
+    RC rc = bufferPool.setCapacity(numOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+    RecordView view;
+    PageNum pinnedPage;
+    rc = rbfm.pinRecord(fileHandle, recordDescriptor, rids[1], view, pinnedPage);
+    assert(rc == success && "Pinning a record should not fail.");
+    vector<byte> page(fileHandle.getPageSize());
+    assert(fileHandle.getNumberOfPages() > 2 * numOfFrames && "The file should have more pages than the pool frames.");
+    for (PageNum p = 0; p < fileHandle.getNumberOfPages(); p++) {
+        rc = fileHandle.readPage(p, page.data());
+        assert(rc == success && "Reading a page should not fail.");
+    }
+    checkView(view, 1, nameLengthOf(1));
+    assert(bufferPool.setCapacity(numOfFrames) != success && "The pool should not drop a pinned frame.");
+    rc = fileHandle.unpinPage(pinnedPage, false);
+    assert(rc == success && "Unpinning the page should not fail.");
+    rc = bufferPool.setCapacity(capacity);
+    assert(rc == success && "The pool should resize once the frame is released.");
+}
+
+// Views of a scan, with a condition or not: every live record is found, tombstones lead to the moved record
+void testScanViews(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+                   const vector<RID> &rids, bool withCondition) {
+    FileHandle scanHandle;
+    RC rc = rbfm.openFile(fileName, scanHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    const float minScore = 30.0f;
+    rc = rbfm.scan(scanHandle, recordDescriptor, withCondition ? "Score" : "", withCondition ? GE_OP : NO_OP,
+                   withCondition ? &minScore : NULL, {"Id", "Note"}, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+
+    vector<bool> seen(numRecords, false);
+    RID rid;
+    RecordView view;
+    while (rbfmScanIterator.getNextRecordView(rid, view) != RBFM_EOF) {
+        const int id = view.getInt(0);
+        assert(id >= 0 && id < numRecords && !isDeleted(id) && "A scan should not return a deleted record.");
+        assert((!withCondition || (!view.isNull(2) && view.getReal(2) >= minScore)) && "The view should satisfy the condition.");
+        checkView(view, id, nameLengthOf(id));
+        seen[id] = true;
+    }
+    rbfmScanIterator.close();
+    for (int id = 0; id < numRecords; id++) {
+        const bool satisfies = !withCondition || (id % 3 != 0 && id * 0.25f >= minScore);
+        assert(seen[id] == (!isDeleted(id) && satisfies) && "The scan should return every live record that satisfies it.");
+    }
+}
+
+int RBFTest_View(RecordBasedFileManager &rbfm) {
+    // Functions tested
+    // 1. RecordView over records of both formats: NULLs, empty and long varchars, whole and projected
+    // 2. pinRecord(): tombstones followed, deleted records refused, the view valid while its page is pinned
+    // 3. RBFM_ScanIterator::getNextRecordView() with and without a condition, over forwarded records
+    cout << endl << "***** In RBF Test Case View *****" << endl;
+
+    RC rc;
+    string fileName = "test_view";
+    vector<Attribute> recordDescriptor;
+    createViewRecordDescriptor(recordDescriptor);
+
+    char record[1000];
+    int recordSize;
+    for (bool compact : {false, true}) {
+        for (int id = 0; id < 60; id++) {
+            prepareViewRecord(id, initialNameLength(id), record, &recordSize);
+            vector<byte> recordFormat;
+            rbfm.transformDataToRecordFormat(recordDescriptor, record, recordFormat, compact);
+            checkView(RecordView(recordFormat.data(), recordDescriptor.size(), compact), id, initialNameLength(id));
+        }
+    }
+
+    rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    vector<RID> rids(numRecords);
+    for (int id = 0; id < numRecords; id++) {
+        prepareViewRecord(id, initialNameLength(id), record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rids[id]);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    for (int id = 0; id < numRecords; id++) {
+        if (isUpdated(id)) {
+            prepareViewRecord(id, grownNameLength, record, &recordSize);
+            rc = rbfm.updateRecord(fileHandle, recordDescriptor, record, rids[id]);
+            assert(rc == success && "Updating a record should not fail.");
+        } else if (isDeleted(id)) {
+            rc = rbfm.deleteRecord(fileHandle, recordDescriptor, rids[id]);
+            assert(rc == success && "Deleting a record should not fail.");
+        }
+    }
+
+    testPinRecord(rbfm, fileHandle, recordDescriptor, rids);
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+    testScanViews(rbfm, fileName, recordDescriptor, rids, false);
+    testScanViews(rbfm, fileName, recordDescriptor, rids, true);
+
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    // The records of a PAX file aren't stored in one piece
+    rc = rbfm.createFile(fileName, PAGE_SIZE, PAX_LAYOUT);
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    prepareViewRecord(1, initialNameLength(1), record, &recordSize);
+    RID rid;
+    rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+    assert(rc == success && "Inserting a record should not fail.");
+    RecordView view;
+    PageNum pinnedPage;
+    assert(rbfm.pinRecord(fileHandle, recordDescriptor, rid, view, pinnedPage) != success
+           && "Pinning a record of a PAX file should fail.");
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case View Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the records read in place
+    remove("test_view");
+    return RBFTest_View(RecordBasedFileManager::instance());
+}
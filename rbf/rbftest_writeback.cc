@@ -0,0 +1,149 @@
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "test_util.h"
+
+const unsigned numberOfPages = 8;
+const unsigned numberOfFrames = 8;
+
+// Pages written to the files since "start"
+unsigned writtenSince(unsigned start) {
+    return BufferPool::instance().getPagesWritten() - start;
+}
+
+void writePage(FileHandle &fileHandle, PageNum pageNum, byte value) {
+    byte page[PAGE_SIZE];
+    memset(page, value, PAGE_SIZE);
+    RC rc = fileHandle.writePage(pageNum, page);
+    assert(rc == success && "Writing a page should not fail.");
+}
+
+// First byte of data page "pageNum" on disk, past the pool
+byte byteOnDisk(const std::string &fileName, PageNum pageNum) {
+    std::ifstream in(fileName.c_str(), std::ifstream::in | std::ifstream::binary);
+    in.seekg((pageNum + 1) * PAGE_SIZE);
+    char value = 0;
+    in.read(&value, 1);
+    assert(in && "The page should be in the file.");
+    return value;
+}
+
+int RBFTest_WriteBack(PagedFileManager &pfm) {
+    // Functions tested
+    // 1. Writes to a resident page are coalesced in its frame: one physical write however many times it changed
+    // 2. flush() and checkpoint() write back the dirty pages once, and nothing when there are none
+    // 3. The background writer only writes back the dirty pages about to be evicted, and only while it is enabled
+    std::cout << std::endl << "***** In RBF Test Case WriteBack *****" << std::endl;
+
+    RC rc;
+    std::string fileName = "test_writeback";
+    BufferPool &bufferPool = BufferPool::instance();
+    // Writes only happen when the test expects them
+    bufferPool.setBackgroundWriterDelay(0);
+    bufferPool.setReplacementPolicy(LRU_REPLACEMENT);
+    rc = bufferPool.setCapacity(numberOfFrames);
+    assert(rc == success && "Resizing the buffer pool should not fail.");
+
+    rc = pfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+
+    FileHandle fileHandle;
+    rc = pfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+
+    byte page[PAGE_SIZE];
+    unsigned start = bufferPool.getPagesWritten();
+    for (PageNum p = 0; p < numberOfPages; p++) {
+        memset(page, p, PAGE_SIZE);
+        rc = fileHandle.appendPage(page);
+        assert(rc == success && "Appending a page should not fail.");
+    }
+    assert(writtenSince(start) == 0 && "Appended pages stay in their frames until they are written back.");
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+    assert(writtenSince(start) == numberOfPages && "Flushing should write every appended page once.");
+
+    // Five writes to page 3 and two to page 5 are two physical writes
+    start = bufferPool.getPagesWritten();
+    for (byte value = 10; value < 15; value++) {
+        writePage(fileHandle, 3, value);
+    }
+    writePage(fileHandle, 5, 20);
+    writePage(fileHandle, 5, 21);
+    assert(writtenSince(start) == 0 && "Writing a resident page should only dirty its frame.");
+    rc = fileHandle.flush();
+    assert(rc == success && "Flushing the file should not fail.");
+    assert(writtenSince(start) == 2 && "Flushing should write each dirty page once.");
+    assert(byteOnDisk(fileName, 3) == 14 && byteOnDisk(fileName, 5) == 21 && "The last write of a page should be on disk.");
+    rc = fileHandle.flush();
+    assert(rc == success && writtenSince(start) == 2 && "Flushing a clean file should write nothing.");
+
+    start = bufferPool.getPagesWritten();
+    writePage(fileHandle, 1, 30);
+    writePage(fileHandle, 2, 31);
+    writePage(fileHandle, 1, 32);
+    rc = bufferPool.checkpoint();
+    assert(rc == success && "A checkpoint should not fail.");
+    assert(writtenSince(start) == 2 && "A checkpoint should write each dirty page once.");
+    assert(byteOnDisk(fileName, 1) == 32 && byteOnDisk(fileName, 2) == 31 && "A checkpoint should leave the pages on disk.");
+    rc = bufferPool.checkpoint();
+    assert(rc == success && writtenSince(start) == 2 && "A checkpoint with no dirty page should write nothing.");
+
+    // Pages 0 and 1 are dirtied, then every other page is read: they are the least recently used ones, which the
+    // writer looks at (a quarter of the pool). Page 6 is dirtied last and stays in memory
+    start = bufferPool.getPagesWritten();
+    writePage(fileHandle, 0, 40);
+    writePage(fileHandle, 1, 41);
+    for (PageNum p = 2; p < numberOfPages; p++) {
+        rc = fileHandle.readPage(p, page);
+        assert(rc == success && "Reading a page should not fail.");
+    }
+    writePage(fileHandle, 6, 42);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(writtenSince(start) == 0 && "Nothing is written back while the background writer is disabled.");
+
+    bufferPool.setBackgroundWriterDelay(10);
+    for (unsigned waited = 0; waited < 2000 && writtenSince(start) < 2; waited += 10) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    bufferPool.setBackgroundWriterDelay(0);
+    assert(writtenSince(start) == 2 && "The background writer should write back the cold dirty pages only.");
+    assert(byteOnDisk(fileName, 0) == 40 && byteOnDisk(fileName, 1) == 41 && "The cold pages should be on disk.");
+
+    // Only page 6 is left
+    rc = fileHandle.flush();
+    assert(rc == success && writtenSince(start) == 3 && "Flushing should write the page the writer left.");
+    assert(byteOnDisk(fileName, 6) == 42 && "The page should be on disk after the flush.");
+
+    rc = pfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+
+    rc = pfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    bufferPool.setCapacity(BUFFER_POOL_FRAMES);
+    bufferPool.setBackgroundWriterDelay(BG_WRITER_DELAY);
+
+    std::cout << "RBF Test Case WriteBack Finished! The result will be examined." << std::endl << std::endl;
+
+    return 0;
+}
+
+int main() {
+    // To test when the dirty pages of the buffer pool reach the disk
+    remove("test_writeback");
+    return RBFTest_WriteBack(PagedFileManager::instance());
+}
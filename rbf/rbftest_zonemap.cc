@@ -0,0 +1,138 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <cstdio>
+#include <set>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "zonemap.h"
+#include "test_util.h"
+
+using namespace std;
+
+const int numRecords = 500;
+
+// Record i: EmpName "Zone<i>", Age "base" + i/100, Height i, Salary i
+void prepareZoneRecord(const vector<Attribute> &recordDescriptor, int i, int base, void *record, int *recordSize) {
+    unsigned char nullsIndicator = 0;
+    string name = "Zone" + to_string(i);
+    prepareRecord(recordDescriptor.size(), &nullsIndicator, name.size(), name, base + i / 100, (float) i, i, record, recordSize);
+}
+
+void insertZoneRecords(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor, int base) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    char record[200];
+    int recordSize;
+    RID rid;
+    for (int i = 0; i < numRecords; i++) {
+        prepareZoneRecord(recordDescriptor, i, base, record, &recordSize);
+        rc = rbfm.insertRecord(fileHandle, recordDescriptor, record, rid);
+        assert(rc == success && "Inserting a record should not fail.");
+    }
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+}
+
+// The Salary of the records with Age == "age"
+set<int> scanAge(RecordBasedFileManager &rbfm, const string &fileName, const vector<Attribute> &recordDescriptor, int age) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    RBFM_ScanIterator rbfmScanIterator;
+    vector<string> attributes = {"Salary"};
+    rc = rbfm.scan(fileHandle, recordDescriptor, "Age", EQ_OP, &age, attributes, rbfmScanIterator);
+    assert(rc == success && "Scanning the file should not fail.");
+    RID rid;
+    char returnedData[200];
+    set<int> returned;
+    while ((rc = rbfmScanIterator.getNextRecord(rid, returnedData)) != RBFM_EOF) {
+        assert(rc == success && "Getting the next record should not fail.");
+        int salary;
+        memcpy(&salary, returnedData + 1, sizeof(int));
+        returned.insert(salary);
+    }
+    rbfmScanIterator.close();
+    return returned;
+}
+
+set<int> salaries(int first, int last) {
+    set<int> values;
+    for (int i = first; i < last; i++) {
+        values.insert(i);
+    }
+    return values;
+}
+
+int RBFTest_ZoneMap(RecordBasedFileManager &rbfm, PagedFileManager &pfm) {
+    // Functions tested
+    // 1. Scan skipping the pages the zone map rules out
+    // 2. A zone map left behind by a file of the same name is not used
+    cout << endl << "***** In RBF Test Case ZoneMap *****" << endl;
+
+    RC rc;
+    string fileName = "test_zonemap";
+    vector<Attribute> recordDescriptor;
+    createRecordDescriptor(recordDescriptor);
+
+    rc = rbfm.createFile(fileName);
+    assert(rc == success && "Creating the file should not fail.");
+    insertZoneRecords(rbfm, fileName, recordDescriptor, 0);
+
+    // Ages 0 to 4, a hundred records each: the pages of the other ages are ruled out
+    FileHandle fileHandle;
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    unsigned pages = fileHandle.getNumberOfPages();
+    {
+        ZoneMap zoneMap;
+        rc = zoneMap.open(fileHandle, recordDescriptor);
+        assert(rc == success && "The zone map of the file should open.");
+        int age = 0;
+        vector<ScanCondition> conditions = {{1, TypeInt, EQ_OP, &age}};
+        assert(zoneMap.mayMatch(1, conditions) && "The first data page holds age 0.");
+        assert(!zoneMap.mayMatch(pages - 1, conditions) && "The last data page doesn't hold age 0.");
+        assert(zoneMap.mayMatch(pages + 10 * zoneMap.getEntriesPerPage(), conditions) && "A page the map doesn't cover may match.");
+    }
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    assert(scanAge(rbfm, fileName, recordDescriptor, 2) == salaries(200, 300) && "The scan should return the records of the age.");
+
+    // The data file is replaced behind the zone map's back, the old map would rule out the new ages
+    rc = remove(fileName.c_str());
+    assert(rc == success && "Removing the data file should not fail.");
+    rc = pfm.createFile(fileName, PAGE_SIZE, RecordBasedFileManager::pageFormat(ROW_LAYOUT));
+    assert(rc == success && "Creating the file should not fail.");
+    rc = rbfm.openFile(fileName, fileHandle);
+    assert(rc == success && "Opening the file should not fail.");
+    {
+        ZoneMap zoneMap;
+        rc = zoneMap.open(fileHandle, recordDescriptor);
+        assert(rc != success && "A zone map of another file should not open.");
+    }
+    rc = rbfm.closeFile(fileHandle);
+    assert(rc == success && "Closing the file should not fail.");
+    insertZoneRecords(rbfm, fileName, recordDescriptor, 20);
+    assert(scanAge(rbfm, fileName, recordDescriptor, 21) == salaries(100, 200) && "The scan should not use the old zone map.");
+
+    rc = rbfm.destroyFile(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    rc = destroyFileShouldSucceed(fileName);
+    assert(rc == success && "Destroying the file should not fail.");
+
+    cout << "RBF Test Case ZoneMap Finished! The result will be examined." << endl << endl;
+
+    return 0;
+}
+
+int main() {
+    // To test the zone maps of the files
+    remove("test_zonemap");
+    remove("test_zonemap.zm");
+    return RBFTest_ZoneMap(RecordBasedFileManager::instance(), PagedFileManager::instance());
+}
@@ -0,0 +1,254 @@
+#include <cstring>
+#include <limits>
+#include "zonemap.h"
+
+using namespace std;
+
+//State of a zone map, at the start of its first page; the creation id of the data file comes next
+#define ZONE_MAP_UNBOUND 0      // no descriptor yet, nothing recorded
+#define ZONE_MAP_BOUND 1        // followed by the number of int/real attributes and their types
+#define ZONE_MAP_INVALID 2      // opened with another descriptor, never used again
+#define ZONE_MAP_HEADER 3       // unsigned values before the types
+
+namespace {
+
+bool hasValue(const byte *entry, unsigned slot) {
+    return entry[slot/8] >> (7-slot%8) & 1;
+}
+
+//Widens the range of "slot" in "entry" to "value", true if it changed
+template <typename T>
+bool widenRange(byte *entry, unsigned bitmapBytes, unsigned slot, T value) {
+    byte *range = entry + bitmapBytes + slot*2*sizeof(T);
+    T bounds[2];
+    memcpy(bounds, range, sizeof(bounds));
+    const bool present = hasValue(entry, slot);
+    if(value != value) { //a NaN is only != to anything, the range can't tell it
+        bounds[0] = -numeric_limits<T>::infinity();
+        bounds[1] = numeric_limits<T>::infinity();
+    }
+    else if(present && bounds[0] <= value && value <= bounds[1]) {
+        return false;
+    }
+    else {
+        bounds[0] = present && bounds[0] < value ? bounds[0] : value;
+        bounds[1] = present && bounds[1] > value ? bounds[1] : value;
+    }
+    entry[slot/8] |= 1 << (7-slot%8);
+    memcpy(range, bounds, sizeof(bounds));
+    return true;
+}
+
+//Whether a value of [low, high] may satisfy "value compOp"
+template <typename T>
+bool rangeMayMatch(const byte *range, CompOp compOp, const void *conditionValue) {
+    T bounds[2], value;
+    memcpy(bounds, range, sizeof(bounds));
+    memcpy(&value, conditionValue, sizeof(T));
+    switch(compOp) {
+        case EQ_OP: return !(value < bounds[0]) && !(bounds[1] < value);
+        case LT_OP: return bounds[0] < value;
+        case LE_OP: return bounds[0] <= value;
+        case GT_OP: return bounds[1] > value;
+        case GE_OP: return bounds[1] >= value;
+        case NE_OP: return !(bounds[0] == value && bounds[1] == value);
+        default: return true;
+    }
+}
+
+}
+
+ZoneMap::~ZoneMap() {
+    if(mapFile.fd < 0) {
+        return;
+    }
+    //The pages are written back with those of the data file (see flush()), so the hidden page is only rewritten
+    //when it has to record new pages
+    if(appended) {
+        PagedFileManager::instance().closeFile(mapFile);
+    }
+    else {
+        ::close(mapFile.fd);
+    }
+}
+
+RC ZoneMap::create(const std::string &fileName, unsigned pageSize) {
+    destroy(fileName);
+    FileHandle dataFile;
+    if(PagedFileManager::instance().openFile(fileName, dataFile) != 0) {
+        return -1;
+    }
+    const unsigned creationId = dataFile.getCreationId();
+    FileHandle mapFile;
+    if(PagedFileManager::instance().closeFile(dataFile) != 0
+       || PagedFileManager::instance().createFile(ZoneMap::fileName(fileName), pageSize) != 0
+       || PagedFileManager::instance().openFile(ZoneMap::fileName(fileName), mapFile) != 0) {
+        return -1;
+    }
+    vector<byte> page(pageSize, 0);
+    unsigned header[2] = {ZONE_MAP_UNBOUND, creationId};
+    memcpy(page.data(), header, sizeof(header));
+    RC rc = mapFile.appendPage(page.data());
+    return PagedFileManager::instance().closeFile(mapFile) != 0 ? -1 : rc;
+}
+
+RC ZoneMap::destroy(const std::string &fileName) {
+    return PagedFileManager::instance().destroyFile(ZoneMap::fileName(fileName));
+}
+
+//Closing a handle of the sidecar writes back its pages
+RC ZoneMap::flush(const FileHandle &fileHandle) {
+    FileHandle mapFile;
+    if(fileHandle.fileName.empty() || PagedFileManager::instance().openFile(fileName(fileHandle.fileName), mapFile) != 0) {
+        return 0;
+    }
+    return PagedFileManager::instance().closeFile(mapFile);
+}
+
+RC ZoneMap::open(const FileHandle &fileHandle, const Schema &recordDescriptor) {
+    slots.assign(recordDescriptor.size(), -1);
+    fieldLengths.resize(recordDescriptor.size());
+    fieldTypes.resize(recordDescriptor.size());
+    types.clear();
+    usable = false;
+    for(unsigned i = 0 ; i < recordDescriptor.size() ; ++i) {
+        fieldLengths[i] = recordDescriptor[i].length;
+        fieldTypes[i] = recordDescriptor.getType(i);
+        if(recordDescriptor.getType(i) != TypeVarChar) {
+            slots[i] = types.size();
+            types.push_back(recordDescriptor.getType(i));
+        }
+    }
+    pageSize = fileHandle.getPageSize();
+    if(types.empty() || fileHandle.fileName.empty() || (ZONE_MAP_HEADER+types.size())*sizeof(unsigned) > pageSize
+       || PagedFileManager::instance().openFile(fileName(fileHandle.fileName), mapFile) != 0) {
+        slots.assign(recordDescriptor.size(), -1);
+        return -1;
+    }
+    bitmapBytes = Schema::nullIndicatorSize(types.size());
+    entrySize = bitmapBytes + 2*sizeof(unsigned)*types.size();
+    entriesPerPage = pageSize / entrySize;
+
+    //A sidecar written before the creation ids has no page 0 and can't tell which file it belongs to
+    unsigned *header = mapFile.getPageSize() == pageSize ? reinterpret_cast<unsigned *>(pin(0)) : NULL;
+    if(header == NULL) {
+        slots.assign(recordDescriptor.size(), -1);
+        return -1;
+    }
+    bool dirty = false;
+    RC rc = 0;
+    if(header[1] != fileHandle.getCreationId()) {
+        rc = -1;
+    }
+    else if(header[0] == ZONE_MAP_UNBOUND) {
+        header[0] = ZONE_MAP_BOUND;
+        header[2] = types.size();
+        memcpy(header + ZONE_MAP_HEADER, types.data(), types.size()*sizeof(unsigned));
+        dirty = true;
+    }
+    else if(header[0] != ZONE_MAP_BOUND || header[2] != types.size()
+            || memcmp(header + ZONE_MAP_HEADER, types.data(), types.size()*sizeof(unsigned)) != 0) {
+        dirty = header[0] != ZONE_MAP_INVALID;
+        header[0] = ZONE_MAP_INVALID;
+        rc = -1;
+    }
+    unpin(0, dirty);
+    if(rc != 0) {
+        slots.assign(recordDescriptor.size(), -1);
+    }
+    usable = rc == 0;
+    return rc;
+}
+
+bool ZoneMap::isOpenFor(const Schema &recordDescriptor) const {
+    if(recordDescriptor.size() != fieldTypes.size()) {
+        return false;
+    }
+    for(unsigned i = 0 ; i < fieldTypes.size() ; ++i) {
+        if(recordDescriptor.getType(i) != fieldTypes[i] || recordDescriptor[i].length != fieldLengths[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RC ZoneMap::widen(unsigned pageNumber, const void *data) {
+    const unsigned zonePage = 1 + pageNumber/entriesPerPage;
+    byte *page = pin(zonePage, true);
+    if(page == NULL) {
+        return -1;
+    }
+    byte *entry = page + pageNumber%entriesPerPage*entrySize;
+    const byte *values = static_cast<const byte *>(data) + Schema::nullIndicatorSize(slots.size());
+    unsigned offset = 0;
+    bool changed = false;
+    for(unsigned i = 0 ; i < slots.size() ; ++i) {
+        if(Schema::isNull(data, i)) {
+            continue;
+        }
+        if(slots[i] == -1) {
+            unsigned length;
+            memcpy(&length, values + offset, sizeof(unsigned));
+            offset += sizeof(unsigned) + length;
+            continue;
+        }
+        if(types[slots[i]] == TypeInt) {
+            int value;
+            memcpy(&value, values + offset, sizeof(int));
+            changed |= widenRange(entry, bitmapBytes, slots[i], value);
+        }
+        else {
+            float value;
+            memcpy(&value, values + offset, sizeof(float));
+            changed |= widenRange(entry, bitmapBytes, slots[i], value);
+        }
+        offset += fieldLengths[i];
+    }
+    unpin(zonePage, changed);
+    return 0;
+}
+
+//NULLs satisfy no condition, so a page without values of a condition's field is skipped as well
+bool ZoneMap::mayMatch(unsigned pageNumber, const std::vector<ScanCondition> &conditions) const {
+    const unsigned zonePage = 1 + pageNumber/entriesPerPage;
+    const byte *page = pin(zonePage);
+    if(page == NULL) {
+        return true;
+    }
+    const byte *entry = page + pageNumber%entriesPerPage*entrySize;
+    bool match = true;
+    for(unsigned i = 0 ; match && i < conditions.size() ; ++i) {
+        if(!covers(conditions[i]) || conditions[i].compOp == NO_OP) {
+            continue;
+        }
+        const unsigned slot = slots[conditions[i].field];
+        const byte *range = entry + bitmapBytes + slot*2*sizeof(unsigned);
+        match = hasValue(entry, slot) && (types[slot] == TypeInt ? rangeMayMatch<int>(range, conditions[i].compOp, conditions[i].value)
+                                                                 : rangeMayMatch<float>(range, conditions[i].compOp, conditions[i].value));
+    }
+    unpin(zonePage, false);
+    return match;
+}
+
+byte *ZoneMap::pin(unsigned zonePage, bool append) const {
+    std::lock_guard<std::mutex> guard(latch);
+    if(zonePage >= mapFile.getNumberOfPages()) {
+        if(!append) {
+            return NULL;
+        }
+        vector<byte> zeros(pageSize, 0);
+        while(mapFile.getNumberOfPages() <= zonePage) {
+            if(mapFile.appendPage(zeros.data()) != 0) {
+                return NULL;
+            }
+            appended = true;
+        }
+    }
+    byte *page;
+    return mapFile.pinPage(zonePage, page) == 0 ? page : NULL;
+}
+
+void ZoneMap::unpin(unsigned zonePage, bool dirty) const {
+    std::lock_guard<std::mutex> guard(latch);
+    mapFile.unpinPage(zonePage, dirty);
+}
@@ -0,0 +1,74 @@
+#ifndef _zonemap_h_
+#define _zonemap_h_
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "rbfm.h"
+
+/**
+Zone map of a record-based file: for every data page, the smallest and the largest value of each int/real attribute
+among its records (NULLs left out), kept in a sidecar file next to it, see fileName(). A scan skips the pages whose
+ranges rule out one of its int/real conditions, without reading them.
+The ranges only ever grow: inserts and updates widen them, deletes leave them alone. They may be wider than what the
+page holds now but never narrower. A moved record widens both its page and its home page, which is where scans
+reach it from.
+Page 0 of the sidecar tells which file and descriptor the map is built for: the creation id of the data file (see
+FileHandle::getCreationId()), set by create(), then the types of its int/real attributes, set by the first open(). A
+sidecar left behind by another file of the same name is never used; a descriptor that doesn't match disables the map
+for good. Page z >= 1 holds the entries of the data pages [(z-1)*E, z*E) where E is getEntriesPerPage(): a bit per
+attribute set once the data page has a value of it, then a (min, max) pair per attribute. widen() appends the zone
+pages as the data file grows; a data page past the zone pages known to mayMatch() may match anything.
+The sidecar has a FileHandle of its own, so its pages are not counted as reads or writes of the data file. The
+workers of a parallel scan share the map, the handle is latched. Files created without it just have no zone map.
+The record manager keeps the map open in the FileHandle of the data file (see RecordBasedFileManager::zoneMapOf())
+until the handle is closed, so the sidecar isn't opened again by every insert and update.
+**/
+class ZoneMap {
+public:
+    ZoneMap() = default;
+    ~ZoneMap();
+    ZoneMap(const ZoneMap &) = delete;
+    ZoneMap &operator=(const ZoneMap &) = delete;
+
+    static std::string fileName(const std::string &fileName) { return fileName + ".zm"; }
+    static RC create(const std::string &fileName, unsigned pageSize);   // Of the existing file "fileName", replaces one
+    static RC destroy(const std::string &fileName);
+    static RC flush(const FileHandle &fileHandle);                      // Writes back its pages, 0 if there is none
+
+    // The zone map of the file "fileHandle" is open on. -1 if there is none, if "recordDescriptor" has no int/real
+    // attribute or if the map was built for another file or descriptor
+    RC open(const FileHandle &fileHandle, const Schema &recordDescriptor);
+    bool isOpenFor(const Schema &recordDescriptor) const;               // open() was given the same types, whatever it returned
+    bool isUsable() const { return usable; }                            // open() succeeded
+
+    // Adds the values of a record, "data" in the format of RecordBasedFileManager::insertRecord()
+    RC widen(unsigned pageNumber, const void *data);
+
+    // False only if no record of the page can satisfy all of the conditions, as far as their int/real fields tell
+    bool mayMatch(unsigned pageNumber, const std::vector<ScanCondition> &conditions) const;
+    bool covers(const ScanCondition &condition) const { return condition.field < slots.size() && slots[condition.field] != -1; }
+
+    unsigned getEntriesPerPage() const { return entriesPerPage; }
+
+private:
+    // NULL if the page doesn't exist, unless "append" asks for it (and the pages before it) to be added
+    byte *pin(unsigned zonePage, bool append = false) const;
+    void unpin(unsigned zonePage, bool dirty) const;
+
+    mutable FileHandle mapFile;                                         // of the sidecar, open from open() on
+    mutable bool appended = false;                                      // the hidden page of the sidecar is outdated
+    mutable std::mutex latch;                                           // of the two above
+    unsigned pageSize = 0;
+    std::vector<int> slots;                                             // by field: its place in the entries, -1 for a varchar
+    std::vector<AttrLength> fieldLengths;                               // by field
+    std::vector<AttrType> fieldTypes;                                   // by field
+    bool usable = false;
+    std::vector<unsigned> types;                                        // by slot, the AttrType
+    unsigned bitmapBytes = 0;                                           // of an entry, then its ranges
+    unsigned entrySize = 0;
+    unsigned entriesPerPage = 0;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "rm.h"
 #include "../ix/ix.h"
+#include "../rbf/zonemap.h"
 #include <cmath>
 #include <iostream>
 
@@ -108,7 +109,7 @@ std::string RelationManager::getTableFilename(const std::string &tableName) {
     //Assume the length of content to be extracted is less than PAGE_SIZE
     if(tableIt.getNextTuple(rid,page) != RBFM_EOF){
         byte *cur = page;
-        unsigned nullFieldLen = ceil(attr.size()/8.0);
+        unsigned nullFieldLen = Schema::nullIndicatorSize(attr.size());
         cur += nullFieldLen;
         unsigned fileNameLen = *(unsigned *)cur;
         cur += sizeof(unsigned);
@@ -173,7 +174,7 @@ int RelationManager::getIdFromTableName(const std::string &tableName){
 
     if(it.getNextRecord(rid,page) != RBFM_EOF){
         byte *cur = page;
-        unsigned nullFieldLen = ceil(attr.size()/8.0);
+        unsigned nullFieldLen = Schema::nullIndicatorSize(attr.size());
         cur += nullFieldLen;
         res = *(unsigned *)cur;
     }
@@ -213,7 +214,7 @@ RC RelationManager::insertCatalogTableTuple(const std::string &tableName, const
  ********************************************************************************************************************/
 void RelationManager::createTableTableRow(const unsigned& tableID, const std::string& tableName, std::vector<byte>& bytesToWrite, bool systemTable) {
     //Null field at the beginning
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(tablesDescriptor.size()/8.0));
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(tablesDescriptor.size());
     vector<byte> emptyBytes(nullInfoFieldLength);
     bytesToWrite.insert(bytesToWrite.end(), emptyBytes.begin(), emptyBytes.end());
 
@@ -239,7 +240,7 @@ void RelationManager::createTableTableRow(const unsigned& tableID, const std::st
 
 void RelationManager::createColumnTableRow(const unsigned& tableID, const Attribute& attribute, const unsigned& colPos, std::vector<byte>& bytesToWrite) {
     //Null field at the beginning
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(columnDescriptor.size()/8.0));
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(columnDescriptor.size());
     vector<byte> emptyBytes(nullInfoFieldLength);
     bytesToWrite.insert(bytesToWrite.end(), emptyBytes.begin(), emptyBytes.end());
 
@@ -270,7 +271,7 @@ void RelationManager::createColumnTableRow(const unsigned& tableID, const Attrib
 }
 void RelationManager::createIndexTableRow(const unsigned& tableID, const std::string& attributeName, const std::string& filename, std::vector<byte>& bytesToWrite) {
     //Null field at the beginning
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(indexesDescriptor.size()/8.0));
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(indexesDescriptor.size());
     vector<byte> emptyBytes(nullInfoFieldLength);
     bytesToWrite.insert(bytesToWrite.end(), emptyBytes.begin(), emptyBytes.end());
 
@@ -291,7 +292,8 @@ void RelationManager::createIndexTableRow(const unsigned& tableID, const std::st
 }
 
 RC RelationManager::createCatalog() {
-    if(PagedFileManager::instance().createFile("Tables") != 0) {
+    schemas.clear();
+    if(PagedFileManager::instance().createFile("Tables", PAGE_SIZE, RecordBasedFileManager::pageFormat(ROW_LAYOUT)) != 0) {
         return -1;
     }
     if(RecordBasedFileManager::instance().createFile("Columns") != 0) {
@@ -326,6 +328,7 @@ RC RelationManager::createCatalog() {
 }
 
 RC RelationManager::deleteCatalog() {
+    schemas.clear();
     if(RecordBasedFileManager::instance().destroyFile("Tables") != 0) {
         return -1;
     }
@@ -338,12 +341,18 @@ RC RelationManager::deleteCatalog() {
     return 0;
 }
 
-RC RelationManager::createTable(const std::string &tableName, const std::vector<Attribute> &attrs) {
-    if(PagedFileManager::instance().createFile(tableName) != 0) {
+RC RelationManager::createTable(const std::string &tableName, const std::vector<Attribute> &attrs, unsigned pageSize, PageLayout layout) {
+    schemas.erase(tableName);
+    RC rc = layout == COLUMN_LAYOUT ? ColumnStoreManager::instance().createTable(tableName, attrs, pageSize)
+                                    : PagedFileManager::instance().createFile(tableName, pageSize, RecordBasedFileManager::pageFormat(layout));
+    if(rc == 0 && layout != COLUMN_LAYOUT) {
+        rc = ZoneMap::create(tableName, pageSize);
+    }
+    if(rc != 0) {
         return -1;
     }
 
-    RC rc = createTableHelper(tableName, attrs, false);
+    rc = createTableHelper(tableName, attrs, false);
     if(rc != 0) {
         return  rc;
     }
@@ -399,13 +408,22 @@ RC RelationManager::isSystemTable(const std::string& tableName, bool& isSysTable
 
     if(it.getNextRecord(rid,page) != RBFM_EOF){
         byte *cur = page;
-        unsigned nullFieldLen = ceil(attr.size()/8.0);
+        unsigned nullFieldLen = Schema::nullIndicatorSize(attr.size());
         cur += nullFieldLen;
         isSysTable = *(unsigned *)cur == 1 ? true : false;
     }
     return it.close();
 }
 
+RC RelationManager::getPageSize(const std::string &tableName, unsigned &pageSize) {
+    FileHandle fh;
+    if(RecordBasedFileManager::instance().openFile(tableName, fh) != 0) {
+        return -1;
+    }
+    pageSize = fh.getPageSize();
+    return RecordBasedFileManager::instance().closeFile(fh);
+}
+
 RC RelationManager::deleteTable(const std::string &tableName) {
     RC rc;
     if(!modifySystemTable_AdminRequest) {
@@ -438,9 +456,20 @@ RC RelationManager::deleteTable(const std::string &tableName) {
         return -1;
     }
 
-    if(PagedFileManager::instance().destroyFile(tableName) != 0) {
+    //A column table has a file per attribute besides its own
+    FileHandle fh;
+    if(PagedFileManager::instance().openFile(tableName, fh) != 0) {
+        return -1;
+    }
+    const bool columnTable = ColumnStoreManager::isColumnTable(fh);
+    if(PagedFileManager::instance().closeFile(fh) != 0) {
         return -1;
     }
+    rc = columnTable ? ColumnStoreManager::instance().destroyTable(tableName, attrs) : RecordBasedFileManager::instance().destroyFile(tableName);
+    if(rc != 0) {
+        return -1;
+    }
+    schemas.erase(tableName);
 
     RM_ScanIterator tableIt;
     std::vector<std::string> attributeNamesEmpty;   //we only want to get RID, not any fields
@@ -542,7 +571,7 @@ RC RelationManager::getAttributes(const std::string &tableName, std::vector<Attr
     while(it.getNextRecord(rid,page) != RBFM_EOF){
         byte *cur = page;
         Attribute tmp;
-        unsigned nullFieldLen = ceil(attr.size()/8.0);
+        unsigned nullFieldLen = Schema::nullIndicatorSize(attr.size());
         cur += nullFieldLen;
 
         unsigned columnNameLen = *(unsigned *)cur;
@@ -566,6 +595,23 @@ RC RelationManager::getAttributes(const std::string &tableName, std::vector<Attr
     return 0;
 }
 
+RC RelationManager::getSchema(const std::string &tableName, const Schema *&schema) {
+    map<string, Schema>::iterator cached = schemas.find(tableName);
+    if(cached == schemas.end()) {
+        std::vector<Attribute> attrs;
+        RC rc = getAttributes(tableName, attrs);
+        if(rc != 0) {
+            return rc;
+        }
+        if(attrs.empty()) { //no such table, nothing worth keeping
+            return -5;
+        }
+        cached = schemas.insert(make_pair(tableName, Schema(attrs))).first;
+    }
+    schema = &cached->second;
+    return 0;
+}
+
 /**************************************
 WHEN return value < 0:
 FILE OPEN ERROR: -1
@@ -586,11 +632,12 @@ RC RelationManager::insertTuple(const std::string &tableName, const void *data,
         }
     }
 
-    std::vector<Attribute> attrs;
-    rc = getAttributes(tableName,attrs);
+    const Schema *schema;
+    rc = getSchema(tableName,schema);
     if(rc < 0) {
         return -2;
     }
+    const Schema &attrs = *schema;
 
     FileHandle fh;
     rc = openFile(tableName,fh);
@@ -598,7 +645,8 @@ RC RelationManager::insertTuple(const std::string &tableName, const void *data,
         return -1;
     }
 
-    rc = RecordBasedFileManager::instance().insertRecord(fh,attrs,data,rid);
+    rc = ColumnStoreManager::isColumnTable(fh) ? ColumnStoreManager::instance().insertRecord(fh,tableName,attrs,data,rid)
+                                               : RecordBasedFileManager::instance().insertRecord(fh,attrs,data,rid);
     if(rc < 0) {
         closeFile(fh);
         return -3;
@@ -613,7 +661,52 @@ RC RelationManager::insertTuple(const std::string &tableName, const void *data,
    return rc;
 }
 
+RC RelationManager::insertTuples(const std::string &tableName, const std::vector<const void *> &tuples, std::vector<RID> &rids) {
+    RC rc;
+    if(!modifySystemTable_AdminRequest) {
+        bool isSysTable;
+        rc = isSystemTable(tableName, isSysTable);
+        if(rc != 0) {
+            return rc;
+        }
+        if(isSysTable) {
+            return -1;
+        }
+    }
+
+    const Schema *schema;
+    rc = getSchema(tableName,schema);
+    if(rc < 0) {
+        return -2;
+    }
+    const Schema &attrs = *schema;
+
+    FileHandle fh;
+    rc = openFile(tableName,fh);
+    if(rc != 0) {
+        return -1;
+    }
+
+    rc = ColumnStoreManager::isColumnTable(fh) ? ColumnStoreManager::instance().insertRecords(fh,tableName,attrs,tuples,rids)
+                                               : RecordBasedFileManager::instance().insertRecords(fh,attrs,tuples,rids);
+    if(rc < 0) {
+        closeFile(fh);
+        return -3;
+    }
+
+    rc = closeFile(fh);
+    if(rc != 0) {
+        return -4;
+    }
+
+    return handleIndexesForInsertion(tableName, attrs, tuples, rids);
+}
+
 RC RelationManager::handleIndexesForInsertion(const std::string &tableName, const std::vector<Attribute> &attrs, const void *data, const RID &rid) {
+    return handleIndexesForInsertion(tableName, attrs, std::vector<const void *>(1, data), std::vector<RID>(1, rid));
+}
+
+RC RelationManager::handleIndexesForInsertion(const std::string &tableName, const std::vector<Attribute> &attrs, const std::vector<const void *> &tuples, const std::vector<RID> &rids) {
 	int tableID = getIdFromTableName(tableName);
     if(tableID < 1) {
         return -1;
@@ -627,51 +720,49 @@ RC RelationManager::handleIndexesForInsertion(const std::string &tableName, cons
     if(processIndexesForTable(tableID, attributeNames, indexAttributes) != 0) {
         return -1;
     }
+    if(indexAttributes.empty()) {
+        return 0;
+    }
 
     //Once we have "attributes" map initialized with keys being attribute names for which indexes exist,
-    //we iterate through fields to check if an index is created on some of them
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(attrs.size()/8.0));
-    const byte* actualData = reinterpret_cast<const byte*>(data) + nullInfoFieldLength;
+    //we open each of these indexes once for the whole batch of tuples
+    map<unsigned, IXFileHandle> indexHandles;
+    RC rc = 0;
+    for(unsigned i = 0 ; i < attrs.size() && rc == 0 ; ++i) {
+        if(indexAttributes.find(attrs[i].name) != indexAttributes.end()) {
+            rc = IndexManager::instance().openFile(indexAttributes[attrs[i].name].filename, indexHandles[i]);
+        }
+    }
 
-    for(unsigned i = 0 ; i < attrs.size() ; ++i) {
-        const byte *byteInNullInfoField = reinterpret_cast<const byte *>(data) + i / 8;
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(attrs.size());
+    for(unsigned t = 0 ; t < tuples.size() && rc == 0 ; ++t) {
+        const byte* actualData = reinterpret_cast<const byte*>(tuples[t]) + nullInfoFieldLength;
+        for(unsigned i = 0 ; i < attrs.size() && rc == 0 ; ++i) {
+            const byte *byteInNullInfoField = reinterpret_cast<const byte *>(tuples[t]) + i / 8;
 
-        bool nullField = *byteInNullInfoField & (1 << 7 - i % 8);
-        if (!nullField) {
-        	if(indexAttributes.find(attrs[i].name) != indexAttributes.end()) {
-                //cout<<"attribute name as index key:"<<attrs[i].name<<endl;
-                IXFileHandle ixFileHandle;
-                RC rc = IndexManager::instance().openFile(indexAttributes[attrs[i].name].filename, ixFileHandle);
-                //cout<<"Open file "<<indexAttributes[attrs[i].name].filename<<" return "<<rc<<endl;
-                if(rc != 0) {
-                    IndexManager::instance().closeFile(ixFileHandle);
-                    return -1;
+            bool nullField = *byteInNullInfoField & (1 << 7 - i % 8);
+            if (!nullField) {
+                map<unsigned, IXFileHandle>::iterator index = indexHandles.find(i);
+                if(index != indexHandles.end()) {
+                    rc = IndexManager::instance().insertEntry(index->second, attrs[i], actualData, rids[t]);
                 }
 
-                rc = IndexManager::instance().insertEntry(ixFileHandle, attrs[i], actualData, rid);
-                //cout<<"insert rid:"<<rid.pageNum<<" "<<rid.slotNum<<endl;
-                //cout<<"Insert return "<<rc<<endl;
-                if(rc != 0) {
-                    IndexManager::instance().closeFile(ixFileHandle);
-                    return -1;
+                if (attrs[i].type == AttrType::TypeInt || attrs[i].type == AttrType::TypeReal) {
+                    actualData += attrs[i].length;
+                } else { //recordDescriptor[i].type == AttrType::TypeVarChar
+                    unsigned varCharLength = *reinterpret_cast<const unsigned *>(actualData);
+                    actualData += (4 + varCharLength);
                 }
-
-                rc = IndexManager::instance().closeFile(ixFileHandle);
-                if(rc != 0) {
-                    return -1;
-                }
-        	}
-
-            if (attrs[i].type == AttrType::TypeInt || attrs[i].type == AttrType::TypeReal) {
-                actualData += attrs[i].length;
-            } else { //recordDescriptor[i].type == AttrType::TypeVarChar
-                unsigned varCharLength = *reinterpret_cast<const unsigned *>(actualData);
-                actualData += (4 + varCharLength);
             }
         }
     }
 
-    return 0;
+    for(map<unsigned, IXFileHandle>::iterator index = indexHandles.begin() ; index != indexHandles.end() ; ++index) {
+        if(IndexManager::instance().closeFile(index->second) != 0) {
+            rc = -1;
+        }
+    }
+    return rc != 0 ? -1 : 0;
 }
 
 /**************************************
@@ -694,11 +785,12 @@ RC RelationManager::deleteTuple(const std::string &tableName, const RID &rid) {
         }
     }
 
-    std::vector<Attribute> attrs;
-    rc = getAttributes(tableName,attrs);
+    const Schema *schema;
+    rc = getSchema(tableName,schema);
     if(rc < 0) {
         return -2;
     }
+    const Schema &attrs = *schema;
 
     rc = handleIndexesForDeletion(tableName, attrs, rid);
     if(rc != 0) {
@@ -711,7 +803,8 @@ RC RelationManager::deleteTuple(const std::string &tableName, const RID &rid) {
         return -1;
     }
 
-    rc = RecordBasedFileManager::instance().deleteRecord(fh,attrs,rid);
+    rc = ColumnStoreManager::isColumnTable(fh) ? ColumnStoreManager::instance().deleteRecord(fh,rid)
+                                               : RecordBasedFileManager::instance().deleteRecord(fh,attrs,rid);
     if(rc < 0) {
         closeFile(fh);
         return -3;
@@ -739,14 +832,14 @@ RC RelationManager::handleIndexesForDeletion(const std::string &tableName, const
         return -1;
     }
 
-    byte data[PAGE_SIZE];
+    byte data[MAX_PAGE_SIZE];
     RC rc = readTuple(tableName, rid, data);
     if(rc != 0) {
         return -1;
     }
     //Once we have "attributes" map initialized with keys being attribute names for which indexes exist,
     //we iterate through fields to check if an index is created on some of them
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(attrs.size()/8.0));
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(attrs.size());
     const byte* actualData = reinterpret_cast<const byte*>(data) + nullInfoFieldLength;
 
     for(unsigned i = 0 ; i < attrs.size() ; ++i) {
@@ -804,11 +897,12 @@ RC RelationManager::updateTuple(const std::string &tableName, const void *data,
         }
     }
 
-    std::vector<Attribute> attrs;
-    rc = getAttributes(tableName,attrs);
+    const Schema *schema;
+    rc = getSchema(tableName,schema);
     if(rc < 0) {
         return -2;
     }
+    const Schema &attrs = *schema;
 
     rc = handleIndexesForUpdate(tableName, attrs, data, rid);
     if(rc != 0) {
@@ -821,7 +915,8 @@ RC RelationManager::updateTuple(const std::string &tableName, const void *data,
         return -1;
     }
 
-    rc = RecordBasedFileManager::instance().updateRecord(fh,attrs,data,rid);
+    rc = ColumnStoreManager::isColumnTable(fh) ? ColumnStoreManager::instance().updateRecord(fh,tableName,attrs,data,rid)
+                                               : RecordBasedFileManager::instance().updateRecord(fh,attrs,data,rid);
     if(rc < 0) {
         closeFile(fh);
         return -3;
@@ -835,6 +930,41 @@ RC RelationManager::updateTuple(const std::string &tableName, const void *data,
     return 0;
 }
 
+RC RelationManager::reclaimForwardedTuples(const std::string &tableName) {
+    FileHandle fh;
+    RC rc = openFile(tableName,fh);
+    if(rc != 0) {
+        return -1;
+    }
+
+    //Column tables never move a tuple
+    unsigned reclaimed;
+    rc = ColumnStoreManager::isColumnTable(fh) ? 0 : RecordBasedFileManager::instance().reclaimForwardedRecords(fh,reclaimed);
+    if(rc != 0) {
+        closeFile(fh);
+        return -1;
+    }
+
+    return closeFile(fh) != 0 ? -1 : 0;
+}
+
+RC RelationManager::compactTable(const std::string &tableName) {
+    FileHandle fh;
+    RC rc = openFile(tableName,fh);
+    if(rc != 0) {
+        return -1;
+    }
+
+    unsigned compacted;
+    rc = ColumnStoreManager::isColumnTable(fh) ? 0 : RecordBasedFileManager::instance().compactFile(fh,compacted);
+    if(rc != 0) {
+        closeFile(fh);
+        return -1;
+    }
+
+    return closeFile(fh) != 0 ? -1 : 0;
+}
+
 RC RelationManager::handleIndexesForUpdate(const std::string &tableName, const std::vector<Attribute> &attrs, const void *data, const RID &rid) {
     int tableID = getIdFromTableName(tableName);
     if(tableID < 1) {
@@ -850,14 +980,14 @@ RC RelationManager::handleIndexesForUpdate(const std::string &tableName, const s
     }
     cout<<"Number of matched indexes:"<<indexAttributes.size()<<endl;
 
-    byte previousData[PAGE_SIZE];
+    byte previousData[MAX_PAGE_SIZE];
     RC rc = readTuple(tableName, rid, previousData);
     if(rc != 0) {
         return -1;
     }
     //Once we have "attributes" map initialized with keys being attribute names for which indexes exist,
     //we iterate through fields to check if an index is created on some of them
-    const unsigned nullInfoFieldLength = static_cast<unsigned>(ceil(attrs.size()/8.0));
+    const unsigned nullInfoFieldLength = Schema::nullIndicatorSize(attrs.size());
     const byte* actualData = reinterpret_cast<const byte*>(previousData) + nullInfoFieldLength;
 
     for(unsigned i = 0 ; i < attrs.size() ; ++i) {
@@ -938,8 +1068,8 @@ FAIL TO READ: -3
 FILE CLOSE ERROR: -4
 **************************************/
 RC RelationManager::readTuple(const std::string &tableName, const RID &rid, void *data) {
-    std::vector<Attribute> attrs;
-    RC rc = getAttributes(tableName,attrs);
+    const Schema *schema;
+    RC rc = getSchema(tableName,schema);
     if(rc < 0) {
         return -2;
     }
@@ -950,7 +1080,8 @@ RC RelationManager::readTuple(const std::string &tableName, const RID &rid, void
         return -1;
     }
 
-    rc = RecordBasedFileManager::instance().readRecord(fh,attrs,rid,data);
+    rc = ColumnStoreManager::isColumnTable(fh) ? ColumnStoreManager::instance().readRecord(fh,tableName,*schema,rid,data)
+                                               : RecordBasedFileManager::instance().readRecord(fh,*schema,rid,data);
     if(rc != 0) {
         closeFile(fh);
         return -3;
@@ -969,8 +1100,8 @@ RC RelationManager::printTuple(const std::vector<Attribute> &attrs, const void *
 
 RC RelationManager::readAttribute(const std::string &tableName, const RID &rid, const std::string &attributeName,
                                   void *data) {
-    std::vector<Attribute> attrs;
-    RC rc = getAttributes(tableName, attrs);
+    const Schema *schema;
+    RC rc = getSchema(tableName, schema);
     if(rc != 0) {
         return -1;
     }
@@ -981,7 +1112,8 @@ RC RelationManager::readAttribute(const std::string &tableName, const RID &rid,
         return -1;
     }
 
-    rc = RecordBasedFileManager::instance().readAttribute(fh, attrs, rid, attributeName, data);
+    rc = ColumnStoreManager::isColumnTable(fh) ? ColumnStoreManager::instance().readAttribute(fh, tableName, *schema, rid, attributeName, data)
+                                               : RecordBasedFileManager::instance().readAttribute(fh, *schema, rid, attributeName, data);
     if(rc != 0) {
         closeFile(fh);
         return rc;
@@ -996,8 +1128,8 @@ RC RelationManager::scan(const std::string &tableName,
                          const void *value,
                          const std::vector<std::string> &attributeNames,
                          RM_ScanIterator &rm_ScanIterator) {
-    std::vector<Attribute> attrs;
-    RC rc = getAttributes(tableName, attrs);
+    const Schema *schema;
+    RC rc = getSchema(tableName, schema);
     if(rc != 0) {
         return -1;
     }
@@ -1008,10 +1140,68 @@ RC RelationManager::scan(const std::string &tableName,
         return -1;
     }
 
-    rc = RecordBasedFileManager::instance().scan(fh, attrs, conditionAttribute, compOp, value, attributeNames, rm_ScanIterator.getRbfmIt());
+    rm_ScanIterator.setColumnar(ColumnStoreManager::isColumnTable(fh));
+    rm_ScanIterator.setParallel(false);
+    if(rm_ScanIterator.isColumnar()) {
+        std::vector<ScanPredicate> predicates;
+        if(compOp != CompOp::NO_OP) {
+            predicates.push_back(ScanPredicate{conditionAttribute, compOp, value});
+        }
+        return ColumnStoreManager::instance().scan(fh, tableName, *schema, predicates, attributeNames, rm_ScanIterator.getCsIt());
+    }
+    rc = RecordBasedFileManager::instance().scan(fh, *schema, conditionAttribute, compOp, value, attributeNames, rm_ScanIterator.getRbfmIt());
     return rc;
 }
 
+RC RelationManager::scan(const std::string &tableName,
+                         const std::vector<ScanPredicate> &predicates,
+                         const std::vector<std::string> &attributeNames,
+                         RM_ScanIterator &rm_ScanIterator) {
+    const Schema *schema;
+    RC rc = getSchema(tableName, schema);
+    if(rc != 0) {
+        return -1;
+    }
+
+    FileHandle fh;
+    rc = openFile(tableName,fh);
+    if(rc != 0) {
+        return -1;
+    }
+
+    rm_ScanIterator.setColumnar(ColumnStoreManager::isColumnTable(fh));
+    rm_ScanIterator.setParallel(false);
+    if(rm_ScanIterator.isColumnar()) {
+        return ColumnStoreManager::instance().scan(fh, tableName, *schema, predicates, attributeNames, rm_ScanIterator.getCsIt());
+    }
+    return RecordBasedFileManager::instance().scan(fh, *schema, predicates, attributeNames, rm_ScanIterator.getRbfmIt());
+}
+
+RC RelationManager::scan(const std::string &tableName,
+                         const std::vector<ScanPredicate> &predicates,
+                         const std::vector<std::string> &attributeNames,
+                         unsigned workers,
+                         RM_ScanIterator &rm_ScanIterator) {
+    const Schema *schema;
+    RC rc = getSchema(tableName, schema);
+    if(rc != 0) {
+        return -1;
+    }
+
+    FileHandle fh;
+    rc = openFile(tableName,fh);
+    if(rc != 0) {
+        return -1;
+    }
+
+    rm_ScanIterator.setColumnar(ColumnStoreManager::isColumnTable(fh));
+    rm_ScanIterator.setParallel(!rm_ScanIterator.isColumnar());
+    if(rm_ScanIterator.isColumnar()) {
+        return ColumnStoreManager::instance().scan(fh, tableName, *schema, predicates, attributeNames, rm_ScanIterator.getCsIt());
+    }
+    return RecordBasedFileManager::instance().parallelScan(fh, *schema, predicates, attributeNames, workers, rm_ScanIterator.getParallelIt());
+}
+
 /*
  * This function searches in 'Indexes' CATALOG for entries
  * satisfy: 'tableID' field = tableID in  and 'attribute-name' field in set 'attributeNames'.
@@ -1035,7 +1225,7 @@ RC RelationManager::processIndexesForTable(const unsigned &tableID, const std::s
 
     while(it.getNextRecord(rid,page) != RBFM_EOF){
         byte *cur = page;
-        unsigned nullFieldLen = ceil(attr.size()/8.0);
+        unsigned nullFieldLen = Schema::nullIndicatorSize(attr.size());
         cur += nullFieldLen; // Null field and table id field
 
         unsigned attributeNameLen = *(unsigned *)cur;
@@ -1076,7 +1266,8 @@ RC RelationManager::createIndex(const std::string &tableName, const std::string
 
     //Our index files will have the following names: TableName_AttributeName
     const string indexFileName = tableName + "_" + attributeName;
-    if(IndexManager::instance().createFile(indexFileName) != 0) {
+    unsigned pageSize;
+    if(getPageSize(tableName, pageSize) != 0 || IndexManager::instance().createFile(indexFileName, pageSize) != 0) {
         return -1;
     }
 
@@ -1101,7 +1292,7 @@ RC RelationManager::createIndex(const std::string &tableName, const std::string
 	}
 
     //Populate index based on existing records in the given table
-    byte page[PAGE_SIZE];
+    byte page[MAX_PAGE_SIZE];
     RID rid;
     RM_ScanIterator tableIt;
     //std::vector<string> projectedAttr = {attributeName};
@@ -1120,7 +1311,7 @@ RC RelationManager::createIndex(const std::string &tableName, const std::string
     while(tableIt.getNextTuple(rid,page) != RBFM_EOF){
         byte *cur = page;
         //NO_OP returns also nulls so have to test for them, and it can be tested with null indicators.
-        unsigned nullFieldLen = ceil(projectedAttr.size()/8.0);
+        unsigned nullFieldLen = Schema::nullIndicatorSize(projectedAttr.size());
         if(!(*cur)){
             cur += nullFieldLen;
 
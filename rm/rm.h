@@ -6,6 +6,8 @@
 #include <map>
 
 #include "../rbf/rbfm.h"
+#include "../rbf/colstore.h"
+#include "../rbf/parallelscan.h"
 #include "../ix/ix.h"
 
 # define RM_EOF (-1)  // end of a scan operator
@@ -13,6 +15,10 @@
 // RM_ScanIterator is an iterator to go through tuples
 class RM_ScanIterator {
     RBFM_ScanIterator rbfmIt;
+    CS_ScanIterator csIt;       // used instead for column tables
+    bool columnar = false;
+    RBFM_ParallelScanIterator parallelIt;   // used instead by a parallel scan
+    bool parallel = false;
 
 public:
     RM_ScanIterator() = default;
@@ -27,10 +33,45 @@ public:
         return rbfmIt;
     }
 
+    CS_ScanIterator& getCsIt() {
+        return csIt;
+    }
+
+    void setColumnar(bool columnar) {
+        RM_ScanIterator::columnar = columnar;
+    }
+
+    bool isColumnar() const {
+        return columnar;
+    }
+
+    RBFM_ParallelScanIterator& getParallelIt() {
+        return parallelIt;
+    }
+
+    void setParallel(bool parallel) {
+        RM_ScanIterator::parallel = parallel;
+    }
+
+    bool isParallel() const {
+        return parallel;
+    }
+
     // "data" follows the same format as RelationManager::insertTuple()
-    RC getNextTuple(RID &rid, void *data) { return rbfmIt.getNextRecord(rid, data); };
+    RC getNextTuple(RID &rid, void *data) {
+        return columnar ? csIt.getNextRecord(rid, data) : (parallel ? parallelIt.getNextRecord(rid, data) : rbfmIt.getNextRecord(rid, data));
+    };
+
+    // The tuple read in place, see RBFM_ScanIterator::getNextRecordView() (CS_ScanIterator::getNextRecordView() on
+    // a column table). Not available in a parallel scan (-1), its tuples are copied out by the workers
+    RC getNextTupleView(RID &rid, RecordView &view) {
+        return columnar ? csIt.getNextRecordView(rid, view) : (parallel ? -1 : rbfmIt.getNextRecordView(rid, view));
+    };
+
+    // The next tuples as column vectors, see CS_ScanIterator::getNextBatch(). Column tables only, -1 otherwise
+    RC getNextBatch(ColumnBatch &batch) { return columnar ? csIt.getNextBatch(batch) : -1; };
 
-    RC close() { return rbfmIt.close(); };
+    RC close() { return columnar ? csIt.close() : (parallel ? parallelIt.close() : rbfmIt.close()); };
 };
 
 // RM_IndexScanIterator is an iterator to go through index entries
@@ -93,22 +134,40 @@ public:
 
     RC deleteCatalog();
 
-    RC createTable(const std::string &tableName, const std::vector<Attribute> &attrs);
+    // pageSize is the page size of the table file; the indexes later built on the table use it too.
+    // layout is how its pages store the tuples (see PageLayout), the file remembers it. COLUMN_LAYOUT makes it a
+    // column table, stored by ColumnStoreManager with a file per attribute
+    RC createTable(const std::string &tableName, const std::vector<Attribute> &attrs, unsigned pageSize = PAGE_SIZE, PageLayout layout = ROW_LAYOUT);
 
     RC createTableHelper(const std::string &tableName, const std::vector<Attribute> &attrs, bool isSystemTable);
 
     RC isSystemTable(const std::string& tableName, bool& isSysTable);
 
+    RC getPageSize(const std::string &tableName, unsigned &pageSize);
+
     RC deleteTable(const std::string &tableName);
 
     RC getAttributes(const std::string &tableName, std::vector<Attribute> &attrs);
 
+    // The attributes of the table compiled into a Schema, kept until the table or the catalog changes.
+    // "schema" stays valid until then
+    RC getSchema(const std::string &tableName, const Schema *&schema);
+
     RC insertTuple(const std::string &tableName, const void *data, RID &rid);
 
+    // Bulk insertion, see RecordBasedFileManager::insertRecords(). The indexes of the table are opened once per call
+    RC insertTuples(const std::string &tableName, const std::vector<const void *> &tuples, std::vector<RID> &rids);
+
     RC deleteTuple(const std::string &tableName, const RID &rid);
 
     RC updateTuple(const std::string &tableName, const void *data, const RID &rid);
 
+    // Brings tuples moved away by updates back to their home page when it has room, see RecordBasedFileManager::reclaimForwardedRecords()
+    RC reclaimForwardedTuples(const std::string &tableName);
+
+    // Gives the space of deleted tuples back to the free space of their pages, see RecordBasedFileManager::compactFile()
+    RC compactTable(const std::string &tableName);
+
     RC readTuple(const std::string &tableName, const RID &rid, void *data);
 
     // Print a tuple that is passed to this utility method.
@@ -126,6 +185,20 @@ public:
             const std::vector<std::string> &attributeNames, // a list of projected attributes
             RM_ScanIterator &rm_ScanIterator);
 
+    // Scan with a conjunction of predicates, see RecordBasedFileManager::scan()
+    RC scan(const std::string &tableName,
+            const std::vector<ScanPredicate> &predicates,
+            const std::vector<std::string> &attributeNames,
+            RM_ScanIterator &rm_ScanIterator);
+
+    // Same scan run by "workers" threads at once (0: one per core), see RecordBasedFileManager::parallelScan(): the
+    // tuples come in no particular order. A column table is scanned as by the scan above
+    RC scan(const std::string &tableName,
+            const std::vector<ScanPredicate> &predicates,
+            const std::vector<std::string> &attributeNames,
+            unsigned workers,
+            RM_ScanIterator &rm_ScanIterator);
+
     RC processIndexesForTable(const unsigned &tableID, const std::set<std::string> &attributeNames, std::map<std::string, IndexAttributeInfo>& attributes);
 
     // Extra credit work (10 points)
@@ -161,9 +234,14 @@ private:
     std::vector<Attribute> indexesDescriptor; //Descriptor of 'Indexes' which is  initialized when object created
 
     RC handleIndexesForInsertion(const std::string &tableName, const std::vector<Attribute> &attrs, const void *data, const RID &rid);
+
+    RC handleIndexesForInsertion(const std::string &tableName, const std::vector<Attribute> &attrs, const std::vector<const void *> &tuples, const std::vector<RID> &rids);
+
     RC handleIndexesForDeletion(const std::string &tableName, const std::vector<Attribute> &attrs, const RID &rid);
     RC handleIndexesForUpdate(const std::string &tableName, const std::vector<Attribute> &attrs, const void *data, const RID &rid);
 
+    std::map<std::string, Schema> schemas; //Cache of getSchema()
+
     unsigned lastTableID;
     bool modifySystemTable_AdminRequest;
 };
@@ -0,0 +1,154 @@
+#include "rm_test_util.h"
+
+const int batchTupleCount = 1500;
+
+// A Name of 1 to 200 letters picked by "id", Age NULL for every 4th tuple
+void prepareBatchTuple(int id, void *buffer, int *tupleSize) {
+    int offset = 0;
+    memset(buffer, id % 4 == 0 ? 0x40 : 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    if (id % 4 != 0) {
+        int age = id % 90;
+        memcpy((char *) buffer + offset, &age, sizeof(int));
+        offset += sizeof(int);
+    }
+    int nameLength = 1 + (id * 13) % 200;
+    memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+    offset += nameLength;
+    *tupleSize = offset;
+}
+
+// Persistent page counters of the file of the table
+void tableCounters(const std::string &tableName, unsigned &reads, unsigned &writes, unsigned &appends, unsigned &pages) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(tableName, fileHandle);
+    assert(rc == success && "Opening the file of the table should not fail.");
+    rc = fileHandle.collectCounterValues(reads, writes, appends);
+    assert(rc == success && "Collecting the counters should not fail.");
+    pages = fileHandle.getNumberOfPages();
+    rbfm.closeFile(fileHandle);
+}
+
+RC TEST_RM_Batch(const std::string &tableName) {
+    // Functions Tested
+    // 1. insertTuples() with varchars and NULLs, over many pages
+    // 2. Each RID it returns reads back its tuple, one write or append per filled page
+    // 3. The indexes of the table are maintained: an index scan finds every tuple under its RID
+    std::cout << std::endl << "***** In RM Test Case Batch *****" << std::endl;
+
+    std::vector<Attribute> attrs;
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+    attr.name = "Age";
+    attrs.push_back(attr);
+    attr.name = "Name";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 200;
+    attrs.push_back(attr);
+
+    RC rc = rm.createTable(tableName, attrs);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+    rc = rm.createIndex(tableName, "Id");
+    assert(rc == success && "RelationManager::createIndex() should not fail.");
+    rc = rm.createIndex(tableName, "Name");
+    assert(rc == success && "RelationManager::createIndex() should not fail.");
+
+    std::vector<std::vector<char> > tuples(batchTupleCount, std::vector<char>(300));
+    std::vector<const void *> data(batchTupleCount);
+    int tupleSize;
+    for (int id = 0; id < batchTupleCount; id++) {
+        prepareBatchTuple(id, tuples[id].data(), &tupleSize);
+        data[id] = tuples[id].data();
+    }
+    // A first tuple: the batch starts on its page
+    char tuple[300];
+    RID firstRid;
+    prepareBatchTuple(batchTupleCount, tuple, &tupleSize);
+    rc = rm.insertTuple(tableName, tuple, firstRid);
+    assert(rc == success && "RelationManager::insertTuple() should not fail.");
+
+    unsigned readsBefore, writesBefore, appendsBefore, pagesBefore;
+    tableCounters(tableName, readsBefore, writesBefore, appendsBefore, pagesBefore);
+    std::vector<RID> rids;
+    rc = rm.insertTuples(tableName, data, rids);
+    assert(rc == success && rids.size() == (size_t) batchTupleCount && "RelationManager::insertTuples() should not fail.");
+    unsigned reads, writes, appends, pages;
+    tableCounters(tableName, reads, writes, appends, pages);
+    std::set<unsigned> dataPages;
+    for (int id = 0; id < batchTupleCount; id++) {
+        dataPages.insert(rids[id].pageNum);
+    }
+    assert(dataPages.size() > 10 && rids[0].pageNum == firstRid.pageNum && "The batch should fill many pages.");
+    assert(appends - appendsBefore == pages - pagesBefore && pages - pagesBefore == dataPages.size() - 1
+           && "Each new page should be appended once.");
+    assert(writes - writesBefore == 2 && "The first page and the free space map should be written once.");
+
+    char returnedData[300];
+    for (int id = 0; id < batchTupleCount; id++) {
+        rc = rm.readTuple(tableName, rids[id], returnedData);
+        assert(rc == success && "RelationManager::readTuple() should not fail.");
+        prepareBatchTuple(id, tuples[id].data(), &tupleSize);
+        assert(memcmp(tuples[id].data(), returnedData, tupleSize) == 0 && "A tuple should read back as written.");
+    }
+
+    // Every Id, in order, under the RID of its tuple
+    RM_IndexScanIterator rmisi;
+    int highId = batchTupleCount - 1;
+    rc = rm.indexScan(tableName, "Id", NULL, &highId, true, true, rmisi);
+    assert(rc == success && "RelationManager::indexScan() should not fail.");
+    RID rid;
+    char key[300];
+    int count = 0;
+    while (rmisi.getNextEntry(rid, key) != RM_EOF) {
+        int id;
+        memcpy(&id, key, sizeof(int));
+        assert(id == count && rid.pageNum == rids[id].pageNum && rid.slotNum == rids[id].slotNum
+               && "The index should have every tuple under its RID.");
+        count++;
+    }
+    rmisi.close();
+    assert(count == batchTupleCount && "The index should have every tuple.");
+
+    // The tuples of one Name, through the varchar index and the iterator of the unbounded scan above
+    const int probe = 7;
+    int nameLength;
+    memcpy(&nameLength, tuples[probe].data() + 1 + 2 * sizeof(int), sizeof(int));
+    memcpy(key, tuples[probe].data() + 1 + 2 * sizeof(int), sizeof(int) + nameLength);
+    rc = rm.indexScan(tableName, "Name", key, key, true, true, rmisi);
+    assert(rc == success && "RelationManager::indexScan() should not fail.");
+    std::set<int> found;
+    while (rmisi.getNextEntry(rid, key) != RM_EOF) {
+        rc = rm.readTuple(tableName, rid, returnedData);
+        assert(rc == success && "An index entry should point to a tuple.");
+        int id;
+        memcpy(&id, returnedData + 1, sizeof(int));
+        assert(rid.pageNum == rids[id].pageNum && rid.slotNum == rids[id].slotNum && "An entry should point to its tuple.");
+        found.insert(id);
+    }
+    rmisi.close();
+    std::set<int> expected;
+    for (int id = 0; id < batchTupleCount; id++) {
+        if (1 + (id * 13) % 200 == nameLength && id % 26 == probe % 26) {
+            expected.insert(id);
+        }
+    }
+    assert(found == expected && "The varchar index should find every tuple of the Name.");
+
+    rc = rm.deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    std::cout << "***** RM Test Case Batch Finished. The result will be examined. *****" << std::endl << std::endl;
+    return success;
+}
+
+int main() {
+    // Bulk insertion into a table with indexes
+    return TEST_RM_Batch("tbl_batch");
+}
@@ -0,0 +1,166 @@
+#include "rm_test_util.h"
+
+// Tuple i: Id i, Name "Col<i>" followed by "extra" times '+', Score i/4 (NULL for every 5th tuple)
+void prepareColumnTuple(int i, int extra, void *buffer, int *tupleSize) {
+    std::string name = "Col" + std::to_string(i) + std::string(extra, '+');
+    int nameLength = name.size();
+    float score = i / 4.0f;
+    int offset = 0;
+    memset(buffer, i % 5 == 0 ? 1 << 5 : 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &i, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, name.data(), nameLength);
+    offset += nameLength;
+    if (i % 5 != 0) {
+        memcpy((char *) buffer + offset, &score, sizeof(float));
+        offset += sizeof(float);
+    }
+    *tupleSize = offset;
+}
+
+void checkColumnTuple(const std::string &tableName, const RID &rid, int i, int extra) {
+    char tuple[200];
+    char returnedData[200];
+    int tupleSize;
+    prepareColumnTuple(i, extra, tuple, &tupleSize);
+    RC rc = rm.readTuple(tableName, rid, returnedData);
+    assert(rc == success && "RelationManager::readTuple() should not fail.");
+    assert(memcmp(tuple, returnedData, tupleSize) == 0 && "The tuple should read back as last written.");
+}
+
+RC TEST_RM_ColumnStore(const std::string &tableName) {
+    // Functions Tested on a column table
+    // 1. Insert, read, read an attribute
+    // 2. Update to a longer varchar, delete
+    // 3. Scan a tuple at a time, then a batch at a time
+    // 4. Scan projecting an attribute the table doesn't have
+    std::cout << std::endl << "***** In RM Test Case ColumnStore *****" << std::endl;
+
+    std::vector<Attribute> attrs;
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+    attr.name = "Name";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 50;
+    attrs.push_back(attr);
+    attr.name = "Score";
+    attr.type = TypeReal;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+
+    RC rc = rm.createTable(tableName, attrs, PAGE_SIZE, COLUMN_LAYOUT);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+
+    // More tuples than a batch holds
+    const int numTuples = 2500;
+    char tuple[200];
+    int tupleSize;
+    std::vector<RID> rids(numTuples);
+    std::vector<int> extras(numTuples, 0);
+    for (int i = 0; i < numTuples; i++) {
+        prepareColumnTuple(i, 0, tuple, &tupleSize);
+        rc = rm.insertTuple(tableName, tuple, rids[i]);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+    }
+    for (int i = 0; i < numTuples; i += 97) {
+        checkColumnTuple(tableName, rids[i], i, 0);
+    }
+    float score;
+    rc = rm.readAttribute(tableName, rids[6], "Score", tuple);
+    memcpy(&score, tuple + 1, sizeof(float));
+    assert(rc == success && tuple[0] == 0 && score == 1.5f && "RelationManager::readAttribute() should return the value.");
+    rc = rm.readAttribute(tableName, rids[5], "Score", tuple);
+    assert(rc == success && (tuple[0] & 0x80) != 0 && "RelationManager::readAttribute() should return a NULL.");
+
+    // Every 3rd tuple gets a longer name, every 10th is deleted
+    std::set<int> live;
+    for (int i = 0; i < numTuples; i++) {
+        if (i % 3 == 0) {
+            extras[i] = 20;
+            prepareColumnTuple(i, extras[i], tuple, &tupleSize);
+            rc = rm.updateTuple(tableName, tuple, rids[i]);
+            assert(rc == success && "RelationManager::updateTuple() should not fail.");
+        }
+        if (i % 10 == 0) {
+            rc = rm.deleteTuple(tableName, rids[i]);
+            assert(rc == success && "RelationManager::deleteTuple() should not fail.");
+        }
+        else {
+            live.insert(i);
+        }
+    }
+    rc = rm.readTuple(tableName, rids[10], tuple);
+    assert(rc != success && "Reading a deleted tuple should fail.");
+    for (int i = 1; i < numTuples; i += 31) {
+        if (i % 10 != 0) {
+            checkColumnTuple(tableName, rids[i], i, extras[i]);
+        }
+    }
+
+    // Id >= 1000, projected on (Name, Id)
+    RM_ScanIterator rmsi;
+    int lowId = 1000;
+    std::vector<std::string> attributes = {"Name", "Id"};
+    rc = rm.scan(tableName, "Id", GE_OP, &lowId, attributes, rmsi);
+    assert(rc == success && "RelationManager::scan() should not fail.");
+    RID rid;
+    std::set<int> returned;
+    while ((rc = rmsi.getNextTuple(rid, tuple)) != RM_EOF) {
+        assert(rc == success && "RM_ScanIterator::getNextTuple() should not fail.");
+        int nameLength, id;
+        memcpy(&nameLength, tuple + 1, sizeof(int));
+        memcpy(&id, tuple + 1 + sizeof(int) + nameLength, sizeof(int));
+        std::string name = "Col" + std::to_string(id) + std::string(extras[id], '+');
+        assert(nameLength == (int) name.size() && memcmp(tuple + 1 + sizeof(int), name.data(), nameLength) == 0
+               && "The projected attributes should come in the order asked.");
+        assert(rid.pageNum == rids[id].pageNum && rid.slotNum == rids[id].slotNum && "A tuple should be scanned under its RID.");
+        assert(returned.insert(id).second && "A tuple should be returned once.");
+    }
+    rmsi.close();
+    assert(returned == std::set<int>(live.lower_bound(lowId), live.end()) && "The scan should return the live tuples satisfying the condition.");
+
+    // The same rows a batch at a time, Score only: a NULL for every 5th
+    rc = rm.scan(tableName, "", NO_OP, NULL, std::vector<std::string>(1, "Score"), rmsi);
+    assert(rc == success && "RelationManager::scan() should not fail.");
+    ColumnBatch batch;
+    returned.clear();
+    unsigned batches = 0;
+    while ((rc = rmsi.getNextBatch(batch)) != RM_EOF) {
+        assert(rc == success && "RM_ScanIterator::getNextBatch() should not fail.");
+        assert(batch.size() > 0 && batch.size() <= CS_BATCH_SIZE && batch.columns.size() == 1 && "A batch holds the projected column of its rows.");
+        const ColumnVector &column = batch.columns[0];
+        assert(column.type == TypeReal && column.nulls.size() == batch.size() && column.reals.size() == batch.size()
+               && "A batch should hold a value per row.");
+        for (unsigned r = 0; r < batch.size(); r++) {
+            int id = batch.rows[r];
+            assert((column.nulls[r] != 0) == (id % 5 == 0) && (column.nulls[r] || column.reals[r] == id / 4.0f)
+                   && "A batch should hold the values of its rows.");
+            assert(returned.insert(id).second && "A row should be returned once.");
+        }
+        batches++;
+    }
+    rmsi.close();
+    assert(returned == live && batches >= (live.size() + CS_BATCH_SIZE - 1) / CS_BATCH_SIZE && "The batches should hold every live row.");
+
+    attributes = {"Id", "Bonus"};
+    rc = rm.scan(tableName, "", NO_OP, NULL, attributes, rmsi);
+    assert(rc != success && "Projecting an unknown attribute should fail.");
+    rmsi.close();
+
+    rc = rm.deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    std::cout << "***** RM Test Case ColumnStore Finished. The result will be examined. *****" << std::endl << std::endl;
+    return success;
+}
+
+int main() {
+    // Tuples of a column table
+    return TEST_RM_ColumnStore("tbl_colstore");
+}
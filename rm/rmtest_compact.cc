@@ -0,0 +1,118 @@
+#include "rm_test_util.h"
+
+const int compactTupleCount = 40;
+const int compactTextLength = 300;
+
+// A tuple whose Text is "compactTextLength" times the same letter, picked by "id"
+void prepareCompactTuple(int id, void *buffer, int *tupleSize) {
+    int offset = 0;
+    memset(buffer, 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &compactTextLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, compactTextLength);
+    offset += compactTextLength;
+    *tupleSize = offset;
+}
+
+// Dead bytes of all the pages of the table, straight from its file
+unsigned deadBytesOfTable(const std::string &tableName) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(tableName, fileHandle);
+    assert(rc == success && "Opening the file of the table should not fail.");
+    unsigned deadBytes = 0;
+    byte page[PAGE_SIZE];
+    for (unsigned p = 0; p < fileHandle.getNumberOfPages(); p++) {
+        rc = fileHandle.readPage(p, page);
+        assert(rc == success && "Reading a page should not fail.");
+        deadBytes += RecordBasedFileManager::deadBytes(page);
+    }
+    rbfm.closeFile(fileHandle);
+    return deadBytes;
+}
+
+RC TEST_RM_Compact(const std::string &tableName) {
+    // Functions Tested
+    // 1. Delete tuples: their bytes stay in the pages as dead bytes
+    // 2. Compact the table, then read the surviving tuples under their RIDs
+    // 3. Scan the compacted table
+    std::cout << std::endl << "***** In RM Test Case Compact *****" << std::endl;
+
+    std::vector<Attribute> attrs;
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+    attr.name = "Text";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 1000;
+    attrs.push_back(attr);
+
+    RC rc = rm.createTable(tableName, attrs);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+
+    char tuple[2000];
+    char returnedData[2000];
+    int tupleSize;
+    std::vector<RID> rids(compactTupleCount);
+    for (int id = 0; id < compactTupleCount; id++) {
+        prepareCompactTuple(id, tuple, &tupleSize);
+        rc = rm.insertTuple(tableName, tuple, rids[id]);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+    }
+
+    // Every third tuple goes, leaving holes on every page
+    for (int id = 0; id < compactTupleCount; id += 3) {
+        rc = rm.deleteTuple(tableName, rids[id]);
+        assert(rc == success && "RelationManager::deleteTuple() should not fail.");
+    }
+    assert(deadBytesOfTable(tableName) > 0 && "Deleted tuples should leave dead bytes.");
+
+    rc = rm.compactTable(tableName);
+    assert(rc == success && "RelationManager::compactTable() should not fail.");
+    assert(deadBytesOfTable(tableName) == 0 && "A compacted table has no dead bytes.");
+
+    std::set<int> live;
+    for (int id = 0; id < compactTupleCount; id++) {
+        rc = rm.readTuple(tableName, rids[id], returnedData);
+        if (id % 3 == 0) {
+            assert(rc != success && "Reading a deleted tuple should fail.");
+            continue;
+        }
+        assert(rc == success && "RelationManager::readTuple() should not fail.");
+        prepareCompactTuple(id, tuple, &tupleSize);
+        assert(memcmp(tuple, returnedData, tupleSize) == 0 && "A tuple should read back as written after the compaction.");
+        live.insert(id);
+    }
+
+    RM_ScanIterator rmsi;
+    rc = rm.scan(tableName, "", NO_OP, NULL, std::vector<std::string>(1, "Id"), rmsi);
+    assert(rc == success && "RelationManager::scan() should not fail.");
+    RID rid;
+    std::set<int> returned;
+    while (rmsi.getNextTuple(rid, returnedData) != RM_EOF) {
+        int id;
+        memcpy(&id, returnedData + 1, sizeof(int));
+        assert(rid.pageNum == rids[id].pageNum && rid.slotNum == rids[id].slotNum && "A tuple should keep its RID.");
+        assert(returned.insert(id).second && "A tuple should be returned once.");
+    }
+    rmsi.close();
+    assert(returned == live && "The scan should return the surviving tuples.");
+
+    rc = rm.compactTable("tbl_compact_missing");
+    assert(rc != success && "Compacting a table that doesn't exist should fail.");
+
+    rc = rm.deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    std::cout << "***** RM Test Case Compact Finished. The result will be examined. *****" << std::endl << std::endl;
+    return success;
+}
+
+int main() {
+    // Compaction of the pages of a table
+    return TEST_RM_Compact("tbl_compact");
+}
@@ -0,0 +1,150 @@
+#include "rm_test_util.h"
+
+const int pageSizeTupleCount = 200;
+
+// Id, then a Text of "textLength" times the same letter picked by "id", then Score, NULL for every 4th tuple
+void preparePageSizeTuple(int id, int textLength, void *buffer, int *tupleSize) {
+    int offset = 0;
+    float score = id / 4.0f;
+    memset(buffer, id % 4 == 0 ? 0x20 : 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &textLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, textLength);
+    offset += textLength;
+    if (id % 4 != 0) {
+        memcpy((char *) buffer + offset, &score, sizeof(float));
+        offset += sizeof(float);
+    }
+    *tupleSize = offset;
+}
+
+// A quarter of the tuples don't fit in a page of 4096 bytes
+int pageSizeTextLength(int id, unsigned pageSize) {
+    return id % 4 == 1 ? pageSize / 2 + 100 : 30 + id % 40;
+}
+
+// Inserts, updates (some tuples move away from their page), scans and index scans a table of "pageSize" bytes pages
+void testTablePageSize(const std::string &tableName, unsigned pageSize, PageLayout layout) {
+    std::vector<Attribute> attrs;
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+    attr.name = "Text";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) (pageSize / 2 + 200);
+    attrs.push_back(attr);
+    attr.name = "Score";
+    attr.type = TypeReal;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+
+    RC rc = rm.createTable(tableName, attrs, pageSize, layout);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+    unsigned tablePageSize;
+    rc = rm.getPageSize(tableName, tablePageSize);
+    assert(rc == success && tablePageSize == pageSize && "The table should have the page size it was created with.");
+
+    std::vector<char> tuple(MAX_PAGE_SIZE + 100);
+    std::vector<char> returnedData(MAX_PAGE_SIZE + 100);
+    int tupleSize;
+    std::vector<RID> rids(pageSizeTupleCount);
+    std::vector<int> textLengths(pageSizeTupleCount);
+    for (int id = 0; id < pageSizeTupleCount; id++) {
+        textLengths[id] = pageSizeTextLength(id, pageSize);
+        preparePageSizeTuple(id, textLengths[id], tuple.data(), &tupleSize);
+        rc = rm.insertTuple(tableName, tuple.data(), rids[id]);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+    }
+
+    // The index gets the page size of its table, the updates keep it up to date
+    rc = rm.createIndex(tableName, "Id");
+    assert(rc == success && "RelationManager::createIndex() should not fail.");
+
+    // Short tuples grown to a wide Text no longer fit on their page
+    for (int id = 2; id < pageSizeTupleCount; id += 6) {
+        textLengths[id] = pageSize / 2 + 200;
+        preparePageSizeTuple(id, textLengths[id], tuple.data(), &tupleSize);
+        rc = rm.updateTuple(tableName, tuple.data(), rids[id]);
+        assert(rc == success && "RelationManager::updateTuple() should not fail.");
+    }
+    for (int id = 0; id < pageSizeTupleCount; id++) {
+        rc = rm.readTuple(tableName, rids[id], returnedData.data());
+        assert(rc == success && "RelationManager::readTuple() should not fail.");
+        preparePageSizeTuple(id, textLengths[id], tuple.data(), &tupleSize);
+        assert(memcmp(tuple.data(), returnedData.data(), tupleSize) == 0 && "A tuple should read back as written.");
+    }
+
+    // Score > 20, projected on (Text): each wide Text whole
+    RM_ScanIterator rmsi;
+    float lowScore = 20.0f;
+    rc = rm.scan(tableName, "Score", GT_OP, &lowScore, std::vector<std::string>(1, "Text"), rmsi);
+    assert(rc == success && "RelationManager::scan() should not fail.");
+    RID rid;
+    int count = 0;
+    int wide = 0;
+    while (rmsi.getNextTuple(rid, returnedData.data()) != RM_EOF) {
+        int textLength;
+        memcpy(&textLength, returnedData.data() + 1, sizeof(int));
+        assert(textLength <= (int) pageSize / 2 + 200 && "The scan should return the Text of a tuple.");
+        const char letter = returnedData[1 + sizeof(int)];
+        assert(returnedData[sizeof(int) + textLength] == letter && "The scan should return the whole Text.");
+        wide += textLength > (int) PAGE_SIZE;
+        count++;
+    }
+    rmsi.close();
+    int expected = 0;
+    int expectedWide = 0;
+    for (int id = 81; id < pageSizeTupleCount; id++) {
+        if (id % 4 != 0) {
+            expected++;
+            expectedWide += textLengths[id] > (int) PAGE_SIZE;
+        }
+    }
+    // A row page returns a forwarded tuple at its new place as well
+    assert(count >= expected && wide >= expectedWide && "The scan should return every matching tuple.");
+    assert((layout != PAX_LAYOUT || count == expected) && "The scan should return every matching tuple once.");
+
+    // Id in [50, 149], in order, with the RIDs the tuples were inserted under
+    RM_IndexScanIterator rmisi;
+    int lowKey = 50, highKey = 149;
+    rc = rm.indexScan(tableName, "Id", &lowKey, &highKey, true, true, rmisi);
+    assert(rc == success && "RelationManager::indexScan() should not fail.");
+    int key;
+    int previous = lowKey - 1;
+    while (rmisi.getNextEntry(rid, &key) != RM_EOF) {
+        assert(key == previous + 1 && "The index scan should return the keys in order.");
+        assert(rid.pageNum == rids[key].pageNum && rid.slotNum == rids[key].slotNum && "An entry should point to its tuple.");
+        previous = key;
+    }
+    rmisi.close();
+    assert(previous == highKey && "The index scan should return the whole range.");
+
+    rc = rm.deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+}
+
+RC TEST_RM_PageSize(const std::string &tableName) {
+    // Functions Tested
+    // 1. Tables of 8K and 64K pages, in both row layouts: tuples with a Text wider than 4096 bytes and NULLs
+    // 2. Updates moving tuples away from their page, read back under their RIDs
+    // 3. A scan with a condition and a projection, an index scan on an index of the same page size
+    std::cout << std::endl << "***** In RM Test Case PageSize *****" << std::endl;
+
+    testTablePageSize(tableName, 2 * PAGE_SIZE, ROW_LAYOUT);
+    testTablePageSize(tableName, MAX_PAGE_SIZE, ROW_LAYOUT);
+    testTablePageSize(tableName, 2 * PAGE_SIZE, PAX_LAYOUT);
+    testTablePageSize(tableName, MAX_PAGE_SIZE, PAX_LAYOUT);
+
+    std::cout << "***** RM Test Case PageSize Finished. The result will be examined. *****" << std::endl << std::endl;
+    return success;
+}
+
+int main() {
+    // Tables whose pages are larger than the default
+    return TEST_RM_PageSize("tbl_pagesize");
+}
@@ -0,0 +1,108 @@
+#include "rm_test_util.h"
+
+// A tuple whose Text is "textLength" times the same letter, picked by "id"
+void prepareReclaimTuple(int id, int textLength, void *buffer, int *tupleSize) {
+    int offset = 0;
+    memset(buffer, 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &textLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, textLength);
+    offset += textLength;
+    *tupleSize = offset;
+}
+
+void checkReclaimTuple(const std::string &tableName, const RID &rid, int id, int textLength) {
+    char tuple[2000];
+    char returnedData[2000];
+    int tupleSize;
+    prepareReclaimTuple(id, textLength, tuple, &tupleSize);
+    RC rc = rm.readTuple(tableName, rid, returnedData);
+    assert(rc == success && "RelationManager::readTuple() should not fail.");
+    assert(memcmp(tuple, returnedData, tupleSize) == 0 && "The tuple should read back as last written.");
+}
+
+// Where the record of the tuple is stored, straight from the file of the table
+RID locateTuple(const std::string &tableName, const std::vector<Attribute> &attrs, const RID &rid) {
+    FileHandle fileHandle;
+    RC rc = rbfm.openFile(tableName, fileHandle);
+    assert(rc == success && "Opening the file of the table should not fail.");
+    RID location;
+    rc = rbfm.locateRecord(fileHandle, attrs, rid, location);
+    assert(rc == success && "Locating a record should not fail.");
+    rbfm.closeFile(fileHandle);
+    return location;
+}
+
+RC TEST_RM_Reclaim(const std::string &tableName) {
+    // Functions Tested
+    // 1. Update a tuple that no longer fits on its page
+    // 2. Delete tuples of its page
+    // 3. Reclaim forwarded tuples
+    std::cout << std::endl << "***** In RM Test Case Reclaim *****" << std::endl;
+
+    std::vector<Attribute> attrs;
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+    attr.name = "Text";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) 1000;
+    attrs.push_back(attr);
+
+    RC rc = rm.createTable(tableName, attrs);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+
+    const int numTuples = 24;
+    char tuple[2000];
+    int tupleSize;
+    std::vector<RID> rids(numTuples);
+    for (int i = 0; i < numTuples; i++) {
+        prepareReclaimTuple(i, 300, tuple, &tupleSize);
+        rc = rm.insertTuple(tableName, tuple, rids[i]);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+    }
+
+    // The page of the first tuple is full, the grown tuple is forwarded
+    prepareReclaimTuple(0, 900, tuple, &tupleSize);
+    rc = rm.updateTuple(tableName, tuple, rids[0]);
+    assert(rc == success && "RelationManager::updateTuple() should not fail.");
+    assert(locateTuple(tableName, attrs, rids[0]).pageNum != rids[0].pageNum && "The grown tuple should be forwarded.");
+
+    rc = rm.reclaimForwardedTuples(tableName);
+    assert(rc == success && "RelationManager::reclaimForwardedTuples() should not fail.");
+    assert(locateTuple(tableName, attrs, rids[0]).pageNum != rids[0].pageNum && "A tuple can't go back to a page without room.");
+
+    // Deletions make room on its page, the tuple comes back
+    for (int i = 1; i <= 3; i++) {
+        rc = rm.deleteTuple(tableName, rids[i]);
+        assert(rc == success && "RelationManager::deleteTuple() should not fail.");
+    }
+    rc = rm.reclaimForwardedTuples(tableName);
+    assert(rc == success && "RelationManager::reclaimForwardedTuples() should not fail.");
+    RID location = locateTuple(tableName, attrs, rids[0]);
+    assert(location.pageNum == rids[0].pageNum && location.slotNum == rids[0].slotNum && "The tuple should be back in its home slot.");
+
+    checkReclaimTuple(tableName, rids[0], 0, 900);
+    for (int i = 4; i < numTuples; i++) {
+        checkReclaimTuple(tableName, rids[i], i, 300);
+    }
+
+    rc = rm.reclaimForwardedTuples("tbl_not_there");
+    assert(rc != success && "RelationManager::reclaimForwardedTuples() on a missing table should fail.");
+
+    rc = rm.deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    std::cout << "***** RM Test Case Reclaim Finished. The result will be examined. *****" << std::endl << std::endl;
+    return success;
+}
+
+int main() {
+    // Reclaim forwarded tuples
+    return TEST_RM_Reclaim("tbl_reclaim");
+}
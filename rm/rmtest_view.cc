@@ -0,0 +1,154 @@
+#include "rm_test_util.h"
+
+const int viewTupleCount = 300;
+const int grownNameLength = 300;
+
+// Name of "nameLength" letters picked by "id", Score NULL for every 3rd tuple
+void prepareViewTuple(int id, int nameLength, void *buffer, int *tupleSize) {
+    int offset = 0;
+    memset(buffer, id % 3 == 0 ? 0x20 : 0, 1);
+    offset += 1;
+    memcpy((char *) buffer + offset, &id, sizeof(int));
+    offset += sizeof(int);
+    memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+    offset += sizeof(int);
+    memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+    offset += nameLength;
+    if (id % 3 != 0) {
+        float score = id * 0.5f;
+        memcpy((char *) buffer + offset, &score, sizeof(float));
+        offset += sizeof(float);
+    }
+    *tupleSize = offset;
+}
+
+// Every 10th tuple grows past the room of its page, every 7th other one is deleted
+bool isGrown(int id) {
+    return id % 10 == 1;
+}
+
+bool isDeleted(int id) {
+    return id % 7 == 0 && !isGrown(id);
+}
+
+int nameLengthOf(int id) {
+    return isGrown(id) ? grownNameLength : 10 + id % 20;
+}
+
+// The tuples of the table through RM_ScanIterator::getNextTupleView(), with Score >= 20: each view holds Id, Name
+// and Score in that order, and projects the tuple as written
+void checkTupleViews(const std::string &tableName) {
+    RM_ScanIterator rmsi;
+    const float minScore = 20.0f;
+    std::vector<std::string> attributes = {"Id", "Name", "Score"};
+    RC rc = rm.scan(tableName, "Score", GE_OP, &minScore, attributes, rmsi);
+    assert(rc == success && "RelationManager::scan() should not fail.");
+
+    std::vector<bool> seen(viewTupleCount, false);
+    RID rid;
+    RecordView view;
+    char tuple[400];
+    char projected[400];
+    int tupleSize;
+    while (rmsi.getNextTupleView(rid, view) != RM_EOF) {
+        assert(view.isValid() && view.getFieldCount() == 3 && "The view should hold the attributes of the table.");
+        const int id = view.getInt(0);
+        assert(id >= 0 && id < viewTupleCount && !isDeleted(id) && "A scan should not return a deleted tuple.");
+        unsigned length;
+        const char *name = view.getVarChar(1, length);
+        assert(std::string(name, length) == std::string(nameLengthOf(id), 'a' + id % 26) && "The varchar should be read in place.");
+        assert(!view.isNull(2) && view.getReal(2) >= minScore && "The view should satisfy the condition.");
+        prepareViewTuple(id, nameLengthOf(id), tuple, &tupleSize);
+        assert(view.project(projected) == (unsigned) tupleSize && memcmp(projected, tuple, tupleSize) == 0
+               && "The view should project the tuple as written.");
+        seen[id] = true;
+    }
+    rmsi.close();
+    for (int id = 0; id < viewTupleCount; id++) {
+        assert(seen[id] == (!isDeleted(id) && id % 3 != 0 && id * 0.5f >= minScore)
+               && "The scan should return every live tuple that satisfies it.");
+    }
+}
+
+RC TEST_RM_View(const std::string &tableName, PageLayout layout) {
+    // Functions Tested
+    // 1. RM_ScanIterator::getNextTupleView() on a row table, over forwarded tuples
+    // 2. Same on a column table, whose views hold the projected attributes only
+    // 3. NULLs and varchars read in place, the views projected as the tuples were written
+    std::cout << std::endl << "***** In RM Test Case View *****" << std::endl;
+
+    std::vector<Attribute> attrs;
+    Attribute attr;
+    attr.name = "Id";
+    attr.type = TypeInt;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+    attr.name = "Name";
+    attr.type = TypeVarChar;
+    attr.length = (AttrLength) grownNameLength;
+    attrs.push_back(attr);
+    attr.name = "Score";
+    attr.type = TypeReal;
+    attr.length = (AttrLength) 4;
+    attrs.push_back(attr);
+
+    RC rc = rm.createTable(tableName, attrs, PAGE_SIZE, layout);
+    assert(rc == success && "RelationManager::createTable() should not fail.");
+
+    char tuple[400];
+    int tupleSize;
+    std::vector<RID> rids(viewTupleCount);
+    for (int id = 0; id < viewTupleCount; id++) {
+        prepareViewTuple(id, 10 + id % 20, tuple, &tupleSize);
+        rc = rm.insertTuple(tableName, tuple, rids[id]);
+        assert(rc == success && "RelationManager::insertTuple() should not fail.");
+    }
+    for (int id = 0; id < viewTupleCount; id++) {
+        if (isGrown(id)) {
+            prepareViewTuple(id, grownNameLength, tuple, &tupleSize);
+            rc = rm.updateTuple(tableName, tuple, rids[id]);
+            assert(rc == success && "RelationManager::updateTuple() should not fail.");
+        } else if (isDeleted(id)) {
+            rc = rm.deleteTuple(tableName, rids[id]);
+            assert(rc == success && "RelationManager::deleteTuple() should not fail.");
+        }
+    }
+
+    checkTupleViews(tableName);
+
+    // Score, then Id: a column table builds the view of the projection, its NULLs included
+    if (layout == COLUMN_LAYOUT) {
+        RM_ScanIterator rmsi;
+        std::vector<std::string> attributes = {"Score", "Id"};
+        rc = rm.scan(tableName, "", NO_OP, NULL, attributes, rmsi);
+        assert(rc == success && "RelationManager::scan() should not fail.");
+        RID rid;
+        RecordView view;
+        int count = 0;
+        while (rmsi.getNextTupleView(rid, view) != RM_EOF) {
+            assert(view.getFieldCount() == 2 && "The view should hold the projected attributes.");
+            const int id = view.getInt(1);
+            assert(view.isNull(0) == (id % 3 == 0) && (view.isNull(0) || view.getReal(0) == id * 0.5f)
+                   && "The projected real should keep its NULL.");
+            count++;
+        }
+        rmsi.close();
+        int live = 0;
+        for (int id = 0; id < viewTupleCount; id++) {
+            live += !isDeleted(id);
+        }
+        assert(count == live && "The scan should return every live tuple.");
+    }
+
+    rc = rm.deleteTable(tableName);
+    assert(rc == success && "RelationManager::deleteTable() should not fail.");
+
+    std::cout << "***** RM Test Case View Finished. The result will be examined. *****" << std::endl << std::endl;
+    return success;
+}
+
+int main() {
+    // Tuples read in place, in a row table and in a column table
+    TEST_RM_View("tbl_view", ROW_LAYOUT);
+    return TEST_RM_View("tbl_view_col", COLUMN_LAYOUT);
+}